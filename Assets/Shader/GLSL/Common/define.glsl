@@ -25,6 +25,7 @@
 const float GLSL_INFINITY = 1.0 / 0.0;
 const float EPSILON = 0.001;
 const uint MAX_ARR_SIZE = 64;
+const float TRAVERSAL_HEATMAP_SCALE = 1024.0;
 
 const float PI = 3.14159265358979323846;
 const float PI_INV = 1.0 / PI;
@@ -37,8 +38,21 @@ const float SHININESS = 32.0;
 const float SPECULAR_STRENGTH = 0.5;
 const float AMBIENT_STRENGTH = 0.1;
 
+// Cascades of the shadow map, laid out side by side in one image.
+const int SHADOW_MAP_MAX_CASCADE_COUNT = 4;
+
 uint XORShift_RNG = 0;
 
+// Rays traced and bounding boxes and triangles tested by the current invocation.
+uint ray_count = 0;
+uint ray_node_visit_count = 0;
+uint ray_triangle_visit_count = 0;
+
+// Counters of the path tracing statistics buffer, each one a 64-bit value split into a low and a high word.
+const uint PATH_TRACING_COUNTER_RAY = 0;
+const uint PATH_TRACING_COUNTER_NODE = 1;
+const uint PATH_TRACING_COUNTER_TRIANGLE = 2;
+
 
 
 
@@ -0,0 +1,49 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+// Records of the current scene, one per mesh, culled against every view by culling.comp.
+layout(std430, set = 0, binding = 10) readonly buffer DrawRecordBuffer {
+    GLSL_DrawRecord draw_records[];
+};
+
+// One region per view, a header of four words followed by a VkDrawIndirectCommand per draw. The header counts
+// the draws written, holds the record count of the scene and counts the records culled by the frustum and the
+// ones the early camera phase found occluded. A word per record follows the regions, set for the late phase. The
+// regions grow with the scene, their stride is passed in the push constants.
+layout(std430, set = 0, binding = 11) buffer DrawCommandBuffer {
+    uint draw_commands[];
+};
+
+const uint DRAW_VIEW_CAMERA = 0;
+const uint DRAW_VIEW_LIGHT = 1;
+const uint DRAW_VIEW_CAMERA_LATE = 2;
+const uint DRAW_VIEW_COUNT = 3;
+
+const uint DRAW_COMMAND_HEADER_DRAW_COUNT = 0;
+const uint DRAW_COMMAND_HEADER_RECORD_COUNT = 1;
+const uint DRAW_COMMAND_HEADER_FRUSTUM_CULLED_COUNT = 2;
+const uint DRAW_COMMAND_HEADER_OCCLUDED_COUNT = 3;
+
+const uint DRAW_COMMAND_HEADER_WORDS = 4;
@@ -25,6 +25,12 @@
 layout(std430, push_constant) uniform PushConstantObject {
     int current_present_image_index;
     int current_frame;
+    int path_tracing_frame_index;
+    // Set by the shadow mapping pass for every cascade it draws.
+    int shadow_map_cascade;
+    // Set by the culling pass, the records a view region holds and its size in words.
+    int draw_record_capacity;
+    int draw_command_view_stride;
 } push_constant_object;
 
 
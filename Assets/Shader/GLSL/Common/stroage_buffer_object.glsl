@@ -25,18 +25,36 @@
 #extension GL_ARB_shader_storage_buffer_object : enable
 
 
-layout(std430, set = 0, binding = 0) buffer StorageBufferObject {
+layout(std430, set = 0, binding = 0) readonly buffer StorageBufferObject {
     int bvh_node_count;
     int material_count;
     int vertex_count;
-    GLSL_BVHNode bvh_node[64];
-    GLSL_Material materials[32];
-    vec4 vertex_position[256];
-    vec4 vertex_normal[256];
-    int vertex_material_id[256];
-    int vertex_entity_id[256];
 } ssbo;
 
+layout(std430, set = 0, binding = 1) readonly buffer BVHNodeBuffer {
+    GLSL_BVHNode bvh_node[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer MaterialBuffer {
+    GLSL_Material materials[];
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer VertexPositionBuffer {
+    vec4 vertex_position[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer VertexNormalBuffer {
+    vec4 vertex_normal[];
+};
+
+layout(std430, set = 0, binding = 5) readonly buffer VertexMaterialIdBuffer {
+    int vertex_material_id[];
+};
+
+layout(std430, set = 0, binding = 6) readonly buffer VertexEntityIdBuffer {
+    int vertex_entity_id[];
+};
+
 
 
 
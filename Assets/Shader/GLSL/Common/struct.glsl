@@ -50,6 +50,12 @@ struct GLSL_BVHNode {
     int vertex_count;
 };
 
+struct GLSL_DrawRecord {
+    GLSL_AABB aabb;
+    int first_vertex;
+    int vertex_count;
+};
+
 struct GLSL_RasterizationCamera {
     vec3 position;
     mat4 view_matrix;
@@ -80,11 +86,6 @@ struct GLSL_Ray {
     vec3 direction;
 };
 
-struct GLSL_HitInfo {
-    float t;
-    int index;
-};
-
 struct GLSL_IntersectInfo {
     bool hit;
     float t;
@@ -105,4 +106,7 @@ struct GLSL_Light {
     mat4 space_matrix;
     vec3 le;
     int entity_id;
+    mat4 cascade_space_matrices[SHADOW_MAP_MAX_CASCADE_COUNT];
+    vec4 cascade_split_depths;
+    int cascade_count;
 };
\ No newline at end of file
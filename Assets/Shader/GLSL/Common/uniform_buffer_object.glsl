@@ -22,10 +22,15 @@
  * SOFTWARE.
  */
 
-layout(std140, set = 1, binding = 0) uniform UniformBufferObject{
+layout(std140, set = 0, binding = 7) uniform UniformBufferObject{
     int rendering_model;
     int path_tracing_spp;
     int path_tracing_max_depth;
+    int path_tracing_enable_bvh_acceleration;
+    int path_tracing_traversal_heatmap;
+    int path_tracing_collect_statistics;
+    int upscaling_enable;
+    float upscaling_sharpness;
     mat4 model_matrix;
     GLSL_RasterizationCamera rasterization_camera;
     GLSL_PhysicallyBasedCamera physically_based_camera;
@@ -22,5 +22,13 @@
  * SOFTWARE.
  */
 
-layout(set = 5, binding = 0, rgba32f) uniform image2D uniform_path_tracing_image;
+// Storage image array of the global descriptor set.
+layout(set = 0, binding = 9, rgba32f) uniform image2D global_storage_images[2];
+
+#define uniform_path_tracing_image global_storage_images[0]
+#define uniform_path_tracing_accumulation_image global_storage_images[1]
+
+layout(std430, set = 0, binding = 8) buffer PathTracingStatisticsBuffer {
+    uint path_tracing_counters[];
+};
 
@@ -0,0 +1,43 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UNIFORM_SAMPLER_GLOBAL_GLSL
+#define UNIFORM_SAMPLER_GLOBAL_GLSL
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Texture array of the global descriptor set, integer textures alias the same binding.
+layout(set = 0, binding = 12) uniform sampler2D global_textures[];
+layout(set = 0, binding = 12) uniform usampler2D global_utextures[];
+
+// Handles of the built in textures, registered ones follow them.
+const uint GLOBAL_TEXTURE_RASTERIZATION_COLOR = 0;
+const uint GLOBAL_TEXTURE_SHADOW_MAP = 1;
+const uint GLOBAL_TEXTURE_RANDOM = 2;
+const uint GLOBAL_TEXTURE_PATH_TRACING = 3;
+const uint GLOBAL_TEXTURE_RASTERIZATION_DEPTH = 4;
+const uint GLOBAL_TEXTURE_HI_Z = 5;
+const uint GLOBAL_TEXTURE_UPSCALING = 6;
+
+#endif
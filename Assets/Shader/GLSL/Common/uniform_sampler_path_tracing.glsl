@@ -22,4 +22,6 @@
  * SOFTWARE.
  */
 
-layout(set = 6, binding = 0) uniform sampler2D uniform_path_tracing_sampler;
\ No newline at end of file
+#include "uniform_sampler_global.glsl"
+
+#define uniform_path_tracing_sampler global_textures[GLOBAL_TEXTURE_PATH_TRACING]
\ No newline at end of file
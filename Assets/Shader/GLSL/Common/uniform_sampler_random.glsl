@@ -22,4 +22,6 @@
  * SOFTWARE.
  */
 
-layout(set = 4, binding = 0) uniform usampler2D uniform_random_sampler;
\ No newline at end of file
+#include "uniform_sampler_global.glsl"
+
+#define uniform_random_sampler global_utextures[GLOBAL_TEXTURE_RANDOM]
\ No newline at end of file
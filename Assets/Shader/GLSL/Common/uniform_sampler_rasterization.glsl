@@ -22,4 +22,6 @@
  * SOFTWARE.
  */
 
-layout(set = 2, binding = 0) uniform sampler2D uniform_rasterization_sampler;
\ No newline at end of file
+#include "uniform_sampler_global.glsl"
+
+#define uniform_rasterization_sampler global_textures[GLOBAL_TEXTURE_RASTERIZATION_COLOR]
\ No newline at end of file
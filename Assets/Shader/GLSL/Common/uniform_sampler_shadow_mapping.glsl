@@ -22,4 +22,6 @@
  * SOFTWARE.
  */
 
-layout(set = 3, binding = 0) uniform sampler2D uniform_shadow_mapping_sampler;
\ No newline at end of file
+#include "uniform_sampler_global.glsl"
+
+#define uniform_shadow_mapping_sampler global_textures[GLOBAL_TEXTURE_SHADOW_MAP]
\ No newline at end of file
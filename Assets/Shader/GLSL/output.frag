@@ -26,12 +26,13 @@
 
 #extension GL_ARB_separate_shader_objects : enable
 
-
+#include "define.glsl"
 #include "struct.glsl"
 #include "push_constant_object.glsl"
 #include "uniform_buffer_object.glsl"
 #include "uniform_sampler_rasterization.glsl"
 #include "uniform_sampler_path_tracing.glsl"
+#include "uniform_sampler_upscaling.glsl"
 
 layout(location = 0) in struct dto {
     vec2 texcoord;
@@ -42,11 +43,17 @@ layout(location = 0) out vec4 out_colour;
 void main() {
     switch(ubo.rendering_model) {
         case 0: {
-            out_colour = vec4(texture(uniform_path_tracing_sampler, in_dto.texcoord).xyz, 1.0);
+            vec3 colour = 1 == ubo.upscaling_enable ?
+                          texture(uniform_upscaling_sampler, in_dto.texcoord).xyz :
+                          texture(uniform_path_tracing_sampler, in_dto.texcoord).xyz;
+            out_colour = vec4(pow(colour, vec3(0.4545)), 1.0);
             break;
         }
         case 1: {
-            out_colour = vec4(texture(uniform_rasterization_sampler, in_dto.texcoord).xyz, 1.0);
+            vec3 colour = 1 == ubo.upscaling_enable ?
+                          texture(uniform_upscaling_sampler, in_dto.texcoord).xyz :
+                          texture(uniform_rasterization_sampler, in_dto.texcoord).xyz;
+            out_colour = vec4(colour, 1.0);
             break;
         }
     }
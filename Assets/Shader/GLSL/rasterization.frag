@@ -36,11 +36,32 @@ layout(location = 0) in struct dto {
     vec3 position;
     vec3 normal;
     vec4 color;
-    vec4 shadow_coord;
+    float view_depth;
 } in_dto;
 
 layout(location = 0) out vec4 out_colour;
 
+// The cascades sit side by side in the shadow map, each one covering the view depths up to its split.
+float shadowFactor() {
+    int cascade = 0;
+    while(cascade < ubo.light.cascade_count - 1 && in_dto.view_depth > ubo.light.cascade_split_depths[cascade]) {
+        ++cascade;
+    }
+
+    vec4 light_position = ubo.light.cascade_space_matrices[cascade]
+                         *ubo.model_matrix * vec4(in_dto.position, 1.0);
+    vec3 shadow_coord = light_position.xyz / light_position.w;
+    vec2 st = shadow_coord.st * 0.5 + 0.5;
+    if(shadow_coord.z <= -1.0 || shadow_coord.z >= 1.0 ||
+       any(lessThan(st, vec2(0.0))) || any(greaterThan(st, vec2(1.0)))) {
+        return 1.0;
+    }
+
+    st.s = (float(cascade) + st.s) / float(ubo.light.cascade_count);
+    float dist = texture(uniform_shadow_mapping_sampler, st).r;
+    return dist + 0.001 < shadow_coord.z ? AMBIENT_STRENGTH : 1.0;
+}
+
 vec4 illuminationBlinnPhong() {
     vec4 result_color = vec4(0.0, 0.0, 0.0, 1.0);
 
@@ -63,14 +84,7 @@ vec4 illuminationBlinnPhong() {
         vec3 ambient = AMBIENT_STRENGTH * material_diffuse_color;
 
         //
-        float shadow = 1.0;
-        vec3 shadow_coord = in_dto.shadow_coord.xyz / in_dto.shadow_coord.w;
-        if ( shadow_coord.z > -1.0 && shadow_coord.z < 1.0 ){
-            float dist = texture(uniform_shadow_mapping_sampler, shadow_coord.st).r;
-            if (dist + 0.001 < shadow_coord.z) {
-                shadow = AMBIENT_STRENGTH;
-            }
-        }
+        float shadow = shadowFactor();
 
         //
         result_color = vec4(shadow * (specular + diffuse + ambient), 1.0);
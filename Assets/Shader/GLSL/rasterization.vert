@@ -40,24 +40,17 @@ layout(location = 0) out struct dto {
     vec3 position;
     vec3 normal;
     vec4 color;
-    vec4 shadow_coord;
+    float view_depth;
 } out_dto;
 
-const mat4 bias_mat = mat4(
-0.5, 0.0, 0.0, 0.0,
-0.0, 0.5, 0.0, 0.0,
-0.0, 0.0, 1.0, 0.0,
-0.5, 0.5, 0.0, 1.0);
-
 void main() {
     out_dto.position = in_position.xyz;
     out_dto.normal = in_normal.xyz;
-    out_dto.color = ssbo.materials[in_material_id].albedo;
-    out_dto.shadow_coord = bias_mat
-                          *ubo.light.space_matrix
-                          *ubo.model_matrix * vec4(in_position.xyz, 1.0);
-
-    gl_Position = ubo.rasterization_camera.projection_matrix
-                 *ubo.rasterization_camera.view_matrix
-                 *ubo.model_matrix * vec4(in_position.xyz, 1.0);
+    out_dto.color = materials[in_material_id].albedo;
+
+    vec4 view_position = ubo.rasterization_camera.view_matrix
+                        *ubo.model_matrix * vec4(in_position.xyz, 1.0);
+    out_dto.view_depth = -view_position.z;
+
+    gl_Position = ubo.rasterization_camera.projection_matrix * view_position;
 }
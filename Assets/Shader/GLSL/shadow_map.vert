@@ -29,9 +29,11 @@
 #include "define.glsl"
 #include "struct.glsl"
 #include "uniform_buffer_object.glsl"
+#include "push_constant_object.glsl"
 
 layout(location = 0) in vec4 in_position;
 
 void main() {
-    gl_Position = ubo.light.space_matrix * ubo.model_matrix * vec4(in_position.xyz, 1.0);
+    gl_Position = ubo.light.cascade_space_matrices[push_constant_object.shadow_map_cascade]
+                 *ubo.model_matrix * vec4(in_position.xyz, 1.0);
 }
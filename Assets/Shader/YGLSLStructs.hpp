@@ -49,6 +49,12 @@ struct alignas(16) GLSL_BVHNode {
     int vertex_count;
 };
 
+struct alignas(16) GLSL_DrawRecord {
+    GLSL_AABB aabb;
+    int first_vertex;
+    int vertex_count;
+};
+
 struct alignas(16) GLSL_Material {
     glm::fvec4 albedo;
     int brdf_type;
@@ -74,6 +80,9 @@ struct alignas(16) GLSL_PhysicallyBasedCamera {
     float image_sensor_height;
 };
 
+// Matches SHADOW_MAP_MAX_CASCADE_COUNT of define.glsl.
+#define SHADOW_MAP_MAX_CASCADE_COUNT 4
+
 struct alignas(16) GLSL_Light {
     glm::fvec3 center;
     alignas(16) glm::fvec3 p0;
@@ -83,24 +92,29 @@ struct alignas(16) GLSL_Light {
     alignas(16) glm::fmat4x4 space_matrix;
     glm::fvec3 le;
     int entity_id;
+    // space_matrix cropped to the camera frustum slice of every cascade, a single cascade keeps it uncropped.
+    glm::fmat4x4 cascade_space_matrices[SHADOW_MAP_MAX_CASCADE_COUNT];
+    // View depth each cascade ends at.
+    glm::fvec4 cascade_split_depths;
+    int cascade_count;
 };
 
-struct alignas(16) GLSL_SSBO {
+struct alignas(16) GLSL_SceneInfo {
     int bvh_node_count;
     int material_count;
     int vertex_count;
-    GLSL_BVHNode bvh_node[64];
-    GLSL_Material materials[32];
-    glm::fvec4 vertex_position[256];
-    glm::fvec4 vertex_normal[256];
-    int vertex_material_id[256];
-    int vertex_entity_id[256];
 };
 
 struct alignas(16) GLSL_UBO{
     int rendering_model;
     int path_tracing_spp;
     int path_tracing_max_depth;
+    int path_tracing_enable_bvh_acceleration;
+    int path_tracing_traversal_heatmap;
+    int path_tracing_collect_statistics;
+    // Set when the render size differs from the display, output then samples the upscaled image.
+    int upscaling_enable;
+    float upscaling_sharpness;
     alignas(16) glm::fmat4x4 model_matrix;
     GLSL_RasterizationCamera rasterization_camera;
     GLSL_PhysicallyBasedCamera physically_based_camera;
@@ -110,6 +124,10 @@ struct alignas(16) GLSL_UBO{
 struct alignas(16) GLSL_PushConstantObject {
     int current_present_image_index;
     int current_frame;
+    int path_tracing_frame_index;
+    int shadow_map_cascade;
+    int draw_record_capacity;
+    int draw_command_view_stride;
 };
 
 
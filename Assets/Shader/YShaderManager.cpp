@@ -71,6 +71,9 @@ void YShaderManager::init() {
     this->compileGlslToSpv(YeAssetsShader::Shadow_Map_Vert, shaderc_vertex_shader);
     this->compileGlslToSpv(YeAssetsShader::Shadow_Map_Frag, shaderc_fragment_shader);
     this->compileGlslToSpv(YeAssetsShader::Path_Tracing_Comp, shaderc_compute_shader);
+    this->compileGlslToSpv(YeAssetsShader::Culling_Comp, shaderc_compute_shader);
+    this->compileGlslToSpv(YeAssetsShader::Hi_Z_Comp, shaderc_compute_shader);
+    this->compileGlslToSpv(YeAssetsShader::Upscaling_Comp, shaderc_compute_shader);
 #else
     this->readSpv(YeAssetsShader::Output_Vert);
     this->readSpv(YeAssetsShader::Output_Frag);
@@ -79,6 +82,9 @@ void YShaderManager::init() {
     this->readSpv(YeAssetsShader::Shadow_Map_Vert);
     this->readSpv(YeAssetsShader::Shadow_Map_Frag);
     this->readSpv(YeAssetsShader::Path_Tracing_Comp);
+    this->readSpv(YeAssetsShader::Culling_Comp);
+    this->readSpv(YeAssetsShader::Hi_Z_Comp);
+    this->readSpv(YeAssetsShader::Upscaling_Comp);
 #endif
 }
 
@@ -35,6 +35,7 @@
 static std::map<enum YeAssetsImage, std::string> g_image_file_map;
 static std::map<enum YeAssetsShader, std::string> g_glsl_file_map;
 static std::map<enum YeAssetsShader, std::string> g_spv_file_map;
+static std::string g_pipeline_cache_file;
 
 void yInitAssets() {
     std::string exe_path = YGlobalInterface::instance()->getPathExecutable();
@@ -53,6 +54,9 @@ void yInitAssets() {
     g_glsl_file_map.emplace(YeAssetsShader::Shadow_Map_Vert, project_path + "/Assets/Shader/GLSL/shadow_map.vert");
     g_glsl_file_map.emplace(YeAssetsShader::Shadow_Map_Frag, project_path + "/Assets/Shader/GLSL/shadow_map.frag");
     g_glsl_file_map.emplace(YeAssetsShader::Path_Tracing_Comp, project_path + "/Assets/Shader/GLSL/path_tracing.comp");
+    g_glsl_file_map.emplace(YeAssetsShader::Culling_Comp, project_path + "/Assets/Shader/GLSL/culling.comp");
+    g_glsl_file_map.emplace(YeAssetsShader::Hi_Z_Comp, project_path + "/Assets/Shader/GLSL/hi_z.comp");
+    g_glsl_file_map.emplace(YeAssetsShader::Upscaling_Comp, project_path + "/Assets/Shader/GLSL/upscaling.comp");
 
     std::string spv_glsl_dir_str = exe_path + "/Assets/Shader/spv_glsl";
     std::filesystem::path spv_glsl_dir = spv_glsl_dir_str;
@@ -72,6 +76,11 @@ void yInitAssets() {
     g_spv_file_map.emplace(YeAssetsShader::Shadow_Map_Vert, spv_glsl_dir_str + "/shadow_map.vert.spv");
     g_spv_file_map.emplace(YeAssetsShader::Shadow_Map_Frag, spv_glsl_dir_str + "/shadow_map.frag.spv");
     g_spv_file_map.emplace(YeAssetsShader::Path_Tracing_Comp, spv_glsl_dir_str + "/path_tracing.comp.spv");
+    g_spv_file_map.emplace(YeAssetsShader::Culling_Comp, spv_glsl_dir_str + "/culling.comp.spv");
+    g_spv_file_map.emplace(YeAssetsShader::Hi_Z_Comp, spv_glsl_dir_str + "/hi_z.comp.spv");
+    g_spv_file_map.emplace(YeAssetsShader::Upscaling_Comp, spv_glsl_dir_str + "/upscaling.comp.spv");
+
+    g_pipeline_cache_file = exe_path + "/pipeline_cache.bin";
 
     YShaderManager::instance();
 }
@@ -88,6 +97,10 @@ const char* yAssetsSpvFile(enum YeAssetsShader s) {
     return g_spv_file_map.find(s)->second.c_str();
 }
 
+const char* yAssetsPipelineCacheFile() {
+    return g_pipeline_cache_file.c_str();
+}
+
 u32* getSpvCode(enum YeAssetsShader s) {
     return YShaderManager::instance()->getSpvCode(s);
 }
@@ -47,13 +47,17 @@ enum YeAssetsShader{
     Rasterization_Frag,
     Shadow_Map_Vert,
     Shadow_Map_Frag,
-    Path_Tracing_Comp
+    Path_Tracing_Comp,
+    Culling_Comp,
+    Hi_Z_Comp,
+    Upscaling_Comp
 };
 
 void yInitAssets();
 const char* yAssetsImageFile(enum YeAssetsImage e);
 const char* yAssetsGlslFile(enum YeAssetsShader s);
 const char* yAssetsSpvFile(enum YeAssetsShader s);
+const char* yAssetsPipelineCacheFile();
 
 u32* getSpvCode(enum YeAssetsShader s);
 u64 getSpvCodeSize(enum YeAssetsShader s);
@@ -37,6 +37,14 @@
 #include "YMath.h"
 
 
+// The bounds are taken from the positions, so they stay exact for the culling and the scene bound.
+static void computeMeshAABB(YsMeshComponent* mesh) {
+    mesh->aabb.reset();
+    for(const auto& position : mesh->positions) {
+        mesh->aabb.expand(glm::fvec3(position));
+    }
+}
+
 void YMdlaImporter::import(const std::string& file_path) {
     std::string thread_id = YGlobalInterface::instance()->getCurrentThreadId();
     YINFO("Parse stl file begin, thread id: %s", thread_id.c_str());
@@ -69,8 +77,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh_floor->normals.push_back(normal);
         }
 
-        mesh_floor->aabb.min = glm::fvec3(0.0f, 0.0f, 0.0f);
-        mesh_floor->aabb.max = glm::fvec3(549.6f, 0.0f, 559.2f);
+        computeMeshAABB(mesh_floor);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_floor->id);
@@ -102,8 +109,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh->normals.push_back(normal);
         }
 
-        mesh->aabb.min = glm::fvec3(213.0f, 547.8f, 227.0f);
-        mesh->aabb.max = glm::fvec3(343.0f, 547.8f, 332.0f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_light->id);
@@ -146,8 +152,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh->normals.push_back(normal);
         }
 
-        mesh->aabb.min = glm::fvec3(0.0f, 548.8f, 0.0f);
-        mesh->aabb.max = glm::fvec3(556.0f, 548.8f, 559.2f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_ceiling->id);
@@ -179,8 +184,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh->normals.push_back(normal);
         }
 
-        mesh->aabb.min = glm::fvec3(0.0f, 0.0f, 559.2f);
-        mesh->aabb.max = glm::fvec3(556.0f, 548.8f, 559.2f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_back_wall->id);
@@ -212,8 +216,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh->normals.push_back(normal);
         }
 
-        mesh->aabb.min = glm::fvec3(0.0f, 0.0f, 0.0f);
-        mesh->aabb.max = glm::fvec3(0.0f, 548.8f, 559.2f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_right_wall->id);
@@ -244,8 +247,7 @@ void YMdlaImporter::import(const std::string& file_path) {
             mesh->normals.push_back(normal);
         }
 
-        mesh->aabb.min = glm::fvec3(549.6f, 0.0f, 0.0f);
-        mesh->aabb.max = glm::fvec3(556.0f, 548.8f, 559.2f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_left_wall->id);
@@ -356,8 +358,7 @@ void YMdlaImporter::import(const std::string& file_path) {
                 mesh->normals.push_back(normal);
             }
         }
-        mesh->aabb.min = glm::fvec3(82.0f, 0.0f, 65.0f);
-        mesh->aabb.max = glm::fvec3(290.0f, 165.0f, 272.0f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_short_block->id);
@@ -468,8 +469,7 @@ void YMdlaImporter::import(const std::string& file_path) {
                 mesh->normals.push_back(normal);
             }
         }
-        mesh->aabb.min = glm::fvec3(265.0f, 0.0f, 247.0f);
-        mesh->aabb.min = glm::fvec3(472.0f, 330.0f, 456.0f);
+        computeMeshAABB(mesh);
 
         //
         YsMaterialComponent* material = YSceneManager::instance()->createComponent<YsMaterialComponent>(entity_tall_block->id);
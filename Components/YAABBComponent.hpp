@@ -60,11 +60,21 @@ struct YsAABBComponent : public YsComponent {
         }
     }
 
+    void expand(const glm::fvec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
     void reset() {
         min = glm::fvec3(9999.0f);
         max = glm::fvec3(-9999.0f);
     }
 
+    f32 surfaceArea() const {
+        glm::fvec3 length = glm::max(max - min, glm::fvec3(0.0f));
+        return 2.0f * (length.x * length.y + length.y * length.z + length.z * length.x);
+    }
+
     f32 boundingSphereRadius() {
         glm::fvec3 length = max - min;
 
@@ -37,7 +37,8 @@ struct YsBVHNodeComponent : public YsComponent {
     YsAABBComponent aabb;
     std::unique_ptr<YsBVHNodeComponent> left = nullptr;
     std::unique_ptr<YsBVHNodeComponent> right = nullptr;
-    std::vector<YsMeshComponent*> meshes;
+    u32 triangle_index = 0;
+    u32 triangle_count = 0;
 
     bool isLeaf() const {
         return !left && !right;
@@ -28,6 +28,7 @@
 
 #include <iostream>
 #include <future>
+#include <chrono>
 #include <functional>
 #include <utility>
 #include <type_traits>
@@ -60,6 +61,15 @@ public:
         return future.get();
     }
 
+    bool valid() const {
+        return future.valid();
+    }
+
+    // Whether getResult would return without blocking.
+    bool ready() const {
+        return future.valid() && std::future_status::ready == future.wait_for(std::chrono::seconds(0));
+    }
+
 private:
     std::future<ReturnType> future;
 };
@@ -42,11 +42,6 @@ void yGenerateUintRand(u32 count, u32* data) {
     }
 }
 
-u32 ySsboSize() {
-    u32 size = sizeof(GLSL_SSBO);
-    return size;
-}
-
 u32 yUboSize() {
     u32 size = sizeof(GLSL_UBO);
     return size;
@@ -57,6 +52,11 @@ u32 yPushConstantSize() {
     return size;
 }
 
+u32 yDrawRecordSize() {
+    u32 size = sizeof(GLSL_DrawRecord);
+    return size;
+}
+
 f32 yRoundToOneDecimal(f32 value){
     return floor(value * 10 + 0.5) / 10;
 }
\ No newline at end of file
@@ -34,9 +34,9 @@ extern "C" {
 
 void yGenerateUintRand(u32 count, u32* data);
 
-u32 ySsboSize();
 u32 yUboSize();
 u32 yPushConstantSize();
+u32 yDrawRecordSize();
 
 f32 yRoundToOneDecimal(f32 value);
 
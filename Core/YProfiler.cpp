@@ -27,6 +27,7 @@
 
 #include <chrono>
 #include <thread>
+#include <algorithm>
 
 YProfiler* YProfiler::instance() {
     static YProfiler profiler;
@@ -61,6 +62,27 @@ void YProfiler::functionTimer() {
         this->m_gpu_fps = 1000.0 / (this->m_gpu_frame_time_accumulator / this->m_gpu_frame_count);
         this->m_gpu_frame_time_accumulator = 0;
         this->m_gpu_frame_count = 0;
+
+        // Keep the last reading while nothing is being dragged.
+        if(this->m_ubo_update_count > 0) {
+            this->m_ubo_update_latency = this->m_ubo_update_latency_accumulator / this->m_ubo_update_count;
+            this->m_ubo_update_latency_accumulator = 0;
+            this->m_ubo_update_count = 0;
+        }
+
+        if(this->m_command_recording_count > 0) {
+            this->m_command_recording_time = this->m_command_recording_time_accumulator / this->m_command_recording_count;
+            this->m_command_recording_time_accumulator = 0;
+            this->m_command_recording_count = 0;
+        }
+
+        for(auto& scope : this->m_gpu_scope_timings) {
+            if(scope.sample_count > 0) {
+                scope.time = scope.time_accumulator / scope.sample_count;
+                scope.time_accumulator = 0;
+                scope.sample_count = 0;
+            }
+        }
         
         this->m_mutex->unlock();
         
@@ -88,3 +110,97 @@ void YProfiler::accumulateGpuFrameTime(double time) {
     this->m_gpu_frame_count++;
     this->m_mutex->unlock();
 }
+
+void YProfiler::accumulateUboUpdateLatency(double time) {
+    this->m_mutex->lock();
+    this->m_ubo_update_latency_accumulator += time;
+    this->m_ubo_update_count++;
+    this->m_mutex->unlock();
+}
+
+void YProfiler::accumulateCommandRecordingTime(double time) {
+    this->m_mutex->lock();
+    this->m_command_recording_time_accumulator += time;
+    this->m_command_recording_count++;
+    this->m_mutex->unlock();
+}
+
+YsQueueTimeline YProfiler::queueTimeline() {
+    this->m_mutex->lock();
+    YsQueueTimeline timeline = this->m_queue_timeline;
+    this->m_mutex->unlock();
+    return timeline;
+}
+
+void YProfiler::recordQueueTimeline(const YsQueueTimeline& timeline) {
+    this->m_mutex->lock();
+    this->m_queue_timeline = timeline;
+    this->m_mutex->unlock();
+}
+
+std::vector<YsGpuScopeTiming> YProfiler::gpuScopeTimings() {
+    this->m_mutex->lock();
+    std::vector<YsGpuScopeTiming> timings = this->m_gpu_scope_timings;
+    this->m_mutex->unlock();
+    return timings;
+}
+
+void YProfiler::accumulateGpuScopeTime(const char* name, double time) {
+    this->m_mutex->lock();
+    auto scope = std::find_if(this->m_gpu_scope_timings.begin(), this->m_gpu_scope_timings.end(), [name](const YsGpuScopeTiming& timing) {
+        return timing.name == name;
+    });
+    if(scope == this->m_gpu_scope_timings.end()) {
+        YsGpuScopeTiming timing;
+        timing.name = name;
+        timing.time = time;
+        timing.history.resize(this->m_gpu_scope_history_size, 0.0f);
+        this->m_gpu_scope_timings.push_back(timing);
+        scope = this->m_gpu_scope_timings.end() - 1;
+    }
+    scope->time_accumulator += time;
+    scope->sample_count++;
+    scope->history[scope->history_offset] = float(time);
+    scope->history_offset = (scope->history_offset + 1) % this->m_gpu_scope_history_size;
+    this->m_mutex->unlock();
+}
+
+void YProfiler::recordGpuScopeInvocations(const char* name, u64 vertex_invocations, u64 fragment_invocations, u64 compute_invocations) {
+    this->m_mutex->lock();
+    auto scope = std::find_if(this->m_gpu_scope_timings.begin(), this->m_gpu_scope_timings.end(), [name](const YsGpuScopeTiming& timing) {
+        return timing.name == name;
+    });
+    if(scope != this->m_gpu_scope_timings.end()) {
+        scope->has_invocations = true;
+        scope->vertex_invocations = vertex_invocations;
+        scope->fragment_invocations = fragment_invocations;
+        scope->compute_invocations = compute_invocations;
+    }
+    this->m_mutex->unlock();
+}
+
+YsPathTracingStatistics YProfiler::pathTracingStatistics() {
+    this->m_mutex->lock();
+    YsPathTracingStatistics statistics = this->m_path_tracing_statistics;
+    this->m_mutex->unlock();
+    return statistics;
+}
+
+void YProfiler::recordPathTracingStatistics(const YsPathTracingStatistics& statistics) {
+    this->m_mutex->lock();
+    this->m_path_tracing_statistics = statistics;
+    this->m_mutex->unlock();
+}
+
+YsCullingStatistics YProfiler::cullingStatistics() {
+    this->m_mutex->lock();
+    YsCullingStatistics statistics = this->m_culling_statistics;
+    this->m_mutex->unlock();
+    return statistics;
+}
+
+void YProfiler::recordCullingStatistics(const YsCullingStatistics& statistics) {
+    this->m_mutex->lock();
+    this->m_culling_statistics = statistics;
+    this->m_mutex->unlock();
+}
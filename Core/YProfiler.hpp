@@ -32,8 +32,60 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 
+// GPU work of the most recent measured frame per queue, in milliseconds from the frame's first graphics timestamp.
+// Without a common time base the compute span starts at 0 on its own queue and cannot be compared with the graphics one.
+struct YsQueueTimeline {
+    bool async_compute;
+    bool common_time_base;
+
+    double scene_end;
+    double frame_end;
+
+    double compute_begin;
+    double compute_end;
+};
+
+// A named GPU timing scope, time is averaged over the last second and history holds one sample per measured frame.
+struct YsGpuScopeTiming {
+    std::string name;
+    double time = 0;
+
+    double time_accumulator = 0;
+    u32 sample_count = 0;
+
+    std::vector<float> history;
+    u32 history_offset = 0;
+
+    // Pipeline statistics of the last measured frame, only set for scopes that collected them.
+    bool has_invocations = false;
+    u64 vertex_invocations = 0;
+    u64 fragment_invocations = 0;
+    u64 compute_invocations = 0;
+};
+
+// Counters path_tracing.comp adds to over one frame's dispatches.
+struct YsPathTracingStatistics {
+    u64 ray_count;
+    u64 node_count;
+    u64 triangle_count;
+
+    double time;
+    double mrays_per_second;
+};
+
+// Records of the last rasterized frame's camera culling, the late ones were drawn after the Hi-Z rebuild.
+struct YsCullingStatistics {
+    u32 record_count;
+    u32 frustum_culled_count;
+    u32 occlusion_culled_count;
+    u32 drawn_count;
+    u32 late_drawn_count;
+};
+
 class YProfiler {
 public:
     static YProfiler* instance();
@@ -43,10 +95,30 @@ public:
     inline u32 renderingFPS() {return this->m_rendering_fps;}
     inline u32 cpuFPS() {return this->m_cpu_fps;}
     inline u32 gpuFPS() {return this->m_gpu_fps;}
+    // Average time from a host UBO change to its upload into a frame, over the last second with updates.
+    inline double uboUpdateLatency() {return this->m_ubo_update_latency;}
+    // Average host time spent recording a frame's command buffers, over the last second.
+    inline double commandRecordingTime() {return this->m_command_recording_time;}
 
     void accumulateRenderingFrameTime(double time);
     void accumulateCpuFrameTime(double time);
     void accumulateGpuFrameTime(double time);
+    void accumulateUboUpdateLatency(double time);
+    void accumulateCommandRecordingTime(double time);
+
+    YsQueueTimeline queueTimeline();
+    void recordQueueTimeline(const YsQueueTimeline& timeline);
+
+    // Scopes keep the order they were first seen in.
+    std::vector<YsGpuScopeTiming> gpuScopeTimings();
+    void accumulateGpuScopeTime(const char* name, double time);
+    void recordGpuScopeInvocations(const char* name, u64 vertex_invocations, u64 fragment_invocations, u64 compute_invocations);
+
+    YsPathTracingStatistics pathTracingStatistics();
+    void recordPathTracingStatistics(const YsPathTracingStatistics& statistics);
+
+    YsCullingStatistics cullingStatistics();
+    void recordCullingStatistics(const YsCullingStatistics& statistics);
 
 private:
     YProfiler();
@@ -67,6 +139,23 @@ private:
     u32 m_gpu_frame_count = 0;
     u32 m_gpu_fps = 0; 
 
+    double m_ubo_update_latency_accumulator = 0;
+    u32 m_ubo_update_count = 0;
+    double m_ubo_update_latency = 0;
+
+    double m_command_recording_time_accumulator = 0;
+    u32 m_command_recording_count = 0;
+    double m_command_recording_time = 0;
+
+    YsQueueTimeline m_queue_timeline = {};
+
+    const u32 m_gpu_scope_history_size = 120;
+    std::vector<YsGpuScopeTiming> m_gpu_scope_timings;
+
+    YsPathTracingStatistics m_path_tracing_statistics = {};
+
+    YsCullingStatistics m_culling_statistics = {};
+
     std::unique_ptr<YAsyncTask<void>> m_async;
 
     std::unique_ptr<std::mutex> m_mutex;
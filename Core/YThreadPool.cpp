@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "YThreadPool.hpp"
+
+
+YThreadPool::YThreadPool(u32 thread_count) {
+    for(u32 i = 1; i < thread_count; ++i) {
+        this->m_workers.emplace_back([this]() {
+            this->workerLoop();
+        });
+    }
+}
+
+YThreadPool::~YThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        this->m_stop = true;
+    }
+    this->m_condition.notify_all();
+    for(auto& worker : this->m_workers) {
+        worker.join();
+    }
+}
+
+void YThreadPool::parallelFor(u32 count, const std::function<void(u32)>& func) {
+    if(0 == count) {
+        return;
+    }
+    if((1 == count) || this->m_workers.empty()) {
+        for(u32 i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    // Guarded by the pool mutex, the last task to finish wakes the caller.
+    u32 remaining = count - 1;
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        for(u32 i = 1; i < count; ++i) {
+            this->m_tasks.emplace_back([this, &func, &remaining, i]() {
+                func(i);
+                std::lock_guard<std::mutex> lock(this->m_mutex);
+                if(0 == --remaining) {
+                    this->m_condition.notify_all();
+                }
+            });
+        }
+    }
+    this->m_condition.notify_all();
+
+    func(0);
+
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    while(remaining > 0) {
+        if(!this->runTask(lock)) {
+            this->m_condition.wait(lock, [this, &remaining]() {
+                return 0 == remaining || !this->m_tasks.empty();
+            });
+        }
+    }
+}
+
+void YThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    while(true) {
+        this->m_condition.wait(lock, [this]() {
+            return this->m_stop || !this->m_tasks.empty();
+        });
+        if(this->m_stop && this->m_tasks.empty()) {
+            return;
+        }
+        this->runTask(lock);
+    }
+}
+
+bool YThreadPool::runTask(std::unique_lock<std::mutex>& lock) {
+    if(this->m_tasks.empty()) {
+        return false;
+    }
+
+    std::function<void()> task = std::move(this->m_tasks.front());
+    this->m_tasks.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+    return true;
+}
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CGPPY_YTHREADPOOL_HPP
+#define CGPPY_YTHREADPOOL_HPP
+
+
+#include "YDefines.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+// A fixed set of worker threads. The queue only ever holds the tasks of the parallelFor calls in progress, each
+// call blocks until its own tasks are done.
+class YThreadPool {
+public:
+    // thread_count includes the calling thread, which always takes part in the work.
+    explicit YThreadPool(u32 thread_count);
+    ~YThreadPool();
+
+    YThreadPool(const YThreadPool&) = delete;
+    YThreadPool& operator=(const YThreadPool&) = delete;
+
+    inline u32 threadCount() const {return u32(this->m_workers.size()) + 1;}
+
+    // Runs func(0) to func(count - 1) on the workers and the calling thread and returns once all of them finished.
+    // While it waits the caller runs queued tasks, so calling it from inside a task cannot deadlock.
+    void parallelFor(u32 count, const std::function<void(u32)>& func);
+
+private:
+    void workerLoop();
+
+    // Pops and runs one queued task, false if the queue was empty. Called with the lock held, returns with it held.
+    bool runTask(std::unique_lock<std::mutex>& lock);
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
+
+
+#endif //CGPPY_YTHREADPOOL_HPP
@@ -0,0 +1,76 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "YWorkerThread.hpp"
+
+
+YWorkerThread::YWorkerThread() {
+    this->m_thread = std::thread([this]() {
+        this->threadLoop();
+    });
+}
+
+YWorkerThread::~YWorkerThread() {
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        this->m_stop = true;
+    }
+    this->m_condition.notify_all();
+    this->m_thread.join();
+}
+
+void YWorkerThread::start(std::function<void()> func) {
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        this->m_job = std::move(func);
+        this->m_busy = true;
+    }
+    this->m_condition.notify_all();
+}
+
+void YWorkerThread::wait() {
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    this->m_condition.wait(lock, [this]() {
+        return !this->m_busy;
+    });
+}
+
+void YWorkerThread::threadLoop() {
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    while(true) {
+        this->m_condition.wait(lock, [this]() {
+            return this->m_stop || this->m_busy;
+        });
+        if(!this->m_busy) {
+            return;
+        }
+
+        std::function<void()> job = std::move(this->m_job);
+        lock.unlock();
+        job();
+        lock.lock();
+        this->m_busy = false;
+        this->m_condition.notify_all();
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CGPPY_YWORKERTHREAD_HPP
+#define CGPPY_YWORKERTHREAD_HPP
+
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+// A single long-lived thread running one job at a time. Unlike YThreadPool every job of a worker runs on the same
+// thread, for work bound to state only that thread may touch, such as a command pool.
+class YWorkerThread {
+public:
+    YWorkerThread();
+    ~YWorkerThread();
+
+    YWorkerThread(const YWorkerThread&) = delete;
+    YWorkerThread& operator=(const YWorkerThread&) = delete;
+
+    // Hands func to the thread and returns at once. The previous job has to be waited on first.
+    void start(std::function<void()> func);
+
+    // Blocks until the started job finished, returns at once when none was started.
+    void wait();
+
+private:
+    void threadLoop();
+
+private:
+    std::function<void()> m_job;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+};
+
+
+#endif //CGPPY_YWORKERTHREAD_HPP
@@ -102,15 +102,41 @@ struct YsChangingPathTracingEnableBvhAccelerationEvent {
     u8 enable_bvh_acceleration;
 };
 
+struct YsChangingPathTracingTraversalHeatmapEvent {
+    u8 traversal_heatmap;
+};
+
 struct YsChangingPathTracingEnableDenoiserEvent {
     u8 enable_denoiser;
 };
 
+struct YsChangingCollectGpuStatisticsEvent {
+    u8 collect_gpu_statistics;
+};
+
+struct YsChangingUpscalingSharpnessEvent {
+    f32 upscaling_sharpness;
+};
+
+struct YsChangingBvhBuildSettingsEvent {
+    u8 partitioning_algorithm;
+    u32 max_leaf_triangle_count;
+};
+
+struct YsBvhBuildFinishedEvent {
+    u32 generation;
+};
+
 using YsEvent = std::variant<YsChangingRenderingModelEvent,
                              YsChangingPathTracingSppEvent,
                              YsChangingPathTracingMaxDepthEvent,
                              YsChangingPathTracingEnableBvhAccelerationEvent,
+                             YsChangingPathTracingTraversalHeatmapEvent,
                              YsChangingPathTracingEnableDenoiserEvent,
+                             YsChangingCollectGpuStatisticsEvent,
+                             YsChangingUpscalingSharpnessEvent,
+                             YsChangingBvhBuildSettingsEvent,
+                             YsBvhBuildFinishedEvent,
                              YsUpdateSceneEvent, 
                              YsKeyEvent, 
                              YsMouseEvent>;
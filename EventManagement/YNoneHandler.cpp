@@ -123,12 +123,7 @@ void YNoneHandler::handleEvent(const YsMouseEvent& event) {
 void YNoneHandler::handleEvent(const YsUpdateSceneEvent& event) {
     YMaterialSystem::instance()->updagteMaterial();
 
-    YPhysicsSystem::instance()->buildBVH();
-
-    YRendererBackendManager::instance()->backend()->updateHostVertexInput();
-    YRendererBackendManager::instance()->backend()->updateHostSsbo();
-    YRendererBackendManager::instance()->backend()->updateHostUbo();
-    YRendererBackendManager::instance()->backend()->setNeedDraw(true);
+    YPhysicsSystem::instance()->buildBVHAsync();
 }
 
 void YNoneHandler::handleEvent(const YsChangingRenderingModelEvent& event) {
@@ -147,6 +142,36 @@ void YNoneHandler::handleEvent(const YsChangingPathTracingEnableBvhAccelerationE
     YRendererBackendManager::instance()->backend()->updateHostUbo();
 }
 
+void YNoneHandler::handleEvent(const YsChangingPathTracingTraversalHeatmapEvent& event) {
+    YRendererBackendManager::instance()->backend()->updateHostUbo();
+}
+
 void YNoneHandler::handleEvent(const YsChangingPathTracingEnableDenoiserEvent& event) {
     YRendererBackendManager::instance()->backend()->updateHostUbo();
 }
+
+void YNoneHandler::handleEvent(const YsChangingCollectGpuStatisticsEvent& event) {
+    YRendererBackendManager::instance()->backend()->updateHostUbo();
+}
+
+void YNoneHandler::handleEvent(const YsChangingUpscalingSharpnessEvent& event) {
+    YRendererBackendManager::instance()->backend()->updateHostUbo();
+}
+
+void YNoneHandler::handleEvent(const YsChangingBvhBuildSettingsEvent& event) {
+    YPhysicsSystem::instance()->setPartitioningAlgorithm(static_cast<YPhysicsSystem::YePartitioningAlgorithm>(event.partitioning_algorithm));
+    YPhysicsSystem::instance()->setMaxLeafTriangleCount(event.max_leaf_triangle_count);
+    YPhysicsSystem::instance()->buildBVHAsync();
+}
+
+void YNoneHandler::handleEvent(const YsBvhBuildFinishedEvent& event) {
+    // A newer build was started in the meantime, or the scene changed and the build it triggers will upload the result.
+    if(!YPhysicsSystem::instance()->commitBVHBuild(event.generation)) {
+        return;
+    }
+
+    YRendererBackendManager::instance()->backend()->updateHostVertexInput();
+    YRendererBackendManager::instance()->backend()->updateHostSsbo();
+    YRendererBackendManager::instance()->backend()->updateHostUbo();
+    YRendererBackendManager::instance()->backend()->setNeedDraw(true);
+}
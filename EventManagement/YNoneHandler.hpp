@@ -43,7 +43,12 @@ private:
     void handleEvent(const YsChangingPathTracingSppEvent& event);
     void handleEvent(const YsChangingPathTracingMaxDepthEvent& event);
     void handleEvent(const YsChangingPathTracingEnableBvhAccelerationEvent& event);
+    void handleEvent(const YsChangingPathTracingTraversalHeatmapEvent& event);
     void handleEvent(const YsChangingPathTracingEnableDenoiserEvent& event);
+    void handleEvent(const YsChangingCollectGpuStatisticsEvent& event);
+    void handleEvent(const YsChangingUpscalingSharpnessEvent& event);
+    void handleEvent(const YsChangingBvhBuildSettingsEvent& event);
+    void handleEvent(const YsBvhBuildFinishedEvent& event);
 
 private:
     YsMouseEvent m_mouse_press;
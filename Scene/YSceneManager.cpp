@@ -52,6 +52,8 @@ YSceneManager::~YSceneManager() {
 }
 
 void YSceneManager::updateSceneInfo() {
+    ++this->m_revision;
+
     //
     this->m_scene_bound.reset();
 
@@ -26,6 +26,7 @@
 #define CGPPY_YSCENEMANAGER_HPP
 
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <list>
@@ -55,6 +56,10 @@ public:
 
     inline YsAABBComponent& sceneBounds() {return this->m_scene_bound;}
 
+    // Bumped whenever components are created or destroyed or the scene info is updated, importers may do so from
+    // their own threads. Lets results computed from a snapshot of the scene tell whether they are stale.
+    inline unsigned int revision() {return this->m_revision.load();}
+
     // Entity
     YsEntity* createEntity();
 
@@ -83,6 +88,7 @@ public:
         YsEntity* entity = this->getEntity(id);
         entity->addComponent<T>(ptr);
         this->m_component_object_correspond_entity_object_map.insert(std::make_pair(ptr, entity));
+        ++this->m_revision;
         return ptr;
     }
 
@@ -90,6 +96,7 @@ public:
     void destroyComponent(unsigned int id) {
         auto& vec = this->m_components[typeid(T)];
         vec.erase(std::remove_if(vec.begin(), vec.end(), [id](const auto& pair) { return pair.first == id; }), vec.end());
+        ++this->m_revision;
     }
 
     template<typename T>
@@ -120,6 +127,8 @@ private:
     glm::fvec3 m_scene_center;
 
     glm::fmat4x4 m_model_matrix;
+
+    std::atomic<unsigned int> m_revision = 0;
 };
 
 
@@ -32,6 +32,14 @@
 #include "YRendererBackendManager.hpp"
 #include "YVulkanBackend.hpp"
 #include "YMath.h"
+#include "YLogger.h"
+#include "YEventHandlerManager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <cmath>
 
 
 YPhysicsSystem* YPhysicsSystem::instance() {
@@ -40,120 +48,484 @@ YPhysicsSystem* YPhysicsSystem::instance() {
 }
 
 YPhysicsSystem::YPhysicsSystem() {
-
+    this->m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+    this->m_thread_pool = std::make_unique<YThreadPool>(this->m_thread_count);
+    this->m_mutex = std::make_unique<std::mutex>();
 }
 
 YPhysicsSystem::~YPhysicsSystem() {
-
+    ++this->m_build_generation;
+    this->waitBVHBuild();
 }
 
-void YPhysicsSystem::buildBVH() {
+void YPhysicsSystem::buildBVHAsync() {
+    // Superseding the running build makes it stop at its next node, it is never waited on here.
+    u32 generation = ++this->m_build_generation;
+    this->m_builds.erase(std::remove_if(this->m_builds.begin(), this->m_builds.end(), [](const std::unique_ptr<YAsyncTask<void>>& task) {
+        return task->ready();
+    }), this->m_builds.end());
+
+    // The pool is shared by all builds, it can only be resized once the superseded ones stopped.
+    if(this->m_thread_count != this->m_thread_pool->threadCount()) {
+        this->waitBVHBuild();
+        this->m_thread_pool = std::make_unique<YThreadPool>(this->m_thread_count);
+    }
+
+    // The worker only sees this copy, the scene may change while it builds. Triangles are numbered in the same order
+    // YRendererBackend concatenates the mesh vertices, so the meshes are copied whole like it does.
+    auto build = std::make_unique<YsBVHBuild>();
+    build->generation = generation;
+    build->scene_revision = YSceneManager::instance()->revision();
+    build->partitioning_algorithm = this->m_partitioning_algorithm;
+    build->max_leaf_triangle_count = this->m_max_leaf_triangle_count;
+    build->parallel_subtree_depth = u32(std::ceil(std::log2(f64(this->m_thread_count)))) + 2;
     std::vector<YsMeshComponent*> mesh_components = YSceneManager::instance()->getComponents<YsMeshComponent>();
-    this->m_root_bvh_node = std::make_unique<YsBVHNodeComponent>();
-    this->recursiveCreateBVH(mesh_components, this->m_root_bvh_node.get(), 16);
+    u64 vertex_count = 0;
+    for(auto mesh_component : mesh_components) {
+        vertex_count += mesh_component->positions.size();
+    }
+    build->positions.reserve(vertex_count);
+    for(auto mesh_component : mesh_components) {
+        build->positions.insert(build->positions.end(), mesh_component->positions.begin(), mesh_component->positions.end());
+    }
+
+    auto task = std::make_unique<YAsyncTask<void>>();
+    task->start([this, build = std::move(build)]() mutable {
+        this->buildBVH(build.get());
+        if(this->isSuperseded(build.get())) {
+            return;
+        }
+
+        u32 generation = build->generation;
+        {
+            std::lock_guard<std::mutex> lock(*this->m_mutex);
+            this->m_finished_build = std::move(build);
+        }
+
+        YsBvhBuildFinishedEvent bvh_build_finished_event;
+        bvh_build_finished_event.generation = generation;
+        YEventHandlerManager::instance()->pushEvent(bvh_build_finished_event);
+    });
+    this->m_builds.push_back(std::move(task));
+}
+
+void YPhysicsSystem::waitBVHBuild() {
+    for(auto& task : this->m_builds) {
+        task->getResult();
+    }
+    this->m_builds.clear();
 }
 
-void YPhysicsSystem::recursiveCreateBVH(const std::vector<YsMeshComponent*>& meshes, YsBVHNodeComponent* node, int max_depth, int current_depth) {
-    node->aabb = this->computeAABB(meshes);
+b8 YPhysicsSystem::commitBVHBuild(u32 generation) {
+    std::unique_ptr<YsBVHBuild> build;
+    {
+        std::lock_guard<std::mutex> lock(*this->m_mutex);
+        if(!this->m_finished_build || (generation != this->m_finished_build->generation) || (generation != this->m_build_generation.load())) {
+            return false;
+        }
+        build = std::move(this->m_finished_build);
+    }
 
-    if(current_depth > max_depth) {
-        this->updateBVHNode(meshes, node);
+    // Its permutation indexes the vertices of the snapshot, the scene has to be rebuilt from the same ones.
+    if(build->scene_revision != YSceneManager::instance()->revision()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(*this->m_mutex);
+        this->m_build_report = build->report;
+    }
+
+    this->m_root_bvh_node = std::move(build->root_bvh_node);
+    this->m_triangle_indices = std::move(build->triangle_indices);
+    return true;
+}
+
+YsBVHBuildReport YPhysicsSystem::buildReport() {
+    std::lock_guard<std::mutex> lock(*this->m_mutex);
+    return this->m_build_report;
+}
+
+void YPhysicsSystem::buildBVH(YsBVHBuild* build) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    u32 triangle_count = build->positions.size() / 3;
+    build->primitives.resize(triangle_count);
+    build->triangle_indices.resize(triangle_count);
+    build->partition_buffer.resize(triangle_count);
+    this->parallelChunks(0, triangle_count, this->chunkCount(0, triangle_count, 1), [&](u32 chunk, u32 begin, u32 end) {
+        for(u32 i = begin; i < end; ++i) {
+            glm::fvec3 p0 = build->positions[i * 3];
+            glm::fvec3 p1 = build->positions[i * 3 + 1];
+            glm::fvec3 p2 = build->positions[i * 3 + 2];
+
+            // Adding +0.0 turns -0.0 into +0.0, min/max then give the same bits no matter the reduction order.
+            YsBVHPrimitive& primitive = build->primitives[i];
+            primitive.min = glm::min(p0, glm::min(p1, p2)) + glm::fvec3(0.0f);
+            primitive.max = glm::max(p0, glm::max(p1, p2)) + glm::fvec3(0.0f);
+            primitive.centroid = (primitive.min + primitive.max) * 0.5f;
+            build->triangle_indices[i] = i;
+        }
+    });
+    build->positions = std::vector<glm::fvec4>();
+
+    build->root_bvh_node = std::make_unique<YsBVHNodeComponent>();
+    this->recursiveCreateBVH(build, build->root_bvh_node.get(), 0, triangle_count);
+    build->primitives = std::vector<YsBVHPrimitive>();
+    build->partition_buffer = std::vector<u32>();
+    if(this->isSuperseded(build)) {
         return;
     }
 
-    if(1 == meshes.size()) {
-        this->updateBVHNode(meshes, node);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end_time - start_time;
+
+    YsBVHBuildReport& report = build->report;
+    report.build_time = duration.count();
+    report.thread_count = this->m_thread_pool->threadCount();
+    report.triangle_count = triangle_count;
+    report.sah_cost = this->recursiveComputeBuildReport(build->root_bvh_node.get(), 1, &report) / 
+                      std::max(build->root_bvh_node->aabb.surfaceArea(), 1e-6f);
+
+    YINFO("BVH Build(%s, %u threads): %u triangles, %u nodes, %u leaves, max depth %u, %.3f ms, SAH cost %.3f",
+          YePartitioningAlgorithm::SAH == build->partitioning_algorithm ? "SAH" : "MedianSplit",
+          report.thread_count,
+          report.triangle_count,
+          report.node_count,
+          report.leaf_count,
+          report.max_depth,
+          report.build_time,
+          report.sah_cost);
+}
+
+void YPhysicsSystem::recursiveCreateBVH(YsBVHBuild* build, YsBVHNodeComponent* node, u32 begin, u32 end, u32 current_depth) {
+    YsAABBComponent centroid_aabb;
+    this->computeAABB(build, begin, end, current_depth, &node->aabb, &centroid_aabb);
+
+    node->triangle_index = begin;
+    node->triangle_count = end - begin;
+
+    // A superseded build is thrown away, the node is left a leaf.
+    if((end - begin <= build->max_leaf_triangle_count) || (current_depth >= this->m_max_depth) || this->isSuperseded(build)) {
         return;
     }
 
-    std::vector<YsMeshComponent*> left_meshes;
-    std::vector<YsMeshComponent*> right_meshes;
+    u32 middle = YePartitioningAlgorithm::SAH == build->partitioning_algorithm ?
+                 this->partitionSAH(build, centroid_aabb, begin, end, current_depth) :
+                 this->partitionMedianSplit(build, centroid_aabb, begin, end, current_depth);
+
+    node->left = std::make_unique<YsBVHNodeComponent>();
+    node->right = std::make_unique<YsBVHNodeComponent>();
+    node->triangle_count = 0;
 
-    switch(node->aabb.longestAxis()) {
-        case YsAABBComponent::YeAxis::X_AXIS: {
-            for(auto mesh : meshes) {
-                if(mesh->aabb.center().x > node->aabb.center().x) {
-                    right_meshes.push_back(mesh);
-                }
-                else {
-                    left_meshes.push_back(mesh);
-                }
+    // The children own disjoint ranges of the permutation, so they can be built concurrently.
+    if((this->m_thread_pool->threadCount() > 1) &&
+       (current_depth < build->parallel_subtree_depth) &&
+       (end - begin >= this->m_parallel_subtree_threshold)) {
+        this->m_thread_pool->parallelFor(2, [&](u32 child) {
+            if(0 == child) {
+                this->recursiveCreateBVH(build, node->left.get(), begin, middle, current_depth + 1);
+            } else {
+                this->recursiveCreateBVH(build, node->right.get(), middle, end, current_depth + 1);
+            }
+        });
+    } else {
+        this->recursiveCreateBVH(build, node->left.get(), begin, middle, current_depth + 1);
+        this->recursiveCreateBVH(build, node->right.get(), middle, end, current_depth + 1);
+    }
+}
+
+u32 YPhysicsSystem::partitionSAH(YsBVHBuild* build, const YsAABBComponent& centroid_aabb, u32 begin, u32 end, u32 current_depth) {
+    glm::fvec3 scale;
+    for(i32 axis = 0; axis < 3; ++axis) {
+        f32 extent = centroid_aabb.max[axis] - centroid_aabb.min[axis];
+        scale[axis] = extent > 0.0f ? f32(this->m_sah_bin_count) / extent : 0.0f;
+    }
+
+    auto binIndex = [&](const YsBVHPrimitive& primitive, i32 axis) {
+        return std::min(u32((primitive.centroid[axis] - centroid_aabb.min[axis]) * scale[axis]), this->m_sah_bin_count - 1);
+    };
+
+    // Every chunk bins its own slice on all three axes, the partial bins are merged in chunk order afterwards.
+    u32 chunk_count = this->chunkCount(begin, end, current_depth);
+    std::vector<YsBVHBin> chunk_bins(chunk_count * 3 * this->m_sah_bin_count);
+    for(auto& bin : chunk_bins) {
+        bin.min = glm::fvec3(std::numeric_limits<f32>::max());
+        bin.max = glm::fvec3(-std::numeric_limits<f32>::max());
+        bin.count = 0;
+    }
+    this->parallelChunks(begin, end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+        YsBVHBin* bins = &chunk_bins[chunk * 3 * this->m_sah_bin_count];
+        for(u32 i = chunk_begin; i < chunk_end; ++i) {
+            const YsBVHPrimitive& primitive = build->primitives[build->triangle_indices[i]];
+            for(i32 axis = 0; axis < 3; ++axis) {
+                YsBVHBin& bin = bins[axis * this->m_sah_bin_count + binIndex(primitive, axis)];
+                bin.min = glm::min(bin.min, primitive.min);
+                bin.max = glm::max(bin.max, primitive.max);
+                bin.count++;
             }
-            break;
         }
-        case YsAABBComponent::YeAxis::Y_AXIS: {
-            for(auto mesh : meshes) {
-                if(mesh->aabb.center().y > node->aabb.center().y) {
-                    right_meshes.push_back(mesh);
-                }
-                else {
-                    left_meshes.push_back(mesh);
-                }
+    });
+    std::vector<YsBVHBin> bins(chunk_bins.begin(), chunk_bins.begin() + 3 * this->m_sah_bin_count);
+    for(u32 chunk = 1; chunk < chunk_count; ++chunk) {
+        for(u32 i = 0; i < bins.size(); ++i) {
+            const YsBVHBin& chunk_bin = chunk_bins[chunk * 3 * this->m_sah_bin_count + i];
+            bins[i].min = glm::min(bins[i].min, chunk_bin.min);
+            bins[i].max = glm::max(bins[i].max, chunk_bin.max);
+            bins[i].count += chunk_bin.count;
+        }
+    }
+
+    i32 best_axis = -1;
+    u32 best_bin = 0;
+    f32 best_cost = std::numeric_limits<f32>::max();
+    std::vector<f32> right_areas(this->m_sah_bin_count);
+    std::vector<u32> right_counts(this->m_sah_bin_count);
+    for(i32 axis = 0; axis < 3; ++axis) {
+        if(0.0f == scale[axis]) {
+            continue;
+        }
+        const YsBVHBin* axis_bins = &bins[axis * this->m_sah_bin_count];
+
+        // Sweep from the right to get the cost of everything above each split plane.
+        YsAABBComponent right_aabb;
+        right_aabb.min = glm::fvec3(std::numeric_limits<f32>::max());
+        right_aabb.max = glm::fvec3(-std::numeric_limits<f32>::max());
+        u32 right_count = 0;
+        for(u32 i = this->m_sah_bin_count - 1; i > 0; --i) {
+            if(axis_bins[i].count > 0) {
+                right_aabb.expand(axis_bins[i].min);
+                right_aabb.expand(axis_bins[i].max);
             }
-            break;
+            right_count += axis_bins[i].count;
+            right_areas[i - 1] = right_aabb.surfaceArea();
+            right_counts[i - 1] = right_count;
         }
-        case YsAABBComponent::YeAxis::Z_AXIS: {
-            for(auto mesh : meshes) {
-                if(mesh->aabb.center().z > node->aabb.center().z) {
-                    right_meshes.push_back(mesh);
-                }
-                else {
-                    left_meshes.push_back(mesh);
-                }
+
+        YsAABBComponent left_aabb;
+        left_aabb.min = glm::fvec3(std::numeric_limits<f32>::max());
+        left_aabb.max = glm::fvec3(-std::numeric_limits<f32>::max());
+        u32 left_count = 0;
+        for(u32 i = 0; i < this->m_sah_bin_count - 1; ++i) {
+            if(axis_bins[i].count > 0) {
+                left_aabb.expand(axis_bins[i].min);
+                left_aabb.expand(axis_bins[i].max);
+            }
+            left_count += axis_bins[i].count;
+            if((0 == left_count) || (0 == right_counts[i])) {
+                continue;
+            }
+
+            f32 cost = left_aabb.surfaceArea() * f32(left_count) + right_areas[i] * f32(right_counts[i]);
+            if(cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = i;
             }
-            break;
         }
     }
 
-    if(!left_meshes.empty()) {
-        node->left = std::make_unique<YsBVHNodeComponent>();
-        this->recursiveCreateBVH(left_meshes, node->left.get(), ++current_depth, max_depth);
+    // Every centroid falls into the same bin, only an object median can split the node.
+    if(-1 == best_axis) {
+        return this->partitionMedianSplit(build, centroid_aabb, begin, end, current_depth);
     }
 
-    if(!right_meshes.empty()) {
-        node->right = std::make_unique<YsBVHNodeComponent>();
-        this->recursiveCreateBVH(right_meshes, node->right.get(), ++current_depth, max_depth);
+    return this->stablePartition(build, begin, end, current_depth, [&](u32 triangle_index) {
+        return binIndex(build->primitives[triangle_index], best_axis) <= best_bin;
+    });
+}
+
+u32 YPhysicsSystem::partitionMedianSplit(YsBVHBuild* build, const YsAABBComponent& centroid_aabb, u32 begin, u32 end, u32 current_depth) {
+    glm::fvec3 length = centroid_aabb.max - centroid_aabb.min;
+    i32 axis = 0;
+    if((length.y > length.x) && (length.y >= length.z)) {
+        axis = 1;
+    } else if((length.z > length.x) && (length.z > length.y)) {
+        axis = 2;
     }
 
-    if(node->isLeaf()) {
-        this->updateBVHNode(meshes, node);
-        return;
+    // Narrows the range holding the median with a parallel histogram over the centroids, the bin holding the middle
+    // element is partitioned out and the rest is left or right of it. The bins are monotone in the centroid, so the
+    // order the final nth_element sees does not depend on the chunk count.
+    u32 middle = begin + (end - begin) / 2;
+    u32 range_begin = begin;
+    u32 range_end = end;
+    f32 key_min = centroid_aabb.min[axis];
+    f32 key_max = centroid_aabb.max[axis];
+    for(u32 pass = 0; (pass < 4) && (range_end - range_begin > this->m_parallel_chunk_threshold) && (key_max > key_min); ++pass) {
+        f32 scale = f32(this->m_median_bin_count) / (key_max - key_min);
+        auto binIndex = [&](u32 triangle_index) {
+            f32 offset = std::max(build->primitives[triangle_index].centroid[axis] - key_min, 0.0f);
+            return std::min(u32(offset * scale), this->m_median_bin_count - 1);
+        };
+
+        u32 chunk_count = this->chunkCount(range_begin, range_end, current_depth);
+        std::vector<u32> chunk_histograms(chunk_count * this->m_median_bin_count, 0);
+        this->parallelChunks(range_begin, range_end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+            u32* histogram = &chunk_histograms[chunk * this->m_median_bin_count];
+            for(u32 i = chunk_begin; i < chunk_end; ++i) {
+                histogram[binIndex(build->triangle_indices[i])]++;
+            }
+        });
+
+        u32 median_bin = 0;
+        u32 bin_first = range_begin;
+        for(; median_bin < this->m_median_bin_count; ++median_bin) {
+            u32 bin_count = 0;
+            for(u32 chunk = 0; chunk < chunk_count; ++chunk) {
+                bin_count += chunk_histograms[chunk * this->m_median_bin_count + median_bin];
+            }
+            if(bin_first + bin_count > middle) {
+                break;
+            }
+            bin_first += bin_count;
+        }
+
+        u32 bin_begin = this->stablePartition(build, range_begin, range_end, current_depth, [&](u32 triangle_index) {
+            return binIndex(triangle_index) < median_bin;
+        });
+        u32 bin_end = this->stablePartition(build, bin_begin, range_end, current_depth, [&](u32 triangle_index) {
+            return binIndex(triangle_index) == median_bin;
+        });
+        range_begin = bin_begin;
+        range_end = bin_end;
+        key_max = key_min + f32(median_bin + 1) / scale;
+        key_min = key_min + f32(median_bin) / scale;
     }
+
+    std::nth_element(build->triangle_indices.begin() + range_begin,
+                     build->triangle_indices.begin() + middle,
+                     build->triangle_indices.begin() + range_end,
+                     [&](u32 a, u32 b) {
+        f32 centroid_a = build->primitives[a].centroid[axis];
+        f32 centroid_b = build->primitives[b].centroid[axis];
+        return (centroid_a < centroid_b) || ((centroid_a == centroid_b) && (a < b));
+    });
+
+    return middle;
 }
 
-void YPhysicsSystem::updateBVHNode(const std::vector<YsMeshComponent*>& meshes, YsBVHNodeComponent* node) {
-    node->meshes = meshes;
-    u32 vertex_index = 0;
-    for(auto mesh : meshes) {
-        this->m_mesh_vertex_index_map.insert(std::make_pair(mesh, vertex_index));
-        vertex_index += mesh->positions.size();
+u32 YPhysicsSystem::stablePartition(YsBVHBuild* build, u32 begin, u32 end, u32 current_depth, const std::function<bool(u32)>& goes_left) {
+    // Count per chunk, then scatter every chunk to its prefix-summed offsets. The result equals std::stable_partition.
+    u32 chunk_count = this->chunkCount(begin, end, current_depth);
+    std::vector<u32> left_counts(chunk_count, 0);
+    this->parallelChunks(begin, end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+        for(u32 i = chunk_begin; i < chunk_end; ++i) {
+            left_counts[chunk] += goes_left(build->triangle_indices[i]) ? 1 : 0;
+        }
+    });
+
+    std::vector<u32> left_offsets(chunk_count, 0);
+    std::vector<u32> right_offsets(chunk_count, 0);
+    u32 left_total = 0;
+    for(u32 chunk = 0; chunk < chunk_count; ++chunk) {
+        left_offsets[chunk] = left_total;
+        left_total += left_counts[chunk];
+    }
+    u32 right_total = 0;
+    u32 chunk_size = (end - begin + chunk_count - 1) / chunk_count;
+    for(u32 chunk = 0; chunk < chunk_count; ++chunk) {
+        right_offsets[chunk] = left_total + right_total;
+        u32 chunk_begin = std::min(begin + chunk * chunk_size, end);
+        u32 chunk_end = std::min(chunk_begin + chunk_size, end);
+        right_total += (chunk_end - chunk_begin) - left_counts[chunk];
     }
+
+    this->parallelChunks(begin, end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+        u32 left = begin + left_offsets[chunk];
+        u32 right = begin + right_offsets[chunk];
+        for(u32 i = chunk_begin; i < chunk_end; ++i) {
+            u32 triangle_index = build->triangle_indices[i];
+            build->partition_buffer[goes_left(triangle_index) ? left++ : right++] = triangle_index;
+        }
+    });
+    this->parallelChunks(begin, end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+        std::copy(build->partition_buffer.begin() + chunk_begin,
+                  build->partition_buffer.begin() + chunk_end,
+                  build->triangle_indices.begin() + chunk_begin);
+    });
+
+    return begin + left_total;
 }
 
-YsAABBComponent YPhysicsSystem::computeAABB(const std::vector<YsMeshComponent*>& meshes) {
-    YsAABBComponent aabb;
-    for(auto mesh : meshes) {
-        aabb.max.x = fmax(aabb.max.x, mesh->aabb.max.x);
-        aabb.max.y = fmax(aabb.max.y, mesh->aabb.max.y);
-        aabb.max.z = fmax(aabb.max.z, mesh->aabb.max.z);
+void YPhysicsSystem::computeAABB(YsBVHBuild* build, u32 begin, u32 end, u32 current_depth, YsAABBComponent* aabb, YsAABBComponent* centroid_aabb) {
+    if(begin == end) {
+        aabb->min = aabb->max = glm::fvec3(0.0f);
+        *centroid_aabb = *aabb;
+        return;
+    }
+
+    u32 chunk_count = this->chunkCount(begin, end, current_depth);
+    std::vector<YsAABBComponent> chunk_aabbs(chunk_count);
+    std::vector<YsAABBComponent> chunk_centroid_aabbs(chunk_count);
+    this->parallelChunks(begin, end, chunk_count, [&](u32 chunk, u32 chunk_begin, u32 chunk_end) {
+        YsAABBComponent& chunk_aabb = chunk_aabbs[chunk];
+        YsAABBComponent& chunk_centroid_aabb = chunk_centroid_aabbs[chunk];
+        chunk_aabb.min = glm::fvec3(std::numeric_limits<f32>::max());
+        chunk_aabb.max = glm::fvec3(-std::numeric_limits<f32>::max());
+        chunk_centroid_aabb.min = chunk_aabb.min;
+        chunk_centroid_aabb.max = chunk_aabb.max;
+        for(u32 i = chunk_begin; i < chunk_end; ++i) {
+            const YsBVHPrimitive& primitive = build->primitives[build->triangle_indices[i]];
+            chunk_aabb.min = glm::min(chunk_aabb.min, primitive.min);
+            chunk_aabb.max = glm::max(chunk_aabb.max, primitive.max);
+            chunk_centroid_aabb.expand(primitive.centroid);
+        }
+    });
+
+    *aabb = chunk_aabbs.front();
+    *centroid_aabb = chunk_centroid_aabbs.front();
+    for(u32 chunk = 1; chunk < chunk_count; ++chunk) {
+        aabb->expand(chunk_aabbs[chunk]);
+        centroid_aabb->expand(chunk_centroid_aabbs[chunk]);
+    }
 
-        aabb.min.x = fmin(aabb.min.x, mesh->aabb.min.x);
-        aabb.min.y = fmin(aabb.min.y, mesh->aabb.min.y);
-        aabb.min.z = fmin(aabb.min.z, mesh->aabb.min.z);
+    // Flat boxes (axis aligned walls) would never pass the slab test in the shader.
+    f32 padding = std::max(1e-4f, 1e-3f * glm::length(aabb->max - aabb->min));
+    for(i32 axis = 0; axis < 3; ++axis) {
+        if(aabb->min[axis] == aabb->max[axis]) {
+            aabb->min[axis] -= padding;
+            aabb->max[axis] += padding;
+        }
     }
+}
 
-    if(aabb.min.x == aabb.max.x) {
-        aabb.min.x -= 1.0f;
-        aabb.max.x += 1.0f;
+u32 YPhysicsSystem::chunkCount(u32 begin, u32 end, u32 current_depth) {
+    u32 thread_count = this->m_thread_pool->threadCount();
+    if((thread_count <= 1) || (end - begin < this->m_parallel_chunk_threshold)) {
+        return 1;
     }
-    if(aabb.min.y == aabb.max.y) {
-        aabb.min.y -= 1.0f;
-        aabb.max.y += 1.0f;
+
+    // Deeper nodes run next to their siblings, so they get a proportionally smaller share of the threads.
+    u32 chunk_count = current_depth > 1 ? (thread_count >> std::min(current_depth - 1, 31u)) : thread_count;
+    return std::max(1u, std::min(chunk_count, (end - begin) / (this->m_parallel_chunk_threshold / 4)));
+}
+
+void YPhysicsSystem::parallelChunks(u32 begin, u32 end, u32 chunk_count, const std::function<void(u32, u32, u32)>& func) {
+    u32 chunk_size = (end - begin + chunk_count - 1) / chunk_count;
+    if(1 == chunk_count) {
+        func(0, begin, end);
+        return;
     }
-    if(aabb.min.z == aabb.max.z) {
-        aabb.min.z -= 1.0f;
-        aabb.max.z += 1.0f;
+
+    this->m_thread_pool->parallelFor(chunk_count, [&](u32 chunk) {
+        u32 chunk_begin = std::min(begin + chunk * chunk_size, end);
+        u32 chunk_end = std::min(chunk_begin + chunk_size, end);
+        func(chunk, chunk_begin, chunk_end);
+    });
+}
+
+f64 YPhysicsSystem::recursiveComputeBuildReport(YsBVHNodeComponent* node, u32 current_depth, YsBVHBuildReport* report) {
+    report->node_count++;
+    report->max_depth = std::max(report->max_depth, current_depth);
+
+    f64 area = node->aabb.surfaceArea();
+    if(node->isLeaf()) {
+        report->leaf_count++;
+        return area * node->triangle_count * this->m_sah_intersection_cost;
     }
 
-    return aabb;
+    return area * this->m_sah_traversal_cost +
+           this->recursiveComputeBuildReport(node->left.get(), current_depth + 1, report) +
+           this->recursiveComputeBuildReport(node->right.get(), current_depth + 1, report);
 }
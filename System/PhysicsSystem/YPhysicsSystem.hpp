@@ -29,6 +29,8 @@
 #include "YDefines.h"
 #include "YVulkanTypes.h"
 #include "YGLSLStructs.hpp"
+#include "YAsyncTask.hpp"
+#include "YThreadPool.hpp"
 
 
 #include <glm/fwd.hpp>
@@ -42,12 +44,25 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 struct YsMeshComponent;
 struct YsBVHNodeComponent;
 struct YsAABBComponent;
 
 
+struct YsBVHBuildReport {
+    f64 build_time = 0.0;
+    f64 sah_cost = 0.0;
+    u32 thread_count = 0;
+    u32 triangle_count = 0;
+    u32 node_count = 0;
+    u32 leaf_count = 0;
+    u32 max_depth = 0;
+};
+
 class YPhysicsSystem {
 public:
     enum class YePartitioningAlgorithm : unsigned char {
@@ -57,27 +72,109 @@ public:
 
     static YPhysicsSystem* instance();
 
-    void buildBVH();
+    // Copies the scene triangles and builds on a worker thread, a build still running is superseded and stops early.
+    // Pushes YsBvhBuildFinishedEvent carrying the build generation when done.
+    void buildBVHAsync();
+    void waitBVHBuild();
+
+    // Swaps in the result of the build of that generation, false if a newer build superseded it or the scene changed
+    // since its snapshot was taken. Main thread only.
+    b8 commitBVHBuild(u32 generation);
 
     inline YsBVHNodeComponent* rootBVHNode() {return this->m_root_bvh_node.get();}
 
-    u32 meshVertexIndex(YsMeshComponent* mc) {this->m_mesh_vertex_index_map.find(mc)->second;}
+    // Leaf nodes reference [triangle_index, triangle_index + triangle_count) of this permutation.
+    inline const std::vector<u32>& triangleIndices() {return this->m_triangle_indices;}
+
+    YsBVHBuildReport buildReport();
+
+    inline YePartitioningAlgorithm getPartitioningAlgorithm() {return this->m_partitioning_algorithm;}
+    inline void setPartitioningAlgorithm(YePartitioningAlgorithm value) {this->m_partitioning_algorithm = value;}
+    inline u32 getMaxLeafTriangleCount() {return this->m_max_leaf_triangle_count;}
+    inline void setMaxLeafTriangleCount(u32 value) {this->m_max_leaf_triangle_count = value < 1 ? 1 : value;}
+    inline u32 getThreadCount() {return this->m_thread_count;}
+    inline void setThreadCount(u32 value) {this->m_thread_count = value < 1 ? 1 : value;}
 
 private:
     YPhysicsSystem();
     ~YPhysicsSystem();
 
-    void recursiveCreateBVH(const std::vector<YsMeshComponent*>& meshes, YsBVHNodeComponent* node, int max_depth, int current_depth = 1);
+    struct YsBVHPrimitive {
+        glm::fvec3 min;
+        glm::fvec3 max;
+        glm::fvec3 centroid;
+    };
+
+    struct YsBVHBin {
+        glm::fvec3 min;
+        glm::fvec3 max;
+        u32 count;
+    };
 
-    void updateBVHNode(const std::vector<YsMeshComponent*>& meshes, YsBVHNodeComponent* node);
+    // Input, scratch and result of one build. A superseded build may still be finishing while the next one runs, so
+    // nothing a build works on is shared with another or with the scene.
+    struct YsBVHBuild {
+        u32 generation;
+        unsigned int scene_revision;
+        YePartitioningAlgorithm partitioning_algorithm;
+        u32 max_leaf_triangle_count;
+        u32 parallel_subtree_depth;
 
-    YsAABBComponent computeAABB(const std::vector<YsMeshComponent*>& meshes);
+        std::vector<glm::fvec4> positions;
 
-private:
-    //
-    std::map<YsMeshComponent*, u32> m_mesh_vertex_index_map;
+        std::vector<YsBVHPrimitive> primitives;
+        std::vector<u32> triangle_indices;
+        std::vector<u32> partition_buffer;
+
+        std::unique_ptr<YsBVHNodeComponent> root_bvh_node;
+        YsBVHBuildReport report;
+    };
 
+    void buildBVH(YsBVHBuild* build);
+
+    inline b8 isSuperseded(const YsBVHBuild* build) {return build->generation != this->m_build_generation.load();}
+
+    void recursiveCreateBVH(YsBVHBuild* build, YsBVHNodeComponent* node, u32 begin, u32 end, u32 current_depth = 1);
+
+    u32 partitionSAH(YsBVHBuild* build, const YsAABBComponent& centroid_aabb, u32 begin, u32 end, u32 current_depth);
+    u32 partitionMedianSplit(YsBVHBuild* build, const YsAABBComponent& centroid_aabb, u32 begin, u32 end, u32 current_depth);
+    u32 stablePartition(YsBVHBuild* build, u32 begin, u32 end, u32 current_depth, const std::function<bool(u32)>& goes_left);
+
+    void computeAABB(YsBVHBuild* build, u32 begin, u32 end, u32 current_depth, YsAABBComponent* aabb, YsAABBComponent* centroid_aabb);
+
+    // Splits [begin, end) into contiguous chunks and runs them on the thread pool, chunk results are always merged in
+    // chunk order.
+    u32 chunkCount(u32 begin, u32 end, u32 current_depth);
+    void parallelChunks(u32 begin, u32 end, u32 chunk_count, const std::function<void(u32, u32, u32)>& func);
+
+    f64 recursiveComputeBuildReport(YsBVHNodeComponent* node, u32 current_depth, YsBVHBuildReport* report);
+
+private:
+    YePartitioningAlgorithm m_partitioning_algorithm = YePartitioningAlgorithm::SAH;
+    u32 m_max_leaf_triangle_count = 4;
+    const u32 m_max_depth = 64;
+    const u32 m_sah_bin_count = 16;
+    const f32 m_sah_traversal_cost = 1.0f;
+    const f32 m_sah_intersection_cost = 1.0f;
+    u32 m_thread_count;
+    const u32 m_parallel_subtree_threshold = 32 * 1024;
+    const u32 m_parallel_chunk_threshold = 64 * 1024;
+    // Buckets of every histogram the median split narrows its range with.
+    const u32 m_median_bin_count = 1024;
+
+    // Committed result, only touched on the main thread.
+    std::vector<u32> m_triangle_indices;
     std::unique_ptr<YsBVHNodeComponent> m_root_bvh_node;
+
+    YsBVHBuildReport m_build_report;
+
+    //
+    std::unique_ptr<YThreadPool> m_thread_pool;
+    std::vector<std::unique_ptr<YAsyncTask<void>>> m_builds;
+    // Finished build waiting for its YsBvhBuildFinishedEvent, guarded by m_mutex.
+    std::unique_ptr<YsBVHBuild> m_finished_build;
+    std::unique_ptr<std::mutex> m_mutex;
+    std::atomic<u32> m_build_generation = 0;
 };
 
 
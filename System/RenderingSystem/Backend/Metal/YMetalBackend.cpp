@@ -39,7 +39,9 @@ YMetalBackend::~YMetalBackend() {
 void YMetalBackend::deviceUpdateVertexInput(u32 vertex_count,
                                                   void* vertex_position_data,
                                                   void* vertex_normal_data,
-                                                  void* vertex_material_id_data) {
+                                                  void* vertex_material_id_data,
+                                                  u32 draw_record_count,
+                                                  void* draw_record_data) {
 
 }
 
@@ -47,7 +49,13 @@ void YMetalBackend::deviceUpdateUbo(void* ubo_data) {
 
 }
 
-void YMetalBackend::deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) {
+void YMetalBackend::deviceUpdateSsbo(void* scene_info_data,
+                                     void* bvh_node_data,
+                                     void* material_data,
+                                     void* vertex_position_data,
+                                     void* vertex_normal_data,
+                                     void* vertex_material_id_data,
+                                     void* vertex_entity_id_data) {
 
 }
 
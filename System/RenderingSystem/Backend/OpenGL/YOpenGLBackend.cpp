@@ -345,7 +345,9 @@ void YOpenGLBackend::drawImage(const YsGLObject* gl_object) {
 void YOpenGLBackend::deviceUpdateVertexInput(u32 vertex_count,
                                                    void* vertex_position_data,
                                                    void* vertex_normal_data,
-                                                   void* vertex_material_id_data) {
+                                                   void* vertex_material_id_data,
+                                                   u32 draw_record_count,
+                                                   void* draw_record_data) {
 
 }
 
@@ -353,7 +355,13 @@ void YOpenGLBackend::deviceUpdateUbo(void* ubo_data) {
 
 }
 
-void YOpenGLBackend::deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) {
+void YOpenGLBackend::deviceUpdateSsbo(void* scene_info_data,
+                                      void* bvh_node_data,
+                                      void* material_data,
+                                      void* vertex_position_data,
+                                      void* vertex_normal_data,
+                                      void* vertex_material_id_data,
+                                      void* vertex_entity_id_data) {
 
 }
 
@@ -93,11 +93,19 @@ private:
     void deviceUpdateVertexInput(u32 vertex_count,
                                void* vertex_position_data,
                                void* vertex_normal_data,
-                               void* vertex_material_id_data) override;
+                               void* vertex_material_id_data,
+                               u32 draw_record_count,
+                               void* draw_record_data) override;
 
     void deviceUpdateUbo(void* ubo_data) override;
 
-    void deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) override;
+    void deviceUpdateSsbo(void* scene_info_data,
+                          void* bvh_node_data,
+                          void* material_data,
+                          void* vertex_position_data,
+                          void* vertex_normal_data,
+                          void* vertex_material_id_data,
+                          void* vertex_entity_id_data) override;
 
     b8 frameRun() override;
 private:
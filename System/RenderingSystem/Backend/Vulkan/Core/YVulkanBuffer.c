@@ -45,54 +45,36 @@ static b8 bufferCreate(YsVkContext* context,
     buffer_info.size = size;
     buffer_info.usage = usage;
     buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (out_buffer->is_concurrent && context->device->shared_queue_family_count > 1) {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = context->device->shared_queue_family_count;
+        buffer_info.pQueueFamilyIndices = context->device->shared_queue_family_indices;
+    }
 
     VK_CHECK(vkCreateBuffer(context->device->logical_device, 
                             &buffer_info, 
                             context->allocator, 
                             &out_buffer->handle));
 
-    // Gather memory requirements.
-    VkMemoryRequirements requirements;
-    vkGetBufferMemoryRequirements(context->device->logical_device, out_buffer->handle, &requirements);
-    out_buffer->memory_index = context->find_memory_index(requirements.memoryTypeBits, out_buffer->memory_property_flags, context);
-    if (out_buffer->memory_index == -1) {
-        YERROR("Unable to create vulkan buffer because the required memory type index was not found.");
-        return false;
-    }
-
-    // Allocate memory info
-    VkMemoryAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    allocate_info.allocationSize = requirements.size;
-    allocate_info.memoryTypeIndex = (u32)out_buffer->memory_index;
-
-    // Allocate the memory.
-    VkResult result = vkAllocateMemory(context->device->logical_device,
-                                       &allocate_info,
-                                       context->allocator,
-                                       &out_buffer->memory);
-
-    if (result != VK_SUCCESS) {
-        YERROR("Unable to create vulkan buffer because the required memory allocation failed. Error: %i", result);
+    if (!context->memory_allocator->allocateBuffer(context,
+                                                   out_buffer->handle,
+                                                   out_buffer->memory_property_flags,
+                                                   out_buffer->memory_strategy,
+                                                   &out_buffer->allocation)) {
+        YERROR("Unable to create vulkan buffer because the memory allocation failed.");
         return false;
     }
-
-    VK_CHECK(vkBindBufferMemory(context->device->logical_device,
-                                out_buffer->handle,
-                                out_buffer->memory,
-                                0));
+    out_buffer->memory_index = (i32)out_buffer->allocation.memory_type_index;
 
     return true;
 }
 
 static void bufferDestroy(YsVkContext* context, YsVkBuffer* buffer) {
-    if (buffer->memory) {
-        vkFreeMemory(context->device->logical_device, buffer->memory, context->allocator);
-        buffer->memory = 0;
-    }
     if (buffer->handle) {
         vkDestroyBuffer(context->device->logical_device, buffer->handle, context->allocator);
         buffer->handle = 0;
     }
+    context->memory_allocator->release(context, &buffer->allocation);
     buffer->total_size = 0;
     buffer->usage = 0;
     buffer->is_locked = false;
@@ -197,48 +179,11 @@ static void bufferDirectUpdate(YsVkContext* context,
                                u32 flags,
                                const void* data,
                                YsVkBuffer* buffer) {
-    void* data_ptr = NULL;
-    VK_CHECK(vkMapMemory(context->device->logical_device, 
-                         buffer->memory, 
-                         offset, 
-                         buffer->total_size, 
-                         flags, 
-                         &data_ptr));
-    yCMemoryCopy(data_ptr, data, buffer->total_size);
-    vkUnmapMemory(context->device->logical_device, buffer->memory);
-}
-
-static void bufferIndirectUpdate(YsVkContext* context,
-                                 YsVkCommandUnit* command_unit,
-                                 VkFence fence,
-                                 u64 offset,
-                                 void* data,
-                                 YsVkBuffer* buffer) {
-    VkMemoryPropertyFlagBits staging_memory_property_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
-                                                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    YsVkBuffer staging_buffer;
-    bufferCreate(context,
-                 buffer->total_size,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 staging_memory_property_flags,
-                 &staging_buffer);
-
-    bufferDirectUpdate(context,
-                       0,
-                       0,
-                       data,
-                       &staging_buffer);
-
-    bufferCopyToBuffer(context,
-                       command_unit,
-                       fence,
-                       staging_buffer.handle,
-                       0,
-                       buffer->handle,
-                       offset,
-                       buffer->total_size);
-
-    bufferDestroy(context, &staging_buffer);
+    if (!buffer->allocation.mapped_data) {
+        YERROR("Buffer memory is not host visible, use the staging buffer to update it.");
+        return;
+    }
+    yCMemoryCopy((u8*)buffer->allocation.mapped_data + offset, data, buffer->total_size - offset);
 }
 
 YsVkBuffer* yVkAllocateBufferObject() {
@@ -249,7 +194,6 @@ YsVkBuffer* yVkAllocateBufferObject() {
         buffer->copyToBuffer = bufferCopyToBuffer;
         buffer->copyToImage = bufferCopyToImage;
         buffer->directUpdate = bufferDirectUpdate;
-        buffer->indirectUpdate = bufferIndirectUpdate;
     }
     return buffer;
 }
\ No newline at end of file
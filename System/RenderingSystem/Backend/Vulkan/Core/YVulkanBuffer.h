@@ -27,6 +27,7 @@
 
 
 #include "YVulkanTypes.h"
+#include "YVulkanMemoryAllocator.h"
 
 
 #ifdef __cplusplus
@@ -55,14 +56,7 @@ typedef struct YsVkBuffer {
                          const void* data,
                          struct YsVkBuffer* buffer);
 
-    void (*indirectUpdate)(struct YsVkContext* context,
-                           struct YsVkCommandUnit* command_unit,
-                           VkFence fence,
-                           u64 offset,
-                           void* data,
-                           struct YsVkBuffer* buffer);
-
-                           void (*copyToBuffer)(struct YsVkContext* context,
+    void (*copyToBuffer)(struct YsVkContext* context,
                          struct YsVkCommandUnit* command_unit,
                          VkFence fence,
                          VkBuffer source,
@@ -75,7 +69,11 @@ typedef struct YsVkBuffer {
     VkBuffer handle;
     VkBufferUsageFlagBits usage;
     b8 is_locked;
-    VkDeviceMemory memory;
+    YsVkMemoryAllocation allocation;
+    // Set before create, defaults to MEMORY_STRATEGY_BUDDY.
+    YeVkMemoryStrategy memory_strategy;
+    // Set before create, used by more than one queue family (async compute, transfer).
+    b8 is_concurrent;
     i32 memory_index;
     VkMemoryPropertyFlagBits memory_property_flags;
 } YsVkBuffer;
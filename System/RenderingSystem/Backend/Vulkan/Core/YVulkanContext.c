@@ -25,8 +25,27 @@
 #include "YVulkanContext.h"
 #include "YLogger.h"
 #include "YCMemoryManager.h"
+#include "YAssets.h"
 #include "GLFW/glfw3.h"
 
+#include <stdio.h>
+
+#define PIPELINE_CACHE_FILE_MAGIC 0x43504C59
+#define PIPELINE_CACHE_FILE_VERSION 1
+
+
+// Prepended to the driver's cache data, a blob from another device or driver is discarded instead of handed to the driver.
+typedef struct YsVkPipelineCacheFileHeader {
+    u32 magic;
+    u32 version;
+    u32 vendor_id;
+    u32 device_id;
+    u32 driver_version;
+    u8 device_uuid[VK_UUID_SIZE];
+    u8 pipeline_cache_uuid[VK_UUID_SIZE];
+    u64 data_size;
+} YsVkPipelineCacheFileHeader;
+
 
 static void* yVkAllocAllocationCallback(void* user_data,
                                  size_t size,
@@ -244,8 +263,129 @@ static b8 yVkDebuggerCreate(YsVkContext* context) {
     return true;
 }
 
+static void pipelineCacheFileHeader(YsVkContext* context, YsVkPipelineCacheFileHeader* out_header) {
+    VkPhysicalDeviceIDProperties id_properties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    properties.pNext = &id_properties;
+    vkGetPhysicalDeviceProperties2(context->device->physical_device, &properties);
+
+    memset(out_header, 0, sizeof(YsVkPipelineCacheFileHeader));
+    out_header->magic = PIPELINE_CACHE_FILE_MAGIC;
+    out_header->version = PIPELINE_CACHE_FILE_VERSION;
+    out_header->vendor_id = properties.properties.vendorID;
+    out_header->device_id = properties.properties.deviceID;
+    out_header->driver_version = properties.properties.driverVersion;
+    memcpy(out_header->device_uuid, id_properties.deviceUUID, VK_UUID_SIZE);
+    memcpy(out_header->pipeline_cache_uuid, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static b8 pipelineCacheCreate(YsVkContext* context) {
+    const char* file_path = yAssetsPipelineCacheFile();
+
+    YsVkPipelineCacheFileHeader expected_header;
+    pipelineCacheFileHeader(context, &expected_header);
+
+    void* initial_data = NULL;
+    u64 initial_data_size = 0;
+    FILE* file = fopen(file_path, "rb");
+    if (file) {
+        YsVkPipelineCacheFileHeader header;
+        if (fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == expected_header.magic &&
+            header.version == expected_header.version &&
+            header.vendor_id == expected_header.vendor_id &&
+            header.device_id == expected_header.device_id &&
+            header.driver_version == expected_header.driver_version &&
+            0 == memcmp(header.device_uuid, expected_header.device_uuid, VK_UUID_SIZE) &&
+            0 == memcmp(header.pipeline_cache_uuid, expected_header.pipeline_cache_uuid, VK_UUID_SIZE) &&
+            header.data_size > 0) {
+            initial_data = yCMemoryAllocate(header.data_size);
+            if (fread(initial_data, header.data_size, 1, file) == 1) {
+                initial_data_size = header.data_size;
+            } else {
+                YWARN("Pipeline cache file %s is truncated, starting with an empty cache.", file_path);
+                yCMemoryFree(initial_data);
+                initial_data = NULL;
+            }
+        } else {
+            YWARN("Pipeline cache file %s does not match this device or driver, starting with an empty cache.", file_path);
+        }
+        fclose(file);
+    } else {
+        YINFO("No pipeline cache file at %s, starting with an empty cache.", file_path);
+    }
+
+    VkPipelineCacheCreateInfo create_info = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    create_info.initialDataSize = initial_data_size;
+    create_info.pInitialData = initial_data;
+    VkResult result = vkCreatePipelineCache(context->device->logical_device,
+                                            &create_info,
+                                            context->allocator,
+                                            &context->pipeline_cache);
+    if (result != VK_SUCCESS && initial_data) {
+        YWARN("vkCreatePipelineCache rejected the cached data with %s, starting with an empty cache.", string_VkResult(result));
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = NULL;
+        result = vkCreatePipelineCache(context->device->logical_device,
+                                       &create_info,
+                                       context->allocator,
+                                       &context->pipeline_cache);
+        initial_data_size = 0;
+    }
+    if (initial_data) {
+        yCMemoryFree(initial_data);
+    }
+    if (result != VK_SUCCESS) {
+        YERROR("vkCreatePipelineCache failed with %s.", string_VkResult(result));
+        context->pipeline_cache = VK_NULL_HANDLE;
+        return false;
+    }
+
+    context->pipeline_cache_warm = initial_data_size > 0;
+    context->pipeline_creation_time = 0.0;
+    YINFO("Pipeline cache created, %llu bytes loaded.", initial_data_size);
+
+    return true;
+}
+
+static b8 savePipelineCache(YsVkContext* context) {
+    if (!context->pipeline_cache) {
+        return false;
+    }
+
+    size_t data_size = 0;
+    VK_CHECK(vkGetPipelineCacheData(context->device->logical_device, context->pipeline_cache, &data_size, NULL));
+    if (0 == data_size) {
+        return false;
+    }
+    void* data = yCMemoryAllocate(data_size);
+    VK_CHECK(vkGetPipelineCacheData(context->device->logical_device, context->pipeline_cache, &data_size, data));
+
+    YsVkPipelineCacheFileHeader header;
+    pipelineCacheFileHeader(context, &header);
+    header.data_size = data_size;
+
+    const char* file_path = yAssetsPipelineCacheFile();
+    b8 saved = false;
+    FILE* file = fopen(file_path, "wb");
+    if (file) {
+        saved = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                fwrite(data, data_size, 1, file) == 1;
+        fclose(file);
+    }
+    yCMemoryFree(data);
+
+    if (saved) {
+        YINFO("Pipeline cache saved to %s, %llu bytes.", file_path, (u64)data_size);
+    } else {
+        YERROR("Unable to write pipeline cache file %s.", file_path);
+    }
+    return saved;
+}
+
 static b8 initialize(u32 swapchain_width,
                      u32 swapchain_height,
+                     VkPresentModeKHR present_mode,
                      struct GLFWwindow* glfw_window,
                      const i8* const* enable_extensions,
                      i32 enable_extensions_count,
@@ -292,13 +432,46 @@ static b8 initialize(u32 swapchain_width,
         return false;
     }
 
+    // Memory Allocator
+    context->memory_allocator = yVkAllocateMemoryAllocatorObject();
+    if (!context->memory_allocator->create(context, context->memory_allocator)) {
+        YERROR("YVulkanContext failed to create Memory Allocator!");
+        return false;
+    }
+
+    // Upload Queue
+    if (context->device->features_12.timelineSemaphore) {
+        context->upload_queue = yVkAllocateUploadQueueObject();
+        if (!context->upload_queue->create(context, context->upload_queue)) {
+            YWARN("YVulkanContext continues without an upload queue.");
+            yCMemoryFree(context->upload_queue);
+            context->upload_queue = NULL;
+        }
+    } else {
+        YWARN("Timeline semaphores are not supported, scene uploads run on the graphics queue.");
+    }
+
+    // Pipeline Cache
+    if (!pipelineCacheCreate(context)) {
+        YWARN("YVulkanContext continues without a pipeline cache.");
+    }
+
     // Swapchain
     context->swapchain = yVkAllocateSwapchainObject();
     context->swapchain->create(context,
                                swapchain_width,
                                swapchain_height,
-                               VK_PRESENT_MODE_FIFO_KHR, //VK_PRESENT_MODE_IMMEDIATE_KHR,
+                               present_mode,
                                context->swapchain);
+
+    // GPU Timer
+    context->gpu_timer = yVkAllocateGpuTimerObject();
+    if (!context->gpu_timer->create(context, context->swapchain->max_frames_in_flight, context->gpu_timer)) {
+        YWARN("YVulkanContext continues without GPU timing scopes.");
+        context->gpu_timer->destroy(context, context->gpu_timer);
+        yCMemoryFree(context->gpu_timer);
+        context->gpu_timer = NULL;
+    }
     YINFO("Vulkan Context Initialized Successfully.");
 
     return true;
@@ -308,6 +481,7 @@ YsVkContext* yVkContextCreate() {
     YsVkContext* context = yCMemoryAllocate(sizeof(YsVkContext));
     if(context) {
         context->initialize = initialize;
+        context->savePipelineCache = savePipelineCache;
     }
 
     return  context;
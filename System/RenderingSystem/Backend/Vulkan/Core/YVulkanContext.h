@@ -32,6 +32,9 @@
 #include "YVulkanRenderStage.h"
 #include "YVulkanResource.h"
 #include "YVulkanPipeline.h"
+#include "YVulkanMemoryAllocator.h"
+#include "YVulkanUploadQueue.h"
+#include "YVulkanGpuTimer.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -46,6 +49,7 @@ struct GLFWwindow;
 typedef struct YsVkContext {
     b8 (*initialize)(u32 swapchain_width,
                      u32 swapchain_height,
+                     VkPresentModeKHR present_mode,
                      struct GLFWwindow* glfw_window,
                      const i8* const*,
                      i32,
@@ -57,6 +61,8 @@ typedef struct YsVkContext {
                              u32 property_flags,
                              struct YsVkContext* context);
 
+    b8 (*savePipelineCache)(struct YsVkContext* context);
+
     const i8* application_name;
 
     const i8* engine_name;
@@ -80,7 +86,22 @@ typedef struct YsVkContext {
 
     YsVkDevice* device;
 
+    YsVkMemoryAllocator* memory_allocator;
+
+    // NULL without timeline semaphore support, scene data is then uploaded through the frame's staging ring.
+    YsVkUploadQueue* upload_queue;
+
     YsVkSwapchain* swapchain;
+
+    // Named GPU scopes with one query pool per frame in flight, NULL when the pools could not be created.
+    YsVkGpuTimer* gpu_timer;
+
+    // Shared by every pipeline, loaded from and saved next to the executable.
+    VkPipelineCache pipeline_cache;
+
+    b8 pipeline_cache_warm;
+
+    f64 pipeline_creation_time;
 } YsVkContext;
 
 YsVkContext* yVkContextCreate();
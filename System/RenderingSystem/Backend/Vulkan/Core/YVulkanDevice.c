@@ -29,6 +29,7 @@
 #include "YGlobalFunction.h"
 
 #define MAX_VK_GRAPHICS_COMPUTE_COMMAND_UNITS_COUNT 64
+#define ASYNC_COMPUTE_COMMAND_UNITS_COUNT 3
 
 static void querySwapchainSupport(VkPhysicalDevice physical_device,
                                   VkSurfaceKHR surface,
@@ -79,6 +80,7 @@ static void querySwapchainSupport(VkPhysicalDevice physical_device,
 static b8 physicalDeviceMeetsRequirements(VkPhysicalDevice device,
                                           const VkPhysicalDeviceProperties* properties,
                                           const VkPhysicalDeviceFeatures* features,
+                                          const VkPhysicalDeviceVulkan12Features* features_12,
                                           b8 is_apple_silicon,
                                           YsVkContext* context) {
     if (!is_apple_silicon) {
@@ -164,6 +166,41 @@ static b8 physicalDeviceMeetsRequirements(VkPhysicalDevice device,
             }
             context->device->graphics_compute_command_units_count += support_queue_count;
         }
+        // The first compute-only family takes path tracing off the graphics queue.
+        if(!support_graphics && support_compute && 0 == context->device->async_compute_command_units_count) {
+            if (queue_families[i].timestampValidBits == 0) {
+                YWARN("Compute queue family %u does not support timestamp queries, async compute is disabled.", i);
+            } else {
+                context->device->async_compute_command_units = yCMemoryAllocate(sizeof(YsVkCommandUnit) * ASYNC_COMPUTE_COMMAND_UNITS_COUNT);
+                for(u32 u = 0; u < ASYNC_COMPUTE_COMMAND_UNITS_COUNT; ++u) {
+                    context->device->async_compute_command_units[u].queue_family_index = i;
+                    context->device->async_compute_command_units[u].queue_index = u % support_queue_count;
+                }
+                context->device->async_compute_command_units_count = ASYNC_COMPUTE_COMMAND_UNITS_COUNT;
+            }
+        }
+        // The first transfer-only family streams scene uploads in the background.
+        if(!support_graphics && !support_compute && support_transfer && !context->device->transfer_command_unit) {
+            context->device->transfer_command_unit = yCMemoryAllocate(sizeof(YsVkCommandUnit));
+            context->device->transfer_command_unit->queue_family_index = i;
+            context->device->transfer_command_unit->queue_index = 0;
+        }
+    }
+
+    if(context->device->graphics_compute_command_units_count > 0) {
+        context->device->shared_queue_family_indices[context->device->shared_queue_family_count++] = context->device->graphics_compute_command_units[0].queue_family_index;
+    }
+    if(context->device->async_compute_command_units_count > 0) {
+        context->device->shared_queue_family_indices[context->device->shared_queue_family_count++] = context->device->async_compute_command_units[0].queue_family_index;
+        YINFO("Async compute queue family: %u", context->device->async_compute_command_units[0].queue_family_index);
+    } else {
+        YINFO("No dedicated compute queue family, path tracing runs on the graphics queue.");
+    }
+    if(context->device->transfer_command_unit) {
+        context->device->shared_queue_family_indices[context->device->shared_queue_family_count++] = context->device->transfer_command_unit->queue_family_index;
+        YINFO("Transfer queue family: %u", context->device->transfer_command_unit->queue_family_index);
+    } else {
+        YINFO("No dedicated transfer queue family, uploads run on a graphics queue.");
     }
 
     querySwapchainSupport(device,
@@ -186,6 +223,28 @@ static b8 physicalDeviceMeetsRequirements(VkPhysicalDevice device,
         return false;
     }
 
+    // Every pipeline binds the global descriptor set, whose texture array is indexed by handle.
+    if (!features_12->runtimeDescriptorArray ||
+        !features_12->descriptorBindingPartiallyBound ||
+        !features_12->descriptorBindingVariableDescriptorCount ||
+        !features_12->descriptorBindingSampledImageUpdateAfterBind ||
+        !features_12->shaderSampledImageArrayNonUniformIndexing) {
+        YERROR("Device does not support descriptor indexing, skipping.");
+        return false;
+    }
+
+    // Rasterization draws the culled scene with one indirect draw per view, drawIndirectCount is optional.
+    if (!features->multiDrawIndirect) {
+        YERROR("Device does not support multiDrawIndirect, skipping.");
+        return false;
+    }
+
+    // The Hi-Z pyramid is written a level at a time through the storage image array.
+    if (!features->shaderStorageImageArrayDynamicIndexing) {
+        YERROR("Device does not support shaderStorageImageArrayDynamicIndexing, skipping.");
+        return false;
+    }
+
     return true;
 }
 
@@ -245,6 +304,7 @@ static b8 selectPhysicalDevice(YsVkContext* context) {
     b8 result = physicalDeviceMeetsRequirements(physical_devices[0],
                                                 &properties,
                                                 &features,
+                                                &vulkan_1_2_features,
                                                 is_apple_silicon,
                                                 context);
     if (result) {
@@ -294,16 +354,23 @@ static b8 selectPhysicalDevice(YsVkContext* context) {
     context->device->features_12 = vulkan_1_2_features;
     context->device->memory = memory;
 
+    // Cached secondaries always declare the counters, so a query begun around them later needs no re-recording.
+    if (features.pipelineStatisticsQuery && features.inheritedQueries) {
+        context->device->inherited_pipeline_statistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                         VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    }
+
     YINFO("Physical device selected.");
     return true;
 }
 
 static void commandBufferAllocate(YsVkContext* context,
                                   YsVkCommandUnit* command_unit,
+                                  u32 command_pool_index,
                                   b8 is_primary,
                                   VkCommandBuffer* out_command_buffer) {
     VkCommandBufferAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-    allocate_info.commandPool = command_unit->command_pools[0];
+    allocate_info.commandPool = command_unit->command_pools[command_pool_index];
     allocate_info.level = is_primary ? VK_COMMAND_BUFFER_LEVEL_PRIMARY : VK_COMMAND_BUFFER_LEVEL_SECONDARY;
     allocate_info.commandBufferCount = 1;
     allocate_info.pNext = 0;
@@ -312,6 +379,83 @@ static void commandBufferAllocate(YsVkContext* context,
                                       out_command_buffer));
 }
 
+static void commandUnitCreate(YsVkContext* context, YsVkCommandUnit* command_unit, u32 command_pool_count) {
+    vkGetDeviceQueue(context->device->logical_device,
+                     command_unit->queue_family_index,
+                     command_unit->queue_index,
+                     &command_unit->queue);
+
+    command_unit->command_pool_count = command_pool_count;
+    command_unit->command_pools = yCMemoryAllocate(sizeof(VkCommandPool) * command_unit->command_pool_count);
+    VkCommandPoolCreateInfo pool_create_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pool_create_info.queueFamilyIndex = command_unit->queue_family_index;
+    pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    for(u32 p = 0; p < command_unit->command_pool_count; ++p) {
+        VK_CHECK(vkCreateCommandPool(context->device->logical_device,
+                                     &pool_create_info,
+                                     context->allocator,
+                                     &command_unit->command_pools[p]));
+    }
+
+    command_unit->command_buffer_count = FRAME_COMMAND_BUFFER_COUNT;
+    command_unit->command_buffers = yCMemoryAllocate(sizeof(VkCommandBuffer) * command_unit->command_buffer_count);
+    for(int c = 0; c < command_unit->command_buffer_count; ++c) {
+        commandBufferAllocate(context,
+                              command_unit,
+                              COMMAND_POOL_MAIN_THREAD,
+                              true,
+                              &command_unit->command_buffers[c]);
+    }
+
+    VkQueryPoolCreateInfo query_pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = TIMESTAMP_QUERY_COUNT;
+    VK_CHECK(vkCreateQueryPool(context->device->logical_device,
+                               &query_pool_info,
+                               NULL,
+                               &command_unit->query_pool_timestamps));
+    vkResetQueryPool(context->device->logical_device,
+                     command_unit->query_pool_timestamps,
+                     0,
+                     TIMESTAMP_QUERY_COUNT);
+}
+
+// The device time domain is the one vkCmdWriteTimestamp writes in, once it can be calibrated the timestamps of
+// different queues share its clock. A domain that is listed but fails to sample is treated as unsupported.
+static b8 calibrateDeviceTimestamps(YsVkContext* context) {
+    PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT get_time_domains =
+            (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(context->instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+    PFN_vkGetCalibratedTimestampsEXT get_calibrated_timestamps =
+            (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(context->device->logical_device, "vkGetCalibratedTimestampsEXT");
+    if(!get_time_domains || !get_calibrated_timestamps) {
+        return false;
+    }
+
+    u32 time_domain_count = 0;
+    VK_CHECK(get_time_domains(context->device->physical_device, &time_domain_count, NULL));
+    if(0 == time_domain_count) {
+        return false;
+    }
+    VkTimeDomainEXT time_domains[time_domain_count];
+    VK_CHECK(get_time_domains(context->device->physical_device, &time_domain_count, time_domains));
+    b8 has_device_time_domain = false;
+    for(u32 i = 0; i < time_domain_count; ++i) {
+        has_device_time_domain = has_device_time_domain || VK_TIME_DOMAIN_DEVICE_EXT == time_domains[i];
+    }
+    if(!has_device_time_domain) {
+        return false;
+    }
+
+    VkCalibratedTimestampInfoEXT timestamp_info = {VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT};
+    timestamp_info.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    u64 timestamp = 0;
+    u64 max_deviation = 0;
+    if(VK_SUCCESS != get_calibrated_timestamps(context->device->logical_device, 1, &timestamp_info, &timestamp, &max_deviation)) {
+        return false;
+    }
+    return true;
+}
+
 static b8 create(YsVkContext* context) {
     if (!selectPhysicalDevice(context)) {
         return false;
@@ -319,16 +463,51 @@ static b8 create(YsVkContext* context) {
 
     YINFO("Creating logical device...");
 
-    VkDeviceQueueCreateInfo queue_create_infos[context->device->graphics_compute_command_units_count];
-    for(int i = 0; i < context->device->graphics_compute_command_units_count; ++i) {
+    // Every family appears once, with as many queues as its command units address.
+    u32 queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context->device->physical_device,
+                                             &queue_family_count,
+                                             NULL);
+    u32 family_queue_counts[queue_family_count];
+    for(u32 i = 0; i < queue_family_count; ++i) {
+        family_queue_counts[i] = 0;
+    }
+    for(u32 i = 0; i < context->device->graphics_compute_command_units_count; ++i) {
         YsVkCommandUnit* i_command_unit = &context->device->graphics_compute_command_units[i];
-        queue_create_infos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queue_create_infos[i].queueFamilyIndex = i_command_unit->queue_family_index;
-        queue_create_infos[i].queueCount = 1;
-        queue_create_infos[i].flags = 0;
-        queue_create_infos[i].pNext = 0;
-        f32 queue_priority = 1.0f;
-        queue_create_infos[i].pQueuePriorities = &queue_priority;
+        u32 queue_count = i_command_unit->queue_index + 1;
+        if(queue_count > family_queue_counts[i_command_unit->queue_family_index]) {
+            family_queue_counts[i_command_unit->queue_family_index] = queue_count;
+        }
+    }
+    for(u32 i = 0; i < context->device->async_compute_command_units_count; ++i) {
+        YsVkCommandUnit* i_command_unit = &context->device->async_compute_command_units[i];
+        u32 queue_count = i_command_unit->queue_index + 1;
+        if(queue_count > family_queue_counts[i_command_unit->queue_family_index]) {
+            family_queue_counts[i_command_unit->queue_family_index] = queue_count;
+        }
+    }
+    if(context->device->transfer_command_unit) {
+        family_queue_counts[context->device->transfer_command_unit->queue_family_index] = 1;
+    }
+
+    f32 queue_priorities[MAX_VK_GRAPHICS_COMPUTE_COMMAND_UNITS_COUNT];
+    for(u32 i = 0; i < MAX_VK_GRAPHICS_COMPUTE_COMMAND_UNITS_COUNT; ++i) {
+        queue_priorities[i] = 1.0f;
+    }
+
+    u32 queue_create_info_count = 0;
+    VkDeviceQueueCreateInfo queue_create_infos[queue_family_count];
+    for(u32 i = 0; i < queue_family_count; ++i) {
+        if(0 == family_queue_counts[i]) {
+            continue;
+        }
+        VkDeviceQueueCreateInfo* queue_create_info = &queue_create_infos[queue_create_info_count++];
+        queue_create_info->sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queue_create_info->queueFamilyIndex = i;
+        queue_create_info->queueCount = family_queue_counts[i];
+        queue_create_info->flags = 0;
+        queue_create_info->pNext = 0;
+        queue_create_info->pQueuePriorities = queue_priorities;
     }
 
     b8 portability_required = false;
@@ -340,21 +519,30 @@ static b8 create(YsVkContext* context) {
     YINFO("Available Extension Count: %d", available_extension_count);
     VkExtensionProperties available_extensions[available_extension_count];
     VK_CHECK(vkEnumerateDeviceExtensionProperties(context->device->physical_device, 0, &available_extension_count, available_extensions));
+    b8 calibrated_timestamps_available = false;
     for (u32 i = 0; i < available_extension_count; ++i) {
         YINFO("Available Device Extension: %s", available_extensions[i].extensionName);
         if (0==strcmp(available_extensions[i].extensionName, "VK_KHR_portability_subset")) {
             YINFO("Adding Device Extension 'VK_KHR_portability_subset'.");
             portability_required = true;
-            break;
+        } else if (0==strcmp(available_extensions[i].extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+            YINFO("Adding Device Extension '%s'.", VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+            calibrated_timestamps_available = true;
         }
     }
-    u32 extension_count = portability_required ? 3 : 1;
-    const char** extension_names = portability_required
-                                   ? (const char* [3]) { VK_KHR_SWAPCHAIN_EXTENSION_NAME, "VK_KHR_portability_subset", "VK_KHR_shader_non_semantic_info" }
-                                   : (const char* [1]) { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    u32 extension_count = 0;
+    const char* extension_names[4];
+    extension_names[extension_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    if(portability_required) {
+        extension_names[extension_count++] = "VK_KHR_portability_subset";
+        extension_names[extension_count++] = "VK_KHR_shader_non_semantic_info";
+    }
+    if(calibrated_timestamps_available) {
+        extension_names[extension_count++] = VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME;
+    }
 
     VkDeviceCreateInfo device_create_info = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
-    device_create_info.queueCreateInfoCount = context->device->graphics_compute_command_units_count;
+    device_create_info.queueCreateInfoCount = queue_create_info_count;
     device_create_info.pQueueCreateInfos = queue_create_infos;
     device_create_info.pEnabledFeatures = &context->device->features;
     device_create_info.enabledExtensionCount = extension_count;
@@ -370,44 +558,19 @@ static b8 create(YsVkContext* context) {
 
     YINFO("Logical device created.");
 
+    context->device->has_calibrated_timestamps = calibrated_timestamps_available && calibrateDeviceTimestamps(context);
+    YINFO("Calibrated device timestamps %s.", context->device->has_calibrated_timestamps ? "supported" : "not supported");
+
     //
+    // Graphics units get an extra pool per recording thread, a pool may only be used by one thread at a time.
     for(int i = 0; i < context->device->graphics_compute_command_units_count; ++i) {
-        YsVkCommandUnit* i_command_unit = &context->device->graphics_compute_command_units[i];
-        vkGetDeviceQueue(context->device->logical_device,
-                         i_command_unit->queue_family_index,
-                         i_command_unit->queue_index,
-                         &i_command_unit->queue);
-
-        i_command_unit->command_pool_count = 1;
-        i_command_unit->command_pools = yCMemoryAllocate(sizeof(VkCommandPool) * i_command_unit->command_pool_count);
-        VkCommandPoolCreateInfo pool_create_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
-        pool_create_info.queueFamilyIndex = i_command_unit->queue_family_index;
-        pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        VK_CHECK(vkCreateCommandPool(context->device->logical_device,
-                                     &pool_create_info,
-                                     context->allocator,
-                                     &i_command_unit->command_pools[0]));
-
-        i_command_unit->command_buffer_count = 2;
-        i_command_unit->command_buffers = yCMemoryAllocate(sizeof(VkCommandBuffer) * i_command_unit->command_buffer_count);
-        for(int c = 0; c < i_command_unit->command_buffer_count; ++c) {
-            commandBufferAllocate(context,
-                                  i_command_unit,
-                                  true,
-                                  &i_command_unit->command_buffers[c]);
-        }
-
-        VkQueryPoolCreateInfo query_pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
-        query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
-        query_pool_info.queryCount = 2;
-        VK_CHECK(vkCreateQueryPool(context->device->logical_device,
-                                   &query_pool_info,
-                                   NULL,
-                                   &i_command_unit->query_pool_timestamps));
-        vkResetQueryPool(context->device->logical_device,
-                         i_command_unit->query_pool_timestamps,
-                         0,
-                         2);
+        commandUnitCreate(context, &context->device->graphics_compute_command_units[i], COMMAND_POOL_RECORDING_THREAD_BEGIN + RECORDING_THREAD_COUNT);
+    }
+    for(int i = 0; i < context->device->async_compute_command_units_count; ++i) {
+        commandUnitCreate(context, &context->device->async_compute_command_units[i], 1);
+    }
+    if(context->device->transfer_command_unit) {
+        commandUnitCreate(context, context->device->transfer_command_unit, 1);
     }
 
     YDEBUG("Vulkan command buffers created.");
@@ -419,14 +582,36 @@ static void destroy(YsVkContext* context) {
     for(int i = 0; i < context->device->graphics_compute_command_units_count; ++i) {
         YsVkCommandUnit* i_command_unit = &context->device->graphics_compute_command_units[i];
         YINFO("Destroying command pools...");
-        vkDestroyCommandPool(context->device->logical_device,
-                             i_command_unit->command_pools[0],
-                             context->allocator);
+        for(u32 p = 0; p < i_command_unit->command_pool_count; ++p) {
+            vkDestroyCommandPool(context->device->logical_device,
+                                 i_command_unit->command_pools[p],
+                                 context->allocator);
+        }
     }
 
     context->device->graphics_compute_command_units_count = 0;
     yCMemoryFree(context->device->graphics_compute_command_units);
 
+    for(int i = 0; i < context->device->async_compute_command_units_count; ++i) {
+        vkDestroyCommandPool(context->device->logical_device,
+                             context->device->async_compute_command_units[i].command_pools[0],
+                             context->allocator);
+    }
+    if(context->device->async_compute_command_units) {
+        yCMemoryFree(context->device->async_compute_command_units);
+        context->device->async_compute_command_units = 0;
+    }
+    context->device->async_compute_command_units_count = 0;
+
+    if(context->device->transfer_command_unit) {
+        vkDestroyCommandPool(context->device->logical_device,
+                             context->device->transfer_command_unit->command_pools[0],
+                             context->allocator);
+        yCMemoryFree(context->device->transfer_command_unit);
+        context->device->transfer_command_unit = 0;
+    }
+    context->device->shared_queue_family_count = 0;
+
     YINFO("Destroying logical device...");
     if (context->device->logical_device) {
         vkDestroyDevice(context->device->logical_device, context->allocator);
@@ -485,6 +670,13 @@ static YsVkCommandUnit* commandUnitsAt(YsVkDevice* device, u32 index) {
     return &device->graphics_compute_command_units[index];
 }
 
+static YsVkCommandUnit* asyncComputeCommandUnitAt(YsVkDevice* device, u32 index) {
+    if(0 == device->async_compute_command_units_count) {
+        return NULL;
+    }
+    return &device->async_compute_command_units[index % device->async_compute_command_units_count];
+}
+
 static void commandBufferFree(YsVkContext* context,
                               YsVkCommandUnit* command_unit,
                               VkCommandBuffer* command_buffer) {
@@ -500,12 +692,29 @@ static void commandBufferBegin(VkCommandBuffer command_buffer, VkCommandBufferUs
     VK_CHECK(vkBeginCommandBuffer(command_buffer, &begin_info));
 }
 
+static void commandBufferBeginSecondary(YsVkDevice* device,
+                                        VkCommandBuffer command_buffer,
+                                        VkRenderPass render_pass,
+                                        u32 subpass,
+                                        VkFramebuffer framebuffer) {
+    VkCommandBufferInheritanceInfo inheritance_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    inheritance_info.renderPass = render_pass;
+    inheritance_info.subpass = subpass;
+    inheritance_info.framebuffer = framebuffer;
+    inheritance_info.pipelineStatistics = device->inherited_pipeline_statistics;
+
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+    VK_CHECK(vkBeginCommandBuffer(command_buffer, &begin_info));
+}
+
 static void commandBufferEnd(VkCommandBuffer command_buffer) {
     VK_CHECK(vkEndCommandBuffer(command_buffer));
 }
 
 static void commandBufferReset(VkCommandBuffer command_buffer) {
-    VkCommandBufferResetFlags flag;
+    VkCommandBufferResetFlags flag = 0;
     VK_CHECK(vkResetCommandBuffer(command_buffer, flag));
 }
 
@@ -514,6 +723,7 @@ static void commandBufferAllocateAndBeginSingleUse(YsVkContext* context,
                                                    VkCommandBuffer* tmp_command_buffer) {
     commandBufferAllocate(context,
                           command_unit,
+                          COMMAND_POOL_MAIN_THREAD,
                           true,
                           tmp_command_buffer);
     commandBufferBegin(*tmp_command_buffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -539,6 +749,40 @@ static void commandBufferEndSingleUse(YsVkContext* context,
                       tmp_command_buffer);
 }
 
+static b8 queryTimestamps(YsVkDevice* device,
+                          VkQueryPool query_pool,
+                          u32 first_query,
+                          u32 query_count,
+                          u64* out_timestamps) {
+    if(query_count > TIMESTAMP_QUERY_COUNT) {
+        YERROR("Timestamp readback of %u queries exceeds the pool size!", query_count);
+        return false;
+    }
+
+    // Every result is followed by its availability, a query that has not been written yet leaves it at zero.
+    u64 results[2 * TIMESTAMP_QUERY_COUNT] = {0};
+    VkResult result = vkGetQueryPoolResults(device->logical_device,
+                                            query_pool,
+                                            first_query,
+                                            query_count,
+                                            sizeof(results),
+                                            results,
+                                            2 * sizeof(u64),
+                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if(VK_SUCCESS != result && VK_NOT_READY != result) {
+        return false;
+    }
+
+    for(u32 i = 0; i < query_count; ++i) {
+        if(0 == results[2 * i + 1]) {
+            return false;
+        }
+        out_timestamps[i] = results[2 * i];
+    }
+
+    return true;
+}
+
 YsVkDevice* yVkAllocateDeviceObject() {
     YsVkDevice* device = yCMemoryAllocate(sizeof(YsVkDevice));
     if(device) {
@@ -548,12 +792,16 @@ YsVkDevice* yVkAllocateDeviceObject() {
         device->commandUnitsFront = commandUnitsFront;
         device->commandUnitsBack = commandUnitsBack;
         device->commandUnitsAt = commandUnitsAt;
+        device->asyncComputeCommandUnitAt = asyncComputeCommandUnitAt;
+        device->commandBufferAllocate = commandBufferAllocate;
         device->commandBufferFree = commandBufferFree;
         device->commandBufferBegin = commandBufferBegin;
+        device->commandBufferBeginSecondary = commandBufferBeginSecondary;
         device->commandBufferEnd = commandBufferEnd;
         device->commandBufferReset = commandBufferReset;
         device->commandBufferAllocateAndBeginSingleUse = commandBufferAllocateAndBeginSingleUse;
         device->commandBufferEndSingleUse = commandBufferEndSingleUse;
+        device->queryTimestamps = queryTimestamps;
     }
 
     return device;
@@ -45,6 +45,14 @@ typedef struct YsVkDevice {
     YsVkCommandUnit* (*commandUnitsBack)(struct YsVkDevice* device);
     YsVkCommandUnit* (*commandUnitsAt)(struct YsVkDevice* device, u32 index);
 
+    // Returns NULL when the device has no dedicated compute queue family.
+    YsVkCommandUnit* (*asyncComputeCommandUnitAt)(struct YsVkDevice* device, u32 index);
+
+    void (*commandBufferAllocate)(struct YsVkContext* context,
+                                  YsVkCommandUnit* command_unit,
+                                  u32 command_pool_index,
+                                  b8 is_primary,
+                                  VkCommandBuffer* out_command_buffer);
 
     void (*commandBufferFree)(struct YsVkContext* context,
                               YsVkCommandUnit* command_unit,
@@ -52,6 +60,13 @@ typedef struct YsVkDevice {
 
     void (*commandBufferBegin)(VkCommandBuffer command_buffer, VkCommandBufferUsageFlags flags);
 
+    // Begins a secondary buffer that continues the given subpass, the framebuffer may be VK_NULL_HANDLE.
+    void (*commandBufferBeginSecondary)(struct YsVkDevice* device,
+                                        VkCommandBuffer command_buffer,
+                                        VkRenderPass render_pass,
+                                        u32 subpass,
+                                        VkFramebuffer framebuffer);
+
     void (*commandBufferEnd)(VkCommandBuffer command_buffer);
 
     void (*commandBufferReset)(VkCommandBuffer command_buffer);
@@ -64,6 +79,13 @@ typedef struct YsVkDevice {
                                       YsVkCommandUnit* command_unit,
                                       VkCommandBuffer* tmp_command_buffer);
 
+    // Copies query_count timestamps without waiting, returns false when any of them has not been written yet.
+    b8 (*queryTimestamps)(struct YsVkDevice* device,
+                          VkQueryPool query_pool,
+                          u32 first_query,
+                          u32 query_count,
+                          u64* out_timestamps);
+
     VkPhysicalDevice physical_device;
     VkPhysicalDeviceProperties properties;
     VkPhysicalDeviceFeatures features;
@@ -76,9 +98,27 @@ typedef struct YsVkDevice {
 
     VkFormat depth_format;
 
+    // Pipeline statistics a query in a primary buffer may count across executed secondaries, 0 without inheritedQueries.
+    VkQueryPipelineStatisticFlags inherited_pipeline_statistics;
+
+    // Set when VK_EXT_calibrated_timestamps samples the device time domain, which puts the timestamps of every queue
+    // on one clock. Without it timestamps are only comparable within the queue that wrote them.
+    b8 has_calibrated_timestamps;
+
     u32 graphics_compute_command_units_count;
     YsVkCommandUnit* graphics_compute_command_units;
 
+    // One unit per frame in flight on a compute-only family, they share that family's queues.
+    u32 async_compute_command_units_count;
+    YsVkCommandUnit* async_compute_command_units;
+
+    // Queue of a transfer-only family for background uploads, NULL when the device has none.
+    YsVkCommandUnit* transfer_command_unit;
+
+    // Distinct graphics, async compute and transfer families, resources used by several queues are created concurrent over them.
+    u32 shared_queue_family_count;
+    u32 shared_queue_family_indices[3];
+
 } YsVkDevice;
 
 YsVkDevice* yVkAllocateDeviceObject();
@@ -0,0 +1,278 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "YVulkanGpuTimer.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YCMemoryManager.h"
+#include "YLogger.h"
+
+
+static b8 gpuTimerCreate(YsVkContext* context,
+                         u32 frame_count,
+                         YsVkGpuTimer* gpu_timer) {
+    gpu_timer->frame_count = frame_count;
+    gpu_timer->frames = yCMemoryAllocate(sizeof(YsVkGpuTimerFrame) * frame_count);
+
+    gpu_timer->supports_compute_statistics = context->device->features.pipelineStatisticsQuery;
+    gpu_timer->supports_graphics_statistics = 0 != context->device->inherited_pipeline_statistics;
+    gpu_timer->is_calibrated = context->device->has_calibrated_timestamps;
+
+    VkQueryPoolCreateInfo query_pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = 2 * GPU_TIMER_MAX_SCOPES;
+
+    VkQueryPoolCreateInfo graphics_statistics_query_pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    graphics_statistics_query_pool_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    graphics_statistics_query_pool_info.queryCount = GPU_TIMER_MAX_SCOPES;
+    graphics_statistics_query_pool_info.pipelineStatistics = context->device->inherited_pipeline_statistics;
+
+    VkQueryPoolCreateInfo compute_statistics_query_pool_info = graphics_statistics_query_pool_info;
+    compute_statistics_query_pool_info.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    for(u32 i = 0; i < frame_count; ++i) {
+        YsVkGpuTimerFrame* frame = &gpu_timer->frames[i];
+        if(VK_SUCCESS != vkCreateQueryPool(context->device->logical_device,
+                                           &query_pool_info,
+                                           NULL,
+                                           &frame->query_pool)) {
+            YERROR("Error creating GPU timer query pool.");
+            return false;
+        }
+        vkResetQueryPool(context->device->logical_device, frame->query_pool, 0, 2 * GPU_TIMER_MAX_SCOPES);
+
+        if(gpu_timer->supports_graphics_statistics) {
+            VK_CHECK(vkCreateQueryPool(context->device->logical_device,
+                                       &graphics_statistics_query_pool_info,
+                                       NULL,
+                                       &frame->graphics_statistics_query_pool));
+            vkResetQueryPool(context->device->logical_device, frame->graphics_statistics_query_pool, 0, GPU_TIMER_MAX_SCOPES);
+        }
+        if(gpu_timer->supports_compute_statistics) {
+            VK_CHECK(vkCreateQueryPool(context->device->logical_device,
+                                       &compute_statistics_query_pool_info,
+                                       NULL,
+                                       &frame->compute_statistics_query_pool));
+            vkResetQueryPool(context->device->logical_device, frame->compute_statistics_query_pool, 0, GPU_TIMER_MAX_SCOPES);
+        }
+    }
+
+    YINFO("GPU timer created, %u scopes per frame, graphics statistics %s, compute statistics %s, queues %s.",
+          GPU_TIMER_MAX_SCOPES,
+          gpu_timer->supports_graphics_statistics ? "supported" : "not supported",
+          gpu_timer->supports_compute_statistics ? "supported" : "not supported",
+          gpu_timer->is_calibrated ? "calibrated" : "timed separately");
+
+    return true;
+}
+
+static void gpuTimerDestroy(YsVkContext* context, YsVkGpuTimer* gpu_timer) {
+    for(u32 i = 0; i < gpu_timer->frame_count; ++i) {
+        YsVkGpuTimerFrame* frame = &gpu_timer->frames[i];
+        if(frame->query_pool) {
+            vkDestroyQueryPool(context->device->logical_device, frame->query_pool, NULL);
+        }
+        if(frame->graphics_statistics_query_pool) {
+            vkDestroyQueryPool(context->device->logical_device, frame->graphics_statistics_query_pool, NULL);
+        }
+        if(frame->compute_statistics_query_pool) {
+            vkDestroyQueryPool(context->device->logical_device, frame->compute_statistics_query_pool, NULL);
+        }
+    }
+    yCMemoryFree(gpu_timer->frames);
+    gpu_timer->frames = NULL;
+    gpu_timer->frame_count = 0;
+    gpu_timer->result_count = 0;
+}
+
+// A scope whose statistics are not available keeps GPU_TIMER_STATISTICS_NONE and only reports its time.
+static void readStatistics(YsVkContext* context,
+                           YsVkGpuTimerFrame* frame,
+                           u32 scope,
+                           YsVkGpuTimerResult* scope_result) {
+    YeVkGpuTimerStatistics statistics = frame->scope_statistics[scope];
+    if(GPU_TIMER_STATISTICS_NONE == statistics) {
+        return;
+    }
+
+    // Counters in the order of their bits, followed by the availability.
+    u64 results[3] = {0};
+    u32 counter_count = GPU_TIMER_STATISTICS_GRAPHICS == statistics ? 2 : 1;
+    VkResult result = vkGetQueryPoolResults(context->device->logical_device,
+                                            GPU_TIMER_STATISTICS_GRAPHICS == statistics ? frame->graphics_statistics_query_pool :
+                                                                                          frame->compute_statistics_query_pool,
+                                            scope,
+                                            1,
+                                            sizeof(results),
+                                            results,
+                                            sizeof(results),
+                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if((VK_SUCCESS != result && VK_NOT_READY != result) || 0 == results[counter_count]) {
+        return;
+    }
+
+    scope_result->statistics = statistics;
+    if(GPU_TIMER_STATISTICS_GRAPHICS == statistics) {
+        scope_result->vertex_invocations = results[0];
+        scope_result->fragment_invocations = results[1];
+    } else {
+        scope_result->compute_invocations = results[0];
+    }
+}
+
+static b8 gpuTimerBeginFrame(YsVkContext* context,
+                             u32 frame_index,
+                             YsVkGpuTimer* gpu_timer) {
+    YsVkGpuTimerFrame* frame = &gpu_timer->frames[frame_index];
+    if(0 == frame->scope_count) {
+        return false;
+    }
+
+    // Every timestamp is followed by its availability, a scope whose queries were not written is not waited on.
+    u64 results[4 * GPU_TIMER_MAX_SCOPES] = {0};
+    VkResult result = vkGetQueryPoolResults(context->device->logical_device,
+                                            frame->query_pool,
+                                            0,
+                                            2 * frame->scope_count,
+                                            sizeof(results),
+                                            results,
+                                            2 * sizeof(u64),
+                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    b8 is_available = VK_SUCCESS == result || VK_NOT_READY == result;
+    for(u32 i = 0; is_available && i < 2 * frame->scope_count; ++i) {
+        is_available = 0 != results[2 * i + 1];
+    }
+
+    if(is_available) {
+        f64 timestamp_period = context->device->properties.limits.timestampPeriod;
+        // Without calibration the queues count from unrelated bases, so each one only measures against itself.
+        u64 first_begins[GPU_TIMER_QUEUE_COUNT] = {0};
+        b8 has_first_begins[GPU_TIMER_QUEUE_COUNT] = {0};
+        for(u32 i = 0; i < frame->scope_count; ++i) {
+            u32 queue = gpu_timer->is_calibrated ? GPU_TIMER_QUEUE_GRAPHICS : frame->scope_queues[i];
+            if(!has_first_begins[queue] || results[4 * i] < first_begins[queue]) {
+                first_begins[queue] = results[4 * i];
+                has_first_begins[queue] = true;
+            }
+        }
+
+        // Scopes are begun in recording order, which is not the order the queues ran them in.
+        gpu_timer->result_count = 0;
+        for(u32 i = 0; i < frame->scope_count; ++i) {
+            u32 queue = gpu_timer->is_calibrated ? GPU_TIMER_QUEUE_GRAPHICS : frame->scope_queues[i];
+            YsVkGpuTimerResult scope_result = {0};
+            scope_result.name = frame->scope_names[i];
+            scope_result.queue = frame->scope_queues[i];
+            scope_result.begin = (results[4 * i] - first_begins[queue]) * timestamp_period / 1000000.0;
+            scope_result.time = (i64)(results[4 * i + 2] - results[4 * i]) * timestamp_period / 1000000.0;
+            readStatistics(context, frame, i, &scope_result);
+
+            u32 position = gpu_timer->result_count++;
+            while(position > 0 &&
+                  (gpu_timer->results[position - 1].queue > scope_result.queue ||
+                   (gpu_timer->results[position - 1].queue == scope_result.queue && gpu_timer->results[position - 1].begin > scope_result.begin))) {
+                gpu_timer->results[position] = gpu_timer->results[position - 1];
+                --position;
+            }
+            gpu_timer->results[position] = scope_result;
+        }
+    }
+
+    // The fence of the frame has signaled, so the pools can be reset from the host before they are recorded again.
+    vkResetQueryPool(context->device->logical_device,
+                     frame->query_pool,
+                     0,
+                     2 * frame->scope_count);
+    if(frame->graphics_statistics_query_pool) {
+        vkResetQueryPool(context->device->logical_device, frame->graphics_statistics_query_pool, 0, frame->scope_count);
+    }
+    if(frame->compute_statistics_query_pool) {
+        vkResetQueryPool(context->device->logical_device, frame->compute_statistics_query_pool, 0, frame->scope_count);
+    }
+    frame->scope_count = 0;
+
+    return is_available;
+}
+
+static u32 gpuTimerCmdBeginScope(VkCommandBuffer command_buffer,
+                                 u32 frame_index,
+                                 const i8* name,
+                                 YeVkGpuTimerQueue queue,
+                                 YeVkGpuTimerStatistics statistics,
+                                 YsVkGpuTimer* gpu_timer) {
+    YsVkGpuTimerFrame* frame = &gpu_timer->frames[frame_index];
+    if(GPU_TIMER_MAX_SCOPES == frame->scope_count) {
+        return GPU_TIMER_NO_SCOPE;
+    }
+
+    b8 is_supported = (GPU_TIMER_STATISTICS_GRAPHICS == statistics && gpu_timer->supports_graphics_statistics) ||
+                      (GPU_TIMER_STATISTICS_COMPUTE == statistics && gpu_timer->supports_compute_statistics);
+    u32 scope = frame->scope_count++;
+    frame->scope_names[scope] = name;
+    frame->scope_queues[scope] = queue;
+    frame->scope_statistics[scope] = gpu_timer->collect_statistics && is_supported ? statistics : GPU_TIMER_STATISTICS_NONE;
+    vkCmdWriteTimestamp(command_buffer,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        frame->query_pool,
+                        2 * scope);
+    if(GPU_TIMER_STATISTICS_GRAPHICS == frame->scope_statistics[scope]) {
+        vkCmdBeginQuery(command_buffer, frame->graphics_statistics_query_pool, scope, 0);
+    } else if(GPU_TIMER_STATISTICS_COMPUTE == frame->scope_statistics[scope]) {
+        vkCmdBeginQuery(command_buffer, frame->compute_statistics_query_pool, scope, 0);
+    }
+    return scope;
+}
+
+static void gpuTimerCmdEndScope(VkCommandBuffer command_buffer,
+                                u32 frame_index,
+                                u32 scope,
+                                YsVkGpuTimer* gpu_timer) {
+    if(GPU_TIMER_NO_SCOPE == scope) {
+        return;
+    }
+
+    YsVkGpuTimerFrame* frame = &gpu_timer->frames[frame_index];
+    if(GPU_TIMER_STATISTICS_GRAPHICS == frame->scope_statistics[scope]) {
+        vkCmdEndQuery(command_buffer, frame->graphics_statistics_query_pool, scope);
+    } else if(GPU_TIMER_STATISTICS_COMPUTE == frame->scope_statistics[scope]) {
+        vkCmdEndQuery(command_buffer, frame->compute_statistics_query_pool, scope);
+    }
+    vkCmdWriteTimestamp(command_buffer,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        frame->query_pool,
+                        2 * scope + 1);
+}
+
+YsVkGpuTimer* yVkAllocateGpuTimerObject() {
+    YsVkGpuTimer* gpu_timer = yCMemoryAllocate(sizeof(YsVkGpuTimer));
+    if(gpu_timer) {
+        gpu_timer->create = gpuTimerCreate;
+        gpu_timer->destroy = gpuTimerDestroy;
+        gpu_timer->beginFrame = gpuTimerBeginFrame;
+        gpu_timer->cmdBeginScope = gpuTimerCmdBeginScope;
+        gpu_timer->cmdEndScope = gpuTimerCmdEndScope;
+    }
+    return gpu_timer;
+}
@@ -0,0 +1,133 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CGPPY_YVULKANGPUTIMER_H
+#define CGPPY_YVULKANGPUTIMER_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define GPU_TIMER_MAX_SCOPES 16
+#define GPU_TIMER_NO_SCOPE 0xFFFFFFFF
+
+// Pipeline statistics a scope counts while collect_statistics is set. Graphics statistics span executed secondaries,
+// so they need the inheritedQueries feature on top of pipelineStatisticsQuery.
+typedef enum YeVkGpuTimerStatistics {
+    GPU_TIMER_STATISTICS_NONE = 0,
+    GPU_TIMER_STATISTICS_GRAPHICS,
+    GPU_TIMER_STATISTICS_COMPUTE
+} YeVkGpuTimerStatistics;
+
+// Queue a scope is recorded for. Timestamps of different queues are only placed on one axis when the device time
+// domain is calibrated, otherwise each queue's scopes start from that queue's own first timestamp.
+typedef enum YeVkGpuTimerQueue {
+    GPU_TIMER_QUEUE_GRAPHICS = 0,
+    GPU_TIMER_QUEUE_ASYNC_COMPUTE,
+    GPU_TIMER_QUEUE_COUNT
+} YeVkGpuTimerQueue;
+
+// Query pairs handed out to the scopes recorded in one frame in flight, in the order they were begun. A scope with
+// statistics also owns the query of the same index in the matching statistics pool.
+typedef struct YsVkGpuTimerFrame {
+    VkQueryPool query_pool;
+    VkQueryPool graphics_statistics_query_pool;
+    VkQueryPool compute_statistics_query_pool;
+    u32 scope_count;
+    const i8* scope_names[GPU_TIMER_MAX_SCOPES];
+    YeVkGpuTimerStatistics scope_statistics[GPU_TIMER_MAX_SCOPES];
+    YeVkGpuTimerQueue scope_queues[GPU_TIMER_MAX_SCOPES];
+} YsVkGpuTimerFrame;
+
+typedef struct YsVkGpuTimerResult {
+    const i8* name;
+    YeVkGpuTimerQueue queue;
+    f64 begin;
+    f64 time;
+
+    YeVkGpuTimerStatistics statistics;
+    u64 vertex_invocations;
+    u64 fragment_invocations;
+    u64 compute_invocations;
+} YsVkGpuTimerResult;
+
+// Named GPU timing scopes. Every scope writes a pair of timestamps into the pool of the frame that records it,
+// the pairs are read back without waiting once that frame slot comes around again.
+typedef struct YsVkGpuTimer {
+    b8 (*create)(struct YsVkContext* context,
+                 u32 frame_count,
+                 struct YsVkGpuTimer* gpu_timer);
+
+    void (*destroy)(struct YsVkContext* context, struct YsVkGpuTimer* gpu_timer);
+
+    // Must be called after the fence of frame_index has been waited on. Collects the scopes the frame recorded last
+    // time into results, sorted by queue and by their start on it, and frees its query pairs. Returns false when a scope
+    // was not available and the frame is left out.
+    b8 (*beginFrame)(struct YsVkContext* context,
+                     u32 frame_index,
+                     struct YsVkGpuTimer* gpu_timer);
+
+    // Returns GPU_TIMER_NO_SCOPE once the frame has run out of query pairs, ending that scope does nothing.
+    // Statistics are only counted when collected and supported, a graphics scope must begin outside a render pass.
+    u32 (*cmdBeginScope)(VkCommandBuffer command_buffer,
+                         u32 frame_index,
+                         const i8* name,
+                         YeVkGpuTimerQueue queue,
+                         YeVkGpuTimerStatistics statistics,
+                         struct YsVkGpuTimer* gpu_timer);
+
+    void (*cmdEndScope)(VkCommandBuffer command_buffer,
+                        u32 frame_index,
+                        u32 scope,
+                        struct YsVkGpuTimer* gpu_timer);
+
+    u32 frame_count;
+    YsVkGpuTimerFrame* frames;
+
+    b8 supports_graphics_statistics;
+    b8 supports_compute_statistics;
+    b8 collect_statistics;
+    b8 is_calibrated;
+
+    // Scopes of the most recently collected frame, in milliseconds from the first scope's start on the same queue,
+    // or on any queue once is_calibrated is set.
+    u32 result_count;
+    YsVkGpuTimerResult results[GPU_TIMER_MAX_SCOPES];
+} YsVkGpuTimer;
+
+YsVkGpuTimer* yVkAllocateGpuTimerObject();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CGPPY_YVULKANGPUTIMER_H
@@ -51,25 +51,35 @@ static void imageCreate(YsVkContext* context,
                                  out_image->handle,
                                  &out_image->memory_requirements);
 
-    i32 memory_type = context->find_memory_index(out_image->memory_requirements.memoryTypeBits,
-                                                 memory_flags,
-                                                 context);
-    if (memory_type == -1) {
-        YERROR("Required memory type not found. Image not valid.");
-        return;
+    // An alias has to fit in the memory of the image it shares, otherwise it falls back to its own allocation.
+    YsVkImage* memory_alias = out_image->memory_alias;
+    if (memory_alias &&
+        (!memory_alias->allocation.is_shareable ||
+         out_image->memory_requirements.size > memory_alias->memory_requirements.size ||
+         0 != memory_alias->allocation.offset % out_image->memory_requirements.alignment ||
+         0 == (out_image->memory_requirements.memoryTypeBits & (1u << memory_alias->allocation.memory_type_index)))) {
+        YWARN("Image memory can not be aliased, size: %llu, alias size: %llu.",
+              out_image->memory_requirements.size,
+              memory_alias->memory_requirements.size);
+        out_image->memory_alias = NULL;
     }
 
-    VkMemoryAllocateInfo memory_allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    memory_allocate_info.allocationSize = out_image->memory_requirements.size;
-    memory_allocate_info.memoryTypeIndex = memory_type;
-    VK_CHECK(vkAllocateMemory(context->device->logical_device,
-                              &memory_allocate_info,
-                              context->allocator,
-                              &out_image->memory));
-    VK_CHECK(vkBindImageMemory(context->device->logical_device,
-                               out_image->handle,
-                               out_image->memory,
-                               0));
+    if (out_image->memory_alias) {
+        out_image->allocation = memory_alias->allocation;
+        out_image->allocation.is_shareable = false;
+        VK_CHECK(vkBindImageMemory(context->device->logical_device,
+                                   out_image->handle,
+                                   out_image->allocation.memory,
+                                   out_image->allocation.offset));
+    } else if (!context->memory_allocator->allocateImage(context,
+                                                         out_image->handle,
+                                                         memory_flags,
+                                                         out_image->memory_strategy,
+                                                         out_image->is_memory_shareable,
+                                                         &out_image->allocation)) {
+        YERROR("Unable to allocate image memory. Image not valid.");
+        return;
+    }
 
     //
     VkImageViewType layer_view_type = VK_IMAGE_VIEW_TYPE_MAX_ENUM;
@@ -116,6 +126,25 @@ static void imageCreate(YsVkContext* context,
         }        
     }
 
+    if(out_image->create_info->mipLevels > 1) {
+        out_image->level_views = yCMemoryAllocate(sizeof(VkImageView) * out_image->create_info->mipLevels);
+        for(int i = 0; i < out_image->create_info->mipLevels; ++i) {
+            VkImageViewCreateInfo level_create_info = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+            level_create_info.image = out_image->handle;
+            level_create_info.viewType = image_view_type;
+            level_create_info.format = out_image->create_info->format;
+            level_create_info.subresourceRange.aspectMask = view_aspect_flags;
+            level_create_info.subresourceRange.baseMipLevel = i;
+            level_create_info.subresourceRange.levelCount = 1;
+            level_create_info.subresourceRange.baseArrayLayer = 0;
+            level_create_info.subresourceRange.layerCount = out_image->create_info->arrayLayers;
+            VK_CHECK(vkCreateImageView(context->device->logical_device,
+                                       &level_create_info,
+                                       context->allocator,
+                                       &out_image->level_views[i]));
+        }
+    }
+
     VkImageViewCreateInfo view_create_info = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
     view_create_info.image = out_image->handle;
     view_create_info.viewType = image_view_type;
@@ -169,23 +198,38 @@ static void imageDestroy(YsVkContext* context, YsVkImage* image) {
         image->image_view = 0;
     }
 
-    for(int i = 0; i < image->create_info->arrayLayers; ++i) {
-        if(image->layer_views[i]) {
-             vkDestroyImageView(context->device->logical_device, 
-                                image->layer_views[i],
-                                context->allocator);
+    if (image->layer_views) {
+        for(int i = 0; i < image->create_info->arrayLayers; ++i) {
+            if(image->layer_views[i]) {
+                 vkDestroyImageView(context->device->logical_device, 
+                                    image->layer_views[i],
+                                    context->allocator);
+            }
         }
+        yCMemoryFree(image->layer_views);
         image->layer_views = NULL;
     }
 
-    if (image->memory) {
-        vkFreeMemory(context->device->logical_device, image->memory, context->allocator);
-        image->memory = 0;
+    if (image->level_views) {
+        for(int i = 0; i < image->create_info->mipLevels; ++i) {
+            if(image->level_views[i]) {
+                 vkDestroyImageView(context->device->logical_device, 
+                                    image->level_views[i],
+                                    context->allocator);
+            }
+        }
+        yCMemoryFree(image->level_views);
+        image->level_views = NULL;
     }
+
     if (image->handle) {
         vkDestroyImage(context->device->logical_device, image->handle, context->allocator);
         image->handle = 0;
     }
+    // Aliased memory belongs to the image it was borrowed from.
+    if (!image->memory_alias) {
+        context->memory_allocator->release(context, &image->allocation);
+    }
 
     yCMemoryFreeReport(image->memory_requirements.size);
     yCMemoryZero(&image->memory_requirements);
@@ -211,7 +255,7 @@ static void transitionImageLayout(VkCommandBuffer command_buffer,
     barrier.image = image->handle;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = image->create_info->mipLevels;
     barrier.subresourceRange.baseArrayLayer = base_array_layer;
     barrier.subresourceRange.layerCount = layer_count;
     barrier.srcAccessMask = src_access_mask;
@@ -234,28 +278,31 @@ static void updatData(YsVkContext* context,
                       u32 data_size,
                       void* data,
                       YsVkImage* image) {
+    // One-time upload during initialization, the host visible buffer is copied straight into the image.
     YsVkBuffer* buffer = yVkAllocateBufferObject();
-    if (buffer->create(context,
-                       data_size,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                       buffer)){
-        buffer->indirectUpdate(context,
-                               command_unit,
-                               VK_NULL_HANDLE,
-                               0,
-                               data,
-                               buffer);
-    } else {
+    if (!buffer->create(context,
+                        data_size,
+                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        buffer)){
         YERROR("Error creating buffer.");
+        yCMemoryFree(buffer);
+        return;
     }
 
+    buffer->directUpdate(context,
+                         0,
+                         0,
+                         data,
+                         buffer);
+
     buffer->copyToImage(context,
                         command_unit,
                         VK_NULL_HANDLE,
                         image,
                         buffer);
 
+    buffer->destroy(context, buffer);
     yCMemoryFree(buffer);                  
 }
 
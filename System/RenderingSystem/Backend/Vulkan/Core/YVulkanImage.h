@@ -27,6 +27,7 @@
 
 
 #include "YVulkanTypes.h"
+#include "YVulkanMemoryAllocator.h"
 
 
 #ifdef __cplusplus
@@ -72,9 +73,17 @@ typedef struct YsVkImage {
 
     VkImage handle;
 
-    VkDeviceMemory memory;
+    YsVkMemoryAllocation allocation;
+    // Set before create, defaults to MEMORY_STRATEGY_BUDDY.
+    YeVkMemoryStrategy memory_strategy;
+    // Set before create on images whose memory other images alias.
+    b8 is_memory_shareable;
+    // Set before create to bind the image to the memory of an image that is never live in the same frame.
+    struct YsVkImage* memory_alias;
 
     VkImageView* layer_views;
+    // One view per mip level over every layer, only created for images with more than one level.
+    VkImageView* level_views;
     VkImageView image_view;
 
     VkMemoryRequirements memory_requirements;
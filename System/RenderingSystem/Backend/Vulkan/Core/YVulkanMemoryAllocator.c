@@ -0,0 +1,564 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "YVulkanMemoryAllocator.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YCMemoryManager.h"
+#include "YLogger.h"
+
+#define MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+#define MEMORY_MIN_BLOCK_SIZE (1ull * 1024 * 1024)
+#define MEMORY_MIN_BUDDY_SIZE 256ull
+
+
+static u64 alignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static b8 isHostVisible(YsVkContext* context, u32 memory_type_index) {
+    return (context->device->memory.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+static b8 deviceAllocate(YsVkContext* context,
+                         u64 size,
+                         u32 memory_type_index,
+                         VkImage dedicated_image,
+                         VkBuffer dedicated_buffer,
+                         VkDeviceMemory* out_memory) {
+    YsVkMemoryAllocator* allocator = context->memory_allocator;
+
+    VkMemoryAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    allocate_info.allocationSize = size;
+    allocate_info.memoryTypeIndex = memory_type_index;
+
+    VkMemoryDedicatedAllocateInfo dedicated_info = {VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO};
+    if(dedicated_image || dedicated_buffer) {
+        dedicated_info.image = dedicated_image;
+        dedicated_info.buffer = dedicated_buffer;
+        allocate_info.pNext = &dedicated_info;
+    }
+
+    VkResult result = vkAllocateMemory(context->device->logical_device,
+                                       &allocate_info,
+                                       context->allocator,
+                                       out_memory);
+    if (result != VK_SUCCESS) {
+        YERROR("vkAllocateMemory failed, size: %llu, memory type: %u, error: %s", size, memory_type_index, string_VkResult(result));
+        return false;
+    }
+
+    allocator->device_allocation_count++;
+    if(allocator->device_allocation_count > context->device->properties.limits.maxMemoryAllocationCount) {
+        YWARN("Device memory allocation count %u exceeds maxMemoryAllocationCount %u.",
+              allocator->device_allocation_count,
+              context->device->properties.limits.maxMemoryAllocationCount);
+    }
+
+    return true;
+}
+
+static void deviceFree(YsVkContext* context, VkDeviceMemory memory) {
+    vkFreeMemory(context->device->logical_device, memory, context->allocator);
+    context->memory_allocator->device_allocation_count--;
+}
+
+// Buddy
+static u32 buddyOrder(u64 size) {
+    u32 order = 0;
+    u64 order_size = MEMORY_MIN_BUDDY_SIZE;
+    while(order_size < size) {
+        order_size <<= 1;
+        ++order;
+    }
+    return order;
+}
+
+static void buddyPush(YsVkMemoryBlock* block, u32 order, u64 offset) {
+    if(block->free_counts[order] == block->free_capacities[order]) {
+        u32 capacity = block->free_capacities[order] ? block->free_capacities[order] * 2 : 8;
+        u64* offsets = yCMemoryAllocate(sizeof(u64) * capacity);
+        if(block->free_offsets[order]) {
+            yCMemoryCopy(offsets, block->free_offsets[order], sizeof(u64) * block->free_counts[order]);
+            yCMemoryFree(block->free_offsets[order]);
+        }
+        block->free_offsets[order] = offsets;
+        block->free_capacities[order] = capacity;
+    }
+    block->free_offsets[order][block->free_counts[order]++] = offset;
+}
+
+static b8 buddyRemove(YsVkMemoryBlock* block, u32 order, u64 offset) {
+    for(u32 i = 0; i < block->free_counts[order]; ++i) {
+        if(block->free_offsets[order][i] == offset) {
+            block->free_offsets[order][i] = block->free_offsets[order][--block->free_counts[order]];
+            return true;
+        }
+    }
+    return false;
+}
+
+static b8 buddyAllocate(YsVkMemoryBlock* block, u32 order, u64* out_offset) {
+    u32 free_order = order;
+    while(free_order < block->order_count && 0 == block->free_counts[free_order]) {
+        ++free_order;
+    }
+    if(free_order >= block->order_count) {
+        return false;
+    }
+
+    u64 offset = block->free_offsets[free_order][--block->free_counts[free_order]];
+    // Split down to the requested order, the upper halves go back to the free lists.
+    while(free_order > order) {
+        --free_order;
+        buddyPush(block, free_order, offset + (MEMORY_MIN_BUDDY_SIZE << free_order));
+    }
+
+    *out_offset = offset;
+    return true;
+}
+
+static void buddyFree(YsVkMemoryBlock* block, u32 order, u64 offset) {
+    while(order + 1 < block->order_count) {
+        u64 buddy_offset = offset ^ (MEMORY_MIN_BUDDY_SIZE << order);
+        if(!buddyRemove(block, order, buddy_offset)) {
+            break;
+        }
+        offset = offset < buddy_offset ? offset : buddy_offset;
+        ++order;
+    }
+    buddyPush(block, order, offset);
+}
+
+// Linear
+static b8 linearAllocate(YsVkMemoryBlock* block, u64 size, u64 alignment, u64* out_offset) {
+    u64 offset = alignUp(block->linear_head, alignment);
+    if(offset + size > block->size) {
+        return false;
+    }
+    block->linear_head = offset + size;
+    *out_offset = offset;
+    return true;
+}
+
+// Block
+static YsVkMemoryBlock* createBlock(YsVkContext* context, YsVkMemoryPool* pool) {
+    VkDeviceMemory memory;
+    if(!deviceAllocate(context, pool->block_size, pool->memory_type_index, VK_NULL_HANDLE, VK_NULL_HANDLE, &memory)) {
+        return NULL;
+    }
+
+    YsVkMemoryBlock* block = yCMemoryAllocate(sizeof(YsVkMemoryBlock));
+    block->memory = memory;
+    block->size = pool->block_size;
+    if(isHostVisible(context, pool->memory_type_index)) {
+        VK_CHECK(vkMapMemory(context->device->logical_device,
+                             block->memory,
+                             0,
+                             VK_WHOLE_SIZE,
+                             0,
+                             (void**)&block->mapped_data));
+    }
+
+    if(MEMORY_STRATEGY_BUDDY == pool->strategy) {
+        block->order_count = buddyOrder(block->size) + 1;
+        block->free_counts = yCMemoryAllocate(sizeof(u32) * block->order_count);
+        block->free_capacities = yCMemoryAllocate(sizeof(u32) * block->order_count);
+        block->free_offsets = yCMemoryAllocate(sizeof(u64*) * block->order_count);
+        buddyPush(block, block->order_count - 1, 0);
+    }
+
+    if(pool->block_count == pool->block_capacity) {
+        u32 capacity = pool->block_capacity ? pool->block_capacity * 2 : 4;
+        YsVkMemoryBlock** blocks = yCMemoryAllocate(sizeof(YsVkMemoryBlock*) * capacity);
+        if(pool->blocks) {
+            yCMemoryCopy(blocks, pool->blocks, sizeof(YsVkMemoryBlock*) * pool->block_count);
+            yCMemoryFree(pool->blocks);
+        }
+        pool->blocks = blocks;
+        pool->block_capacity = capacity;
+    }
+    pool->blocks[pool->block_count++] = block;
+
+    YINFO("Vulkan memory block allocated, memory type: %u, size: %llu, blocks in pool: %u.",
+          pool->memory_type_index,
+          pool->block_size,
+          pool->block_count);
+
+    return block;
+}
+
+static void destroyBlock(YsVkContext* context, YsVkMemoryBlock* block) {
+    // Freeing the memory implicitly unmaps it.
+    deviceFree(context, block->memory);
+    for(u32 i = 0; i < block->order_count; ++i) {
+        if(block->free_offsets[i]) {
+            yCMemoryFree(block->free_offsets[i]);
+        }
+    }
+    if(block->order_count) {
+        yCMemoryFree(block->free_counts);
+        yCMemoryFree(block->free_capacities);
+        yCMemoryFree(block->free_offsets);
+    }
+    yCMemoryFree(block);
+}
+
+static b8 blockAllocate(YsVkMemoryPool* pool,
+                        YsVkMemoryBlock* block,
+                        u64 size,
+                        u64 alignment,
+                        u32 order,
+                        u64* out_offset) {
+    if(MEMORY_STRATEGY_BUDDY == pool->strategy) {
+        return buddyAllocate(block, order, out_offset);
+    }
+    return linearAllocate(block, size, alignment, out_offset);
+}
+
+// Pool
+static YsVkMemoryPool* acquirePool(YsVkMemoryAllocator* allocator,
+                                   u32 memory_type_index,
+                                   YeVkMemoryResourceKind resource_kind,
+                                   YeVkMemoryStrategy strategy) {
+    YsVkMemoryPool* pool = allocator->pools[memory_type_index][resource_kind][strategy];
+    if(!pool) {
+        pool = yCMemoryAllocate(sizeof(YsVkMemoryPool));
+        pool->memory_type_index = memory_type_index;
+        pool->resource_kind = resource_kind;
+        pool->strategy = strategy;
+        pool->block_size = allocator->block_sizes[memory_type_index];
+        allocator->pools[memory_type_index][resource_kind][strategy] = pool;
+    }
+    return pool;
+}
+
+static b8 poolAllocate(YsVkContext* context,
+                       YsVkMemoryPool* pool,
+                       u64 size,
+                       u64 alignment,
+                       YsVkMemoryAllocation* out_allocation) {
+    // Buddy ranges are aligned to their own size, so the order also covers the alignment.
+    u32 order = 0;
+    u64 allocation_size = size;
+    if(MEMORY_STRATEGY_BUDDY == pool->strategy) {
+        order = buddyOrder(size > alignment ? size : alignment);
+        allocation_size = MEMORY_MIN_BUDDY_SIZE << order;
+    }
+
+    u64 offset = 0;
+    YsVkMemoryBlock* block = NULL;
+    for(u32 i = 0; i < pool->block_count; ++i) {
+        if(blockAllocate(pool, pool->blocks[i], size, alignment, order, &offset)) {
+            block = pool->blocks[i];
+            break;
+        }
+    }
+
+    if(!block) {
+        block = createBlock(context, pool);
+        if(!block || !blockAllocate(pool, block, size, alignment, order, &offset)) {
+            YERROR("Unable to suballocate %llu bytes from memory type %u.", size, pool->memory_type_index);
+            return false;
+        }
+    }
+
+    block->used_size += allocation_size;
+    block->allocation_count++;
+
+    out_allocation->memory = block->memory;
+    out_allocation->offset = offset;
+    out_allocation->size = allocation_size;
+    out_allocation->mapped_data = block->mapped_data ? block->mapped_data + offset : NULL;
+    out_allocation->pool = pool;
+    out_allocation->block = block;
+    out_allocation->buddy_order = order;
+
+    return true;
+}
+
+static void poolFree(YsVkContext* context, YsVkMemoryAllocation* allocation) {
+    YsVkMemoryPool* pool = allocation->pool;
+    YsVkMemoryBlock* block = allocation->block;
+
+    block->used_size -= allocation->size;
+    block->allocation_count--;
+    if(MEMORY_STRATEGY_BUDDY == pool->strategy) {
+        buddyFree(block, allocation->buddy_order, allocation->offset);
+    } else if(0 == block->allocation_count) {
+        block->linear_head = 0;
+    }
+
+    // Keep one empty block around so a pool that is repeatedly emptied does not thrash vkAllocateMemory.
+    if(0 == block->allocation_count && pool->block_count > 1) {
+        for(u32 i = 0; i < pool->block_count; ++i) {
+            if(pool->blocks[i] == block) {
+                pool->blocks[i] = pool->blocks[--pool->block_count];
+                break;
+            }
+        }
+        destroyBlock(context, block);
+    }
+}
+
+//
+static b8 allocateMemory(YsVkContext* context,
+                         const VkMemoryRequirements* requirements,
+                         VkMemoryPropertyFlags property_flags,
+                         YeVkMemoryStrategy strategy,
+                         YeVkMemoryResourceKind resource_kind,
+                         b8 dedicated,
+                         VkImage dedicated_image,
+                         VkBuffer dedicated_buffer,
+                         YsVkMemoryAllocation* out_allocation) {
+    YsVkMemoryAllocator* allocator = context->memory_allocator;
+    *out_allocation = (YsVkMemoryAllocation){0};
+
+    i32 memory_type_index = context->find_memory_index(requirements->memoryTypeBits, property_flags, context);
+    if (memory_type_index == -1) {
+        YERROR("Required memory type not found.");
+        return false;
+    }
+    out_allocation->memory_type_index = (u32)memory_type_index;
+
+    if(!dedicated) {
+        YsVkMemoryPool* pool = acquirePool(allocator, (u32)memory_type_index, resource_kind, strategy);
+        return poolAllocate(context,
+                            pool,
+                            requirements->size,
+                            requirements->alignment,
+                            out_allocation);
+    }
+
+    if(!deviceAllocate(context,
+                       requirements->size,
+                       (u32)memory_type_index,
+                       dedicated_image,
+                       dedicated_buffer,
+                       &out_allocation->memory)) {
+        return false;
+    }
+    out_allocation->offset = 0;
+    out_allocation->size = requirements->size;
+    if(isHostVisible(context, (u32)memory_type_index)) {
+        VK_CHECK(vkMapMemory(context->device->logical_device,
+                             out_allocation->memory,
+                             0,
+                             VK_WHOLE_SIZE,
+                             0,
+                             &out_allocation->mapped_data));
+    }
+
+    allocator->dedicated_allocation_count++;
+    allocator->dedicated_allocation_size += requirements->size;
+
+    return true;
+}
+
+static b8 allocateBuffer(YsVkContext* context,
+                         VkBuffer buffer,
+                         VkMemoryPropertyFlags property_flags,
+                         YeVkMemoryStrategy strategy,
+                         YsVkMemoryAllocation* out_allocation) {
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(context->device->logical_device, buffer, &requirements);
+
+    // A buffer larger than half a block would leave most of it unusable, give it its own memory.
+    i32 memory_type_index = context->find_memory_index(requirements.memoryTypeBits, property_flags, context);
+    b8 dedicated = memory_type_index != -1 &&
+                   requirements.size > context->memory_allocator->block_sizes[memory_type_index] / 2;
+
+    if(!allocateMemory(context,
+                       &requirements,
+                       property_flags,
+                       strategy,
+                       MEMORY_RESOURCE_BUFFER,
+                       dedicated,
+                       VK_NULL_HANDLE,
+                       dedicated ? buffer : VK_NULL_HANDLE,
+                       out_allocation)) {
+        return false;
+    }
+
+    VK_CHECK(vkBindBufferMemory(context->device->logical_device,
+                                buffer,
+                                out_allocation->memory,
+                                out_allocation->offset));
+    return true;
+}
+
+static b8 allocateImage(YsVkContext* context,
+                        VkImage image,
+                        VkMemoryPropertyFlags property_flags,
+                        YeVkMemoryStrategy strategy,
+                        b8 shareable,
+                        YsVkMemoryAllocation* out_allocation) {
+    VkMemoryDedicatedRequirements dedicated_requirements = {VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS};
+    VkMemoryRequirements2 requirements = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+    requirements.pNext = &dedicated_requirements;
+    VkImageMemoryRequirementsInfo2 requirements_info = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2};
+    requirements_info.image = image;
+    vkGetImageMemoryRequirements2(context->device->logical_device, &requirements_info, &requirements);
+
+    // Render targets are large and long lived, they gain nothing from sharing a block.
+    i32 memory_type_index = context->find_memory_index(requirements.memoryRequirements.memoryTypeBits, property_flags, context);
+    b8 dedicated = dedicated_requirements.prefersDedicatedAllocation ||
+                   dedicated_requirements.requiresDedicatedAllocation ||
+                   (memory_type_index != -1 &&
+                    requirements.memoryRequirements.size >= context->memory_allocator->block_sizes[memory_type_index] / 4);
+    // Memory other images alias is only tied to this image when the driver insists on it.
+    b8 tie_to_image = dedicated && (!shareable || dedicated_requirements.requiresDedicatedAllocation);
+
+    if(!allocateMemory(context,
+                       &requirements.memoryRequirements,
+                       property_flags,
+                       strategy,
+                       MEMORY_RESOURCE_IMAGE,
+                       dedicated,
+                       tie_to_image ? image : VK_NULL_HANDLE,
+                       VK_NULL_HANDLE,
+                       out_allocation)) {
+        return false;
+    }
+    out_allocation->is_shareable = !tie_to_image;
+
+    VK_CHECK(vkBindImageMemory(context->device->logical_device,
+                               image,
+                               out_allocation->memory,
+                               out_allocation->offset));
+    return true;
+}
+
+static void release(YsVkContext* context, YsVkMemoryAllocation* allocation) {
+    if(!allocation->memory) {
+        return;
+    }
+
+    if(allocation->pool) {
+        poolFree(context, allocation);
+    } else {
+        deviceFree(context, allocation->memory);
+        context->memory_allocator->dedicated_allocation_count--;
+        context->memory_allocator->dedicated_allocation_size -= allocation->size;
+    }
+
+    *allocation = (YsVkMemoryAllocation){0};
+}
+
+static u32 queryPoolStatistics(YsVkMemoryAllocator* allocator,
+                               u32 max_statistics_count,
+                               YsVkMemoryPoolStatistics* out_statistics) {
+    u32 statistics_count = 0;
+    for(u32 type = 0; type < VK_MAX_MEMORY_TYPES; ++type) {
+        for(u32 kind = 0; kind < MEMORY_RESOURCE_COUNT; ++kind) {
+            for(u32 strategy = 0; strategy < MEMORY_STRATEGY_COUNT; ++strategy) {
+                YsVkMemoryPool* pool = allocator->pools[type][kind][strategy];
+                if(!pool || statistics_count >= max_statistics_count) {
+                    continue;
+                }
+
+                YsVkMemoryPoolStatistics* statistics = &out_statistics[statistics_count++];
+                *statistics = (YsVkMemoryPoolStatistics){0};
+                statistics->memory_type_index = pool->memory_type_index;
+                statistics->strategy = pool->strategy;
+                statistics->resource_kind = pool->resource_kind;
+                statistics->block_count = pool->block_count;
+                for(u32 i = 0; i < pool->block_count; ++i) {
+                    YsVkMemoryBlock* block = pool->blocks[i];
+                    statistics->allocation_count += block->allocation_count;
+                    statistics->reserved_size += block->size;
+                    statistics->used_size += block->used_size;
+
+                    u64 largest_free_size = 0;
+                    if(MEMORY_STRATEGY_BUDDY == pool->strategy) {
+                        for(u32 order = block->order_count; order > 0; --order) {
+                            if(block->free_counts[order - 1] > 0) {
+                                largest_free_size = MEMORY_MIN_BUDDY_SIZE << (order - 1);
+                                break;
+                            }
+                        }
+                    } else {
+                        largest_free_size = block->size - block->linear_head;
+                    }
+                    if(largest_free_size > statistics->largest_free_size) {
+                        statistics->largest_free_size = largest_free_size;
+                    }
+                }
+
+                u64 free_size = statistics->reserved_size - statistics->used_size;
+                statistics->fragmentation = free_size > 0 ? 1.0f - (f32)statistics->largest_free_size / (f32)free_size : 0.0f;
+            }
+        }
+    }
+    return statistics_count;
+}
+
+static b8 create(YsVkContext* context, YsVkMemoryAllocator* allocator) {
+    // Blocks are a power of two for the buddy strategy and never take more than an eighth of their heap.
+    VkPhysicalDeviceMemoryProperties* memory = &context->device->memory;
+    for(u32 i = 0; i < memory->memoryTypeCount; ++i) {
+        u64 heap_size = memory->memoryHeaps[memory->memoryTypes[i].heapIndex].size;
+        u64 block_size = MEMORY_BLOCK_SIZE;
+        while(block_size > MEMORY_MIN_BLOCK_SIZE && block_size > heap_size / 8) {
+            block_size >>= 1;
+        }
+        allocator->block_sizes[i] = block_size;
+    }
+    return true;
+}
+
+static void destroy(YsVkContext* context, YsVkMemoryAllocator* allocator) {
+    for(u32 type = 0; type < VK_MAX_MEMORY_TYPES; ++type) {
+        for(u32 kind = 0; kind < MEMORY_RESOURCE_COUNT; ++kind) {
+            for(u32 strategy = 0; strategy < MEMORY_STRATEGY_COUNT; ++strategy) {
+                YsVkMemoryPool* pool = allocator->pools[type][kind][strategy];
+                if(!pool) {
+                    continue;
+                }
+                for(u32 i = 0; i < pool->block_count; ++i) {
+                    destroyBlock(context, pool->blocks[i]);
+                }
+                if(pool->blocks) {
+                    yCMemoryFree(pool->blocks);
+                }
+                yCMemoryFree(pool);
+                allocator->pools[type][kind][strategy] = NULL;
+            }
+        }
+    }
+}
+
+YsVkMemoryAllocator* yVkAllocateMemoryAllocatorObject() {
+    YsVkMemoryAllocator* allocator = yCMemoryAllocate(sizeof(YsVkMemoryAllocator));
+    if(allocator) {
+        allocator->create = create;
+        allocator->destroy = destroy;
+        allocator->allocateBuffer = allocateBuffer;
+        allocator->allocateImage = allocateImage;
+        allocator->release = release;
+        allocator->queryPoolStatistics = queryPoolStatistics;
+    }
+    return allocator;
+}
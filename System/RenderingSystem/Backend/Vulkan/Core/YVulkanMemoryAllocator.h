@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CGPPY_YVULKANMEMORYALLOCATOR_H
+#define CGPPY_YVULKANMEMORYALLOCATOR_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef enum YeVkMemoryStrategy {
+    // Power of two blocks that split and merge, for resources with independent lifetimes.
+    MEMORY_STRATEGY_BUDDY = 0,
+    // Bump allocation, a block is only reused once all of its allocations are freed.
+    MEMORY_STRATEGY_LINEAR,
+    MEMORY_STRATEGY_COUNT
+} YeVkMemoryStrategy;
+
+// Buffers and optimal tiled images live in separate pools so bufferImageGranularity never applies.
+typedef enum YeVkMemoryResourceKind {
+    MEMORY_RESOURCE_BUFFER = 0,
+    MEMORY_RESOURCE_IMAGE,
+    MEMORY_RESOURCE_COUNT
+} YeVkMemoryResourceKind;
+
+typedef struct YsVkMemoryBlock {
+    VkDeviceMemory memory;
+    u8* mapped_data;
+    u64 size;
+    u64 used_size;
+    u32 allocation_count;
+
+    // Linear
+    u64 linear_head;
+
+    // Buddy, free offsets per order, order 0 is the minimum buddy size.
+    u32 order_count;
+    u32* free_counts;
+    u32* free_capacities;
+    u64** free_offsets;
+} YsVkMemoryBlock;
+
+typedef struct YsVkMemoryPool {
+    u32 memory_type_index;
+    YeVkMemoryStrategy strategy;
+    YeVkMemoryResourceKind resource_kind;
+    u64 block_size;
+
+    u32 block_count;
+    u32 block_capacity;
+    YsVkMemoryBlock** blocks;
+} YsVkMemoryPool;
+
+typedef struct YsVkMemoryAllocation {
+    VkDeviceMemory memory;
+    u64 offset;
+    u64 size;
+    u32 memory_type_index;
+    // Only set for host visible memory, blocks stay mapped for their whole lifetime.
+    void* mapped_data;
+
+    // False when the memory is dedicated to one image, no other image may be bound to it.
+    b8 is_shareable;
+
+    // NULL for dedicated allocations.
+    YsVkMemoryPool* pool;
+    YsVkMemoryBlock* block;
+    u32 buddy_order;
+} YsVkMemoryAllocation;
+
+typedef struct YsVkMemoryPoolStatistics {
+    u32 memory_type_index;
+    YeVkMemoryStrategy strategy;
+    YeVkMemoryResourceKind resource_kind;
+    u32 block_count;
+    u32 allocation_count;
+    u64 reserved_size;
+    u64 used_size;
+    u64 largest_free_size;
+    // 0 when all free space is contiguous, approaching 1 as it scatters into small ranges.
+    f32 fragmentation;
+} YsVkMemoryPoolStatistics;
+
+typedef struct YsVkMemoryAllocator {
+    b8 (*create)(struct YsVkContext* context, struct YsVkMemoryAllocator* allocator);
+
+    void (*destroy)(struct YsVkContext* context, struct YsVkMemoryAllocator* allocator);
+
+    // Allocates and binds memory for the buffer.
+    b8 (*allocateBuffer)(struct YsVkContext* context,
+                         VkBuffer buffer,
+                         VkMemoryPropertyFlags property_flags,
+                         YeVkMemoryStrategy strategy,
+                         YsVkMemoryAllocation* out_allocation);
+
+    // Allocates and binds memory for the image, large images get a dedicated allocation. Shareable memory is
+    // not tied to the image handle so images that are never live at the same time can be bound to it too.
+    b8 (*allocateImage)(struct YsVkContext* context,
+                        VkImage image,
+                        VkMemoryPropertyFlags property_flags,
+                        YeVkMemoryStrategy strategy,
+                        b8 shareable,
+                        YsVkMemoryAllocation* out_allocation);
+
+    void (*release)(struct YsVkContext* context, YsVkMemoryAllocation* allocation);
+
+    u32 (*queryPoolStatistics)(struct YsVkMemoryAllocator* allocator,
+                               u32 max_statistics_count,
+                               YsVkMemoryPoolStatistics* out_statistics);
+
+    YsVkMemoryPool* pools[VK_MAX_MEMORY_TYPES][MEMORY_RESOURCE_COUNT][MEMORY_STRATEGY_COUNT];
+    u64 block_sizes[VK_MAX_MEMORY_TYPES];
+
+    u32 device_allocation_count;
+    u32 dedicated_allocation_count;
+    u64 dedicated_allocation_size;
+} YsVkMemoryAllocator;
+
+YsVkMemoryAllocator* yVkAllocateMemoryAllocatorObject();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CGPPY_YVULKANMEMORYALLOCATOR_H
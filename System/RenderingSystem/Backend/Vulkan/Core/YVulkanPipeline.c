@@ -26,6 +26,7 @@
 #include "YVulkanContext.h"
 #include "YCMemoryManager.h"
 #include "YLogger.h"
+#include "GLFW/glfw3.h"
 
 
 static b8 createShaderModule(YsVkContext* context,
@@ -96,12 +97,15 @@ static b8 create(YsVkContext* context,
     for(int i = 0; i < context->device->properties.limits.maxBoundDescriptorSets; ++i) {
         set_layouts[i] = empty_layout; 
     }
+    // Only sets up to the highest one bound are declared, with the global set alone that is a single layout.
+    u32 set_layout_count = 0;
     for(int i = 0; i < config->descriptor_count; ++i) {
         set_layouts[config->descriptors[i].set] = config->descriptors[i].descriptor_set_layout;
+        set_layout_count = config->descriptors[i].set + 1 > set_layout_count ? config->descriptors[i].set + 1 : set_layout_count;
     }
 
     VkPipelineLayoutCreateInfo pipeline_layout_create_info = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-    pipeline_layout_create_info.setLayoutCount = context->device->properties.limits.maxBoundDescriptorSets;
+    pipeline_layout_create_info.setLayoutCount = set_layout_count;
     pipeline_layout_create_info.pSetLayouts = set_layouts;
     pipeline_layout_create_info.pushConstantRangeCount = config->push_constant_range_count;
     pipeline_layout_create_info.pPushConstantRanges = config->push_constant_range;
@@ -202,12 +206,14 @@ static b8 create(YsVkContext* context,
             pipeline_create_info.layout = out_pipeline->pipeline_layout;
             pipeline_create_info.renderPass = config->render_stage->render_pass_handle;
             pipeline_create_info.subpass = 0;
+            f64 begin_time = glfwGetTime();
             VkResult result = vkCreateGraphicsPipelines(context->device->logical_device,
-                                                        VK_NULL_HANDLE,
+                                                        context->pipeline_cache,
                                                         1,
                                                         &pipeline_create_info,
                                                         context->allocator,
                                                         &out_pipeline->handle);
+            context->pipeline_creation_time += (glfwGetTime() - begin_time) * 1000.0;
 
             if (VK_SUCCESS != result) {
                 YERROR("vkCreateGraphicsPipelines failed with %s.", string_VkResult(result));
@@ -220,14 +226,17 @@ static b8 create(YsVkContext* context,
         }
         case VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO: {
             VkComputePipelineCreateInfo pipeline_create_info = {config->pipeline_type};
+            pipeline_create_info.flags = config->create_flags;
             pipeline_create_info.stage = shader_stage_create_info[0];
             pipeline_create_info.layout = out_pipeline->pipeline_layout;
+            f64 begin_time = glfwGetTime();
             VkResult result = vkCreateComputePipelines(context->device->logical_device,
-                                                       VK_NULL_HANDLE,
+                                                       context->pipeline_cache,
                                                        1,
                                                        &pipeline_create_info,
                                                        context->allocator,
                                                        &out_pipeline->handle);
+            context->pipeline_creation_time += (glfwGetTime() - begin_time) * 1000.0;
             if (VK_SUCCESS != result) {
                 YERROR("vkCreateComputePipelines failed with %s.", string_VkResult(result));
                 return false;
@@ -0,0 +1,337 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "YVulkanRenderGraph.h"
+#include "YVulkanImage.h"
+#include "YCMemoryManager.h"
+#include "YLogger.h"
+
+
+static u32 addImage(YsVkRenderGraph* graph, const char* name, b8 is_transient) {
+    if(graph->image_count == RENDER_GRAPH_MAX_IMAGE_COUNT) {
+        YERROR("Render graph image limit reached, image: %s.", name);
+        return RENDER_GRAPH_NONE;
+    }
+
+    YsVkRenderGraphImage* image = &graph->images[graph->image_count];
+    image->name = name;
+    image->is_transient = is_transient;
+    image->alias_of = RENDER_GRAPH_NONE;
+    return graph->image_count++;
+}
+
+static void bindImage(YsVkRenderGraph* graph,
+                      u32 image_index,
+                      YsVkImage* image,
+                      VkImageAspectFlags aspect_mask,
+                      VkImageLayout initial_layout) {
+    YsVkRenderGraphImage* graph_image = &graph->images[image_index];
+    graph_image->image = image;
+    graph_image->aspect_mask = aspect_mask;
+    graph_image->layer_count = image->create_info->arrayLayers;
+    // Rebinding a recreated image starts over from its initial layout.
+    if(graph_image->layer_states) {
+        yCMemoryFree(graph_image->layer_states);
+    }
+    graph_image->layer_states = yCMemoryAllocate(sizeof(YsVkRenderGraphLayerState) * graph_image->layer_count);
+    for(u32 i = 0; i < graph_image->layer_count; ++i) {
+        graph_image->layer_states[i].layout = initial_layout;
+    }
+}
+
+static void reset(YsVkRenderGraph* graph) {
+    graph->pass_count = 0;
+}
+
+static u32 addPass(YsVkRenderGraph* graph,
+                   const char* name,
+                   b8 has_side_effects,
+                   void (*record)(VkCommandBuffer command_buffer, void* user_data),
+                   void* user_data) {
+    if(graph->pass_count == RENDER_GRAPH_MAX_PASS_COUNT) {
+        YERROR("Render graph pass limit reached, pass: %s.", name);
+        return RENDER_GRAPH_NONE;
+    }
+
+    YsVkRenderGraphPass* pass = &graph->passes[graph->pass_count];
+    *pass = (YsVkRenderGraphPass){0};
+    pass->name = name;
+    pass->has_side_effects = has_side_effects;
+    pass->record = record;
+    pass->user_data = user_data;
+    return graph->pass_count++;
+}
+
+static void addAccess(YsVkRenderGraph* graph,
+                      u32 pass_index,
+                      u32 image_index,
+                      u32 layer,
+                      u32 flags,
+                      VkImageLayout layout,
+                      VkImageLayout final_layout,
+                      VkPipelineStageFlags stage_mask,
+                      VkAccessFlags access_mask) {
+    YsVkRenderGraphPass* pass = &graph->passes[pass_index];
+    if(pass->access_count == RENDER_GRAPH_MAX_PASS_ACCESS_COUNT) {
+        YERROR("Render graph access limit reached, pass: %s.", pass->name);
+        return;
+    }
+
+    YsVkRenderGraphAccess* access = &pass->accesses[pass->access_count++];
+    access->image = image_index;
+    access->layer = layer;
+    access->flags = flags;
+    access->layout = layout;
+    access->final_layout = final_layout;
+    access->stage_mask = stage_mask;
+    access->access_mask = access_mask;
+}
+
+static b8 passWrites(YsVkRenderGraphPass* pass, u32 image_index, u32 layer) {
+    for(u32 i = 0; i < pass->access_count; ++i) {
+        if((pass->accesses[i].flags & RENDER_GRAPH_ACCESS_WRITE) &&
+           pass->accesses[i].image == image_index &&
+           pass->accesses[i].layer == layer) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void compile(YsVkRenderGraph* graph) {
+    for(u32 i = 0; i < graph->pass_count; ++i) {
+        graph->passes[i].is_live = graph->passes[i].has_side_effects;
+    }
+
+    // Walking backwards, every read of a live pass keeps the latest earlier writer of that layer alive.
+    for(i32 i = (i32)graph->pass_count - 1; i >= 0; --i) {
+        YsVkRenderGraphPass* pass = &graph->passes[i];
+        if(!pass->is_live) {
+            continue;
+        }
+
+        for(u32 a = 0; a < pass->access_count; ++a) {
+            YsVkRenderGraphAccess* access = &pass->accesses[a];
+            if(!(access->flags & RENDER_GRAPH_ACCESS_READ)) {
+                continue;
+            }
+
+            for(i32 w = i - 1; w >= 0; --w) {
+                if(passWrites(&graph->passes[w], access->image, access->layer)) {
+                    graph->passes[w].is_live = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    graph->culled_pass_count = 0;
+    for(u32 i = 0; i < graph->pass_count; ++i) {
+        if(!graph->passes[i].is_live) {
+            graph->culled_pass_count++;
+        }
+    }
+}
+
+static void planConfiguration(YsVkRenderGraph* graph, u32 configuration) {
+    for(u32 i = 0; i < graph->pass_count; ++i) {
+        if(!graph->passes[i].is_live) {
+            continue;
+        }
+        for(u32 a = 0; a < graph->passes[i].access_count; ++a) {
+            graph->images[graph->passes[i].accesses[a].image].configuration_mask |= 1u << configuration;
+        }
+    }
+}
+
+static void planAliases(YsVkRenderGraph* graph) {
+    // Greedy in registration order, so the image that owns the memory is always created before its aliases.
+    for(u32 i = 0; i < graph->image_count; ++i) {
+        YsVkRenderGraphImage* image = &graph->images[i];
+        if(!image->is_transient || 0 == image->configuration_mask) {
+            continue;
+        }
+
+        for(u32 j = 0; j < i; ++j) {
+            YsVkRenderGraphImage* owner = &graph->images[j];
+            if(!owner->is_transient || RENDER_GRAPH_NONE != owner->alias_of) {
+                continue;
+            }
+
+            u32 group_mask = owner->configuration_mask;
+            for(u32 k = j + 1; k < i; ++k) {
+                if(graph->images[k].alias_of == j) {
+                    group_mask |= graph->images[k].configuration_mask;
+                }
+            }
+            if(0 == (group_mask & image->configuration_mask)) {
+                image->alias_of = j;
+                owner->has_aliases = true;
+                YINFO("Render graph image %s aliases the memory of %s.", image->name, owner->name);
+                break;
+            }
+        }
+    }
+}
+
+static void invalidateAliasedImages(YsVkRenderGraph* graph) {
+    for(u32 i = 0; i < graph->image_count; ++i) {
+        YsVkRenderGraphImage* image = &graph->images[i];
+        if(RENDER_GRAPH_NONE == image->alias_of && !image->has_aliases) {
+            continue;
+        }
+        for(u32 l = 0; l < image->layer_count; ++l) {
+            image->layer_states[l] = (YsVkRenderGraphLayerState){0};
+        }
+    }
+}
+
+static void execute(YsVkRenderGraph* graph) {
+    graph->barrier_count = 0;
+
+    for(u32 i = 0; i < graph->pass_count; ++i) {
+        YsVkRenderGraphPass* pass = &graph->passes[i];
+        if(!pass->is_live) {
+            continue;
+        }
+
+        VkImageMemoryBarrier barriers[RENDER_GRAPH_MAX_PASS_ACCESS_COUNT];
+        u32 barrier_count = 0;
+        VkPipelineStageFlags src_stage_mask = 0;
+        VkPipelineStageFlags dst_stage_mask = 0;
+
+        for(u32 a = 0; a < pass->access_count; ++a) {
+            YsVkRenderGraphAccess* access = &pass->accesses[a];
+            if(access->flags & RENDER_GRAPH_ACCESS_EXTERNAL) {
+                continue;
+            }
+
+            YsVkRenderGraphImage* image = &graph->images[access->image];
+            YsVkRenderGraphLayerState* state = &image->layer_states[access->layer];
+
+            // Layout changes and writes wait for every earlier access, reads only for a write they can not see yet.
+            b8 need_barrier = false;
+            VkPipelineStageFlags barrier_src_stage_mask = 0;
+            if(access->layout != state->layout || (access->flags & RENDER_GRAPH_ACCESS_WRITE)) {
+                barrier_src_stage_mask = state->write_stage_mask | state->read_stage_mask;
+                need_barrier = access->layout != state->layout || barrier_src_stage_mask != 0;
+            } else if(state->write_stage_mask) {
+                barrier_src_stage_mask = state->write_stage_mask;
+                need_barrier = (access->stage_mask & ~state->read_stage_mask) != 0 ||
+                               (access->access_mask & ~state->visible_access_mask) != 0;
+            }
+            if(!need_barrier) {
+                continue;
+            }
+
+            // A layer read and written by the same pass gets a single barrier.
+            VkImageMemoryBarrier* barrier = NULL;
+            for(u32 b = 0; b < barrier_count; ++b) {
+                if(barriers[b].image == image->image->handle && barriers[b].subresourceRange.baseArrayLayer == access->layer) {
+                    barrier = &barriers[b];
+                }
+            }
+            if(!barrier) {
+                barrier = &barriers[barrier_count++];
+                *barrier = (VkImageMemoryBarrier){VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+                barrier->oldLayout = (access->flags & RENDER_GRAPH_ACCESS_DISCARD) ? VK_IMAGE_LAYOUT_UNDEFINED : state->layout;
+                barrier->newLayout = access->layout;
+                barrier->srcAccessMask = state->write_access_mask;
+                barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier->image = image->image->handle;
+                barrier->subresourceRange.aspectMask = image->aspect_mask;
+                barrier->subresourceRange.baseMipLevel = 0;
+                barrier->subresourceRange.levelCount = image->image->create_info->mipLevels;
+                barrier->subresourceRange.baseArrayLayer = access->layer;
+                barrier->subresourceRange.layerCount = 1;
+            }
+            barrier->dstAccessMask |= access->access_mask;
+
+            src_stage_mask |= barrier_src_stage_mask ? barrier_src_stage_mask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            dst_stage_mask |= access->stage_mask;
+        }
+
+        if(barrier_count > 0) {
+            vkCmdPipelineBarrier(pass->command_buffer,
+                                 src_stage_mask,
+                                 dst_stage_mask,
+                                 0,
+                                 0,
+                                 NULL,
+                                 0,
+                                 NULL,
+                                 barrier_count,
+                                 barriers);
+            graph->barrier_count += barrier_count;
+        }
+
+        // The states only advance after the pass is recorded, so imageLayout still returns the layout it starts from.
+        pass->record(pass->command_buffer, pass->user_data);
+
+        for(u32 a = 0; a < pass->access_count; ++a) {
+            YsVkRenderGraphAccess* access = &pass->accesses[a];
+            YsVkRenderGraphLayerState* state = &graph->images[access->image].layer_states[access->layer];
+            if(!(access->flags & RENDER_GRAPH_ACCESS_WRITE)) {
+                state->read_stage_mask |= access->stage_mask;
+                state->visible_access_mask |= access->access_mask;
+            } else if(access->flags & RENDER_GRAPH_ACCESS_EXTERNAL) {
+                // The pass already made its write visible to the declared stages.
+                state->write_stage_mask = 0;
+                state->write_access_mask = 0;
+                state->read_stage_mask = access->stage_mask;
+                state->visible_access_mask = access->access_mask;
+            } else {
+                state->write_stage_mask = access->stage_mask;
+                state->write_access_mask = access->access_mask;
+                state->read_stage_mask = 0;
+                state->visible_access_mask = 0;
+            }
+            state->layout = access->final_layout;
+        }
+    }
+}
+
+static VkImageLayout imageLayout(YsVkRenderGraph* graph, u32 image_index, u32 layer) {
+    return graph->images[image_index].layer_states[layer].layout;
+}
+
+YsVkRenderGraph* yVkAllocateRenderGraphObject() {
+    YsVkRenderGraph* render_graph = yCMemoryAllocate(sizeof(YsVkRenderGraph));
+    if(render_graph) {
+        render_graph->addImage = addImage;
+        render_graph->bindImage = bindImage;
+        render_graph->reset = reset;
+        render_graph->addPass = addPass;
+        render_graph->addAccess = addAccess;
+        render_graph->compile = compile;
+        render_graph->planConfiguration = planConfiguration;
+        render_graph->planAliases = planAliases;
+        render_graph->invalidateAliasedImages = invalidateAliasedImages;
+        render_graph->execute = execute;
+        render_graph->imageLayout = imageLayout;
+    }
+    return render_graph;
+}
@@ -0,0 +1,174 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CGPPY_YVULKANRENDERGRAPH_H
+#define CGPPY_YVULKANRENDERGRAPH_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define RENDER_GRAPH_MAX_IMAGE_COUNT 16
+#define RENDER_GRAPH_MAX_PASS_COUNT 16
+#define RENDER_GRAPH_MAX_PASS_ACCESS_COUNT 8
+#define RENDER_GRAPH_NONE (~0u)
+
+typedef enum YeVkRenderGraphAccessFlag {
+    RENDER_GRAPH_ACCESS_READ = 0x1,
+    RENDER_GRAPH_ACCESS_WRITE = 0x2,
+    // The previous contents are not needed, the layout transition may start from undefined.
+    RENDER_GRAPH_ACCESS_DISCARD = 0x4,
+    // The pass synchronizes the access itself, e.g. across queue families, only the resulting state is tracked.
+    RENDER_GRAPH_ACCESS_EXTERNAL = 0x8
+} YeVkRenderGraphAccessFlag;
+
+typedef struct YsVkRenderGraphAccess {
+    u32 image;
+    u32 layer;
+    u32 flags;
+    VkImageLayout layout;
+    // Layout the pass leaves the image in, render passes move their attachments to the final layout themselves.
+    VkImageLayout final_layout;
+    VkPipelineStageFlags stage_mask;
+    VkAccessFlags access_mask;
+} YsVkRenderGraphAccess;
+
+typedef struct YsVkRenderGraphPass {
+    const char* name;
+    // Passes without side effects are culled when nothing live reads what they write.
+    b8 has_side_effects;
+    b8 is_live;
+
+    // Barriers of the pass are recorded into command_buffer right before record is called.
+    VkCommandBuffer command_buffer;
+    void (*record)(VkCommandBuffer command_buffer, void* user_data);
+    void* user_data;
+
+    u32 access_count;
+    YsVkRenderGraphAccess accesses[RENDER_GRAPH_MAX_PASS_ACCESS_COUNT];
+} YsVkRenderGraphPass;
+
+// Synchronization state of one layer, it persists across frames so cached passes can be skipped.
+typedef struct YsVkRenderGraphLayerState {
+    VkImageLayout layout;
+    VkPipelineStageFlags write_stage_mask;
+    VkAccessFlags write_access_mask;
+    // Stages that read since the last write and the accesses the write has already been made visible to.
+    VkPipelineStageFlags read_stage_mask;
+    VkAccessFlags visible_access_mask;
+} YsVkRenderGraphLayerState;
+
+typedef struct YsVkRenderGraphImage {
+    const char* name;
+    struct YsVkImage* image;
+    VkImageAspectFlags aspect_mask;
+
+    // Transient images only hold data while the passes of one configuration use them, their memory can be aliased.
+    b8 is_transient;
+    // Bit per planned configuration the image is live in.
+    u32 configuration_mask;
+    // Image whose memory this one is bound to, or RENDER_GRAPH_NONE.
+    u32 alias_of;
+    b8 has_aliases;
+
+    u32 layer_count;
+    YsVkRenderGraphLayerState* layer_states;
+} YsVkRenderGraphImage;
+
+// Frame graph of the passes recorded for one frame. Passes declare the image layers they read and write, the
+// graph culls passes whose results are unused, and emits the barriers between the remaining ones in declaration
+// order. Images are registered once and planned against every configuration so transient images that are never
+// live together can share memory.
+typedef struct YsVkRenderGraph {
+    u32 (*addImage)(struct YsVkRenderGraph* graph, const char* name, b8 is_transient);
+
+    // Called once the image exists, every layer starts out in initial_layout.
+    void (*bindImage)(struct YsVkRenderGraph* graph,
+                      u32 image_index,
+                      struct YsVkImage* image,
+                      VkImageAspectFlags aspect_mask,
+                      VkImageLayout initial_layout);
+
+    // Removes the passes of the previous frame, image states are kept.
+    void (*reset)(struct YsVkRenderGraph* graph);
+
+    u32 (*addPass)(struct YsVkRenderGraph* graph,
+                   const char* name,
+                   b8 has_side_effects,
+                   void (*record)(VkCommandBuffer command_buffer, void* user_data),
+                   void* user_data);
+
+    void (*addAccess)(struct YsVkRenderGraph* graph,
+                      u32 pass_index,
+                      u32 image_index,
+                      u32 layer,
+                      u32 flags,
+                      VkImageLayout layout,
+                      VkImageLayout final_layout,
+                      VkPipelineStageFlags stage_mask,
+                      VkAccessFlags access_mask);
+
+    // Marks the passes that contribute to a pass with side effects, the others are culled.
+    void (*compile)(struct YsVkRenderGraph* graph);
+
+    // After compile, records which images the configuration keeps live.
+    void (*planConfiguration)(struct YsVkRenderGraph* graph, u32 configuration);
+
+    // After every configuration is planned, pairs transient images that are never live in the same configuration.
+    void (*planAliases)(struct YsVkRenderGraph* graph);
+
+    // The contents of aliased images are lost once another image of the same memory was written.
+    void (*invalidateAliasedImages)(struct YsVkRenderGraph* graph);
+
+    // Records the barriers and the live passes, in declaration order.
+    void (*execute)(struct YsVkRenderGraph* graph);
+
+    // Inside a record callback this is still the layout the pass starts from.
+    VkImageLayout (*imageLayout)(struct YsVkRenderGraph* graph, u32 image_index, u32 layer);
+
+    u32 image_count;
+    YsVkRenderGraphImage images[RENDER_GRAPH_MAX_IMAGE_COUNT];
+
+    u32 pass_count;
+    YsVkRenderGraphPass passes[RENDER_GRAPH_MAX_PASS_COUNT];
+
+    // Statistics of the last executed frame.
+    u32 culled_pass_count;
+    u32 barrier_count;
+} YsVkRenderGraph;
+
+YsVkRenderGraph* yVkAllocateRenderGraphObject();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CGPPY_YVULKANRENDERGRAPH_H
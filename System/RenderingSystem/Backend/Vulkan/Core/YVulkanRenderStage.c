@@ -32,6 +32,31 @@
 #include <stdio.h>
 
 
+static void createFramebuffers(YsVkContext* context, YsVkRenderStage* render_stage) {
+    YsVkRenderStageCreateInfo* create_info = render_stage->create_info;
+    render_stage->framebuffers = yCMemoryAllocate(sizeof(VkFramebuffer) * create_info->framebuffer_count);
+    for(u32 i = 0; i < create_info->framebuffer_count; ++i) {
+        create_info->framebuffer_create_info[i].renderPass = render_stage->render_pass_handle;
+        VkFramebufferCreateInfo fb_create_info = create_info->framebuffer_create_info[i];
+        VK_CHECK(vkCreateFramebuffer(context->device->logical_device,
+                                     &fb_create_info,
+                                     context->allocator,
+                                     &render_stage->framebuffers[i]));
+    }
+}
+
+static void destroyFramebuffers(YsVkContext* context, YsVkRenderStage* render_stage) {
+    if (!render_stage->framebuffers) {
+        return;
+    }
+
+    for(u32 i = 0; i < render_stage->create_info->framebuffer_count; ++i) {
+        vkDestroyFramebuffer(context->device->logical_device, render_stage->framebuffers[i], context->allocator);
+    }
+    yCMemoryFree(render_stage->framebuffers);
+    render_stage->framebuffers = NULL;
+}
+
 static b8 create(YsVkContext* context,
                  YsVkRenderStageCreateInfo* create_info,
                  YsVkRenderStage* render_stage) {
@@ -65,20 +90,15 @@ static b8 create(YsVkContext* context,
                                 &render_stage->render_pass_handle));
 
     //
-    render_stage->framebuffers = yCMemoryAllocate(sizeof(VkFramebuffer) * create_info->framebuffer_count);
-    for(u32 i = 0; i < create_info->framebuffer_count; ++i) {
-        create_info->framebuffer_create_info[i].renderPass = render_stage->render_pass_handle;
-        VkFramebufferCreateInfo fb_create_info = create_info->framebuffer_create_info[i];
-        VK_CHECK(vkCreateFramebuffer(context->device->logical_device,
-                                     &fb_create_info,
-                                     context->allocator,
-                                     &render_stage->framebuffers[i]));
-    }
+    createFramebuffers(context, render_stage);
 
     return true;
 }
 
 static void destroy(YsVkContext* context, YsVkRenderStage* render_stage) {
+    if (render_stage) {
+        destroyFramebuffers(context, render_stage);
+    }
     if (render_stage && render_stage->render_pass_handle) {
         vkDestroyRenderPass(context->device->logical_device, render_stage->render_pass_handle, context->allocator);
         render_stage->render_pass_handle = 0;
@@ -90,6 +110,8 @@ YsVkRenderStage* yVkAllocateRenderStageObject() {
     if(render_stage) {
         render_stage->create = create;
         render_stage->destroy = destroy;
+        render_stage->createFramebuffers = createFramebuffers;
+        render_stage->destroyFramebuffers = destroyFramebuffers;
     }
 
     return render_stage;
@@ -41,6 +41,11 @@ typedef struct YsVkRenderStage {
 
     void (*destroy)(struct YsVkContext* context, struct YsVkRenderStage* render_stage);
 
+    // Framebuffers follow create_info->framebuffer_create_info, they are recreated when their attachments change size.
+    void (*createFramebuffers)(struct YsVkContext* context, struct YsVkRenderStage* render_stage);
+
+    void (*destroyFramebuffers)(struct YsVkContext* context, struct YsVkRenderStage* render_stage);
+
     YsVkRenderStageCreateInfo* create_info;
 
     VkRenderPass render_pass_handle;
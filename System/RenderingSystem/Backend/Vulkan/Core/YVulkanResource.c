@@ -24,7 +24,10 @@
 
 #include "YVulkanResource.h"
 #include "YVulkanBuffer.h"
+#include "YVulkanStagingBuffer.h"
+#include "YVulkanUploadQueue.h"
 #include "YVulkanImage.h"
+#include "YVulkanRenderGraph.h"
 #include "YVulkanContext.h"
 #include "YVulkanRenderingSystem.h"
 #include "YVulkanOutputSystem.h"
@@ -36,44 +39,86 @@
 
 #include "stb_image_write.h"
 
+#define STAGING_BUFFER_SEGMENT_SIZE (8 * 1024 * 1024)
+#define STAGING_BUFFER_MAX_SEGMENT_SIZE (256 * 1024 * 1024)
+
+
+// Staging
+static void createStagingBuffer(YsVkContext* context, YsVkResources* resource) {
+    resource->staging_buffer = yVkAllocateStagingBufferObject();
+    if(!resource->staging_buffer->create(context,
+                                         STAGING_BUFFER_SEGMENT_SIZE,
+                                         STAGING_BUFFER_MAX_SEGMENT_SIZE,
+                                         context->swapchain->max_frames_in_flight,
+                                         resource->staging_buffer)) {
+        YERROR("Error creating staging buffer.");
+    }
+}
 
 // Vertex
-static void createVertexInputBuffer(YsVkContext* context,
-                                    YsVkResources* resource,
-                                    u32 vertex_count) {
-    resource->current_draw_vertex_count = vertex_count;
+static b8 vertexInputBufferFits(YsVkResources* resource, u32 vertex_count, u32 draw_record_count) {
+    return resource->vertex_input_position_buffer &&
+           resource->vertex_input_position_buffer->total_size >= sizeof(vec4) * vertex_count &&
+           resource->vertex_input_material_id_buffer->total_size >= sizeof(i32) * vertex_count &&
+           resource->draw_record_buffer->total_size >= yDrawRecordSize() * draw_record_count &&
+           resource->draw_record_capacity >= draw_record_count;
+}
 
-    VkMemoryPropertyFlagBits memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VkBufferUsageFlagBits usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | 
-                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT | 
-                                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    resource->vertex_input_position_buffer = yVkAllocateBufferObject();
-    if (!resource->vertex_input_position_buffer->create(context,
-                                                        sizeof(vec4) * vertex_count,
-                                                        usage,
-                                                        memory_property_flags,
-                                                        resource->vertex_input_position_buffer)) {
-        YERROR("Error Create VkBuffer");
+static void updateSceneDescriptorSets(YsVkContext* context, YsVkResources* resource);
+static b8 growDrawCommandBuffer(YsVkContext* context, YsVkResources* resource, u32 draw_record_count);
+
+static void createVertexInputBufferObject(YsVkContext* context,
+                                          YsVkBuffer** buffer,
+                                          VkBufferUsageFlags usage,
+                                          u64 size) {
+    if(*buffer) {
+        (*buffer)->destroy(context, *buffer);
+    } else {
+        *buffer = yVkAllocateBufferObject();
+        (*buffer)->is_concurrent = true;
     }
 
-    resource->vertex_input_normal_buffer = yVkAllocateBufferObject();
-    if (!resource->vertex_input_normal_buffer->create(context,
-                                                      sizeof(vec4) * vertex_count,
-                                                      usage,
-                                                      memory_property_flags,
-                                                      resource->vertex_input_normal_buffer)) {
+    VkMemoryPropertyFlagBits memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    if (!(*buffer)->create(context,
+                           size > 16 ? size : 16,
+                           usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                           memory_property_flags,
+                           *buffer)) {
         YERROR("Error Create VkBuffer");
     }
+}
 
-    resource->vertex_input_material_id_buffer = yVkAllocateBufferObject();
-    if (!resource->vertex_input_material_id_buffer->create(context,
-                                                           sizeof(i32) * vertex_count,
-                                                           usage,
-                                                           memory_property_flags,
-                                                           resource->vertex_input_material_id_buffer)) {
-        YERROR("Error Create VkBuffer");
+static void createVertexInputBuffer(YsVkContext* context,
+                                    YsVkResources* resource,
+                                    u32 vertex_count,
+                                    u32 draw_record_count) {
+    resource->current_draw_vertex_count = vertex_count;
+    resource->current_draw_record_count = draw_record_count;
+    resource->command_generation++;
+
+    // Vertex buffers only grow, the caller has to drain the frames in flight before they are recreated.
+    if(vertexInputBufferFits(resource, vertex_count, draw_record_count)) {
+        return;
     }
+
+    createVertexInputBufferObject(context, 
+                                  &resource->vertex_input_position_buffer, 
+                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
+                                  sizeof(vec4) * vertex_count);
+    createVertexInputBufferObject(context, 
+                                  &resource->vertex_input_normal_buffer, 
+                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
+                                  sizeof(vec4) * vertex_count);
+    createVertexInputBufferObject(context, 
+                                  &resource->vertex_input_material_id_buffer, 
+                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
+                                  sizeof(i32) * vertex_count);
+    createVertexInputBufferObject(context, 
+                                  &resource->draw_record_buffer, 
+                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
+                                  yDrawRecordSize() * draw_record_count);
+    growDrawCommandBuffer(context, resource, draw_record_count);
+    updateSceneDescriptorSets(context, resource);
 }
 
 static void createVertexInputDescription(YsVkContext* context, YsVkResources* resources) {
@@ -104,133 +149,317 @@ static void createVertexInputDescription(YsVkContext* context, YsVkResources* re
 
 static void updateVertexInputBuffer(YsVkContext* context,
                                     YsVkResources* resource,
-                                    YsVkCommandUnit* command_unit,
                                     void* vertex_position_data,
                                     void* vertex_normal_data,
-                                    void* vertex_material_id_data) {
-    resource->vertex_input_position_buffer->indirectUpdate(context,
-                                                           command_unit,
-                                                           0,
-                                                           0,
-                                                           vertex_position_data,
-                                                           resource->vertex_input_position_buffer);
-    resource->vertex_input_normal_buffer->indirectUpdate(context,
-                                                         command_unit,
-                                                         0,
-                                                         0,
-                                                         vertex_normal_data,
-                                                         resource->vertex_input_normal_buffer);
-    resource->vertex_input_material_id_buffer->indirectUpdate(context,
-                                                              command_unit,
-                                                              0,
-                                                              0,
-                                                              vertex_material_id_data,
-                                                              resource->vertex_input_material_id_buffer);
+                                    void* vertex_material_id_data,
+                                    void* draw_record_data) {
+    u32 vertex_count = resource->current_draw_vertex_count;
+    resource->staging_buffer->upload(context,
+                                     0,
+                                     sizeof(vec4) * vertex_count,
+                                     vertex_position_data,
+                                     resource->vertex_input_position_buffer->handle,
+                                     resource->staging_buffer);
+    resource->staging_buffer->upload(context,
+                                     0,
+                                     sizeof(vec4) * vertex_count,
+                                     vertex_normal_data,
+                                     resource->vertex_input_normal_buffer->handle,
+                                     resource->staging_buffer);
+    resource->staging_buffer->upload(context,
+                                     0,
+                                     sizeof(i32) * vertex_count,
+                                     vertex_material_id_data,
+                                     resource->vertex_input_material_id_buffer->handle,
+                                     resource->staging_buffer);
+    resource->staging_buffer->upload(context,
+                                     0,
+                                     yDrawRecordSize() * resource->current_draw_record_count,
+                                     draw_record_data,
+                                     resource->draw_record_buffer->handle,
+                                     resource->staging_buffer);
 }
 
-// SSBO
-static void createSsboBuffer(YsVkContext* context,
-                             YsVkResources* resource,
-                             u32 data_size) {
-    resource->ssbo_buffer = yVkAllocateBufferObject();
-    if (!resource->ssbo_buffer->create(context,
-                                       data_size,
-                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                       resource->ssbo_buffer)) {
-        YERROR("Error creating ssbo buffer.");
-    }                        
-}
-
-static void createSsboDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->ssbo_descriptor.set = 0;
-    resources->ssbo_descriptor.is_single_descriptor_set = true;
-
-    VkDescriptorSetLayoutBinding ssbo_layout_binding = {};
-    ssbo_layout_binding.binding = 0;
-    ssbo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    ssbo_layout_binding.descriptorCount = 1;
-    ssbo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | 
-                                     VK_SHADER_STAGE_FRAGMENT_BIT |
-                                     VK_SHADER_STAGE_COMPUTE_BIT;
-    VkDescriptorSetLayoutCreateInfo ssbo_layout_info = {};
-    ssbo_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    ssbo_layout_info.bindingCount = 1;
-    ssbo_layout_info.pBindings = &ssbo_layout_binding;
-    vkCreateDescriptorSetLayout(context->device->logical_device,
-                                &ssbo_layout_info,
-                                NULL,
-                                &resources->ssbo_descriptor.descriptor_set_layout);
-
-    VkDescriptorPoolSize ssbo_pool_size;
-    ssbo_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    ssbo_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo ssbo_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    ssbo_pool_info.poolSizeCount = 1;
-    ssbo_pool_info.pPoolSizes = &ssbo_pool_size;
-    ssbo_pool_info.maxSets = 1;
+// Descriptor
+static void createGlobalDescriptor(YsVkContext* context, YsVkResources* resources) {
+    // One set per frame in flight, a swapped in scene is only written to the set of a frame that has finished.
+    resources->global_descriptor.set = 0;
+    resources->global_descriptor.is_single_descriptor_set = false;
+
+    VkDescriptorSetLayoutBinding layout_bindings[GLOBAL_BINDING_COUNT] = {};
+    VkDescriptorBindingFlags binding_flags[GLOBAL_BINDING_COUNT] = {};
+    for(u32 i = 0; i < GLOBAL_BINDING_COUNT; ++i) {
+        layout_bindings[i].binding = i;
+        layout_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        layout_bindings[i].descriptorCount = 1;
+        layout_bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | 
+                                        VK_SHADER_STAGE_FRAGMENT_BIT |
+                                        VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    layout_bindings[GLOBAL_BINDING_UBO].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layout_bindings[GLOBAL_BINDING_STORAGE_IMAGES].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    layout_bindings[GLOBAL_BINDING_STORAGE_IMAGES].descriptorCount = GLOBAL_STORAGE_IMAGE_COUNT;
+    layout_bindings[GLOBAL_BINDING_TEXTURES].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layout_bindings[GLOBAL_BINDING_TEXTURES].descriptorCount = GLOBAL_TEXTURE_CAPACITY;
+    // Handles that were never registered stay unwritten, and registering one does not invalidate
+    // command buffers that already bound the set.
+    binding_flags[GLOBAL_BINDING_TEXTURES] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                             VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                             VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO};
+    binding_flags_info.bindingCount = GLOBAL_BINDING_COUNT;
+    binding_flags_info.pBindingFlags = binding_flags;
+    VkDescriptorSetLayoutCreateInfo layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    layout_info.pNext = &binding_flags_info;
+    layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layout_info.bindingCount = GLOBAL_BINDING_COUNT;
+    layout_info.pBindings = layout_bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
+                                         &layout_info,
+                                         context->allocator,
+                                         &resources->global_descriptor.descriptor_set_layout));
+
+    u32 set_count = context->swapchain->max_frames_in_flight;
+    VkDescriptorPoolSize pool_sizes[4];
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[0].descriptorCount = (SSBO_BINDING_COUNT + 3) * set_count;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_sizes[1].descriptorCount = set_count;
+    pool_sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pool_sizes[2].descriptorCount = GLOBAL_STORAGE_IMAGE_COUNT * set_count;
+    pool_sizes[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[3].descriptorCount = GLOBAL_TEXTURE_CAPACITY * set_count;
+    VkDescriptorPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.poolSizeCount = 4;
+    pool_info.pPoolSizes = pool_sizes;
+    pool_info.maxSets = set_count;
     VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &ssbo_pool_info,
+                                    &pool_info,
                                     context->allocator,
-                                    &resources->ssbo_descriptor.descriptor_pool));
+                                    &resources->global_descriptor.descriptor_pool));
 
-    VkDescriptorSetAllocateInfo ssbo_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    ssbo_alloc_info.descriptorPool = resources->ssbo_descriptor.descriptor_pool;
-    ssbo_alloc_info.descriptorSetCount = 1;
-    ssbo_alloc_info.pSetLayouts = &resources->ssbo_descriptor.descriptor_set_layout;
-    resources->ssbo_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * ssbo_alloc_info.descriptorSetCount);
+    VkDescriptorSetLayout set_layouts[set_count];
+    u32 texture_counts[set_count];
+    for(u32 i = 0; i < set_count; ++i) {
+        set_layouts[i] = resources->global_descriptor.descriptor_set_layout;
+        texture_counts[i] = GLOBAL_TEXTURE_CAPACITY;
+    }
+    VkDescriptorSetVariableDescriptorCountAllocateInfo variable_count_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO};
+    variable_count_info.descriptorSetCount = set_count;
+    variable_count_info.pDescriptorCounts = texture_counts;
+    VkDescriptorSetAllocateInfo alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    alloc_info.pNext = &variable_count_info;
+    alloc_info.descriptorPool = resources->global_descriptor.descriptor_pool;
+    alloc_info.descriptorSetCount = set_count;
+    alloc_info.pSetLayouts = set_layouts;
+    resources->global_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * set_count);
     VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device, 
-                                      &ssbo_alloc_info, 
-                                      resources->ssbo_descriptor.descriptor_sets));
+                                      &alloc_info, 
+                                      resources->global_descriptor.descriptor_sets));
+
+    resources->scene_descriptor_dirty = yCMemoryAllocate(sizeof(b8) * set_count);
+    resources->global_texture_count = GLOBAL_TEXTURE_BUILTIN_COUNT;
 }
 
-static void updateSsboDescriptorSets(YsVkContext* context, YsVkResources* resource) {
-    VkDescriptorBufferInfo ssbo_buffer_info;
-    ssbo_buffer_info.buffer = resource->ssbo_buffer->handle;
-    ssbo_buffer_info.offset = 0;
-    ssbo_buffer_info.range = resource->ssbo_buffer->total_size; 
+static void writeGlobalImage(YsVkContext* context,
+                             YsVkResources* resource,
+                             u32 frame_index,
+                             u32 binding,
+                             u32 handle,
+                             VkImageView image_view,
+                             VkSampler sampler,
+                             VkImageLayout image_layout) {
+    VkDescriptorImageInfo image_info;
+    image_info.sampler = sampler;
+    image_info.imageView = image_view;
+    image_info.imageLayout = image_layout;
 
     VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    write_descriptor_set.dstSet = resource->ssbo_descriptor.descriptor_sets[0];
-    write_descriptor_set.dstBinding = 0;
-    write_descriptor_set.dstArrayElement = 0;
-    write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write_descriptor_set.dstSet = resource->global_descriptor.descriptor_sets[frame_index];
+    write_descriptor_set.dstBinding = binding;
+    write_descriptor_set.dstArrayElement = handle;
+    write_descriptor_set.descriptorType = GLOBAL_BINDING_TEXTURES == binding ? 
+                                          VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : 
+                                          VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     write_descriptor_set.descriptorCount = 1;
-    write_descriptor_set.pBufferInfo = &ssbo_buffer_info;
+    write_descriptor_set.pImageInfo = &image_info;
     vkUpdateDescriptorSets(context->device->logical_device,
                            1,
                            &write_descriptor_set,
                            0,
+                           NULL);
+}
+
+static u32 registerTexture(YsVkContext* context,
+                           YsVkResources* resource,
+                           VkImageView image_view,
+                           VkSampler sampler,
+                           VkImageLayout image_layout) {
+    if(resource->global_texture_count >= GLOBAL_TEXTURE_CAPACITY) {
+        YERROR("Global texture array is full, capacity: %u.", GLOBAL_TEXTURE_CAPACITY);
+        return GLOBAL_TEXTURE_INVALID;
+    }
+
+    u32 handle = resource->global_texture_count++;
+    for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         handle,
+                         image_view,
+                         sampler,
+                         image_layout);
+    }
+
+    return handle;
+}
+
+static void updateSceneDescriptorSet(YsVkContext* context, YsVkResources* resource, u32 frame_index) {
+    VkDescriptorBufferInfo buffer_infos[SSBO_BINDING_COUNT + 2];
+    VkWriteDescriptorSet write_descriptor_sets[SSBO_BINDING_COUNT + 2];
+    u32 write_count = 0;
+    
+    // A scene may upload its vertex input before its storage buffers, only buffers that exist are written.
+    for(u32 i = 0; i < SSBO_BINDING_COUNT && resource->ssbo_buffers[i]; ++i) {
+        buffer_infos[write_count].buffer = resource->ssbo_buffers[i]->handle;
+        buffer_infos[write_count].offset = 0;
+        buffer_infos[write_count].range = resource->ssbo_buffers[i]->total_size;
+
+        write_descriptor_sets[write_count] = (VkWriteDescriptorSet){VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write_descriptor_sets[write_count].dstBinding = i;
+        ++write_count;
+    }
+    if(resource->draw_record_buffer) {
+        buffer_infos[write_count].buffer = resource->draw_record_buffer->handle;
+        buffer_infos[write_count].offset = 0;
+        buffer_infos[write_count].range = resource->draw_record_buffer->total_size;
+
+        write_descriptor_sets[write_count] = (VkWriteDescriptorSet){VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write_descriptor_sets[write_count].dstBinding = GLOBAL_BINDING_DRAW_RECORDS;
+        ++write_count;
+    }
+    // The draw command buffer grows with the record count, so its slice is rewritten with the scene.
+    if(resource->draw_command_buffer) {
+        buffer_infos[write_count].buffer = resource->draw_command_buffer->handle;
+        buffer_infos[write_count].offset = resource->draw_command_slice_size * frame_index;
+        buffer_infos[write_count].range = DRAW_COMMAND_SLICE_SIZE(resource->draw_record_capacity);
+
+        write_descriptor_sets[write_count] = (VkWriteDescriptorSet){VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write_descriptor_sets[write_count].dstBinding = GLOBAL_BINDING_DRAW_COMMANDS;
+        ++write_count;
+    }
+    for(u32 i = 0; i < write_count; ++i) {
+        write_descriptor_sets[i].dstSet = resource->global_descriptor.descriptor_sets[frame_index];
+        write_descriptor_sets[i].dstArrayElement = 0;
+        write_descriptor_sets[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write_descriptor_sets[i].descriptorCount = 1;
+        write_descriptor_sets[i].pBufferInfo = &buffer_infos[i];
+    }
+    vkUpdateDescriptorSets(context->device->logical_device,
+                           write_count,
+                           write_descriptor_sets,
+                           0,
                            0);
+
+    // Command buffers that bound the set are invalidated by the update.
+    resource->command_generation++;
+}
+
+static void updateSceneDescriptorSets(YsVkContext* context, YsVkResources* resource) {
+    for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        updateSceneDescriptorSet(context, resource, i);
+    }
+}
+
+// SSBO
+static b8 ssboBufferFits(YsVkResources* resource, u32 binding, u64 data_size) {
+    u64 required_size = data_size > 16 ? data_size : 16;
+    return resource->ssbo_buffers[binding] &&
+           resource->ssbo_buffers[binding]->total_size >= required_size;
+}
+
+static b8 ssboFits(YsVkResources* resource, struct YsVkResourcesSsboData* ssbo_data) {
+    for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+        if(!ssboBufferFits(resource, i, ssbo_data->sizes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 createSsboBuffer(YsVkContext* context,
+                           YsVkResources* resource,
+                           u32 binding,
+                           u64 data_size) {
+    // Storage buffers only grow, a smaller scene reuses the previous allocation.
+    if(ssboBufferFits(resource, binding, data_size)) {
+        return false;
+    }
+    u64 required_size = data_size > 16 ? data_size : 16;
+
+    if(resource->ssbo_buffers[binding]) {
+        resource->ssbo_buffers[binding]->destroy(context, resource->ssbo_buffers[binding]);
+    } else {
+        resource->ssbo_buffers[binding] = yVkAllocateBufferObject();
+        resource->ssbo_buffers[binding]->is_concurrent = true;
+    }
+
+    u64 capacity = required_size + required_size / 2;
+    if (!resource->ssbo_buffers[binding]->create(context,
+                                                 capacity,
+                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 resource->ssbo_buffers[binding])) {
+        YERROR("Error creating ssbo buffer, binding: %u, size: %llu.", binding, capacity);
+    }
+
+    return true;
 }
 
 static void createSsbo(YsVkContext* context,
                        YsVkResources* resource,
-                       u32 data_size) {
-    createSsboBuffer(context,
-                     resource,
-                     data_size);                                 
+                       struct YsVkResourcesSsboData* ssbo_data) {
+    b8 reallocated = false;
+    for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+        reallocated |= createSsboBuffer(context,
+                                        resource,
+                                        i,
+                                        ssbo_data->sizes[i]);
+        resource->ssbo_data_sizes[i] = ssbo_data->sizes[i];
+    }
     
-    updateSsboDescriptorSets(context, resource);             
+    // The descriptor set may still be in use by frames in flight, only rewrite it when a buffer changed.
+    if(reallocated) {
+        updateSceneDescriptorSets(context, resource);
+    }
 }
 
 static void updateSsboBuffer(YsVkContext* context,
                              YsVkResources* resource,
-                             YsVkCommandUnit* command_unit,
-                             void* data) {
-    resource->ssbo_buffer->indirectUpdate(context,
-                                          command_unit,
-                                          0,
-                                          0,
-                                          data,
-                                          resource->ssbo_buffer);
+                             struct YsVkResourcesSsboData* ssbo_data) {
+    for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+        resource->staging_buffer->upload(context,
+                                         0,
+                                         ssbo_data->sizes[i],
+                                         ssbo_data->data[i],
+                                         resource->ssbo_buffers[i]->handle,
+                                         resource->staging_buffer);
+    }
 }
 
 // UBO
 static void createUboBuffer(YsVkContext* context, YsVkResources* resource) {
+    // One slice per frame in flight, so the frame being recorded never writes memory an earlier frame still reads.
+    u64 alignment = context->device->properties.limits.minUniformBufferOffsetAlignment;
+    resource->ubo_slice_size = (yUboSize() + alignment - 1) & ~(alignment - 1);
+
     resource->ubo_buffer = yVkAllocateBufferObject();
+    resource->ubo_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
+    resource->ubo_buffer->is_concurrent = true;
     if (!resource->ubo_buffer->create(context,
-                                      yUboSize(),
+                                      resource->ubo_slice_size * context->swapchain->max_frames_in_flight,
                                       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                                       resource->ubo_buffer)) {
@@ -238,86 +467,321 @@ static void createUboBuffer(YsVkContext* context, YsVkResources* resource) {
     }
 }
 
-static void createUboDescription(YsVkContext* context, YsVkResources* resources) {
-    resources->ubo_descriptor.set = 1;
-    resources->ubo_descriptor.is_single_descriptor_set = true;
-    
-    VkDescriptorSetLayoutBinding ubo_layout_binding;
-    ubo_layout_binding.binding = 0;
-    ubo_layout_binding.descriptorCount = 1;
-    ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    ubo_layout_binding.pImmutableSamplers = NULL;
-    ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | 
-                                    VK_SHADER_STAGE_FRAGMENT_BIT |
-                                    VK_SHADER_STAGE_COMPUTE_BIT;
-    VkDescriptorSetLayoutCreateInfo ubo_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    ubo_layout_info.bindingCount = 1;
-    ubo_layout_info.pBindings = &ubo_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &ubo_layout_info,
-                                         context->allocator,
-                                         &resources->ubo_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize ubo_pool_size;
-    ubo_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    ubo_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo ubo_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    ubo_pool_info.poolSizeCount = 1;
-    ubo_pool_info.pPoolSizes = &ubo_pool_size;
-    ubo_pool_info.maxSets = 1;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &ubo_pool_info,
-                                    context->allocator,
-                                    &resources->ubo_descriptor.descriptor_pool));
-
-    VkDescriptorSetAllocateInfo ubo_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    ubo_alloc_info.descriptorPool = resources->ubo_descriptor.descriptor_pool;
-    ubo_alloc_info.descriptorSetCount = 1;
-    ubo_alloc_info.pSetLayouts = &resources->ubo_descriptor.descriptor_set_layout;
-    resources->ubo_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * ubo_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device, 
-                                      &ubo_alloc_info, 
-                                      resources->ubo_descriptor.descriptor_sets));
-}
-
 static void updateUboDescriptorSets(YsVkContext* context, YsVkResources* resource) {
-    VkDescriptorBufferInfo ubo_buffer_info;
-    ubo_buffer_info.buffer = resource->ubo_buffer->handle;
-    ubo_buffer_info.offset = 0;
-    ubo_buffer_info.range = resource->ubo_buffer->total_size;   
+    for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        VkDescriptorBufferInfo ubo_buffer_info;
+        ubo_buffer_info.buffer = resource->ubo_buffer->handle;
+        ubo_buffer_info.offset = resource->ubo_slice_size * i;
+        ubo_buffer_info.range = yUboSize();
 
-    VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    write_descriptor_set.dstSet = resource->ubo_descriptor.descriptor_sets[0];
-    write_descriptor_set.dstBinding = 0;
-    write_descriptor_set.dstArrayElement = 0;
-    write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    write_descriptor_set.descriptorCount = 1;
-    write_descriptor_set.pBufferInfo = &ubo_buffer_info;
+        VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write_descriptor_set.dstSet = resource->global_descriptor.descriptor_sets[i];
+        write_descriptor_set.dstBinding = GLOBAL_BINDING_UBO;
+        write_descriptor_set.dstArrayElement = 0;
+        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write_descriptor_set.descriptorCount = 1;
+        write_descriptor_set.pBufferInfo = &ubo_buffer_info;
 
-    vkUpdateDescriptorSets(context->device->logical_device,
-                           1,
-                           &write_descriptor_set,
-                           0,
-                           0);
+        vkUpdateDescriptorSets(context->device->logical_device,
+                               1,
+                               &write_descriptor_set,
+                               0,
+                               0);
+    }
 }
 
 static void createUbo(YsVkContext* context,
                       YsVkResources* resource) {
     createUboBuffer(context, resource);                    
 
-    createUboDescription(context, resource);
-
     updateUboDescriptorSets(context, resource);                                     
 }
 
 static void updateUboBuffer(struct YsVkContext* context,
                             struct YsVkResources* resource,
+                            u32 frame_index,
                             void* data) {
-    resource->ubo_buffer->directUpdate(context,
-                                       0,
-                                       0,
-                                       data,
-                                       resource->ubo_buffer);
+    // The slice is persistently mapped and coherent, the frame fence already guarantees the GPU is done with it.
+    yCMemoryCopy((u8*)resource->ubo_buffer->allocation.mapped_data + resource->ubo_slice_size * frame_index,
+                 data,
+                 yUboSize());
+}
+
+// Draw
+static void createDrawCommandBuffer(YsVkContext* context, YsVkResources* resource, u32 draw_record_capacity) {
+    // Filled by the culling pass of the frame and read by its indirect draws, so every frame owns a slice.
+    u64 alignment = context->device->properties.limits.minStorageBufferOffsetAlignment;
+    resource->draw_record_capacity = draw_record_capacity;
+    resource->draw_command_slice_size = (DRAW_COMMAND_SLICE_SIZE(draw_record_capacity) + alignment - 1) & ~(alignment - 1);
+
+    resource->draw_command_buffer = yVkAllocateBufferObject();
+    if (!resource->draw_command_buffer->create(context,
+                                               resource->draw_command_slice_size * context->swapchain->max_frames_in_flight,
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | 
+                                               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | 
+                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                               resource->draw_command_buffer)) {
+        YERROR("Error creating draw command buffer, record capacity: %u.", draw_record_capacity);
+    }
+}
+
+static void retireBufferObject(YsVkContext* context, YsVkResources* resource, YsVkBuffer** buffer);
+
+static b8 growDrawCommandBuffer(YsVkContext* context, YsVkResources* resource, u32 draw_record_count) {
+    // Grows like the storage buffers, frames recorded before keep culling into the retired buffer. The caller
+    // marks the scene descriptor sets dirty so every frame picks up the new slices.
+    if(draw_record_count <= resource->draw_record_capacity) {
+        return false;
+    }
+
+    retireBufferObject(context, resource, &resource->draw_command_buffer);
+    createDrawCommandBuffer(context, resource, draw_record_count + draw_record_count / 2);
+    return true;
+}
+
+static void createCullingStatisticsBuffer(YsVkContext* context, YsVkResources* resource) {
+    resource->culling_statistics_slice_size = DRAW_COMMAND_HEADER_SIZE * 2;
+
+    resource->culling_statistics_buffer = yVkAllocateBufferObject();
+    resource->culling_statistics_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
+    if (!resource->culling_statistics_buffer->create(context,
+                                                     resource->culling_statistics_slice_size * context->swapchain->max_frames_in_flight,
+                                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                     resource->culling_statistics_buffer)) {
+        YERROR("Error creating culling statistics buffer.");
+    }
+}
+
+static void createDrawCommand(YsVkContext* context, YsVkResources* resource) {
+    createDrawCommandBuffer(context, resource, DRAW_RECORD_INITIAL_CAPACITY);
+    createCullingStatisticsBuffer(context, resource);
+
+    updateSceneDescriptorSets(context, resource);
+}
+
+// Upload Queue
+static void destroyBufferObject(YsVkContext* context, YsVkBuffer** buffer) {
+    if(*buffer) {
+        (*buffer)->destroy(context, *buffer);
+        yCMemoryFree(*buffer);
+        *buffer = NULL;
+    }
+}
+
+static void retireBufferObject(YsVkContext* context, YsVkResources* resource, YsVkBuffer** buffer) {
+    if(!*buffer) {
+        return;
+    }
+
+    if(resource->retired_buffer_count == resource->retired_buffer_capacity) {
+        u32 new_capacity = resource->retired_buffer_capacity ? resource->retired_buffer_capacity * 2 : 16;
+        YsVkBuffer** new_buffers = yCMemoryAllocate(sizeof(YsVkBuffer*) * new_capacity);
+        if(resource->retired_buffers) {
+            yCMemoryCopy(new_buffers, resource->retired_buffers, sizeof(YsVkBuffer*) * resource->retired_buffer_count);
+            yCMemoryFree(resource->retired_buffers);
+        }
+        resource->retired_buffers = new_buffers;
+        resource->retired_buffer_capacity = new_capacity;
+    }
+    resource->retired_buffers[resource->retired_buffer_count++] = *buffer;
+    *buffer = NULL;
+
+    // Frames recorded before the swap may still read the buffer until every frame slot has been waited on once.
+    resource->retired_frame_countdown = context->swapchain->max_frames_in_flight;
+}
+
+static void createUploadBufferObject(YsVkContext* context,
+                                     YsVkBuffer** buffer,
+                                     VkBufferUsageFlags usage,
+                                     u64 size) {
+    *buffer = yVkAllocateBufferObject();
+    (*buffer)->is_concurrent = true;
+    if (!(*buffer)->create(context,
+                           size > 16 ? size : 16,
+                           usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           *buffer)) {
+        YERROR("Error Create VkBuffer");
+    }
+}
+
+static void uploadVertexInputBuffer(YsVkContext* context,
+                                    YsVkResources* resource,
+                                    u32 vertex_count,
+                                    void* vertex_position_data,
+                                    void* vertex_normal_data,
+                                    void* vertex_material_id_data,
+                                    u32 draw_record_count,
+                                    void* draw_record_data) {
+    YsVkUploadQueue* upload_queue = context->upload_queue;
+
+    // A newer scene replaces one that was never swapped in, its copies have to finish before the buffers go away.
+    if(resource->has_pending_vertex_input) {
+        upload_queue->wait(context, resource->pending_upload_value, upload_queue);
+        destroyBufferObject(context, &resource->pending_vertex_input_position_buffer);
+        destroyBufferObject(context, &resource->pending_vertex_input_normal_buffer);
+        destroyBufferObject(context, &resource->pending_vertex_input_material_id_buffer);
+        destroyBufferObject(context, &resource->pending_draw_record_buffer);
+    }
+
+    createUploadBufferObject(context,
+                             &resource->pending_vertex_input_position_buffer,
+                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                             sizeof(vec4) * vertex_count);
+    createUploadBufferObject(context,
+                             &resource->pending_vertex_input_normal_buffer,
+                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                             sizeof(vec4) * vertex_count);
+    createUploadBufferObject(context,
+                             &resource->pending_vertex_input_material_id_buffer,
+                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                             sizeof(i32) * vertex_count);
+    createUploadBufferObject(context,
+                             &resource->pending_draw_record_buffer,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             yDrawRecordSize() * draw_record_count);
+
+    upload_queue->begin(context, upload_queue);
+    upload_queue->uploadBuffer(context,
+                               0,
+                               sizeof(vec4) * vertex_count,
+                               vertex_position_data,
+                               resource->pending_vertex_input_position_buffer->handle,
+                               upload_queue);
+    upload_queue->uploadBuffer(context,
+                               0,
+                               sizeof(vec4) * vertex_count,
+                               vertex_normal_data,
+                               resource->pending_vertex_input_normal_buffer->handle,
+                               upload_queue);
+    upload_queue->uploadBuffer(context,
+                               0,
+                               sizeof(i32) * vertex_count,
+                               vertex_material_id_data,
+                               resource->pending_vertex_input_material_id_buffer->handle,
+                               upload_queue);
+    upload_queue->uploadBuffer(context,
+                               0,
+                               yDrawRecordSize() * draw_record_count,
+                               draw_record_data,
+                               resource->pending_draw_record_buffer->handle,
+                               upload_queue);
+    resource->pending_upload_value = upload_queue->submit(context, upload_queue);
+
+    resource->pending_draw_vertex_count = vertex_count;
+    resource->pending_draw_record_count = draw_record_count;
+    resource->has_pending_vertex_input = true;
+}
+
+static void uploadSsbo(YsVkContext* context,
+                       YsVkResources* resource,
+                       struct YsVkResourcesSsboData* ssbo_data) {
+    YsVkUploadQueue* upload_queue = context->upload_queue;
+
+    if(resource->has_pending_ssbo) {
+        upload_queue->wait(context, resource->pending_upload_value, upload_queue);
+        for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+            destroyBufferObject(context, &resource->pending_ssbo_buffers[i]);
+        }
+    }
+
+    upload_queue->begin(context, upload_queue);
+    for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+        createUploadBufferObject(context,
+                                 &resource->pending_ssbo_buffers[i],
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 ssbo_data->sizes[i]);
+        resource->pending_ssbo_data_sizes[i] = ssbo_data->sizes[i];
+
+        upload_queue->uploadBuffer(context,
+                                   0,
+                                   ssbo_data->sizes[i],
+                                   ssbo_data->data[i],
+                                   resource->pending_ssbo_buffers[i]->handle,
+                                   upload_queue);
+    }
+    resource->pending_upload_value = upload_queue->submit(context, upload_queue);
+
+    resource->has_pending_ssbo = true;
+}
+
+static b8 beginFrame(YsVkContext* context,
+                     YsVkResources* resource,
+                     u32 frame_index) {
+    //
+    if(resource->retired_buffer_count > 0 && 0 == --resource->retired_frame_countdown) {
+        for(u32 i = 0; i < resource->retired_buffer_count; ++i) {
+            destroyBufferObject(context, &resource->retired_buffers[i]);
+        }
+        resource->retired_buffer_count = 0;
+    }
+
+    // Once the host has seen the value, later frames no longer have to wait on it.
+    if(resource->upload_wait_value > 0 && context->upload_queue->isComplete(context,
+                                                                            resource->upload_wait_value,
+                                                                            context->upload_queue)) {
+        resource->upload_wait_value = 0;
+    }
+
+    //
+    b8 swapped = false;
+    if(resource->has_pending_vertex_input || resource->has_pending_ssbo) {
+        // Without a previous scene there is nothing to keep drawing, swap right away and let the frame wait.
+        b8 has_scene = resource->vertex_input_position_buffer || resource->ssbo_buffers[0];
+        if(!has_scene || context->upload_queue->isComplete(context,
+                                                           resource->pending_upload_value,
+                                                           context->upload_queue)) {
+            if(resource->has_pending_vertex_input) {
+                retireBufferObject(context, resource, &resource->vertex_input_position_buffer);
+                retireBufferObject(context, resource, &resource->vertex_input_normal_buffer);
+                retireBufferObject(context, resource, &resource->vertex_input_material_id_buffer);
+                retireBufferObject(context, resource, &resource->draw_record_buffer);
+                resource->vertex_input_position_buffer = resource->pending_vertex_input_position_buffer;
+                resource->vertex_input_normal_buffer = resource->pending_vertex_input_normal_buffer;
+                resource->vertex_input_material_id_buffer = resource->pending_vertex_input_material_id_buffer;
+                resource->draw_record_buffer = resource->pending_draw_record_buffer;
+                resource->pending_vertex_input_position_buffer = NULL;
+                resource->pending_vertex_input_normal_buffer = NULL;
+                resource->pending_vertex_input_material_id_buffer = NULL;
+                resource->pending_draw_record_buffer = NULL;
+                resource->current_draw_vertex_count = resource->pending_draw_vertex_count;
+                resource->current_draw_record_count = resource->pending_draw_record_count;
+                growDrawCommandBuffer(context, resource, resource->current_draw_record_count);
+                for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+                    resource->scene_descriptor_dirty[i] = true;
+                }
+                resource->has_pending_vertex_input = false;
+                resource->command_generation++;
+            }
+
+            if(resource->has_pending_ssbo) {
+                for(u32 i = 0; i < SSBO_BINDING_COUNT; ++i) {
+                    retireBufferObject(context, resource, &resource->ssbo_buffers[i]);
+                    resource->ssbo_buffers[i] = resource->pending_ssbo_buffers[i];
+                    resource->ssbo_data_sizes[i] = resource->pending_ssbo_data_sizes[i];
+                    resource->pending_ssbo_buffers[i] = NULL;
+                }
+                for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+                    resource->scene_descriptor_dirty[i] = true;
+                }
+                resource->has_pending_ssbo = false;
+            }
+
+            resource->upload_wait_value = resource->pending_upload_value;
+            swapped = true;
+        }
+    }
+
+    //
+    if(resource->scene_descriptor_dirty[frame_index]) {
+        updateSceneDescriptorSet(context, resource, frame_index);
+        resource->scene_descriptor_dirty[frame_index] = false;
+    }
+
+    return swapped;
 }
 
 // Push Constant
@@ -371,6 +835,46 @@ static void createSampler(YsVkContext* context, YsVkResources* resource) {
                              &resource->sampler_nearest));
 }
 
+// Render Graph
+static YsVkImage* graphImage(YsVkResources* resource, u32 graph_image) {
+    switch (graph_image) {
+        case GRAPH_IMAGE_RASTERIZATION_COLOR: return resource->rasterization_color_image;
+        case GRAPH_IMAGE_RASTERIZATION_DEPTH: return resource->rasterization_depth_image;
+        case GRAPH_IMAGE_SHADOW_MAP: return resource->shadow_map_image;
+        case GRAPH_IMAGE_PATH_TRACING: return resource->path_tracing_image;
+        case GRAPH_IMAGE_PATH_TRACING_ACCUMULATION: return resource->path_tracing_accumulation_image;
+        case GRAPH_IMAGE_UPSCALING: return resource->upscaling_image;
+        default: return NULL;
+    }
+}
+
+static void prepareGraphImage(YsVkResources* resource, u32 graph_image, YsVkImage* image) {
+    YsVkRenderGraph* graph = resource->render_graph;
+    if(!graph) {
+        return;
+    }
+
+    image->is_memory_shareable = graph->images[graph_image].has_aliases;
+    if(graph->images[graph_image].alias_of != RENDER_GRAPH_NONE) {
+        image->memory_alias = graphImage(resource, graph->images[graph_image].alias_of);
+    }
+}
+
+static void bindGraphImages(YsVkResources* resource) {
+    YsVkRenderGraph* graph = resource->render_graph;
+    if(!graph) {
+        return;
+    }
+
+    VkImageAspectFlags depth_aspect_mask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    graph->bindImage(graph, GRAPH_IMAGE_RASTERIZATION_COLOR, resource->rasterization_color_image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    graph->bindImage(graph, GRAPH_IMAGE_RASTERIZATION_DEPTH, resource->rasterization_depth_image, depth_aspect_mask, VK_IMAGE_LAYOUT_UNDEFINED);
+    graph->bindImage(graph, GRAPH_IMAGE_SHADOW_MAP, resource->shadow_map_image, depth_aspect_mask, VK_IMAGE_LAYOUT_UNDEFINED);
+    graph->bindImage(graph, GRAPH_IMAGE_PATH_TRACING, resource->path_tracing_image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    graph->bindImage(graph, GRAPH_IMAGE_PATH_TRACING_ACCUMULATION, resource->path_tracing_accumulation_image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    graph->bindImage(graph, GRAPH_IMAGE_UPSCALING, resource->upscaling_image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_GENERAL);
+}
+
 // Image Rasterization
 static void createRasterizationImage(YsVkContext* context, 
                                      YsVkResources* resource,
@@ -384,7 +888,7 @@ static void createRasterizationImage(YsVkContext* context,
     color_image_create_info->extent.height = height;
     color_image_create_info->extent.depth = 1;
     color_image_create_info->mipLevels = 1;
-    color_image_create_info->arrayLayers = context->swapchain->image_count;
+    color_image_create_info->arrayLayers = context->swapchain->max_frames_in_flight;
     color_image_create_info->format = VK_FORMAT_R32G32B32A32_SFLOAT;
     color_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     color_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -395,6 +899,7 @@ static void createRasterizationImage(YsVkContext* context,
     color_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
     color_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     resource->rasterization_color_image = yVkAllocateImageObject();
+    prepareGraphImage(resource, GRAPH_IMAGE_RASTERIZATION_COLOR, resource->rasterization_color_image);
     resource->rasterization_color_image->create(context,
                                                 color_image_create_info,
                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
@@ -409,7 +914,7 @@ static void createRasterizationImage(YsVkContext* context,
     depth_image_create_info->extent.height = height;
     depth_image_create_info->extent.depth = 1;
     depth_image_create_info->mipLevels = 1;
-    depth_image_create_info->arrayLayers = context->swapchain->image_count;
+    depth_image_create_info->arrayLayers = context->swapchain->max_frames_in_flight;
     depth_image_create_info->format = context->device->depth_format;
     depth_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     depth_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -420,6 +925,7 @@ static void createRasterizationImage(YsVkContext* context,
     depth_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
     depth_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     resource->rasterization_depth_image = yVkAllocateImageObject();
+    prepareGraphImage(resource, GRAPH_IMAGE_RASTERIZATION_DEPTH, resource->rasterization_depth_image);
     resource->rasterization_depth_image->create(context,
                                                 depth_image_create_info,
                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
@@ -427,73 +933,90 @@ static void createRasterizationImage(YsVkContext* context,
                                                 resource->rasterization_depth_image);
 }
 
-static void createRasterizationImageDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->rasterization_color_image_descriptor.set = 2;
-    resources->rasterization_color_image_descriptor.is_single_descriptor_set = false;
-
-    VkDescriptorSetLayoutBinding image_layout_binding;
-    image_layout_binding.binding = 0;
-    image_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_layout_binding.descriptorCount = 1;
-    image_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    image_layout_binding.pImmutableSamplers = NULL;
-    VkDescriptorSetLayoutCreateInfo image_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    image_layout_info.bindingCount = 1;
-    image_layout_info.pBindings = &image_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &image_layout_info,
-                                         context->allocator,
-                                         &resources->rasterization_color_image_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize image_pool_size;
-    image_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo image_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    image_pool_info.poolSizeCount = 1;
-    image_pool_info.pPoolSizes = &image_pool_size;
-    image_pool_info.maxSets = resources->rasterization_color_image->create_info->arrayLayers;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &image_pool_info,
-                                    context->allocator,
-                                    &resources->rasterization_color_image_descriptor.descriptor_pool));
-
-    VkDescriptorSetAllocateInfo image_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    image_alloc_info.descriptorPool = resources->rasterization_color_image_descriptor.descriptor_pool;
-    image_alloc_info.descriptorSetCount = resources->rasterization_color_image->create_info->arrayLayers;
-    VkDescriptorSetLayout set_layouts[image_alloc_info.descriptorSetCount] = {};
-    for(int i = 0; i < image_alloc_info.descriptorSetCount; ++i) {
-        set_layouts[i] = resources->rasterization_color_image_descriptor.descriptor_set_layout;
+static void updateRasterizationImageDescriptor(YsVkContext* context, YsVkResources* resource) {
+    for(int i = 0; i < resource->rasterization_color_image->create_info->arrayLayers; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_RASTERIZATION_COLOR,
+                         resource->rasterization_color_image->layer_views[i],
+                         resource->sampler_linear,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        // Only read while the Hi-Z pyramid is built, in between the rasterization render passes.
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_RASTERIZATION_DEPTH,
+                         resource->rasterization_depth_image->layer_views[i],
+                         resource->sampler_nearest,
+                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
     }
-    image_alloc_info.pSetLayouts = set_layouts;
-    resources->rasterization_color_image_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * image_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device,
-                                      &image_alloc_info,
-                                      resources->rasterization_color_image_descriptor.descriptor_sets));
 }
 
-static void updateRasterizationImageDescriptor(YsVkContext* context, YsVkResources* resource) {
-    for(int i = 0; i < resource->rasterization_color_image->create_info->arrayLayers; ++i) {
-        VkDescriptorImageInfo rasterization_image_info;
-        rasterization_image_info.sampler = resource->sampler_linear;
-        rasterization_image_info.imageView = resource->rasterization_color_image->layer_views[i];
-        rasterization_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+// Image Hi-Z
+static void createHiZImage(YsVkContext* context, 
+                           YsVkResources* resource,
+                           u32 width,
+                           u32 height) {
+    u32 level_count = 1;
+    while(((width > height ? width : height) >> level_count) > 0 && level_count < HI_Z_MAX_LEVEL_COUNT) {
+        ++level_count;
+    }
 
-        VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        write_descriptor_set.dstSet = resource->rasterization_color_image_descriptor.descriptor_sets[i];
-        write_descriptor_set.dstBinding = 0;
-        write_descriptor_set.dstArrayElement = 0;
-        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        write_descriptor_set.descriptorCount = 1;
-        write_descriptor_set.pImageInfo = &rasterization_image_info;
-        vkUpdateDescriptorSets(context->device->logical_device,
-                               1,
-                               &write_descriptor_set,
-                               0,
-                               NULL);
+    VkImageCreateInfo* hi_z_image_create_info = yCMemoryAllocate(sizeof(VkImageCreateInfo));
+    hi_z_image_create_info->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    hi_z_image_create_info->imageType = VK_IMAGE_TYPE_2D;
+    hi_z_image_create_info->extent.width = width;
+    hi_z_image_create_info->extent.height = height;
+    hi_z_image_create_info->extent.depth = 1;
+    hi_z_image_create_info->mipLevels = level_count;
+    hi_z_image_create_info->arrayLayers = 1;
+    hi_z_image_create_info->format = VK_FORMAT_R32_SFLOAT;
+    hi_z_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
+    hi_z_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    hi_z_image_create_info->usage = VK_IMAGE_USAGE_SAMPLED_BIT |
+                                    VK_IMAGE_USAGE_STORAGE_BIT |
+                                    VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    hi_z_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
+    hi_z_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    resource->hi_z_image = yVkAllocateImageObject();
+    resource->hi_z_image->create(context,
+                                 hi_z_image_create_info,
+                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 VK_IMAGE_ASPECT_COLOR_BIT,
+                                 resource->hi_z_image);
+}
+
+static void updateHiZImageDescriptor(YsVkContext* context, YsVkResources* resource) {
+    u32 level_count = resource->hi_z_image->create_info->mipLevels;
+    for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        for(u32 level = 0; level < HI_Z_MAX_LEVEL_COUNT; ++level) {
+            writeGlobalImage(context,
+                             resource,
+                             i,
+                             GLOBAL_BINDING_STORAGE_IMAGES,
+                             GLOBAL_STORAGE_IMAGE_HI_Z + level,
+                             level_count > 1 ? 
+                             resource->hi_z_image->level_views[level < level_count ? level : level_count - 1] : 
+                             resource->hi_z_image->image_view,
+                             VK_NULL_HANDLE,
+                             VK_IMAGE_LAYOUT_GENERAL);
+        }
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_HI_Z,
+                         resource->hi_z_image->image_view,
+                         resource->sampler_nearest,
+                         VK_IMAGE_LAYOUT_GENERAL);
     }
 }
 
 // Image Shadow Map
+// A single layer shared by the frames in flight, the cascades sit side by side in it.
 static void createShadowMapImage(YsVkContext* context, 
                                  YsVkResources* resource,
                                  u32 width,
@@ -505,7 +1028,7 @@ static void createShadowMapImage(YsVkContext* context,
     shadow_map_image_create_info->extent.height = height;
     shadow_map_image_create_info->extent.depth = 1;
     shadow_map_image_create_info->mipLevels = 1;
-    shadow_map_image_create_info->arrayLayers = context->swapchain->image_count;
+    shadow_map_image_create_info->arrayLayers = 1;
     shadow_map_image_create_info->format = context->device->depth_format;
     shadow_map_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     shadow_map_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -515,6 +1038,7 @@ static void createShadowMapImage(YsVkContext* context,
     shadow_map_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
     shadow_map_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     resource->shadow_map_image = yVkAllocateImageObject();
+    prepareGraphImage(resource, GRAPH_IMAGE_SHADOW_MAP, resource->shadow_map_image);
     resource->shadow_map_image->create(context,
                                        shadow_map_image_create_info,
                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
@@ -522,69 +1046,26 @@ static void createShadowMapImage(YsVkContext* context,
                                        resource->shadow_map_image);
 }
 
-static void createShadowMapImageDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->shadow_map_image_descriptor.set = 3;
-    resources->shadow_map_image_descriptor.is_single_descriptor_set = false;
-    
-    VkDescriptorSetLayoutBinding image_layout_binding;
-    image_layout_binding.binding = 0;
-    image_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_layout_binding.descriptorCount = 1;
-    image_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    image_layout_binding.pImmutableSamplers = NULL;
-    VkDescriptorSetLayoutCreateInfo image_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    image_layout_info.bindingCount = 1;
-    image_layout_info.pBindings = &image_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &image_layout_info,
-                                         context->allocator,
-                                         &resources->shadow_map_image_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize image_pool_size;
-    image_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo image_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    image_pool_info.poolSizeCount = 1;
-    image_pool_info.pPoolSizes = &image_pool_size;
-    image_pool_info.maxSets = resources->shadow_map_image->create_info->arrayLayers;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &image_pool_info,
-                                    context->allocator,
-                                    &resources->shadow_map_image_descriptor.descriptor_pool));
-
-    VkDescriptorSetAllocateInfo image_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    image_alloc_info.descriptorPool = resources->shadow_map_image_descriptor.descriptor_pool;
-    image_alloc_info.descriptorSetCount = resources->shadow_map_image->create_info->arrayLayers;
-    VkDescriptorSetLayout set_layouts[image_alloc_info.descriptorSetCount] = {};
-    for(int i = 0; i < image_alloc_info.descriptorSetCount; ++i) {
-        set_layouts[i] = resources->shadow_map_image_descriptor.descriptor_set_layout;
+static void updateShadowMapImageDescriptor(YsVkContext* context, YsVkResources* resource) {
+    for(int i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_SHADOW_MAP,
+                         resource->shadow_map_image->image_view,
+                         resource->sampler_linear,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
-    image_alloc_info.pSetLayouts = set_layouts;
-    resources->shadow_map_image_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * image_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device,
-                                      &image_alloc_info,
-                                      resources->shadow_map_image_descriptor.descriptor_sets));                                     
 }
 
-static void updateShadowMapImageDescriptor(YsVkContext* context, YsVkResources* resource) {
-    for(int i = 0; i < resource->shadow_map_image->create_info->arrayLayers; ++i) {
-        VkDescriptorImageInfo shadow_map_image_info;
-        shadow_map_image_info.sampler = resource->sampler_linear;
-        shadow_map_image_info.imageView = resource->shadow_map_image->layer_views[i];
-        shadow_map_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-        VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        write_descriptor_set.dstSet = resource->shadow_map_image_descriptor.descriptor_sets[i];
-        write_descriptor_set.dstBinding = 0;
-        write_descriptor_set.dstArrayElement = 0;
-        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        write_descriptor_set.descriptorCount = 1;
-        write_descriptor_set.pImageInfo = &shadow_map_image_info;
-        vkUpdateDescriptorSets(context->device->logical_device,
-                               1,
-                               &write_descriptor_set,
-                               0,
-                               0);
+// Images written by the upload queue or only used by path tracing are shared across queue families. The
+// per-frame path tracing image layers stay exclusive and change owner explicitly every frame.
+static void shareAcrossQueueFamilies(YsVkContext* context, VkImageCreateInfo* create_info) {
+    if (context->device->shared_queue_family_count > 1) {
+        create_info->sharingMode = VK_SHARING_MODE_CONCURRENT;
+        create_info->queueFamilyIndexCount = context->device->shared_queue_family_count;
+        create_info->pQueueFamilyIndices = context->device->shared_queue_family_indices;
     }
 }
 
@@ -609,6 +1090,7 @@ static void createRandomImage(YsVkContext* context,
                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     random_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
     random_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    shareAcrossQueueFamilies(context, random_image_create_info);
     resource->random_image = yVkAllocateImageObject();
     resource->random_image->create(context,
                                    random_image_create_info,
@@ -617,68 +1099,18 @@ static void createRandomImage(YsVkContext* context,
                                    resource->random_image);
 }
 
-static void createRandomImageDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->random_image_descriptor.set = 4;
-    resources->random_image_descriptor.is_single_descriptor_set = true;
-
-    VkDescriptorSetLayoutBinding image_layout_binding;
-    image_layout_binding.binding = 0;
-    image_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_layout_binding.descriptorCount = 1;
-    image_layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    image_layout_binding.pImmutableSamplers = NULL;
-    VkDescriptorSetLayoutCreateInfo image_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    image_layout_info.bindingCount = 1;
-    image_layout_info.pBindings = &image_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &image_layout_info,
-                                         context->allocator,
-                                         &resources->random_image_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize image_pool_size;
-    image_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo image_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    image_pool_info.poolSizeCount = 1;
-    image_pool_info.pPoolSizes = &image_pool_size;
-    image_pool_info.maxSets = resources->random_image->create_info->arrayLayers;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &image_pool_info,
-                                    context->allocator,
-                                    &resources->random_image_descriptor.descriptor_pool));
-
-    VkDescriptorSetAllocateInfo image_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    image_alloc_info.descriptorPool = resources->random_image_descriptor.descriptor_pool;
-    image_alloc_info.descriptorSetCount = resources->random_image->create_info->arrayLayers;
-    VkDescriptorSetLayout set_layouts[image_alloc_info.descriptorSetCount] = {};
-    for(int i = 0; i < image_alloc_info.descriptorSetCount; ++i) {
-        set_layouts[i] = resources->random_image_descriptor.descriptor_set_layout;
-    }
-    image_alloc_info.pSetLayouts = set_layouts;
-    resources->random_image_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * image_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device,
-                                      &image_alloc_info,
-                                      resources->random_image_descriptor.descriptor_sets));     
-}
-
 static void updateRandomImageDescriptor(YsVkContext* context, YsVkResources* resource) {
-    VkDescriptorImageInfo random_image_info;
-    random_image_info.sampler = resource->sampler_nearest;
-    random_image_info.imageView = resource->random_image->image_view;
-    random_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    
-    VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    write_descriptor_set.dstSet = resource->random_image_descriptor.descriptor_sets[0];
-    write_descriptor_set.dstBinding = 0;
-    write_descriptor_set.dstArrayElement = 0;
-    write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    write_descriptor_set.descriptorCount = 1;
-    write_descriptor_set.pImageInfo = &random_image_info;
-    vkUpdateDescriptorSets(context->device->logical_device,
-                           1,
-                           &write_descriptor_set,
-                           0,
-                           0);
+    // A single layer shared by all frames, written into every global set.
+    for(u32 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_RANDOM,
+                         resource->random_image->image_view,
+                         resource->sampler_nearest,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
 }
 
 // Image Path Tracing
@@ -694,80 +1126,86 @@ static void createPathTracingImage(YsVkContext* context,
     path_tracing_image_create_info->extent.height = height;
     path_tracing_image_create_info->extent.depth = 1;
     path_tracing_image_create_info->mipLevels = 1;
-    path_tracing_image_create_info->arrayLayers = context->swapchain->image_count;
+    path_tracing_image_create_info->arrayLayers = context->swapchain->max_frames_in_flight;
     path_tracing_image_create_info->format = VK_FORMAT_R32G32B32A32_SFLOAT;
     path_tracing_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     path_tracing_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     path_tracing_image_create_info->usage = VK_IMAGE_USAGE_SAMPLED_BIT |
-                                            VK_IMAGE_USAGE_STORAGE_BIT;
+                                            VK_IMAGE_USAGE_STORAGE_BIT |
+                                            VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     path_tracing_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
     path_tracing_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     resource->path_tracing_image = yVkAllocateImageObject();
+    prepareGraphImage(resource, GRAPH_IMAGE_PATH_TRACING, resource->path_tracing_image);
     resource->path_tracing_image->create(context,
                                          path_tracing_image_create_info,
                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                          VK_IMAGE_ASPECT_COLOR_BIT,
                                          resource->path_tracing_image);
-}
 
-static void createPathTracingImageComputeStorageDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->path_tracing_image_compute_storage_descriptor.set = 5;
-    resources->path_tracing_image_compute_storage_descriptor.is_single_descriptor_set = false;
-    
-    VkDescriptorSetLayoutBinding image_layout_binding;
-    image_layout_binding.binding = 0;
-    image_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    image_layout_binding.descriptorCount = 1;
-    image_layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    image_layout_binding.pImmutableSamplers = NULL;
-    VkDescriptorSetLayoutCreateInfo image_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    image_layout_info.bindingCount = 1;
-    image_layout_info.pBindings = &image_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &image_layout_info,
-                                         context->allocator,
-                                         &resources->path_tracing_image_compute_storage_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize image_pool_size;
-    image_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    image_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo image_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    image_pool_info.poolSizeCount = 1;
-    image_pool_info.pPoolSizes = &image_pool_size;
-    image_pool_info.maxSets = resources->path_tracing_image->create_info->arrayLayers;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &image_pool_info,
-                                    context->allocator,
-                                    &resources->path_tracing_image_compute_storage_descriptor.descriptor_pool));
+    // Running mean in rgb and sample count in alpha, shared by all frames in flight.
+    VkImageCreateInfo* path_tracing_accumulation_image_create_info = yCMemoryAllocate(sizeof(VkImageCreateInfo));
+    *path_tracing_accumulation_image_create_info = *path_tracing_image_create_info;
+    path_tracing_accumulation_image_create_info->arrayLayers = 1;
+    path_tracing_accumulation_image_create_info->usage = VK_IMAGE_USAGE_STORAGE_BIT |
+                                                         VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    shareAcrossQueueFamilies(context, path_tracing_accumulation_image_create_info);
+    resource->path_tracing_accumulation_image = yVkAllocateImageObject();
+    resource->path_tracing_accumulation_image->create(context,
+                                                      path_tracing_accumulation_image_create_info,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                                      resource->path_tracing_accumulation_image);
+}
 
-    VkDescriptorSetAllocateInfo image_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    image_alloc_info.descriptorPool = resources->path_tracing_image_compute_storage_descriptor.descriptor_pool;
-    image_alloc_info.descriptorSetCount = resources->path_tracing_image->create_info->arrayLayers;
-    VkDescriptorSetLayout set_layouts[image_alloc_info.descriptorSetCount] = {};
-    for(int i = 0; i < image_alloc_info.descriptorSetCount; ++i) {
-        set_layouts[i] = resources->path_tracing_image_compute_storage_descriptor.descriptor_set_layout;
+static void createPathTracingStatisticsBuffer(YsVkContext* context, YsVkResources* resource) {
+    u64 alignment = context->device->properties.limits.minStorageBufferOffsetAlignment;
+    resource->path_tracing_statistics_slice_size = (sizeof(u32) * 2 * PATH_TRACING_COUNTER_COUNT + alignment - 1) & ~(alignment - 1);
+
+    // Written by whichever queue traces, so it is shared like the UBO.
+    resource->path_tracing_statistics_buffer = yVkAllocateBufferObject();
+    resource->path_tracing_statistics_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
+    resource->path_tracing_statistics_buffer->is_concurrent = true;
+    if (!resource->path_tracing_statistics_buffer->create(context,
+                                                          resource->path_tracing_statistics_slice_size * resource->path_tracing_image->create_info->arrayLayers,
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                          resource->path_tracing_statistics_buffer)) {
+        YERROR("Error creating path tracing statistics buffer.");
     }
-    image_alloc_info.pSetLayouts = set_layouts;
-    resources->path_tracing_image_compute_storage_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * image_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device,
-                                      &image_alloc_info,
-                                      resources->path_tracing_image_compute_storage_descriptor.descriptor_sets));        
 }
 
 static void updatePathTracingImageComputeStorageDescriptor(YsVkContext* context, YsVkResources* resource) {
     for(int i = 0; i <resource->path_tracing_image->create_info->arrayLayers; ++i) {
-        VkDescriptorImageInfo path_tracing_image_info;
-        path_tracing_image_info.sampler = resource->sampler_linear;
-        path_tracing_image_info.imageView = resource->path_tracing_image->layer_views[i];
-        path_tracing_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_STORAGE_IMAGES,
+                         GLOBAL_STORAGE_IMAGE_PATH_TRACING,
+                         resource->path_tracing_image->layer_views[i],
+                         VK_NULL_HANDLE,
+                         VK_IMAGE_LAYOUT_GENERAL);
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_STORAGE_IMAGES,
+                         GLOBAL_STORAGE_IMAGE_PATH_TRACING_ACCUMULATION,
+                         resource->path_tracing_accumulation_image->image_view,
+                         VK_NULL_HANDLE,
+                         VK_IMAGE_LAYOUT_GENERAL);
+    
+        VkDescriptorBufferInfo path_tracing_statistics_buffer_info;
+        path_tracing_statistics_buffer_info.buffer = resource->path_tracing_statistics_buffer->handle;
+        path_tracing_statistics_buffer_info.offset = resource->path_tracing_statistics_slice_size * i;
+        path_tracing_statistics_buffer_info.range = sizeof(u32) * 2 * PATH_TRACING_COUNTER_COUNT;
     
         VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        write_descriptor_set.dstSet = resource->path_tracing_image_compute_storage_descriptor.descriptor_sets[i];
-        write_descriptor_set.dstBinding = 0;
+        write_descriptor_set.dstSet = resource->global_descriptor.descriptor_sets[i];
+        write_descriptor_set.dstBinding = GLOBAL_BINDING_PATH_TRACING_STATISTICS;
         write_descriptor_set.dstArrayElement = 0;
-        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         write_descriptor_set.descriptorCount = 1;
-        write_descriptor_set.pImageInfo = &path_tracing_image_info;
+        write_descriptor_set.pBufferInfo = &path_tracing_statistics_buffer_info;
         vkUpdateDescriptorSets(context->device->logical_device,
                                1,
                                &write_descriptor_set,
@@ -776,84 +1214,192 @@ static void updatePathTracingImageComputeStorageDescriptor(YsVkContext* context,
     }
 }
 
-static void createPathTracingImageFragmentSampledDescriptor(YsVkContext* context, YsVkResources* resources) {
-    resources->path_tracing_image_fragment_sampled_descriptor.set = 6;
-    resources->path_tracing_image_fragment_sampled_descriptor.is_single_descriptor_set = false;
-    
-    VkDescriptorSetLayoutBinding image_layout_binding;
-    image_layout_binding.binding = 0;
-    image_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_layout_binding.descriptorCount = 1;
-    image_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    image_layout_binding.pImmutableSamplers = NULL;
-    VkDescriptorSetLayoutCreateInfo image_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    image_layout_info.bindingCount = 1;
-    image_layout_info.pBindings = &image_layout_binding;
-    VK_CHECK(vkCreateDescriptorSetLayout(context->device->logical_device,
-                                         &image_layout_info,
-                                         context->allocator,
-                                         &resources->path_tracing_image_fragment_sampled_descriptor.descriptor_set_layout));
-
-    VkDescriptorPoolSize image_pool_size;
-    image_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    image_pool_size.descriptorCount = 1;
-    VkDescriptorPoolCreateInfo image_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    image_pool_info.poolSizeCount = 1;
-    image_pool_info.pPoolSizes = &image_pool_size;
-    image_pool_info.maxSets = resources->path_tracing_image->create_info->arrayLayers;
-    VK_CHECK(vkCreateDescriptorPool(context->device->logical_device,
-                                    &image_pool_info,
-                                    context->allocator,
-                                    &resources->path_tracing_image_fragment_sampled_descriptor.descriptor_pool));
-
-    VkDescriptorSetAllocateInfo image_alloc_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    image_alloc_info.descriptorPool = resources->path_tracing_image_fragment_sampled_descriptor.descriptor_pool;
-    image_alloc_info.descriptorSetCount = resources->path_tracing_image->create_info->arrayLayers;
-    VkDescriptorSetLayout set_layouts[image_alloc_info.descriptorSetCount] = {};
-    for(int i = 0; i < image_alloc_info.descriptorSetCount; ++i) {
-        set_layouts[i] = resources->path_tracing_image_fragment_sampled_descriptor.descriptor_set_layout;
+static void updatePathTracingImageFragmentSampledDescriptor(YsVkContext* context, YsVkResources* resource) {
+    for(int i = 0; i <resource->path_tracing_image->create_info->arrayLayers; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_PATH_TRACING,
+                         resource->path_tracing_image->layer_views[i],
+                         resource->sampler_linear,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
-    image_alloc_info.pSetLayouts = set_layouts;
-    resources->path_tracing_image_fragment_sampled_descriptor.descriptor_sets = yCMemoryAllocate(sizeof(VkDescriptorSet) * image_alloc_info.descriptorSetCount);
-    VK_CHECK(vkAllocateDescriptorSets(context->device->logical_device,
-                                      &image_alloc_info,
-                                      resources->path_tracing_image_fragment_sampled_descriptor.descriptor_sets)); 
 }
 
-static void updatePathTracingImageFragmentSampledDescriptor(YsVkContext* context, YsVkResources* resource) {
-    for(int i = 0; i <resource->path_tracing_image->create_info->arrayLayers; ++i) {
-         VkDescriptorImageInfo path_tracing_image_info;
-        path_tracing_image_info.sampler = resource->sampler_linear;
-        path_tracing_image_info.imageView = resource->path_tracing_image->layer_views[i];
-        path_tracing_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+// Image Upscaling
+static void createUpscalingImage(YsVkContext* context, 
+                                 YsVkResources* resource,
+                                 u32 width,
+                                 u32 height) {
+    VkImageCreateInfo* upscaling_image_create_info = yCMemoryAllocate(sizeof(VkImageCreateInfo));
+    upscaling_image_create_info->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    upscaling_image_create_info->imageType = VK_IMAGE_TYPE_2D;
+    upscaling_image_create_info->extent.width = width;
+    upscaling_image_create_info->extent.height = height;
+    upscaling_image_create_info->extent.depth = 1;
+    upscaling_image_create_info->mipLevels = 1;
+    upscaling_image_create_info->arrayLayers = context->swapchain->max_frames_in_flight;
+    upscaling_image_create_info->format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    upscaling_image_create_info->tiling = VK_IMAGE_TILING_OPTIMAL;
+    upscaling_image_create_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    upscaling_image_create_info->usage = VK_IMAGE_USAGE_SAMPLED_BIT |
+                                         VK_IMAGE_USAGE_STORAGE_BIT;
+    upscaling_image_create_info->samples = VK_SAMPLE_COUNT_1_BIT;
+    upscaling_image_create_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    resource->upscaling_image = yVkAllocateImageObject();
+    prepareGraphImage(resource, GRAPH_IMAGE_UPSCALING, resource->upscaling_image);
+    resource->upscaling_image->create(context,
+                                      upscaling_image_create_info,
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                      VK_IMAGE_ASPECT_COLOR_BIT,
+                                      resource->upscaling_image);
+}
 
-        VkWriteDescriptorSet write_descriptor_set = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        write_descriptor_set.dstSet = resource->path_tracing_image_fragment_sampled_descriptor.descriptor_sets[i];
-        write_descriptor_set.dstBinding = 0;
-        write_descriptor_set.dstArrayElement = 0;
-        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        write_descriptor_set.descriptorCount = 1;
-        write_descriptor_set.pImageInfo = &path_tracing_image_info;
-        vkUpdateDescriptorSets(context->device->logical_device,
-                               1,
-                               &write_descriptor_set,
-                               0,
-                               0);
+static void updateUpscalingImageDescriptor(YsVkContext* context, YsVkResources* resource) {
+    for(int i = 0; i < resource->upscaling_image->create_info->arrayLayers; ++i) {
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_STORAGE_IMAGES,
+                         GLOBAL_STORAGE_IMAGE_UPSCALING,
+                         resource->upscaling_image->layer_views[i],
+                         VK_NULL_HANDLE,
+                         VK_IMAGE_LAYOUT_GENERAL);
+        writeGlobalImage(context,
+                         resource,
+                         i,
+                         GLOBAL_BINDING_TEXTURES,
+                         GLOBAL_TEXTURE_UPSCALING,
+                         resource->upscaling_image->layer_views[i],
+                         resource->sampler_linear,
+                         VK_IMAGE_LAYOUT_GENERAL);
     }
 }
 
+// The random image is seeded once per size, the path tracing and upscaling images start out in the layouts the graph
+// expects.
+static void uploadRandomImageData(YsVkContext* context, YsVkResources* resource) {
+    u32 pixel_count = resource->random_image->create_info->extent.width * resource->random_image->create_info->extent.height;
+    u32* rand_data = yCMemoryAllocate(sizeof(u32) * pixel_count);
+    yGenerateUintRand(pixel_count, rand_data);
+    if(context->upload_queue) {
+        // The first frames wait on the timeline instead of the host waiting for the copy.
+        context->upload_queue->begin(context, context->upload_queue);
+        context->upload_queue->uploadImage(context,
+                                           sizeof(u32) * pixel_count,
+                                           rand_data,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                           resource->random_image,
+                                           context->upload_queue);
+        resource->upload_wait_value = context->upload_queue->submit(context, context->upload_queue);
+    } else {
+        resource->random_image->updatImageData(context,
+                                               context->device->commandUnitsFront(context->device),
+                                               sizeof(u32) * pixel_count,
+                                               rand_data,
+                                               resource->random_image);
+    }
+    yCMemoryFree(rand_data);
+}
+
+static void transitionInitialImageLayouts(YsVkContext* context, YsVkResources* resource) {
+    vkQueueWaitIdle(context->device->commandUnitsFront(context->device)->queue);
+    VkCommandBuffer temp_command_buffer;
+    context->device->commandBufferAllocateAndBeginSingleUse(context,
+                                                            context->device->commandUnitsFront(context->device),
+                                                            &temp_command_buffer);
+
+    resource->path_tracing_image->transitionLayout(temp_command_buffer,
+                                                   0,
+                                                   resource->path_tracing_image->create_info->arrayLayers,
+                                                   VK_IMAGE_LAYOUT_UNDEFINED,
+                                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                   VK_ACCESS_NONE,
+                                                   VK_ACCESS_NONE,
+                                                   context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                   context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                   resource->path_tracing_image);
+
+    resource->path_tracing_accumulation_image->transitionLayout(temp_command_buffer,
+                                                                0,
+                                                                1,
+                                                                VK_IMAGE_LAYOUT_UNDEFINED,
+                                                                VK_IMAGE_LAYOUT_GENERAL,
+                                                                VK_ACCESS_NONE,
+                                                                VK_ACCESS_NONE,
+                                                                context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                                context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                                resource->path_tracing_accumulation_image);
+
+    resource->upscaling_image->transitionLayout(temp_command_buffer,
+                                                0,
+                                                resource->upscaling_image->create_info->arrayLayers,
+                                                VK_IMAGE_LAYOUT_UNDEFINED,
+                                                VK_IMAGE_LAYOUT_GENERAL,
+                                                VK_ACCESS_NONE,
+                                                VK_ACCESS_NONE,
+                                                context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                context->device->commandUnitsFront(context->device)->queue_family_index,
+                                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                resource->upscaling_image);
+
+    // Cleared to the far plane, nothing is occluded until the pyramid is first built.
+    resource->hi_z_image->transitionLayout(temp_command_buffer,
+                                           0,
+                                           1,
+                                           VK_IMAGE_LAYOUT_UNDEFINED,
+                                           VK_IMAGE_LAYOUT_GENERAL,
+                                           VK_ACCESS_NONE,
+                                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           context->device->commandUnitsFront(context->device)->queue_family_index,
+                                           context->device->commandUnitsFront(context->device)->queue_family_index,
+                                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                           resource->hi_z_image);
+    VkClearColorValue far_depth = {{1.0f, 0.0f, 0.0f, 0.0f}};
+    VkImageSubresourceRange hi_z_range = {VK_IMAGE_ASPECT_COLOR_BIT};
+    hi_z_range.baseMipLevel = 0;
+    hi_z_range.levelCount = resource->hi_z_image->create_info->mipLevels;
+    hi_z_range.baseArrayLayer = 0;
+    hi_z_range.layerCount = 1;
+    vkCmdClearColorImage(temp_command_buffer,
+                         resource->hi_z_image->handle,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         &far_depth,
+                         1,
+                         &hi_z_range);
+
+    context->device->commandBufferEndSingleUse(context,
+                                               context->device->commandUnitsFront(context->device),
+                                               &temp_command_buffer);
+}
+
 //
 static void initialize(YsVkContext* context, 
                        YsVkResources* resource,
                        struct YsVkResourcesImageSize image_size) {
+    resource->command_generation = 1;
+
+    // Staging
+    createStagingBuffer(context, resource);
+
     // Vertex
     createVertexInputDescription(context, resource);
 
-    // SSBO
-    createSsboDescriptor(context, resource); 
+    // Descriptor
+    createGlobalDescriptor(context, resource); 
     
     // UBO
     createUbo(context, resource);
+
+    // Draw
+    createDrawCommand(context, resource);
     
     // Push Constant
     createPushConstants(resource);
@@ -865,76 +1411,134 @@ static void initialize(YsVkContext* context,
                              resource,
                              image_size.rasterization_image_width,
                              image_size.rasterization_image_height);
-    createRasterizationImageDescriptor(context, resource);
     updateRasterizationImageDescriptor(context, resource);
 
+    createHiZImage(context, 
+                   resource,
+                   image_size.rasterization_image_width,
+                   image_size.rasterization_image_height);
+    updateHiZImageDescriptor(context, resource);
+
     createShadowMapImage(context, 
                          resource,
                          image_size.shadow_map_image_width,
                          image_size.shadow_map_image_height);
-    createShadowMapImageDescriptor(context, resource);
     updateShadowMapImageDescriptor(context, resource);
 
     createRandomImage(context, 
                       resource,
                       image_size.random_image_width,
                       image_size.random_image_height);
-    createRandomImageDescriptor(context, resource);
     updateRandomImageDescriptor(context, resource);
 
     createPathTracingImage(context, 
                            resource,
                            image_size.path_tracing_image_width,
                            image_size.path_tracing_image_height);
-    createPathTracingImageComputeStorageDescriptor(context, resource);
+    createPathTracingStatisticsBuffer(context, resource);
     updatePathTracingImageComputeStorageDescriptor(context, resource);
-    createPathTracingImageFragmentSampledDescriptor(context, resource);
     updatePathTracingImageFragmentSampledDescriptor(context, resource);
 
+    createUpscalingImage(context, 
+                         resource,
+                         image_size.upscaling_image_width,
+                         image_size.upscaling_image_height);
+    updateUpscalingImageDescriptor(context, resource);
+
     //
-    u32 pixel_count = resource->random_image->create_info->extent.width * resource->random_image->create_info->extent.height;
-    u32* rand_data = yCMemoryAllocate(sizeof(u32) * pixel_count);
-    yGenerateUintRand(pixel_count, rand_data);
-    resource->random_image->updatImageData(context,
-                                           context->device->commandUnitsFront(context->device),
-                                           sizeof(u32) * pixel_count,
-                                           rand_data,
-                                           resource->random_image);
+    uploadRandomImageData(context, resource);
+    transitionInitialImageLayouts(context, resource);
+
+    bindGraphImages(resource);
+}
+
+static void destroyImageObject(YsVkContext* context, YsVkImage** image) {
+    if(!*image) {
+        return;
+    }
+
+    (*image)->destroy(context, *image);
+    yCMemoryFree((*image)->create_info);
+    yCMemoryFree(*image);
+    *image = NULL;
+}
+
+// The device is idle. The global sets are kept since pipeline configs hold copies of them, only their writes change.
+static void resize(YsVkContext* context,
+                   YsVkResources* resource,
+                   struct YsVkResourcesImageSize image_size) {
+    // Images that alias memory go before the image they borrow it from.
+    destroyImageObject(context, &resource->upscaling_image);
+    destroyImageObject(context, &resource->path_tracing_accumulation_image);
+    destroyImageObject(context, &resource->path_tracing_image);
+    destroyImageObject(context, &resource->random_image);
+    destroyImageObject(context, &resource->shadow_map_image);
+    destroyImageObject(context, &resource->hi_z_image);
+    destroyImageObject(context, &resource->rasterization_depth_image);
+    destroyImageObject(context, &resource->rasterization_color_image);
+
+    createRasterizationImage(context, 
+                             resource,
+                             image_size.rasterization_image_width,
+                             image_size.rasterization_image_height);
+    updateRasterizationImageDescriptor(context, resource);
+
+    createHiZImage(context, 
+                   resource,
+                   image_size.rasterization_image_width,
+                   image_size.rasterization_image_height);
+    updateHiZImageDescriptor(context, resource);
+
+    createShadowMapImage(context, 
+                         resource,
+                         image_size.shadow_map_image_width,
+                         image_size.shadow_map_image_height);
+    updateShadowMapImageDescriptor(context, resource);
+
+    createRandomImage(context, 
+                      resource,
+                      image_size.random_image_width,
+                      image_size.random_image_height);
+    updateRandomImageDescriptor(context, resource);
+
+    createPathTracingImage(context, 
+                           resource,
+                           image_size.path_tracing_image_width,
+                           image_size.path_tracing_image_height);
+    updatePathTracingImageComputeStorageDescriptor(context, resource);
+    updatePathTracingImageFragmentSampledDescriptor(context, resource);
+
+    createUpscalingImage(context, 
+                         resource,
+                         image_size.upscaling_image_width,
+                         image_size.upscaling_image_height);
+    updateUpscalingImageDescriptor(context, resource);
 
     //
-    vkQueueWaitIdle(context->device->commandUnitsFront(context->device)->queue);
-    VkCommandBuffer temp_command_buffer;
-    context->device->commandBufferAllocateAndBeginSingleUse(context,
-                                                            context->device->commandUnitsFront(context->device),
-                                                            &temp_command_buffer);
+    uploadRandomImageData(context, resource);
+    transitionInitialImageLayouts(context, resource);
 
-    resource->path_tracing_image->transitionLayout(temp_command_buffer,
-                                                   0,
-                                                   resource->path_tracing_image->create_info->arrayLayers,
-                                                   VK_IMAGE_LAYOUT_UNDEFINED,
-                                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                   VK_ACCESS_NONE,
-                                                   VK_ACCESS_NONE,
-                                                   context->device->commandUnitsFront(context->device)->queue_family_index,
-                                                   context->device->commandUnitsFront(context->device)->queue_family_index,
-                                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                   resource->path_tracing_image);
+    bindGraphImages(resource);
 
-    context->device->commandBufferEndSingleUse(context,
-                                               context->device->commandUnitsFront(context->device),
-                                               &temp_command_buffer);                                                                                               
+    ++resource->command_generation;
 }
 
 YsVkResources* yVkAllocateResourcesObject() {
     YsVkResources* vk_resources = yCMemoryAllocate(sizeof(YsVkResources));
     if(vk_resources) {
         vk_resources->initialize = initialize;
+        vk_resources->resize = resize;
+        vk_resources->vertexInputBufferFits = vertexInputBufferFits;
         vk_resources->createVertexInputBuffer = createVertexInputBuffer;
         vk_resources->updateVertexInputBuffer = updateVertexInputBuffer;
+        vk_resources->ssboFits = ssboFits;
         vk_resources->createSsbo = createSsbo;
         vk_resources->updateSsboBuffer = updateSsboBuffer;
         vk_resources->updateUboBuffer = updateUboBuffer;
+        vk_resources->uploadVertexInputBuffer = uploadVertexInputBuffer;
+        vk_resources->uploadSsbo = uploadSsbo;
+        vk_resources->beginFrame = beginFrame;
+        vk_resources->registerTexture = registerTexture;
     }
     return vk_resources;
 }
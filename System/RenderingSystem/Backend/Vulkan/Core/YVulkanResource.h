@@ -34,6 +34,112 @@ extern "C" {
 #endif
 
 
+typedef enum YeVkSsboBinding {
+    SSBO_BINDING_SCENE_INFO = 0,
+    SSBO_BINDING_BVH_NODE,
+    SSBO_BINDING_MATERIAL,
+    SSBO_BINDING_VERTEX_POSITION,
+    SSBO_BINDING_VERTEX_NORMAL,
+    SSBO_BINDING_VERTEX_MATERIAL_ID,
+    SSBO_BINDING_VERTEX_ENTITY_ID,
+    SSBO_BINDING_COUNT
+} YeVkSsboBinding;
+
+// Bindings of the global descriptor set, the only set a pipeline binds. The SSBO bindings come first.
+typedef enum YeVkGlobalBinding {
+    GLOBAL_BINDING_UBO = SSBO_BINDING_COUNT,
+    GLOBAL_BINDING_PATH_TRACING_STATISTICS,
+    GLOBAL_BINDING_STORAGE_IMAGES,
+    GLOBAL_BINDING_DRAW_RECORDS,
+    GLOBAL_BINDING_DRAW_COMMANDS,
+    // Variable sized, has to stay the last binding.
+    GLOBAL_BINDING_TEXTURES,
+    GLOBAL_BINDING_COUNT
+} YeVkGlobalBinding;
+
+#define HI_Z_MAX_LEVEL_COUNT 16
+
+// Handles into the storage image array of the global set.
+typedef enum YeVkGlobalStorageImage {
+    GLOBAL_STORAGE_IMAGE_PATH_TRACING = 0,
+    GLOBAL_STORAGE_IMAGE_PATH_TRACING_ACCUMULATION,
+    // One handle per level of the Hi-Z pyramid, levels the pyramid does not have repeat its last one.
+    GLOBAL_STORAGE_IMAGE_HI_Z,
+    GLOBAL_STORAGE_IMAGE_UPSCALING = GLOBAL_STORAGE_IMAGE_HI_Z + HI_Z_MAX_LEVEL_COUNT,
+    GLOBAL_STORAGE_IMAGE_COUNT
+} YeVkGlobalStorageImage;
+
+// Handles into the texture array of the global set, registered textures are handed out after these.
+typedef enum YeVkGlobalTexture {
+    GLOBAL_TEXTURE_RASTERIZATION_COLOR = 0,
+    GLOBAL_TEXTURE_SHADOW_MAP,
+    GLOBAL_TEXTURE_RANDOM,
+    GLOBAL_TEXTURE_PATH_TRACING,
+    GLOBAL_TEXTURE_RASTERIZATION_DEPTH,
+    GLOBAL_TEXTURE_HI_Z,
+    GLOBAL_TEXTURE_UPSCALING,
+    GLOBAL_TEXTURE_BUILTIN_COUNT
+} YeVkGlobalTexture;
+
+#define GLOBAL_TEXTURE_CAPACITY 1024
+#define GLOBAL_TEXTURE_INVALID (~0u)
+
+// Views the culling pass writes a compacted list of indirect draws for. The camera is drawn in two phases, the
+// late one draws the records the early one found occluded by the previous Hi-Z pyramid and that are visible in
+// the pyramid rebuilt from the early draws.
+typedef enum YeVkDrawView {
+    DRAW_VIEW_CAMERA = 0,
+    DRAW_VIEW_LIGHT,
+    DRAW_VIEW_CAMERA_LATE,
+    DRAW_VIEW_COUNT
+} YeVkDrawView;
+
+// Words of the header that starts every view region, the draws follow it.
+typedef enum YeVkDrawCommandHeader {
+    DRAW_COMMAND_HEADER_DRAW_COUNT = 0,
+    DRAW_COMMAND_HEADER_RECORD_COUNT,
+    DRAW_COMMAND_HEADER_FRUSTUM_CULLED_COUNT,
+    DRAW_COMMAND_HEADER_OCCLUDED_COUNT,
+    DRAW_COMMAND_HEADER_WORD_COUNT
+} YeVkDrawCommandHeader;
+
+// Records the draw command buffer is created for, it grows with the scene.
+#define DRAW_RECORD_INITIAL_CAPACITY 4096
+#define DRAW_COMMAND_HEADER_SIZE (sizeof(u32) * DRAW_COMMAND_HEADER_WORD_COUNT)
+#define DRAW_COMMAND_VIEW_SIZE(capacity) (DRAW_COMMAND_HEADER_SIZE + sizeof(VkDrawIndirectCommand) * (capacity))
+// The view regions are followed by one word per record, set by the early camera phase for the late one.
+#define DRAW_COMMAND_SLICE_SIZE(capacity) (DRAW_COMMAND_VIEW_SIZE(capacity) * DRAW_VIEW_COUNT + sizeof(u32) * (capacity))
+
+// Byte offset of the cascade the shadow mapping pass draws in GLSL_PushConstantObject.
+#define PUSH_CONSTANT_SHADOW_MAP_CASCADE_OFFSET (sizeof(i32) * 3)
+// Byte offset of the record capacity and view stride the culling pass indexes the draw command slice with.
+#define PUSH_CONSTANT_DRAW_COMMAND_LAYOUT_OFFSET (sizeof(i32) * 4)
+#define PUSH_CONSTANT_DRAW_COMMAND_LAYOUT_SIZE (sizeof(i32) * 2)
+
+// Images declared to the render graph, in creation order so an image only aliases memory that already exists.
+typedef enum YeVkGraphImage {
+    GRAPH_IMAGE_RASTERIZATION_COLOR = 0,
+    GRAPH_IMAGE_RASTERIZATION_DEPTH,
+    GRAPH_IMAGE_SHADOW_MAP,
+    GRAPH_IMAGE_PATH_TRACING,
+    GRAPH_IMAGE_PATH_TRACING_ACCUMULATION,
+    GRAPH_IMAGE_UPSCALING,
+    GRAPH_IMAGE_COUNT
+} YeVkGraphImage;
+
+// Counters path_tracing.comp adds to when statistics are collected, each one a low and a high u32 word.
+typedef enum YeVkPathTracingCounter {
+    PATH_TRACING_COUNTER_RAY = 0,
+    PATH_TRACING_COUNTER_NODE,
+    PATH_TRACING_COUNTER_TRIANGLE,
+    PATH_TRACING_COUNTER_COUNT
+} YeVkPathTracingCounter;
+
+struct YsVkResourcesSsboData {
+    u64 sizes[SSBO_BINDING_COUNT];
+    void* data[SSBO_BINDING_COUNT];
+};
+
 struct YsVkResourcesImageSize {
     u32 rasterization_image_width;
     u32 rasterization_image_height;
@@ -46,6 +152,10 @@ struct YsVkResourcesImageSize {
 
     u32 path_tracing_image_width;
     u32 path_tracing_image_height;
+
+    // The display size, the other color images are rendered at the render scale.
+    u32 upscaling_image_width;
+    u32 upscaling_image_height;
 };
 
 typedef struct YsVkResources {
@@ -54,32 +164,83 @@ typedef struct YsVkResources {
                        struct YsVkResources* resource,
                        struct YsVkResourcesImageSize image_size);
 
+    // Recreates every size dependent image and rewrites the descriptor sets that reference them.
+    void (*resize)(struct YsVkContext* context, 
+                   struct YsVkResources* resource,
+                   struct YsVkResourcesImageSize image_size);
+
     // Vertex
+    b8 (*vertexInputBufferFits)(struct YsVkResources* resource, u32 vertex_count, u32 draw_record_count);
+
     void (*createVertexInputBuffer)(struct YsVkContext* context,
                                    struct YsVkResources* resource,
-                                   u32 vertex_count);
+                                   u32 vertex_count,
+                                   u32 draw_record_count);
 
     void (*updateVertexInputBuffer)(struct YsVkContext* context,
                                     struct YsVkResources* resource,
-                                    struct YsVkCommandUnit* command_unit,
                                     void* vertex_position_data,
                                     void* vertex_normal_data,
-                                    void* vertex_material_id_data);
+                                    void* vertex_material_id_data,
+                                    void* draw_record_data);
     // SSBO
+    b8 (*ssboFits)(struct YsVkResources* resource, struct YsVkResourcesSsboData* ssbo_data);
+
     void (*createSsbo)(struct YsVkContext* context,
                        struct YsVkResources* resource,
-                       u32 data_size);
+                       struct YsVkResourcesSsboData* ssbo_data);
 
     void (*updateSsboBuffer)(struct YsVkContext* context,
                              struct YsVkResources* resource,
-                             struct YsVkCommandUnit* command_unit,
-                             void* data);
+                             struct YsVkResourcesSsboData* ssbo_data);
 
     // UBO
     void (*updateUboBuffer)(struct YsVkContext* context,
                             struct YsVkResources* resource,
+                            u32 frame_index,
                             void* data);
 
+    // Upload Queue
+    void (*uploadVertexInputBuffer)(struct YsVkContext* context,
+                                    struct YsVkResources* resource,
+                                    u32 vertex_count,
+                                    void* vertex_position_data,
+                                    void* vertex_normal_data,
+                                    void* vertex_material_id_data,
+                                    u32 draw_record_count,
+                                    void* draw_record_data);
+
+    void (*uploadSsbo)(struct YsVkContext* context,
+                       struct YsVkResources* resource,
+                       struct YsVkResourcesSsboData* ssbo_data);
+
+    // Called once the fence of frame_index has been waited on. Returns true when a finished upload was swapped in.
+    b8 (*beginFrame)(struct YsVkContext* context,
+                     struct YsVkResources* resource,
+                     u32 frame_index);
+
+    // Texture, writes the view into the texture array of every global set and returns its handle, or
+    // GLOBAL_TEXTURE_INVALID once the array is full. Neither a new set nor a new pipeline layout is needed.
+    u32 (*registerTexture)(struct YsVkContext* context,
+                           struct YsVkResources* resource,
+                           VkImageView image_view,
+                           VkSampler sampler,
+                           VkImageLayout image_layout);
+
+    // Render Graph, planned before initialize so transient images are created in aliased memory. May be NULL.
+    struct YsVkRenderGraph* render_graph;
+
+    // Bumped whenever a buffer or descriptor set that recorded draw commands reference changes, cached
+    // secondary command buffers of an older generation are re-recorded.
+    u64 command_generation;
+
+    // Staging
+    struct YsVkStagingBuffer* staging_buffer;
+
+    // Descriptor, one global set per frame in flight holding every buffer and image the shaders access.
+    YsVkDescriptor global_descriptor;
+    u32 global_texture_count;
+
     // Vertex
     u32 current_draw_vertex_count;
 
@@ -95,13 +256,48 @@ typedef struct YsVkResources {
     VkVertexInputBindingDescription vertex_material_id_binding_description;
     VkVertexInputAttributeDescription vertex_material_id_attribute_description;
 
+    // Draw, the records of the current scene and one slice of indirect draws per frame in flight.
+    u32 current_draw_record_count;
+    struct YsVkBuffer* draw_record_buffer;
+
+    struct YsVkBuffer* draw_command_buffer;
+    u32 draw_record_capacity;
+    u64 draw_command_slice_size;
+
+    // Host visible, the headers of both camera phases copied out of the frame's draw command slice.
+    struct YsVkBuffer* culling_statistics_buffer;
+    u64 culling_statistics_slice_size;
+
     // SSBO
-    struct YsVkBuffer* ssbo_buffer;
-    YsVkDescriptor ssbo_descriptor;
+    struct YsVkBuffer* ssbo_buffers[SSBO_BINDING_COUNT];
+    u64 ssbo_data_sizes[SSBO_BINDING_COUNT];
+    // Per frame, the scene buffers of the set are rewritten once the frame has finished.
+    b8* scene_descriptor_dirty;
+
+    // Upload Queue, the previous scene keeps rendering until the pending buffers are complete.
+    u64 pending_upload_value;
+    u64 upload_wait_value;
+
+    b8 has_pending_vertex_input;
+    u32 pending_draw_vertex_count;
+    struct YsVkBuffer* pending_vertex_input_position_buffer;
+    struct YsVkBuffer* pending_vertex_input_normal_buffer;
+    struct YsVkBuffer* pending_vertex_input_material_id_buffer;
+    u32 pending_draw_record_count;
+    struct YsVkBuffer* pending_draw_record_buffer;
+
+    b8 has_pending_ssbo;
+    struct YsVkBuffer* pending_ssbo_buffers[SSBO_BINDING_COUNT];
+    u64 pending_ssbo_data_sizes[SSBO_BINDING_COUNT];
+
+    u32 retired_buffer_count;
+    u32 retired_buffer_capacity;
+    u32 retired_frame_countdown;
+    struct YsVkBuffer** retired_buffers;
 
     // UBO
     struct YsVkBuffer* ubo_buffer;
-    YsVkDescriptor ubo_descriptor;
+    u64 ubo_slice_size;
     
     // Push Constant
     u32 push_constant_range_count;
@@ -109,19 +305,27 @@ typedef struct YsVkResources {
 
     // Image
     struct YsVkImage* rasterization_color_image;
-    YsVkDescriptor rasterization_color_image_descriptor;
 
     struct YsVkImage* rasterization_depth_image;
 
+    // Farthest depth per texel of every level, built from the rasterization depth and kept in the general layout.
+    // Not a graph image, it has to outlive the frame that built it.
+    struct YsVkImage* hi_z_image;
+
     struct YsVkImage* shadow_map_image;
-    YsVkDescriptor shadow_map_image_descriptor;
 
     struct YsVkImage* random_image;
-    YsVkDescriptor random_image_descriptor;
 
     struct YsVkImage* path_tracing_image;
-    YsVkDescriptor path_tracing_image_compute_storage_descriptor;
-    YsVkDescriptor path_tracing_image_fragment_sampled_descriptor;
+
+    struct YsVkImage* path_tracing_accumulation_image;
+
+    // One layer per frame in flight at the display size, written by the upscaling pass and kept in the general layout.
+    struct YsVkImage* upscaling_image;
+
+    // Host visible, one slice of counters per frame in flight, bound in the global set.
+    struct YsVkBuffer* path_tracing_statistics_buffer;
+    u64 path_tracing_statistics_slice_size;
 
     // Sampler
     VkSampler sampler_linear;
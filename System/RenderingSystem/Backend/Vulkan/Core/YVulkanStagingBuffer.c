@@ -0,0 +1,354 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "YVulkanStagingBuffer.h"
+#include "YVulkanBuffer.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YCMemoryManager.h"
+#include "YLogger.h"
+
+
+static u64 alignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void releaseOverflowBuffers(YsVkContext* context, YsVkStagingSegment* segment) {
+    for(u32 i = 0; i < segment->overflow_buffer_count; ++i) {
+        segment->overflow_buffers[i]->destroy(context, segment->overflow_buffers[i]);
+        yCMemoryFree(segment->overflow_buffers[i]);
+    }
+    segment->overflow_buffer_count = 0;
+}
+
+static void pushCopy(YsVkStagingSegment* segment,
+                     VkBuffer source,
+                     u64 source_offset,
+                     VkBuffer dest,
+                     u64 dest_offset,
+                     u64 size) {
+    if(segment->copy_count == segment->copy_capacity) {
+        u32 capacity = segment->copy_capacity ? segment->copy_capacity * 2 : 16;
+        YsVkStagingCopy* copies = yCMemoryAllocate(sizeof(YsVkStagingCopy) * capacity);
+        if(segment->copies) {
+            yCMemoryCopy(copies, segment->copies, sizeof(YsVkStagingCopy) * segment->copy_count);
+            yCMemoryFree(segment->copies);
+        }
+        segment->copies = copies;
+        segment->copy_capacity = capacity;
+    }
+
+    YsVkStagingCopy* copy = &segment->copies[segment->copy_count++];
+    copy->source = source;
+    copy->dest = dest;
+    copy->region.srcOffset = source_offset;
+    copy->region.dstOffset = dest_offset;
+    copy->region.size = size;
+}
+
+static void pushOverflowBuffer(YsVkStagingSegment* segment, YsVkBuffer* buffer) {
+    if(segment->overflow_buffer_count == segment->overflow_buffer_capacity) {
+        u32 capacity = segment->overflow_buffer_capacity ? segment->overflow_buffer_capacity * 2 : 4;
+        YsVkBuffer** buffers = yCMemoryAllocate(sizeof(YsVkBuffer*) * capacity);
+        if(segment->overflow_buffers) {
+            yCMemoryCopy(buffers, segment->overflow_buffers, sizeof(YsVkBuffer*) * segment->overflow_buffer_count);
+            yCMemoryFree(segment->overflow_buffers);
+        }
+        segment->overflow_buffers = buffers;
+        segment->overflow_buffer_capacity = capacity;
+    }
+    segment->overflow_buffers[segment->overflow_buffer_count++] = buffer;
+}
+
+static void releaseRetiredBuffers(YsVkContext* context, YsVkStagingBuffer* staging_buffer) {
+    for(u32 i = 0; i < staging_buffer->retired_buffer_count; ++i) {
+        staging_buffer->retired_buffers[i]->destroy(context, staging_buffer->retired_buffers[i]);
+        yCMemoryFree(staging_buffer->retired_buffers[i]);
+    }
+    staging_buffer->retired_buffer_count = 0;
+}
+
+static void retireRingBuffer(YsVkStagingBuffer* staging_buffer) {
+    if(staging_buffer->retired_buffer_count == staging_buffer->retired_buffer_capacity) {
+        u32 capacity = staging_buffer->retired_buffer_capacity ? staging_buffer->retired_buffer_capacity * 2 : 4;
+        YsVkBuffer** buffers = yCMemoryAllocate(sizeof(YsVkBuffer*) * capacity);
+        if(staging_buffer->retired_buffers) {
+            yCMemoryCopy(buffers, staging_buffer->retired_buffers, sizeof(YsVkBuffer*) * staging_buffer->retired_buffer_count);
+            yCMemoryFree(staging_buffer->retired_buffers);
+        }
+        staging_buffer->retired_buffers = buffers;
+        staging_buffer->retired_buffer_capacity = capacity;
+    }
+    staging_buffer->retired_buffers[staging_buffer->retired_buffer_count++] = staging_buffer->buffer;
+    staging_buffer->buffer = NULL;
+
+    // Copies recorded by the other frames in flight still read the old ring.
+    staging_buffer->retired_segment_countdown = staging_buffer->segment_count;
+}
+
+static b8 createRingBuffer(YsVkContext* context, u64 segment_size, YsVkStagingBuffer* staging_buffer) {
+    YsVkBuffer* buffer = yVkAllocateBufferObject();
+    buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
+    if(!buffer->create(context,
+                       segment_size * staging_buffer->segment_count,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                       buffer)) {
+        yCMemoryFree(buffer);
+        return false;
+    }
+
+    if(staging_buffer->buffer) {
+        retireRingBuffer(staging_buffer);
+    }
+    staging_buffer->buffer = buffer;
+    staging_buffer->segment_size = segment_size;
+
+    // Host visible blocks stay mapped for their whole lifetime.
+    staging_buffer->mapped_data = buffer->allocation.mapped_data;
+
+    // The queued copies keep the handle and offset of the ring they were written to, the segments start over.
+    for(u32 i = 0; i < staging_buffer->segment_count; ++i) {
+        staging_buffer->segments[i].offset = segment_size * i;
+        staging_buffer->segments[i].head = 0;
+    }
+
+    return true;
+}
+
+// required_size is what the overflowing segment needed for the whole frame, the segments at least double so a
+// frame of several uploads that each fit does not keep recreating a ring of the same size.
+static b8 growRingBuffer(YsVkContext* context, u64 required_size, YsVkStagingBuffer* staging_buffer) {
+    u64 segment_size = staging_buffer->segment_size * 2;
+    while(segment_size < required_size) {
+        segment_size *= 2;
+    }
+    if(segment_size > staging_buffer->max_segment_size) {
+        return false;
+    }
+
+    if(!createRingBuffer(context, segment_size, staging_buffer)) {
+        YERROR("Error growing staging ring buffer to %u segments of %llu bytes.", staging_buffer->segment_count, segment_size);
+        return false;
+    }
+
+    YINFO("Staging ring buffer grown to %u segments of %llu bytes.", staging_buffer->segment_count, segment_size);
+
+    return true;
+}
+
+static b8 stagingBufferCreate(YsVkContext* context,
+                              u64 segment_size,
+                              u64 max_segment_size,
+                              u32 segment_count,
+                              YsVkStagingBuffer* staging_buffer) {
+    VkPhysicalDeviceLimits* limits = &context->device->properties.limits;
+    staging_buffer->alignment = 16;
+    if(limits->optimalBufferCopyOffsetAlignment > staging_buffer->alignment) {
+        staging_buffer->alignment = limits->optimalBufferCopyOffsetAlignment;
+    }
+    if(limits->nonCoherentAtomSize > staging_buffer->alignment) {
+        staging_buffer->alignment = limits->nonCoherentAtomSize;
+    }
+
+    staging_buffer->segment_size = alignUp(segment_size, staging_buffer->alignment);
+    staging_buffer->max_segment_size = max_segment_size;
+    staging_buffer->segment_count = segment_count;
+    staging_buffer->current_segment = 0;
+
+    staging_buffer->segments = yCMemoryAllocate(sizeof(YsVkStagingSegment) * segment_count);
+    if(!createRingBuffer(context, staging_buffer->segment_size, staging_buffer)) {
+        YERROR("Error creating staging ring buffer.");
+        return false;
+    }
+
+    YINFO("Staging ring buffer created, %u segments of %llu bytes.", segment_count, staging_buffer->segment_size);
+
+    return true;
+}
+
+static void stagingBufferDestroy(YsVkContext* context, YsVkStagingBuffer* staging_buffer) {
+    for(u32 i = 0; i < staging_buffer->segment_count; ++i) {
+        YsVkStagingSegment* segment = &staging_buffer->segments[i];
+        releaseOverflowBuffers(context, segment);
+        if(segment->copies) {
+            yCMemoryFree(segment->copies);
+        }
+        if(segment->overflow_buffers) {
+            yCMemoryFree(segment->overflow_buffers);
+        }
+    }
+    yCMemoryFree(staging_buffer->segments);
+    staging_buffer->segments = NULL;
+
+    releaseRetiredBuffers(context, staging_buffer);
+    if(staging_buffer->retired_buffers) {
+        yCMemoryFree(staging_buffer->retired_buffers);
+        staging_buffer->retired_buffers = NULL;
+    }
+
+    if(staging_buffer->buffer) {
+        staging_buffer->buffer->destroy(context, staging_buffer->buffer);
+        yCMemoryFree(staging_buffer->buffer);
+        staging_buffer->buffer = NULL;
+    }
+    staging_buffer->mapped_data = NULL;
+}
+
+static void stagingBufferBeginFrame(YsVkContext* context,
+                                    u32 frame_index,
+                                    YsVkStagingBuffer* staging_buffer) {
+    staging_buffer->current_segment = frame_index;
+    if(staging_buffer->retired_buffer_count > 0 && 0 == --staging_buffer->retired_segment_countdown) {
+        releaseRetiredBuffers(context, staging_buffer);
+    }
+
+    // Uploads queued before the first frame are still waiting to be recorded, keep them.
+    YsVkStagingSegment* segment = &staging_buffer->segments[frame_index];
+    if(segment->copy_count > 0) {
+        return;
+    }
+
+    segment->head = 0;
+    releaseOverflowBuffers(context, segment);
+}
+
+static b8 stagingBufferUpload(YsVkContext* context,
+                              u64 dest_offset,
+                              u64 size,
+                              const void* data,
+                              VkBuffer dest,
+                              YsVkStagingBuffer* staging_buffer) {
+    if(0 == size) {
+        return true;
+    }
+
+    // A frame that uploads more than its segment holds grows the ring, the dedicated buffer is the last resort.
+    YsVkStagingSegment* segment = &staging_buffer->segments[staging_buffer->current_segment];
+    u64 head = alignUp(segment->head, staging_buffer->alignment);
+    if(head + size > staging_buffer->segment_size && growRingBuffer(context, alignUp(head + size, staging_buffer->alignment), staging_buffer)) {
+        head = 0;
+    }
+    if(head + size <= staging_buffer->segment_size) {
+        yCMemoryCopy(staging_buffer->mapped_data + segment->offset + head, data, size);
+        pushCopy(segment,
+                 staging_buffer->buffer->handle,
+                 segment->offset + head,
+                 dest,
+                 dest_offset,
+                 size);
+        segment->head = head + size;
+        return true;
+    }
+
+    // Larger than the largest segment, fall back to a dedicated buffer owned by this frame.
+    YWARN("Staging ring segment exhausted, using a dedicated %llu byte staging buffer.", size);
+    YsVkBuffer* overflow_buffer = yVkAllocateBufferObject();
+    if(!overflow_buffer->create(context,
+                                size,
+                                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                overflow_buffer)) {
+        YERROR("Error creating overflow staging buffer, size: %llu.", size);
+        yCMemoryFree(overflow_buffer);
+        return false;
+    }
+    overflow_buffer->directUpdate(context, 0, 0, data, overflow_buffer);
+    pushOverflowBuffer(segment, overflow_buffer);
+    pushCopy(segment,
+             overflow_buffer->handle,
+             0,
+             dest,
+             dest_offset,
+             size);
+
+    return true;
+}
+
+static void stagingBufferCmdFlush(VkCommandBuffer command_buffer, YsVkStagingBuffer* staging_buffer) {
+    YsVkStagingSegment* segment = &staging_buffer->segments[staging_buffer->current_segment];
+    if(0 == segment->copy_count) {
+        return;
+    }
+
+    // Earlier submissions on this queue may still read the destinations.
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_NONE;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+
+    for(u32 i = 0; i < segment->copy_count; ++i) {
+        vkCmdCopyBuffer(command_buffer,
+                        segment->copies[i].source,
+                        segment->copies[i].dest,
+                        1,
+                        &segment->copies[i].region);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                            VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+
+    segment->copy_count = 0;
+}
+
+YsVkStagingBuffer* yVkAllocateStagingBufferObject() {
+    YsVkStagingBuffer* staging_buffer = yCMemoryAllocate(sizeof(YsVkStagingBuffer));
+    if(staging_buffer) {
+        staging_buffer->create = stagingBufferCreate;
+        staging_buffer->destroy = stagingBufferDestroy;
+        staging_buffer->beginFrame = stagingBufferBeginFrame;
+        staging_buffer->upload = stagingBufferUpload;
+        staging_buffer->cmdFlush = stagingBufferCmdFlush;
+    }
+    return staging_buffer;
+}
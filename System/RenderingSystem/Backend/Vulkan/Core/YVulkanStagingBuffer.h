@@ -0,0 +1,107 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CGPPY_YVULKANSTAGINGBUFFER_H
+#define CGPPY_YVULKANSTAGINGBUFFER_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct YsVkStagingCopy {
+    VkBuffer source;
+    VkBuffer dest;
+    VkBufferCopy region;
+} YsVkStagingCopy;
+
+// One segment of the ring, owned by a single frame in flight.
+typedef struct YsVkStagingSegment {
+    u64 offset;
+    u64 head;
+
+    u32 copy_count;
+    u32 copy_capacity;
+    YsVkStagingCopy* copies;
+
+    // Uploads that did not fit into the segment, released once the frame fence signals.
+    u32 overflow_buffer_count;
+    u32 overflow_buffer_capacity;
+    struct YsVkBuffer** overflow_buffers;
+} YsVkStagingSegment;
+
+typedef struct YsVkStagingBuffer {
+    // The segments grow up to max_segment_size when a frame uploads more than fits.
+    b8 (*create)(struct YsVkContext* context,
+                 u64 segment_size,
+                 u64 max_segment_size,
+                 u32 segment_count,
+                 struct YsVkStagingBuffer* staging_buffer);
+
+    void (*destroy)(struct YsVkContext* context, struct YsVkStagingBuffer* staging_buffer);
+
+    // Must be called after the fence of frame_index has been waited on.
+    void (*beginFrame)(struct YsVkContext* context,
+                       u32 frame_index,
+                       struct YsVkStagingBuffer* staging_buffer);
+
+    b8 (*upload)(struct YsVkContext* context,
+                 u64 dest_offset,
+                 u64 size,
+                 const void* data,
+                 VkBuffer dest,
+                 struct YsVkStagingBuffer* staging_buffer);
+
+    void (*cmdFlush)(VkCommandBuffer command_buffer, struct YsVkStagingBuffer* staging_buffer);
+
+    struct YsVkBuffer* buffer;
+    u8* mapped_data;
+    u64 alignment;
+    u64 segment_size;
+    u64 max_segment_size;
+    u32 segment_count;
+    u32 current_segment;
+    YsVkStagingSegment* segments;
+
+    // Ring buffers replaced by a larger one, released once every segment has been begun again.
+    u32 retired_buffer_count;
+    u32 retired_buffer_capacity;
+    u32 retired_segment_countdown;
+    struct YsVkBuffer** retired_buffers;
+} YsVkStagingBuffer;
+
+YsVkStagingBuffer* yVkAllocateStagingBufferObject();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CGPPY_YVULKANSTAGINGBUFFER_H
@@ -31,16 +31,37 @@
 #include "YCMemoryManager.h"
 
 
-static void destroy(YsVkContext* context, YsVkSwapchain* swapchain) {
-    vkDeviceWaitIdle(context->device->logical_device);
-
+static void destroyImageViews(YsVkContext* context, YsVkSwapchain* swapchain) {
     for (u32 i = 0; i < swapchain->image_count; ++i) {
         vkDestroyImageView(context->device->logical_device, 
                            swapchain->present_src_images[i].image_view, 
                            context->allocator);
+        yCMemoryFree(swapchain->present_src_images[i].create_info);
     }
+}
+
+static void destroy(YsVkContext* context, YsVkSwapchain* swapchain) {
+    vkDeviceWaitIdle(context->device->logical_device);
+
+    destroyImageViews(context, swapchain);
+    yCMemoryFree(swapchain->present_src_images);
+    swapchain->present_src_images = NULL;
+    swapchain->image_count = 0;
 
     vkDestroySwapchainKHR(context->device->logical_device, swapchain->handle, context->allocator);
+    swapchain->handle = VK_NULL_HANDLE;
+}
+
+static VkPresentModeKHR selectPresentMode(YsVkContext* context, VkPresentModeKHR present_mode) {
+    for (u32 i = 0; i < context->device->swapchain_support.present_mode_count; ++i) {
+        if (context->device->swapchain_support.present_modes[i] == present_mode) {
+            return present_mode;
+        }
+    }
+
+    // FIFO is the only mode every surface has to support.
+    YWARN("Present mode %s is not supported, using VK_PRESENT_MODE_FIFO_KHR.", string_VkPresentModeKHR(present_mode));
+    return VK_PRESENT_MODE_FIFO_KHR;
 }
 
 static void create(YsVkContext* context,
@@ -48,7 +69,12 @@ static void create(YsVkContext* context,
                    u32 height,
                    VkPresentModeKHR present_mode,
                    YsVkSwapchain* swapchain) {
-    destroy(context, swapchain);
+    VkSwapchainKHR old_swapchain = swapchain->handle;
+
+    // The extent limits follow the window, they are queried again for every swapchain.
+    VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context->device->physical_device,
+                                                       context->surface,
+                                                       &context->device->swapchain_support.capabilities));
 
     VkExtent2D swapchain_extent = {width, height};
 
@@ -83,7 +109,12 @@ static void create(YsVkContext* context,
         image_count = context->device->swapchain_support.capabilities.maxImageCount;
     }
 
-    swapchain->max_frames_in_flight = image_count;
+    swapchain->max_frames_in_flight = SWAPCHAIN_MAX_FRAMES_IN_FLIGHT;
+    if (0 == swapchain->frames_in_flight) {
+        swapchain->frames_in_flight = SWAPCHAIN_MAX_FRAMES_IN_FLIGHT;
+    }
+    swapchain->present_mode = selectPresentMode(context, present_mode);
+    swapchain->extent = swapchain_extent;
 
     VkSwapchainCreateInfoKHR swapchain_create_info = {VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR};
     swapchain_create_info.surface = context->surface;
@@ -99,22 +130,33 @@ static void create(YsVkContext* context,
     swapchain_create_info.pQueueFamilyIndices = queue_family_indices;
     swapchain_create_info.preTransform = context->device->swapchain_support.capabilities.currentTransform;
     swapchain_create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    swapchain_create_info.presentMode = present_mode;
+    swapchain_create_info.presentMode = swapchain->present_mode;
     swapchain_create_info.clipped = VK_TRUE;
-    swapchain_create_info.oldSwapchain = 0;
+    swapchain_create_info.oldSwapchain = old_swapchain;
 
     VK_CHECK(vkCreateSwapchainKHR(context->device->logical_device, &swapchain_create_info, context->allocator, &swapchain->handle));
 
+    // The old swapchain is retired by the new one, its images are gone once it is destroyed.
+    if (old_swapchain) {
+        destroyImageViews(context, swapchain);
+        vkDestroySwapchainKHR(context->device->logical_device, old_swapchain, context->allocator);
+    }
+
     if (!context->device->detectDepthFormat(context->device)) {
         context->device->depth_format = VK_FORMAT_UNDEFINED;
         YFATAL("Failed to find a supported format!");
     }
 
+    u32 previous_image_count = swapchain->image_count;
     swapchain->image_count = 0;
     VK_CHECK(vkGetSwapchainImagesKHR(context->device->logical_device, swapchain->handle, &swapchain->image_count, 0));
     VkImage swapchain_images[swapchain->image_count];
     VK_CHECK(vkGetSwapchainImagesKHR(context->device->logical_device, swapchain->handle, &swapchain->image_count, swapchain_images));
 
+    if (swapchain->present_src_images && previous_image_count != swapchain->image_count) {
+        yCMemoryFree(swapchain->present_src_images);
+        swapchain->present_src_images = NULL;
+    }
     if (NULL == swapchain->present_src_images) {
         swapchain->present_src_images = yCMemoryAllocate(sizeof(YsVkImage) * swapchain->image_count);
     }
@@ -144,7 +186,11 @@ static void create(YsVkContext* context,
                                    &swapchain->present_src_images[i].image_view));
     }
 
-    YINFO("Swapchain created successfully.");
+    YINFO("Swapchain created successfully, %ux%u, %u images, %s.",
+          swapchain_extent.width,
+          swapchain_extent.height,
+          swapchain->image_count,
+          string_VkPresentModeKHR(swapchain->present_mode));
 }
 
 
@@ -34,7 +34,11 @@
 extern "C" {
 #endif
 
+// Per-frame resources are sized for this many frames, the frames actually in flight are chosen at runtime.
+#define SWAPCHAIN_MAX_FRAMES_IN_FLIGHT 3
+
 typedef struct YsVkSwapchain {
+    // Also recreates an existing swapchain, the caller makes sure the device no longer uses its images.
     void (*create)(struct YsVkContext* context,
                    u32 width,
                    u32 height,
@@ -46,8 +50,16 @@ typedef struct YsVkSwapchain {
 
     VkSurfaceFormatKHR image_format;
 
+    // Falls back to FIFO when the requested mode is not supported by the surface.
+    VkPresentModeKHR present_mode;
+
+    VkExtent2D extent;
+
     u8 max_frames_in_flight;
 
+    // At most max_frames_in_flight, independent of the image count.
+    u8 frames_in_flight;
+
     VkSwapchainKHR handle;
 
     u32 image_count;
@@ -48,6 +48,37 @@ struct YsVkOutputSystem;
 struct YsVkRasterizationSystem;
 struct YsVkShadowMappingSystem;
 struct YsVkPathTracingSystem;
+struct YsVkRenderGraph;
+struct YsVkGpuTimer;
+
+typedef enum YeVkTimestampQuery {
+    TIMESTAMP_QUERY_FRAME_BEGIN = 0,
+    TIMESTAMP_QUERY_FRAME_END,
+    TIMESTAMP_QUERY_SCENE_END,
+    TIMESTAMP_QUERY_PATH_TRACING_BEGIN,
+    TIMESTAMP_QUERY_PATH_TRACING_END,
+    TIMESTAMP_QUERY_COUNT
+} YeVkTimestampQuery;
+
+// Graphics command buffers of a frame, the pre and post buffers are only used around an async compute submission.
+typedef enum YeVkFrameCommandBuffer {
+    FRAME_COMMAND_BUFFER_MAIN = 0,
+    FRAME_COMMAND_BUFFER_PRE_ASYNC_COMPUTE,
+    FRAME_COMMAND_BUFFER_POST_ASYNC_COMPUTE,
+    FRAME_COMMAND_BUFFER_COUNT
+} YeVkFrameCommandBuffer;
+
+// Worker threads recording the secondary command buffers of the rendering systems. Graphics command units hold
+// one command pool per thread after the main thread's pool, since a pool may only be recorded from one thread.
+typedef enum YeVkRecordingThread {
+    RECORDING_THREAD_SHADOW_MAPPING = 0,
+    RECORDING_THREAD_RASTERIZATION,
+    RECORDING_THREAD_OUTPUT,
+    RECORDING_THREAD_COUNT
+} YeVkRecordingThread;
+
+#define COMMAND_POOL_MAIN_THREAD 0
+#define COMMAND_POOL_RECORDING_THREAD_BEGIN 1
 
 typedef struct YsVkDescriptor {
     VkDescriptorSetLayout descriptor_set_layout;
@@ -93,6 +124,7 @@ typedef struct YsVkShader {
 
 typedef struct YsVkPipelineConfig {
     VkStructureType pipeline_type;
+    VkPipelineCreateFlags create_flags;
 
     YsVkShaderConfig shader_config;
 
@@ -0,0 +1,439 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "YVulkanUploadQueue.h"
+#include "YVulkanBuffer.h"
+#include "YVulkanImage.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YCMemoryManager.h"
+#include "YLogger.h"
+
+#define UPLOAD_QUEUE_BATCH_COUNT 4
+#define UPLOAD_QUEUE_STAGING_SIZE (32 * 1024 * 1024)
+
+
+static u64 alignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void uploadQueueWait(YsVkContext* context, u64 timeline_value, YsVkUploadQueue* upload_queue);
+
+static void releaseRetiredStagingBuffers(YsVkContext* context, YsVkUploadQueue* upload_queue) {
+    for(u32 i = 0; i < upload_queue->retired_staging_buffer_count; ++i) {
+        upload_queue->retired_staging_buffers[i]->destroy(context, upload_queue->retired_staging_buffers[i]);
+        yCMemoryFree(upload_queue->retired_staging_buffers[i]);
+    }
+    upload_queue->retired_staging_buffer_count = 0;
+}
+
+static void retireStagingBuffer(YsVkUploadQueue* upload_queue) {
+    if(upload_queue->retired_staging_buffer_count == upload_queue->retired_staging_buffer_capacity) {
+        u32 capacity = upload_queue->retired_staging_buffer_capacity ? upload_queue->retired_staging_buffer_capacity * 2 : 4;
+        YsVkBuffer** buffers = yCMemoryAllocate(sizeof(YsVkBuffer*) * capacity);
+        if(upload_queue->retired_staging_buffers) {
+            yCMemoryCopy(buffers, upload_queue->retired_staging_buffers, sizeof(YsVkBuffer*) * upload_queue->retired_staging_buffer_count);
+            yCMemoryFree(upload_queue->retired_staging_buffers);
+        }
+        upload_queue->retired_staging_buffers = buffers;
+        upload_queue->retired_staging_buffer_capacity = capacity;
+    }
+    upload_queue->retired_staging_buffers[upload_queue->retired_staging_buffer_count++] = upload_queue->staging_buffer;
+    upload_queue->staging_buffer = NULL;
+
+    // The batch being recorded may already have copied out of the old ring.
+    upload_queue->retired_staging_value = upload_queue->submitted_value + 1;
+}
+
+static b8 createStagingBuffer(YsVkContext* context, u64 size, YsVkUploadQueue* upload_queue) {
+    YsVkBuffer* buffer = yVkAllocateBufferObject();
+    buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
+    if(!buffer->create(context,
+                       size,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                       buffer)) {
+        YERROR("Error creating upload staging ring of %llu bytes.", size);
+        yCMemoryFree(buffer);
+        return false;
+    }
+
+    if(upload_queue->staging_buffer) {
+        retireStagingBuffer(upload_queue);
+    }
+    upload_queue->staging_buffer = buffer;
+    upload_queue->staging_size = size;
+
+    // Positions of the old ring mean nothing in the new one, no batch holds any of it.
+    upload_queue->staging_head = 0;
+    upload_queue->staging_tail = 0;
+    for(u32 i = 0; i < upload_queue->batch_count; ++i) {
+        upload_queue->batches[i].staging_end = 0;
+    }
+
+    return true;
+}
+
+static YsVkUploadBatch* oldestPendingBatch(YsVkUploadQueue* upload_queue) {
+    // Batches are submitted in ring order, the one after the current batch is the oldest.
+    for(u32 i = 1; i < upload_queue->batch_count; ++i) {
+        YsVkUploadBatch* batch = &upload_queue->batches[(upload_queue->current_batch + i) % upload_queue->batch_count];
+        if(batch->timeline_value > 0 && batch->staging_end > upload_queue->staging_tail) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+static u64 allocateStaging(YsVkContext* context, u64 size, YsVkUploadQueue* upload_queue) {
+    size = alignUp(size, upload_queue->staging_alignment);
+    if(size > upload_queue->staging_size) {
+        u64 staging_size = upload_queue->staging_size;
+        while(staging_size < size) {
+            staging_size *= 2;
+        }
+        if(!createStagingBuffer(context, staging_size, upload_queue)) {
+            return UINT64_MAX;
+        }
+        YINFO("Upload staging ring grown to %llu bytes.", staging_size);
+    }
+
+    // Copies never wrap, the rest of the ring is skipped when the allocation does not fit before its end.
+    for(;;) {
+        u64 offset = upload_queue->staging_head % upload_queue->staging_size;
+        u64 padding = offset + size > upload_queue->staging_size ? upload_queue->staging_size - offset : 0;
+        if(upload_queue->staging_head + padding + size - upload_queue->staging_tail <= upload_queue->staging_size) {
+            upload_queue->staging_head += padding;
+            break;
+        }
+
+        // Frees the ring up to the oldest batch still holding it, that only blocks while the batch is copying.
+        YsVkUploadBatch* batch = oldestPendingBatch(upload_queue);
+        if(batch) {
+            uploadQueueWait(context, batch->timeline_value, upload_queue);
+            upload_queue->staging_tail = batch->staging_end;
+            continue;
+        }
+
+        // Only the batch being recorded holds the ring, a larger one takes the rest of the batch.
+        if(!createStagingBuffer(context, upload_queue->staging_size * 2, upload_queue)) {
+            return UINT64_MAX;
+        }
+        YINFO("Upload staging ring grown to %llu bytes.", upload_queue->staging_size);
+    }
+
+    u64 offset = upload_queue->staging_head % upload_queue->staging_size;
+    upload_queue->staging_head += size;
+    return offset;
+}
+
+static b8 pushStaging(YsVkContext* context,
+                      u64 size,
+                      const void* data,
+                      VkBuffer* staging_buffer,
+                      u64* staging_offset,
+                      YsVkUploadQueue* upload_queue) {
+    u64 offset = allocateStaging(context, size, upload_queue);
+    if(UINT64_MAX == offset) {
+        YERROR("Error staging upload of %llu bytes.", size);
+        return false;
+    }
+
+    // Host visible blocks stay mapped for their whole lifetime.
+    yCMemoryCopy((u8*)upload_queue->staging_buffer->allocation.mapped_data + offset, data, size);
+    *staging_buffer = upload_queue->staging_buffer->handle;
+    *staging_offset = offset;
+    return true;
+}
+
+static b8 uploadQueueIsComplete(YsVkContext* context, u64 timeline_value, YsVkUploadQueue* upload_queue) {
+    u64 completed_value = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(context->device->logical_device,
+                                        upload_queue->timeline_semaphore,
+                                        &completed_value));
+    return completed_value >= timeline_value;
+}
+
+static void uploadQueueWait(YsVkContext* context, u64 timeline_value, YsVkUploadQueue* upload_queue) {
+    VkSemaphoreWaitInfo wait_info = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &upload_queue->timeline_semaphore;
+    wait_info.pValues = &timeline_value;
+    VK_CHECK(vkWaitSemaphores(context->device->logical_device, &wait_info, UINT64_MAX));
+}
+
+static b8 uploadQueueCreate(YsVkContext* context, YsVkUploadQueue* upload_queue) {
+    // A transfer-only family copies next to the graphics queue, otherwise the last graphics queue is used.
+    upload_queue->command_unit = context->device->transfer_command_unit ?
+                                 context->device->transfer_command_unit :
+                                 context->device->commandUnitsBack(context->device);
+
+    VkSemaphoreTypeCreateInfo semaphore_type_info = {VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    semaphore_type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphore_type_info.initialValue = 0;
+    VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    semaphore_create_info.pNext = &semaphore_type_info;
+    VkResult result = vkCreateSemaphore(context->device->logical_device,
+                                        &semaphore_create_info,
+                                        context->allocator,
+                                        &upload_queue->timeline_semaphore);
+    if(result != VK_SUCCESS) {
+        YERROR("Error creating upload timeline semaphore: %s", string_VkResult(result));
+        return false;
+    }
+    upload_queue->submitted_value = 0;
+
+    VkPhysicalDeviceLimits* limits = &context->device->properties.limits;
+    upload_queue->staging_alignment = 16;
+    if(limits->optimalBufferCopyOffsetAlignment > upload_queue->staging_alignment) {
+        upload_queue->staging_alignment = limits->optimalBufferCopyOffsetAlignment;
+    }
+    if(limits->nonCoherentAtomSize > upload_queue->staging_alignment) {
+        upload_queue->staging_alignment = limits->nonCoherentAtomSize;
+    }
+
+    upload_queue->batch_count = UPLOAD_QUEUE_BATCH_COUNT;
+    upload_queue->current_batch = 0;
+    upload_queue->batches = yCMemoryAllocate(sizeof(YsVkUploadBatch) * upload_queue->batch_count);
+
+    VkCommandBuffer command_buffers[UPLOAD_QUEUE_BATCH_COUNT];
+    VkCommandBufferAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocate_info.commandPool = upload_queue->command_unit->command_pools[0];
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = upload_queue->batch_count;
+    VK_CHECK(vkAllocateCommandBuffers(context->device->logical_device,
+                                      &allocate_info,
+                                      command_buffers));
+    for(u32 i = 0; i < upload_queue->batch_count; ++i) {
+        upload_queue->batches[i].command_buffer = command_buffers[i];
+    }
+
+    if(!createStagingBuffer(context, UPLOAD_QUEUE_STAGING_SIZE, upload_queue)) {
+        return false;
+    }
+
+    YINFO("Upload queue created on queue family %u.", upload_queue->command_unit->queue_family_index);
+
+    return true;
+}
+
+static void uploadQueueDestroy(YsVkContext* context, YsVkUploadQueue* upload_queue) {
+    uploadQueueWait(context, upload_queue->submitted_value, upload_queue);
+
+    for(u32 i = 0; i < upload_queue->batch_count; ++i) {
+        YsVkUploadBatch* batch = &upload_queue->batches[i];
+        vkFreeCommandBuffers(context->device->logical_device,
+                             upload_queue->command_unit->command_pools[0],
+                             1,
+                             &batch->command_buffer);
+    }
+    yCMemoryFree(upload_queue->batches);
+    upload_queue->batches = NULL;
+    upload_queue->batch_count = 0;
+
+    releaseRetiredStagingBuffers(context, upload_queue);
+    if(upload_queue->retired_staging_buffers) {
+        yCMemoryFree(upload_queue->retired_staging_buffers);
+        upload_queue->retired_staging_buffers = NULL;
+    }
+    if(upload_queue->staging_buffer) {
+        upload_queue->staging_buffer->destroy(context, upload_queue->staging_buffer);
+        yCMemoryFree(upload_queue->staging_buffer);
+        upload_queue->staging_buffer = NULL;
+    }
+
+    vkDestroySemaphore(context->device->logical_device,
+                       upload_queue->timeline_semaphore,
+                       context->allocator);
+    upload_queue->timeline_semaphore = VK_NULL_HANDLE;
+}
+
+static void uploadQueueBegin(YsVkContext* context, YsVkUploadQueue* upload_queue) {
+    YsVkUploadBatch* batch = &upload_queue->batches[upload_queue->current_batch];
+
+    // Only blocks when every batch of the ring is still copying.
+    if(batch->timeline_value > 0) {
+        uploadQueueWait(context, batch->timeline_value, upload_queue);
+        if(batch->staging_end > upload_queue->staging_tail) {
+            upload_queue->staging_tail = batch->staging_end;
+        }
+    }
+    if(upload_queue->retired_staging_buffer_count > 0 && uploadQueueIsComplete(context,
+                                                                               upload_queue->retired_staging_value,
+                                                                               upload_queue)) {
+        releaseRetiredStagingBuffers(context, upload_queue);
+    }
+
+    context->device->commandBufferReset(batch->command_buffer);
+    context->device->commandBufferBegin(batch->command_buffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    upload_queue->is_recording = true;
+}
+
+static void uploadQueueUploadBuffer(YsVkContext* context,
+                                    u64 dest_offset,
+                                    u64 size,
+                                    const void* data,
+                                    VkBuffer dest,
+                                    YsVkUploadQueue* upload_queue) {
+    if(!upload_queue->is_recording) {
+        YERROR("Upload queue buffer upload outside of begin and submit.");
+        return;
+    }
+    if(0 == size) {
+        return;
+    }
+
+    YsVkUploadBatch* batch = &upload_queue->batches[upload_queue->current_batch];
+    VkBuffer staging_buffer;
+    u64 staging_offset;
+    if(!pushStaging(context, size, data, &staging_buffer, &staging_offset, upload_queue)) {
+        return;
+    }
+
+    VkBufferCopy copy_region;
+    copy_region.srcOffset = staging_offset;
+    copy_region.dstOffset = dest_offset;
+    copy_region.size = size;
+    vkCmdCopyBuffer(batch->command_buffer,
+                    staging_buffer,
+                    dest,
+                    1,
+                    &copy_region);
+}
+
+static void uploadQueueUploadImage(YsVkContext* context,
+                                   u64 size,
+                                   const void* data,
+                                   VkImageLayout final_layout,
+                                   YsVkImage* image,
+                                   YsVkUploadQueue* upload_queue) {
+    if(!upload_queue->is_recording) {
+        YERROR("Upload queue image upload outside of begin and submit.");
+        return;
+    }
+
+    YsVkUploadBatch* batch = &upload_queue->batches[upload_queue->current_batch];
+    VkBuffer staging_buffer;
+    u64 staging_offset;
+    if(!pushStaging(context, size, data, &staging_buffer, &staging_offset, upload_queue)) {
+        return;
+    }
+
+    u32 queue_family_index = upload_queue->command_unit->queue_family_index;
+    image->transitionLayout(batch->command_buffer,
+                            0,
+                            image->create_info->arrayLayers,
+                            VK_IMAGE_LAYOUT_UNDEFINED,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_ACCESS_NONE,
+                            VK_ACCESS_TRANSFER_WRITE_BIT,
+                            queue_family_index,
+                            queue_family_index,
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            image);
+
+    VkBufferImageCopy region = {0};
+    region.bufferOffset = staging_offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = image->create_info->arrayLayers;
+    region.imageExtent.width = image->create_info->extent.width;
+    region.imageExtent.height = image->create_info->extent.height;
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(batch->command_buffer,
+                           staging_buffer,
+                           image->handle,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &region);
+
+    // Visibility for the reading queue comes from its wait on the timeline semaphore.
+    image->transitionLayout(batch->command_buffer,
+                            0,
+                            image->create_info->arrayLayers,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            final_layout,
+                            VK_ACCESS_TRANSFER_WRITE_BIT,
+                            VK_ACCESS_NONE,
+                            queue_family_index,
+                            queue_family_index,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            image);
+}
+
+static u64 uploadQueueSubmit(YsVkContext* context, YsVkUploadQueue* upload_queue) {
+    if(!upload_queue->is_recording) {
+        return upload_queue->submitted_value;
+    }
+
+    YsVkUploadBatch* batch = &upload_queue->batches[upload_queue->current_batch];
+    context->device->commandBufferEnd(batch->command_buffer);
+    upload_queue->is_recording = false;
+
+    u64 signal_value = upload_queue->submitted_value + 1;
+    VkTimelineSemaphoreSubmitInfo timeline_submit_info = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    timeline_submit_info.signalSemaphoreValueCount = 1;
+    timeline_submit_info.pSignalSemaphoreValues = &signal_value;
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.pNext = &timeline_submit_info;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch->command_buffer;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &upload_queue->timeline_semaphore;
+    VkResult result = vkQueueSubmit(upload_queue->command_unit->queue,
+                                    1,
+                                    &submit_info,
+                                    VK_NULL_HANDLE);
+    if(result != VK_SUCCESS) {
+        YERROR("Upload queue vkQueueSubmit failed with result: %s", string_VkResult(result));
+        return upload_queue->submitted_value;
+    }
+
+    upload_queue->submitted_value = signal_value;
+    batch->timeline_value = signal_value;
+    batch->staging_end = upload_queue->staging_head;
+    upload_queue->current_batch = (upload_queue->current_batch + 1) % upload_queue->batch_count;
+
+    return signal_value;
+}
+
+YsVkUploadQueue* yVkAllocateUploadQueueObject() {
+    YsVkUploadQueue* upload_queue = yCMemoryAllocate(sizeof(YsVkUploadQueue));
+    if(upload_queue) {
+        upload_queue->create = uploadQueueCreate;
+        upload_queue->destroy = uploadQueueDestroy;
+        upload_queue->begin = uploadQueueBegin;
+        upload_queue->uploadBuffer = uploadQueueUploadBuffer;
+        upload_queue->uploadImage = uploadQueueUploadImage;
+        upload_queue->submit = uploadQueueSubmit;
+        upload_queue->isComplete = uploadQueueIsComplete;
+        upload_queue->wait = uploadQueueWait;
+    }
+
+    return upload_queue;
+}
@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CGPPY_YVULKANUPLOADQUEUE_H
+#define CGPPY_YVULKANUPLOADQUEUE_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Copies of one submission, its part of the staging ring is reused once the timeline passes timeline_value.
+typedef struct YsVkUploadBatch {
+    VkCommandBuffer command_buffer;
+    u64 timeline_value;
+
+    // Ring position after the batch's last staging copy, the ring is free up to it once the batch completes.
+    u64 staging_end;
+} YsVkUploadBatch;
+
+// Background uploads on the transfer queue. Every submitted batch signals the next value of a timeline
+// semaphore, consumers wait on that value only when they start reading the uploaded data.
+typedef struct YsVkUploadQueue {
+    b8 (*create)(struct YsVkContext* context, struct YsVkUploadQueue* upload_queue);
+
+    void (*destroy)(struct YsVkContext* context, struct YsVkUploadQueue* upload_queue);
+
+    void (*begin)(struct YsVkContext* context, struct YsVkUploadQueue* upload_queue);
+
+    void (*uploadBuffer)(struct YsVkContext* context,
+                         u64 dest_offset,
+                         u64 size,
+                         const void* data,
+                         VkBuffer dest,
+                         struct YsVkUploadQueue* upload_queue);
+
+    // The image ends in final_layout, readable by any queue family it is shared with.
+    void (*uploadImage)(struct YsVkContext* context,
+                        u64 size,
+                        const void* data,
+                        VkImageLayout final_layout,
+                        struct YsVkImage* image,
+                        struct YsVkUploadQueue* upload_queue);
+
+    // Returns the timeline value signaled once every copy of the batch has finished.
+    u64 (*submit)(struct YsVkContext* context, struct YsVkUploadQueue* upload_queue);
+
+    b8 (*isComplete)(struct YsVkContext* context, u64 timeline_value, struct YsVkUploadQueue* upload_queue);
+
+    void (*wait)(struct YsVkContext* context, u64 timeline_value, struct YsVkUploadQueue* upload_queue);
+
+    struct YsVkCommandUnit* command_unit;
+    VkSemaphore timeline_semaphore;
+    u64 submitted_value;
+
+    u32 batch_count;
+    u32 current_batch;
+    b8 is_recording;
+    YsVkUploadBatch* batches;
+
+    // Persistent host visible ring every upload is staged in. Head and tail count bytes written and freed since
+    // the ring was created, the ring only grows when a single batch needs more than all of it.
+    struct YsVkBuffer* staging_buffer;
+    u64 staging_size;
+    u64 staging_alignment;
+    u64 staging_head;
+    u64 staging_tail;
+
+    // Rings replaced by a larger one, released once the timeline passes retired_staging_value.
+    u32 retired_staging_buffer_count;
+    u32 retired_staging_buffer_capacity;
+    u64 retired_staging_value;
+    struct YsVkBuffer** retired_staging_buffers;
+} YsVkUploadQueue;
+
+YsVkUploadQueue* yVkAllocateUploadQueueObject();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CGPPY_YVULKANUPLOADQUEUE_H
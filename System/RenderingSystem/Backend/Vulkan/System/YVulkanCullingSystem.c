@@ -0,0 +1,347 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "YVulkanCullingSystem.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YVulkanResource.h"
+#include "YVulkanBuffer.h"
+#include "YVulkanImage.h"
+#include "YLogger.h"
+#include "YCMemoryManager.h"
+#include "YAssets.h"
+
+
+static YsVkPipeline* createComputePipeline(YsVkContext* context,
+                                           YsVkResources* resources,
+                                           enum YeAssetsShader shader) {
+    YsVkPipelineConfig* pipeline_config = yCMemoryAllocate(sizeof(YsVkPipelineConfig));
+    pipeline_config->pipeline_type = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_config->create_flags = VK_PIPELINE_CREATE_DISPATCH_BASE_BIT;
+    pipeline_config->shader_config.shader_stage_config_count = 1;
+    pipeline_config->shader_config.shader_stage_config[0].stage_flag = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_config->shader_config.shader_stage_config[0].source_length = getSpvCodeSize(shader);
+    pipeline_config->shader_config.shader_stage_config[0].source = getSpvCode(shader);
+
+    pipeline_config->descriptor_count = 1;
+    pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * pipeline_config->descriptor_count);
+    pipeline_config->descriptors[0] = resources->global_descriptor;
+    pipeline_config->push_constant_range_count = resources->push_constant_range_count;
+    pipeline_config->push_constant_range = resources->push_constant_range;
+
+    YsVkPipeline* pipeline = yVkAllocatePipelineObject();
+    if (!pipeline->create(context,
+                          pipeline_config,
+                          pipeline)) {
+        return NULL;
+    }
+
+    return pipeline;
+}
+
+static b8 initialize(YsVkContext* context,
+                     YsVkResources* resources,
+                     YsVkCullingSystem* culling_system) {
+    culling_system->pipeline = createComputePipeline(context, resources, Culling_Comp);
+    if (!culling_system->pipeline) {
+        YERROR("Create Culling Pipeline Failed.");
+        return false;
+    }
+
+    culling_system->hi_z_pipeline = createComputePipeline(context, resources, Hi_Z_Comp);
+    if (!culling_system->hi_z_pipeline) {
+        YERROR("Create Hi-Z Pipeline Failed.");
+        return false;
+    }
+
+    return true;
+}
+
+static void cmdBindComputePipeline(VkCommandBuffer command_buffer,
+                                   u32 current_frame,
+                                   YsVkPipeline* pipeline) {
+    vkCmdBindPipeline(command_buffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      pipeline->handle);
+
+    for(int i = 0; i < pipeline->config->descriptor_count; ++i) {
+        const VkDescriptorSet* p_descriptor_set = pipeline->config->descriptors[i].is_single_descriptor_set ?
+                                                  &pipeline->config->descriptors[i].descriptor_sets[0] :
+                                                  &pipeline->config->descriptors[i].descriptor_sets[current_frame];
+
+        vkCmdBindDescriptorSets(command_buffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipeline->pipeline_layout,
+                                pipeline->config->descriptors[i].set,
+                                1,
+                                p_descriptor_set,
+                                0,
+                                NULL);
+    }
+}
+
+static void cmdDispatchCall(YsVkContext* context,
+                            VkCommandBuffer command_buffer,
+                            YsVkResources* resources,
+                            u32 current_frame,
+                            u32 view,
+                            YsVkCullingSystem* culling_system) {
+    // The slice was last read by this frame's previous submission, which its fence has already waited on.
+    VkDeviceSize view_offset = resources->draw_command_slice_size * current_frame + DRAW_COMMAND_VIEW_SIZE(resources->draw_record_capacity) * view;
+    u32 draw_record_count = resources->current_draw_record_count;
+
+    //
+    u32 header[DRAW_COMMAND_HEADER_WORD_COUNT] = {0};
+    header[DRAW_COMMAND_HEADER_RECORD_COUNT] = draw_record_count;
+    vkCmdUpdateBuffer(command_buffer,
+                      resources->draw_command_buffer->handle,
+                      view_offset,
+                      DRAW_COMMAND_HEADER_SIZE,
+                      header);
+    // Without drawIndirectCount every record is drawn, culled ones have to stay zero sized draws.
+    if(!context->device->features_12.drawIndirectCount && draw_record_count > 0) {
+        vkCmdFillBuffer(command_buffer,
+                        resources->draw_command_buffer->handle,
+                        view_offset + DRAW_COMMAND_HEADER_SIZE,
+                        sizeof(VkDrawIndirectCommand) * draw_record_count,
+                        0);
+    }
+
+    // The late camera phase also reads the flags the early one wrote.
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+
+    //
+    if(draw_record_count > 0) {
+        cmdBindComputePipeline(command_buffer, current_frame, culling_system->pipeline);
+
+        // The regions grow with the scene, the shader indexes them with the layout of this frame's slice.
+        i32 draw_command_layout[2];
+        draw_command_layout[0] = (i32)resources->draw_record_capacity;
+        draw_command_layout[1] = (i32)(DRAW_COMMAND_VIEW_SIZE(resources->draw_record_capacity) / sizeof(u32));
+        vkCmdPushConstants(command_buffer,
+                           culling_system->pipeline->pipeline_layout,
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                           PUSH_CONSTANT_DRAW_COMMAND_LAYOUT_OFFSET,
+                           PUSH_CONSTANT_DRAW_COMMAND_LAYOUT_SIZE,
+                           draw_command_layout);
+
+        // The view is passed as the base work group in y.
+        vkCmdDispatchBase(command_buffer,
+                          0,
+                          view,
+                          0,
+                          (draw_record_count + 64 - 1) / 64,
+                          1,
+                          1);
+    }
+
+    //
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+}
+
+static void cmdBuildHiZ(YsVkContext* context,
+                        VkCommandBuffer command_buffer,
+                        YsVkResources* resources,
+                        u32 current_frame,
+                        YsVkCullingSystem* culling_system) {
+    YsVkImage* hi_z_image = resources->hi_z_image;
+
+    // The depth layer of the frame is sampled for level 0, the culls that read the old pyramid have to finish first.
+    VkImageMemoryBarrier depth_barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    depth_barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depth_barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depth_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    depth_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depth_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depth_barrier.image = resources->rasterization_depth_image->handle;
+    depth_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    depth_barrier.subresourceRange.baseMipLevel = 0;
+    depth_barrier.subresourceRange.levelCount = 1;
+    depth_barrier.subresourceRange.baseArrayLayer = current_frame;
+    depth_barrier.subresourceRange.layerCount = 1;
+
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         1,
+                         &depth_barrier);
+
+    // One dispatch per level, the level is passed as the base work group in z.
+    cmdBindComputePipeline(command_buffer, current_frame, culling_system->hi_z_pipeline);
+    for(u32 level = 0; level < hi_z_image->create_info->mipLevels; ++level) {
+        u32 width = hi_z_image->create_info->extent.width >> level;
+        u32 height = hi_z_image->create_info->extent.height >> level;
+        width = width > 0 ? width : 1;
+        height = height > 0 ? height : 1;
+        vkCmdDispatchBase(command_buffer,
+                          0,
+                          0,
+                          level,
+                          (width + 8 - 1) / 8,
+                          (height + 8 - 1) / 8,
+                          1);
+
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             NULL,
+                             0,
+                             NULL);
+    }
+
+    //
+    depth_barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depth_barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_barrier.srcAccessMask = VK_ACCESS_NONE;
+    depth_barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         0,
+                         0,
+                         NULL,
+                         0,
+                         NULL,
+                         1,
+                         &depth_barrier);
+}
+
+static void cmdReadbackStatistics(YsVkContext* context,
+                                  VkCommandBuffer command_buffer,
+                                  YsVkResources* resources,
+                                  u32 current_frame,
+                                  YsVkCullingSystem* culling_system) {
+    VkDeviceSize slice_offset = resources->draw_command_slice_size * current_frame;
+
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+
+    VkBufferCopy copy_regions[2];
+    copy_regions[0].srcOffset = slice_offset + DRAW_COMMAND_VIEW_SIZE(resources->draw_record_capacity) * DRAW_VIEW_CAMERA;
+    copy_regions[0].dstOffset = resources->culling_statistics_slice_size * current_frame;
+    copy_regions[0].size = DRAW_COMMAND_HEADER_SIZE;
+    copy_regions[1].srcOffset = slice_offset + DRAW_COMMAND_VIEW_SIZE(resources->draw_record_capacity) * DRAW_VIEW_CAMERA_LATE;
+    copy_regions[1].dstOffset = copy_regions[0].dstOffset + DRAW_COMMAND_HEADER_SIZE;
+    copy_regions[1].size = DRAW_COMMAND_HEADER_SIZE;
+    vkCmdCopyBuffer(command_buffer,
+                    resources->draw_command_buffer->handle,
+                    resources->culling_statistics_buffer->handle,
+                    2,
+                    copy_regions);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+}
+
+void yVkCmdDrawCulled(YsVkContext* context,
+                      VkCommandBuffer command_buffer,
+                      YsVkResources* resources,
+                      u32 current_frame,
+                      u32 view) {
+    VkDeviceSize view_offset = resources->draw_command_slice_size * current_frame + DRAW_COMMAND_VIEW_SIZE(resources->draw_record_capacity) * view;
+    if(context->device->features_12.drawIndirectCount) {
+        vkCmdDrawIndirectCount(command_buffer,
+                               resources->draw_command_buffer->handle,
+                               view_offset + DRAW_COMMAND_HEADER_SIZE,
+                               resources->draw_command_buffer->handle,
+                               view_offset,
+                               resources->draw_record_capacity,
+                               sizeof(VkDrawIndirectCommand));
+    } else if(resources->current_draw_record_count > 0) {
+        vkCmdDrawIndirect(command_buffer,
+                          resources->draw_command_buffer->handle,
+                          view_offset + DRAW_COMMAND_HEADER_SIZE,
+                          resources->current_draw_record_count,
+                          sizeof(VkDrawIndirectCommand));
+    }
+}
+
+YsVkCullingSystem* yVkCullingSystemCreate() {
+    YsVkCullingSystem* culling_system = yCMemoryAllocate(sizeof(YsVkCullingSystem));
+    if(culling_system) {
+        culling_system->initialize = initialize;
+        culling_system->cmdDispatchCall = cmdDispatchCall;
+        culling_system->cmdBuildHiZ = cmdBuildHiZ;
+        culling_system->cmdReadbackStatistics = cmdReadbackStatistics;
+    }
+
+    return culling_system;
+}
@@ -0,0 +1,87 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CGPPY_YVULKANCULLINGSYSTEM_H
+#define CGPPY_YVULKANCULLINGSYSTEM_H
+
+
+#include "YVulkanTypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct YsVkCullingSystem {
+    b8 (*initialize)(struct YsVkContext* context,
+                     struct YsVkResources* resources,
+                     struct YsVkCullingSystem* culling_system);
+
+    // Culls the draw records against the frustum of the view and writes its indirect draws for the current frame,
+    // the camera phases also test them against the Hi-Z pyramid. Recorded outside a render pass, before the pass
+    // that draws the view.
+    void (*cmdDispatchCall)(struct YsVkContext* context,
+                            VkCommandBuffer command_buffer,
+                            struct YsVkResources* resources,
+                            u32 current_frame,
+                            u32 view,
+                            struct YsVkCullingSystem* culling_system);
+
+    // Rebuilds the Hi-Z pyramid from the rasterization depth of the current frame, recorded in between the
+    // rasterization render passes. The depth is left in the attachment layout.
+    void (*cmdBuildHiZ)(struct YsVkContext* context,
+                        VkCommandBuffer command_buffer,
+                        struct YsVkResources* resources,
+                        u32 current_frame,
+                        struct YsVkCullingSystem* culling_system);
+
+    // Copies the headers of both camera phases into the culling statistics slice of the current frame, to be
+    // read once its fence has been waited on. Recorded after the late camera phase.
+    void (*cmdReadbackStatistics)(struct YsVkContext* context,
+                                  VkCommandBuffer command_buffer,
+                                  struct YsVkResources* resources,
+                                  u32 current_frame,
+                                  struct YsVkCullingSystem* culling_system);
+
+    struct YsVkPipeline* pipeline;
+    struct YsVkPipeline* hi_z_pipeline;
+} YsVkCullingSystem;
+
+YsVkCullingSystem* yVkCullingSystemCreate();
+
+// Draws the indirect draws the culling pass wrote for the view, with the vertex buffers already bound.
+void yVkCmdDrawCulled(struct YsVkContext* context,
+                      VkCommandBuffer command_buffer,
+                      struct YsVkResources* resources,
+                      u32 current_frame,
+                      u32 view);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
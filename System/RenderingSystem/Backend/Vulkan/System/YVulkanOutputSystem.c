@@ -31,6 +31,7 @@
 #include "YVulkanResource.h"
 #include "YVulkanImage.h"
 #include "YVulkanBuffer.h"
+#include "YVulkanStagingBuffer.h"
 #include "YLogger.h"
 #include "YCMemoryManager.h"
 #include "YAssets.h"
@@ -47,6 +48,32 @@ static float computeScale(const float* image_size, const float* window_size) {
     }
 }
 
+// One framebuffer per present image, they are indexed by the acquired image and not by the frame in flight.
+static void fillFramebufferCreateInfos(YsVkContext* context, YsVkRenderStageCreateInfo* render_stage_create_info) {
+    render_stage_create_info->framebuffer_count = context->swapchain->image_count;
+    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
+    for(int i = 0; i < render_stage_create_info->framebuffer_count; ++i) {
+        render_stage_create_info->framebuffer_create_info[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        render_stage_create_info->framebuffer_create_info[i].attachmentCount = render_stage_create_info->attachment_count;
+        render_stage_create_info->framebuffer_create_info[i].pAttachments = &context->swapchain->present_src_images[i].image_view;
+        render_stage_create_info->framebuffer_create_info[i].width = context->swapchain->extent.width;
+        render_stage_create_info->framebuffer_create_info[i].height = context->swapchain->extent.height;
+        render_stage_create_info->framebuffer_create_info[i].layers = 1;
+    }
+}
+
+static void setViewport(YsVkContext* context, YsVkPipelineConfig* pipeline_config) {
+    pipeline_config->viewport.x = 0.0f;
+    pipeline_config->viewport.y = 0.0f;
+    pipeline_config->viewport.width = context->swapchain->extent.width;
+    pipeline_config->viewport.height = context->swapchain->extent.height;
+    pipeline_config->viewport.minDepth = 0.0f;
+    pipeline_config->viewport.maxDepth = 1.0f;
+    pipeline_config->scissor.offset.x = 0;
+    pipeline_config->scissor.offset.y = 0;
+    pipeline_config->scissor.extent = context->swapchain->extent;
+}
+
 static b8 initialize(YsVkContext* context,
                      YsVkResources* resources,
                      YsVkOutputSystem* output_system) {
@@ -71,16 +98,7 @@ static b8 initialize(YsVkContext* context,
     render_stage_create_info->subpass_configs[0].subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     render_stage_create_info->subpass_configs[0].subpass_description.colorAttachmentCount = 1;
     render_stage_create_info->subpass_configs[0].subpass_description.pColorAttachments = &render_stage_create_info->subpass_configs[0].attachment_references[0];
-    render_stage_create_info->framebuffer_count = context->swapchain->image_count;
-    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
-    for(int i = 0; i < render_stage_create_info->framebuffer_count; ++i) {
-        render_stage_create_info->framebuffer_create_info[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        render_stage_create_info->framebuffer_create_info[i].attachmentCount = render_stage_create_info->attachment_count;
-        render_stage_create_info->framebuffer_create_info[i].pAttachments = &context->swapchain->present_src_images[i].image_view;
-        render_stage_create_info->framebuffer_create_info[i].width = context->swapchain->present_src_images->create_info->extent.width;
-        render_stage_create_info->framebuffer_create_info[i].height = context->swapchain->present_src_images->create_info->extent.height;
-        render_stage_create_info->framebuffer_create_info[i].layers = 1;
-    }
+    fillFramebufferCreateInfos(context, render_stage_create_info);
     output_system->render_stage = yVkAllocateRenderStageObject();
     output_system->render_stage->create(context,
                                         render_stage_create_info,
@@ -129,23 +147,12 @@ static b8 initialize(YsVkContext* context,
     output_pipeline_config->shader_config.shader_stage_config[1].source = getSpvCode(Output_Frag);
     output_pipeline_config->render_stage = output_system->render_stage;
     output_pipeline_config->vertex_input_info = &pipeline_vertex_info;
-    output_pipeline_config->descriptor_count = 3;
+    output_pipeline_config->descriptor_count = 1;
     output_pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * output_pipeline_config->descriptor_count);
-    output_pipeline_config->descriptors[0] = resources->ubo_descriptor;
-    output_pipeline_config->descriptors[1] = resources->rasterization_color_image_descriptor;
-    output_pipeline_config->descriptors[2] = resources->path_tracing_image_fragment_sampled_descriptor;
+    output_pipeline_config->descriptors[0] = resources->global_descriptor;
     output_pipeline_config->push_constant_range_count = resources->push_constant_range_count;
     output_pipeline_config->push_constant_range = resources->push_constant_range;
-    output_pipeline_config->viewport.x = 0.0f;
-    output_pipeline_config->viewport.y = 0.0f;
-    output_pipeline_config->viewport.width = context->swapchain->present_src_images->create_info->extent.width;
-    output_pipeline_config->viewport.height = context->swapchain->present_src_images->create_info->extent.height;
-    output_pipeline_config->viewport.minDepth = 0.0f;
-    output_pipeline_config->viewport.maxDepth = 1.0f;
-    output_pipeline_config->scissor.offset.x = 0;
-    output_pipeline_config->scissor.offset.y = 0;
-    output_pipeline_config->scissor.extent.width = context->swapchain->present_src_images->create_info->extent.width;
-    output_pipeline_config->scissor.extent.height = context->swapchain->present_src_images->create_info->extent.height;
+    setViewport(context, output_pipeline_config);
     output_system->pipeline = yVkAllocatePipelineObject();
     if (!output_system->pipeline->create(context,
                                          output_pipeline_config,
@@ -163,8 +170,26 @@ static b8 initialize(YsVkContext* context,
                           &output_system->complete_semaphores[i]);
     }
 
+    //
+    output_system->secondary_command_buffers = (VkCommandBuffer*)yCMemoryAllocate(sizeof(VkCommandBuffer) * context->swapchain->max_frames_in_flight);
+    output_system->console_command_buffers = (VkCommandBuffer*)yCMemoryAllocate(sizeof(VkCommandBuffer) * context->swapchain->max_frames_in_flight);
+    output_system->secondary_command_buffer_generations = (u64*)yCMemoryAllocate(sizeof(u64) * context->swapchain->max_frames_in_flight);
+    for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        context->device->commandBufferAllocate(context,
+                                               context->device->commandUnitsAt(context->device, i),
+                                               COMMAND_POOL_RECORDING_THREAD_BEGIN + RECORDING_THREAD_OUTPUT,
+                                               false,
+                                               &output_system->secondary_command_buffers[i]);
+        context->device->commandBufferAllocate(context,
+                                               context->device->commandUnitsAt(context->device, i),
+                                               COMMAND_POOL_MAIN_THREAD,
+                                               false,
+                                               &output_system->console_command_buffers[i]);
+    }
+
     //
     output_system->vertex_input_position_buffer = yVkAllocateBufferObject();
+    output_system->vertex_input_position_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
     if (output_system->vertex_input_position_buffer->create(context,
                                                             sizeof(vec4) * 4,
                                                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -184,12 +209,12 @@ static b8 initialize(YsVkContext* context,
                               x,  y, 0.0f, 1.0f,
                               x, -y, 0.0f, 1.0f,
                               -x, -y, 0.0f, 1.0f};
-        output_system->vertex_input_position_buffer->indirectUpdate(context,
-                                                                    context->device->commandUnitsFront(context->device),
-                                                                    VK_NULL_HANDLE,
-                                                                    0,
-                                                                    position,
-                                                                    output_system->vertex_input_position_buffer);
+        resources->staging_buffer->upload(context,
+                                          0,
+                                          output_system->vertex_input_position_buffer->total_size,
+                                          position,
+                                          output_system->vertex_input_position_buffer->handle,
+                                          resources->staging_buffer);
     } else {
         YERROR("Error creating vertex buffer.");
     }
@@ -199,17 +224,18 @@ static b8 initialize(YsVkContext* context,
                               1.0f, 0.0f, 0.0f, 1.0f,
                               0.0f, 0.0f, 0.0f, 1.0f};
     output_system->vertex_input_texcoord_buffer = yVkAllocateBufferObject();
+    output_system->vertex_input_texcoord_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
     if (output_system->vertex_input_texcoord_buffer->create(context,
                                                             sizeof(vec4) * 4,
                                                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                                             output_system->vertex_input_texcoord_buffer)) {
-        output_system->vertex_input_texcoord_buffer->indirectUpdate(context,
-                                                                    context->device->commandUnitsFront(context->device),
-                                                                    VK_NULL_HANDLE,
-                                                                    0,
-                                                                    texture_coord,
-                                                                    output_system->vertex_input_texcoord_buffer);
+        resources->staging_buffer->upload(context,
+                                          0,
+                                          output_system->vertex_input_texcoord_buffer->total_size,
+                                          texture_coord,
+                                          output_system->vertex_input_texcoord_buffer->handle,
+                                          resources->staging_buffer);
     } else {
         YERROR("Error creating vertex buffer.");
     }
@@ -217,17 +243,18 @@ static b8 initialize(YsVkContext* context,
     u32 indices[6] = {0, 1, 2,
                       2, 3, 0};
     output_system->vertex_input_index_buffer = yVkAllocateBufferObject();
+    output_system->vertex_input_index_buffer->memory_strategy = MEMORY_STRATEGY_LINEAR;
     if (output_system->vertex_input_index_buffer->create(context,
                                                          sizeof(u32) * 6,
                                                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                                          output_system->vertex_input_index_buffer)) {
-        output_system->vertex_input_index_buffer->indirectUpdate(context,
-                                                                 context->device->commandUnitsFront(context->device),
-                                                                 VK_NULL_HANDLE,
-                                                                 0,
-                                                                 indices,
-                                                                 output_system->vertex_input_index_buffer);
+        resources->staging_buffer->upload(context,
+                                          0,
+                                          output_system->vertex_input_index_buffer->total_size,
+                                          indices,
+                                          output_system->vertex_input_index_buffer->handle,
+                                          resources->staging_buffer);
     } else {
         YERROR("Error Creating Index Buffer.");
     }
@@ -235,47 +262,42 @@ static b8 initialize(YsVkContext* context,
     return true;
 }
 
-static void cmdDrawCall(YsVkContext* context,
-                        YsVkCommandUnit* command_unit,
-                        u32 command_buffer_index,
-                        YsVkResources* resources,
-                        u32 current_present_image_index,
-                        u32 current_frame,
-                        void* push_constant_data,
-                        YsVkOutputSystem* output_system) {
-    //
-    VkClearValue clear_value;
-    clear_value.color.float32[0] = 0.0f;
-    clear_value.color.float32[1] = 0.0f;
-    clear_value.color.float32[2] = 0.0f;
-    clear_value.color.float32[3] = 1.0f;
+static void resize(YsVkContext* context, YsVkOutputSystem* output_system) {
+    YsVkRenderStage* render_stage = output_system->render_stage;
+    render_stage->destroyFramebuffers(context, render_stage);
+    yCMemoryFree(render_stage->create_info->framebuffer_create_info);
+    fillFramebufferCreateInfos(context, render_stage->create_info);
+    render_stage->createFramebuffers(context, render_stage);
 
-    vkCmdSetViewport(command_unit->command_buffers[command_buffer_index], 0, 1, &output_system->pipeline->config->viewport);
-    vkCmdSetScissor(command_unit->command_buffers[command_buffer_index], 0, 1, &output_system->pipeline->config->scissor);
+    setViewport(context, output_system->pipeline->config);
 
-    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_pass_begin_info.renderPass = output_system->render_stage->render_pass_handle;
-    render_pass_begin_info.framebuffer = output_system->render_stage->framebuffers[current_frame];
-    render_pass_begin_info.renderArea = output_system->pipeline->config->scissor;
-    render_pass_begin_info.clearValueCount = output_system->render_stage->create_info->attachment_count;
-    render_pass_begin_info.pClearValues = &clear_value;
-    vkCmdBeginRenderPass(command_unit->command_buffers[command_buffer_index], 
-                         &render_pass_begin_info,
-                         VK_SUBPASS_CONTENTS_INLINE);                                             
+    // The cached quads set the old viewport.
+    for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        output_system->secondary_command_buffer_generations[i] = 0;
+    }
+}
 
-    vkCmdBindPipeline(command_unit->command_buffers[command_buffer_index],
+// Push constants are baked in at record time, the output shaders do not read the per-frame values.
+static void cmdRecordDraw(VkCommandBuffer command_buffer,
+                          u32 current_frame,
+                          void* push_constant_data,
+                          YsVkOutputSystem* output_system) {
+    vkCmdSetViewport(command_buffer, 0, 1, &output_system->pipeline->config->viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &output_system->pipeline->config->scissor);
+
+    vkCmdBindPipeline(command_buffer,
                       VK_PIPELINE_BIND_POINT_GRAPHICS,
                       output_system->pipeline->handle);
 
     VkBuffer vertex_buffers[2] = {output_system->vertex_input_position_buffer->handle,
                                   output_system->vertex_input_texcoord_buffer->handle};
     VkDeviceSize vertex_offsets[2] = {0};
-    vkCmdBindVertexBuffers(command_unit->command_buffers[command_buffer_index],
+    vkCmdBindVertexBuffers(command_buffer,
                            0,
                            2,
                            vertex_buffers,
                            vertex_offsets);
-    vkCmdBindIndexBuffer(command_unit->command_buffers[command_buffer_index],
+    vkCmdBindIndexBuffer(command_buffer,
                          output_system->vertex_input_index_buffer->handle,
                          0,
                          VK_INDEX_TYPE_UINT32);
@@ -285,7 +307,7 @@ static void cmdDrawCall(YsVkContext* context,
                                                   &output_system->pipeline->config->descriptors[i].descriptor_sets[0] :
                                                   &output_system->pipeline->config->descriptors[i].descriptor_sets[current_frame];
 
-        vkCmdBindDescriptorSets(command_unit->command_buffers[command_buffer_index],
+        vkCmdBindDescriptorSets(command_buffer,
                                 VK_PIPELINE_BIND_POINT_GRAPHICS,
                                 output_system->pipeline->pipeline_layout,
                                 output_system->pipeline->config->descriptors[i].set,
@@ -295,24 +317,100 @@ static void cmdDrawCall(YsVkContext* context,
                                 NULL);    
     }                                        
 
-    vkCmdPushConstants(command_unit->command_buffers[command_buffer_index],
+    vkCmdPushConstants(command_buffer,
                        output_system->pipeline->pipeline_layout,
                        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
                        0,
                        yPushConstantSize(),
                        push_constant_data);
 
-    vkCmdDrawIndexed(command_unit->command_buffers[command_buffer_index],
+    vkCmdDrawIndexed(command_buffer,
                      6,
                      1,
                      0,
                      0,
                      0);
+}
 
-    yRenderDeveloperConsole(command_unit,
-                            command_buffer_index,
+static void cmdRecordSecondary(YsVkContext* context,
+                               YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               YsVkOutputSystem* output_system) {
+    if(output_system->secondary_command_buffer_generations[current_frame] == resources->command_generation) {
+        return;
+    }
+
+    VkCommandBuffer secondary_command_buffer = output_system->secondary_command_buffers[current_frame];
+    context->device->commandBufferBeginSecondary(context->device,
+                                                 secondary_command_buffer,
+                                                 output_system->render_stage->render_pass_handle,
+                                                 0,
+                                                 VK_NULL_HANDLE);
+    cmdRecordDraw(secondary_command_buffer, current_frame, push_constant_data, output_system);
+    context->device->commandBufferEnd(secondary_command_buffer);
+    output_system->secondary_command_buffer_generations[current_frame] = resources->command_generation;
+}
+
+static void cmdRecordConsole(YsVkContext* context,
+                             u32 current_present_image_index,
+                             u32 current_frame,
+                             YsVkOutputSystem* output_system) {
+    VkCommandBuffer console_command_buffer = output_system->console_command_buffers[current_frame];
+    context->device->commandBufferBeginSecondary(context->device,
+                                                 console_command_buffer,
+                                                 output_system->render_stage->render_pass_handle,
+                                                 0,
+                                                 output_system->render_stage->framebuffers[current_present_image_index]);
+    u32 gpu_scope = GPU_TIMER_NO_SCOPE;
+    if(context->gpu_timer) {
+        gpu_scope = context->gpu_timer->cmdBeginScope(console_command_buffer,
+                                                       current_frame,
+                                                       "ImGui",
+                                                       GPU_TIMER_QUEUE_GRAPHICS,
+                                                       GPU_TIMER_STATISTICS_NONE,
+                                                       context->gpu_timer);
+    }
+    yRenderDeveloperConsole(console_command_buffer,
                             current_frame, 
                             current_present_image_index);
+    if(context->gpu_timer) {
+        context->gpu_timer->cmdEndScope(console_command_buffer, current_frame, gpu_scope, context->gpu_timer);
+    }
+    context->device->commandBufferEnd(console_command_buffer);
+}
+
+static void cmdDrawCall(YsVkContext* context,
+                        YsVkCommandUnit* command_unit,
+                        u32 command_buffer_index,
+                        YsVkResources* resources,
+                        u32 current_present_image_index,
+                        u32 current_frame,
+                        void* push_constant_data,
+                        YsVkOutputSystem* output_system) {
+    //
+    VkFramebuffer framebuffer = output_system->render_stage->framebuffers[current_present_image_index];
+    VkCommandBuffer secondary_command_buffers[2] = {output_system->secondary_command_buffers[current_frame],
+                                                    output_system->console_command_buffers[current_frame]};
+
+    //
+    VkClearValue clear_value;
+    clear_value.color.float32[0] = 0.0f;
+    clear_value.color.float32[1] = 0.0f;
+    clear_value.color.float32[2] = 0.0f;
+    clear_value.color.float32[3] = 1.0f;
+
+    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    render_pass_begin_info.renderPass = output_system->render_stage->render_pass_handle;
+    render_pass_begin_info.framebuffer = framebuffer;
+    render_pass_begin_info.renderArea = output_system->pipeline->config->scissor;
+    render_pass_begin_info.clearValueCount = output_system->render_stage->create_info->attachment_count;
+    render_pass_begin_info.pClearValues = &clear_value;
+    vkCmdBeginRenderPass(command_unit->command_buffers[command_buffer_index], 
+                         &render_pass_begin_info,
+                         VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    vkCmdExecuteCommands(command_unit->command_buffers[command_buffer_index], 2, secondary_command_buffers);
 
     vkCmdEndRenderPass(command_unit->command_buffers[command_buffer_index]);
 }
@@ -321,6 +419,9 @@ YsVkOutputSystem* yVkOutputSystemCreate() {
     YsVkOutputSystem* output_system = yCMemoryAllocate(sizeof(YsVkOutputSystem));
     if(output_system) {
         output_system->initialize = initialize;
+        output_system->resize = resize;
+        output_system->cmdRecordSecondary = cmdRecordSecondary;
+        output_system->cmdRecordConsole = cmdRecordConsole;
         output_system->cmdDrawCall = cmdDrawCall;
     }
 
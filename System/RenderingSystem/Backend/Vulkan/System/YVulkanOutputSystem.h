@@ -39,6 +39,24 @@ typedef struct YsVkOutputSystem {
                      struct YsVkResources* resources,
                      struct YsVkOutputSystem* output_system);
 
+    // Follows a recreated swapchain, the framebuffers are rebuilt for the new present images and extent.
+    void (*resize)(struct YsVkContext* context,
+                   struct YsVkOutputSystem* output_system);
+
+    // Re-records the cached quad of current_frame when it is stale, called on the output recording thread.
+    void (*cmdRecordSecondary)(struct YsVkContext* context,
+                               struct YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               struct YsVkOutputSystem* output_system);
+
+    // The console polls GLFW while it is built, so it is recorded on the main thread every frame.
+    void (*cmdRecordConsole)(struct YsVkContext* context,
+                             u32 current_present_image_index,
+                             u32 current_frame,
+                             struct YsVkOutputSystem* output_system);
+
+    // Runs the render pass with the quad and the console, both must have been recorded for current_frame.
     void (*cmdDrawCall)(struct YsVkContext* context,
                         struct YsVkCommandUnit* command_unit,
                         u32 command_buffer_index,
@@ -52,6 +70,11 @@ typedef struct YsVkOutputSystem {
     struct YsVkPipeline* pipeline;
     VkSemaphore* complete_semaphores;
 
+    // Draw commands per frame in flight, replayed until the command generation of the resources changes.
+    VkCommandBuffer* secondary_command_buffers;
+    u64* secondary_command_buffer_generations;
+    VkCommandBuffer* console_command_buffers;
+
     struct YsVkBuffer* vertex_input_position_buffer;
     struct YsVkBuffer* vertex_input_texcoord_buffer;
     struct YsVkBuffer* vertex_input_index_buffer;
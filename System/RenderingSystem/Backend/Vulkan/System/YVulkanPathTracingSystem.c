@@ -38,22 +38,32 @@
 #include <math.h>
 
 
+static void computeTiles(YsVkResources* resources, YsVkPathTracingSystem* path_tracing_system) {
+    path_tracing_system->group_count_x = (resources->path_tracing_image->create_info->extent.width + 32 - 1) / 32;
+    path_tracing_system->group_count_y = (resources->path_tracing_image->create_info->extent.height + 32 - 1) / 32;
+    path_tracing_system->group_count_z = 1;
+
+    // The image is traced tile by tile so a frame only dispatches as much work as its time budget allows.
+    path_tracing_system->tile_group_count = 4;
+    path_tracing_system->tile_count_x = (path_tracing_system->group_count_x + path_tracing_system->tile_group_count - 1) / path_tracing_system->tile_group_count;
+    path_tracing_system->tile_count_y = (path_tracing_system->group_count_y + path_tracing_system->tile_group_count - 1) / path_tracing_system->tile_group_count;
+    path_tracing_system->tile_count = path_tracing_system->tile_count_x * path_tracing_system->tile_count_y;
+}
+
 static b8 initialize(YsVkContext* context,
                      YsVkResources* resources,
                      YsVkPathTracingSystem* path_tracing_system) {
     YsVkPipelineConfig* path_tracing_pipeline_config = yCMemoryAllocate(sizeof(YsVkPipelineConfig));
     path_tracing_pipeline_config->pipeline_type = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    path_tracing_pipeline_config->create_flags = VK_PIPELINE_CREATE_DISPATCH_BASE_BIT;
     path_tracing_pipeline_config->shader_config.shader_stage_config_count = 1;
     path_tracing_pipeline_config->shader_config.shader_stage_config[0].stage_flag = VK_SHADER_STAGE_COMPUTE_BIT;
     path_tracing_pipeline_config->shader_config.shader_stage_config[0].source_length = getSpvCodeSize(Path_Tracing_Comp);
     path_tracing_pipeline_config->shader_config.shader_stage_config[0].source = getSpvCode(Path_Tracing_Comp);
     
-    path_tracing_pipeline_config->descriptor_count = 4;
+    path_tracing_pipeline_config->descriptor_count = 1;
     path_tracing_pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * path_tracing_pipeline_config->descriptor_count);
-    path_tracing_pipeline_config->descriptors[0] = resources->ubo_descriptor;
-    path_tracing_pipeline_config->descriptors[1] = resources->ssbo_descriptor;
-    path_tracing_pipeline_config->descriptors[2] = resources->random_image_descriptor;
-    path_tracing_pipeline_config->descriptors[3] = resources->path_tracing_image_compute_storage_descriptor;
+    path_tracing_pipeline_config->descriptors[0] = resources->global_descriptor;
     path_tracing_pipeline_config->push_constant_range_count = resources->push_constant_range_count;
     path_tracing_pipeline_config->push_constant_range = resources->push_constant_range;
     
@@ -66,9 +76,14 @@ static b8 initialize(YsVkContext* context,
     }
 
     //
+    path_tracing_system->ready_semaphores = yCMemoryAllocate(sizeof(VkSemaphore) * context->swapchain->max_frames_in_flight);
     path_tracing_system->complete_semaphores = yCMemoryAllocate(sizeof(VkSemaphore) * context->swapchain->max_frames_in_flight);
     for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
         VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        vkCreateSemaphore(context->device->logical_device,
+                          &semaphore_create_info,
+                          context->allocator,
+                          &path_tracing_system->ready_semaphores[i]);
         vkCreateSemaphore(context->device->logical_device,
                           &semaphore_create_info,
                           context->allocator,
@@ -76,9 +91,7 @@ static b8 initialize(YsVkContext* context,
     }
 
     //
-    path_tracing_system->group_count_x = (resources->path_tracing_image->create_info->extent.width + 32 - 1) / 32;
-    path_tracing_system->group_count_y = (resources->path_tracing_image->create_info->extent.height + 32 - 1) / 32;
-    path_tracing_system->group_count_z = 1;
+    computeTiles(resources, path_tracing_system);
 
     return true;
 }
@@ -90,6 +103,8 @@ static void cmdDispatchCall(YsVkContext* context,
                         u32 current_present_image_index,
                         u32 current_frame,
                         void* push_constant_data,
+                        u32 tile_begin,
+                        u32 tile_count,
                         YsVkPathTracingSystem* path_tracing_system) {
     //
     vkCmdBindPipeline(command_unit->command_buffers[command_buffer_index],
@@ -118,16 +133,27 @@ static void cmdDispatchCall(YsVkContext* context,
                        yPushConstantSize(),
                        push_constant_data);
 
-    vkCmdDispatch(command_unit->command_buffers[command_buffer_index], 
-                  path_tracing_system->group_count_x, 
-                  path_tracing_system->group_count_y,
-                  path_tracing_system->group_count_z);
+    u32 tile_end = tile_begin + tile_count < path_tracing_system->tile_count ? tile_begin + tile_count : path_tracing_system->tile_count;
+    for(u32 tile = tile_begin; tile < tile_end; ++tile) {
+        u32 base_group_x = (tile % path_tracing_system->tile_count_x) * path_tracing_system->tile_group_count;
+        u32 base_group_y = (tile / path_tracing_system->tile_count_x) * path_tracing_system->tile_group_count;
+        u32 group_count_x = path_tracing_system->group_count_x - base_group_x;
+        u32 group_count_y = path_tracing_system->group_count_y - base_group_y;
+        vkCmdDispatchBase(command_unit->command_buffers[command_buffer_index],
+                          base_group_x,
+                          base_group_y,
+                          0,
+                          group_count_x < path_tracing_system->tile_group_count ? group_count_x : path_tracing_system->tile_group_count,
+                          group_count_y < path_tracing_system->tile_group_count ? group_count_y : path_tracing_system->tile_group_count,
+                          path_tracing_system->group_count_z);
+    }
 }
 
 YsVkPathTracingSystem* yVkPathTracingSystemCreate() {
     YsVkPathTracingSystem* path_tracing_system = yCMemoryAllocate(sizeof(YsVkPathTracingSystem));
     if(path_tracing_system) {
         path_tracing_system->initialize = initialize;
+        path_tracing_system->resize = computeTiles;
         path_tracing_system->cmdDispatchCall = cmdDispatchCall;
     }
 
@@ -39,6 +39,9 @@ typedef struct YsVkPathTracingSystem {
                      struct YsVkResources* resources,
                      struct YsVkPathTracingSystem* path_tracing_system);
 
+    // Recomputes the dispatch tiles for a recreated path tracing image.
+    void (*resize)(struct YsVkResources* resources,
+                   struct YsVkPathTracingSystem* path_tracing_system);
 
     void (*cmdDispatchCall)(struct YsVkContext* context,
                             struct YsVkCommandUnit* command_unit,
@@ -47,14 +50,23 @@ typedef struct YsVkPathTracingSystem {
                             u32 current_present_image_index,
                             u32 current_frame,
                             void* push_constant_data,
+                            u32 tile_begin,
+                            u32 tile_count,
                             struct YsVkPathTracingSystem* path_tracing_system);
 
     struct YsVkPipeline* pipeline;
+    // Async compute only, signaled once the frame's uploads are flushed and its output layer is released.
+    VkSemaphore* ready_semaphores;
     VkSemaphore* complete_semaphores;
 
     u32 group_count_x;
     u32 group_count_y;
     u32 group_count_z;
+
+    u32 tile_group_count;
+    u32 tile_count_x;
+    u32 tile_count_y;
+    u32 tile_count;
 } YsVkPathTracingSystem;
 
 YsVkPathTracingSystem* yVkPathTracingSystemCreate();
@@ -25,6 +25,7 @@
 #include "YVulkanRasterizationSystem.h"
 #include "YVulkanOutputSystem.h"
 #include "YVulkanShadowMappingSystem.h"
+#include "YVulkanCullingSystem.h"
 #include "YVulkanRenderingSystem.h"
 #include "YVulkanContext.h"
 #include "YVulkanDevice.h"
@@ -37,28 +38,61 @@
 #include "YGlobalFunction.h"
 
 
-static b8 initialize(YsVkContext* context,
-                     YsVkResources* resources,
-                     YsVkRasterizationSystem* rasterization_system) {
-    // Render Stage
+// One framebuffer per frame in flight, each renders into its own layer of the color and depth images.
+static void fillFramebufferCreateInfos(YsVkContext* context,
+                                       YsVkResources* resources,
+                                       YsVkRenderStageCreateInfo* render_stage_create_info) {
+    render_stage_create_info->framebuffer_count = context->swapchain->max_frames_in_flight;
+    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
+    for(int i = 0; i < render_stage_create_info->framebuffer_count; ++i) {
+        VkImageView* image_views = yCMemoryAllocate(sizeof(VkImageView) * render_stage_create_info->attachment_count);
+        image_views[0] = resources->rasterization_color_image->layer_views[i];
+        image_views[1] = resources->rasterization_depth_image->layer_views[i];
+        render_stage_create_info->framebuffer_create_info[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        render_stage_create_info->framebuffer_create_info[i].attachmentCount = render_stage_create_info->attachment_count;
+        render_stage_create_info->framebuffer_create_info[i].pAttachments = image_views;
+        render_stage_create_info->framebuffer_create_info[i].width = resources->rasterization_color_image->create_info->extent.width;
+        render_stage_create_info->framebuffer_create_info[i].height = resources->rasterization_color_image->create_info->extent.height;
+        render_stage_create_info->framebuffer_create_info[i].layers = 1;
+    }
+}
+
+static void setViewport(YsVkResources* resources, YsVkPipelineConfig* pipeline_config) {
+    pipeline_config->viewport.x = 0.0f;
+    pipeline_config->viewport.y = 0.0f;
+    pipeline_config->viewport.width = resources->rasterization_color_image->create_info->extent.width;
+    pipeline_config->viewport.height = resources->rasterization_color_image->create_info->extent.height;
+    pipeline_config->viewport.minDepth = 0.0f;
+    pipeline_config->viewport.maxDepth = 1.0f;
+    pipeline_config->scissor.offset.x = 0;
+    pipeline_config->scissor.offset.y = 0;
+    pipeline_config->scissor.extent.width = resources->rasterization_color_image->create_info->extent.width;
+    pipeline_config->scissor.extent.height = resources->rasterization_color_image->create_info->extent.height;
+}
+
+// The early stage clears and keeps the color attachment for the late one, which loads both attachments and
+// draws the records the early Hi-Z test deferred.
+static YsVkRenderStage* createRenderStage(YsVkContext* context,
+                                          YsVkResources* resources,
+                                          b8 is_late) {
     YsVkRenderStageCreateInfo* render_stage_create_info = yCMemoryAllocate(sizeof(YsVkRenderStageCreateInfo));
     render_stage_create_info->attachment_count = 2;
     render_stage_create_info->attachment_descriptions = yCMemoryAllocate(sizeof(VkAttachmentDescription) * render_stage_create_info->attachment_count);
     render_stage_create_info->attachment_descriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
     render_stage_create_info->attachment_descriptions[0].samples = VK_SAMPLE_COUNT_1_BIT;
-    render_stage_create_info->attachment_descriptions[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    render_stage_create_info->attachment_descriptions[0].loadOp = is_late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     render_stage_create_info->attachment_descriptions[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     render_stage_create_info->attachment_descriptions[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     render_stage_create_info->attachment_descriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    render_stage_create_info->attachment_descriptions[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    render_stage_create_info->attachment_descriptions[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    render_stage_create_info->attachment_descriptions[0].initialLayout = is_late ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    render_stage_create_info->attachment_descriptions[0].finalLayout = is_late ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     render_stage_create_info->attachment_descriptions[1].format = VK_FORMAT_D32_SFLOAT_S8_UINT;
     render_stage_create_info->attachment_descriptions[1].samples = VK_SAMPLE_COUNT_1_BIT;
-    render_stage_create_info->attachment_descriptions[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    render_stage_create_info->attachment_descriptions[1].loadOp = is_late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     render_stage_create_info->attachment_descriptions[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     render_stage_create_info->attachment_descriptions[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     render_stage_create_info->attachment_descriptions[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    render_stage_create_info->attachment_descriptions[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    render_stage_create_info->attachment_descriptions[1].initialLayout = is_late ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     render_stage_create_info->attachment_descriptions[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     render_stage_create_info->subpass_count = 1;
     render_stage_create_info->subpass_configs = yCMemoryAllocate(sizeof(YsSubpassConfig) * render_stage_create_info->subpass_count);
@@ -72,23 +106,21 @@ static b8 initialize(YsVkContext* context,
     render_stage_create_info->subpass_configs[0].subpass_description.colorAttachmentCount = 1;
     render_stage_create_info->subpass_configs[0].subpass_description.pColorAttachments = &render_stage_create_info->subpass_configs[0].attachment_references[0];
     render_stage_create_info->subpass_configs[0].subpass_description.pDepthStencilAttachment = &render_stage_create_info->subpass_configs[0].attachment_references[1];
-    render_stage_create_info->framebuffer_count = context->swapchain->image_count;
-    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
-    for(int i = 0; i < render_stage_create_info->framebuffer_count; ++i) {
-        VkImageView* image_views = yCMemoryAllocate(sizeof(VkImageView) * render_stage_create_info->attachment_count);
-        image_views[0] = resources->rasterization_color_image->layer_views[i];
-        image_views[1] = resources->rasterization_depth_image->layer_views[i];
-        render_stage_create_info->framebuffer_create_info[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        render_stage_create_info->framebuffer_create_info[i].attachmentCount = render_stage_create_info->attachment_count;
-        render_stage_create_info->framebuffer_create_info[i].pAttachments = image_views;
-        render_stage_create_info->framebuffer_create_info[i].width = resources->rasterization_color_image->create_info->extent.width;
-        render_stage_create_info->framebuffer_create_info[i].height = resources->rasterization_color_image->create_info->extent.height;
-        render_stage_create_info->framebuffer_create_info[i].layers = 1;
-    }
-    rasterization_system->render_stage = yVkAllocateRenderStageObject();
-    rasterization_system->render_stage->create(context,
-                                               render_stage_create_info,
-                                               rasterization_system->render_stage);
+    fillFramebufferCreateInfos(context, resources, render_stage_create_info);
+    YsVkRenderStage* render_stage = yVkAllocateRenderStageObject();
+    render_stage->create(context,
+                         render_stage_create_info,
+                         render_stage);
+
+    return render_stage;
+}
+
+static b8 initialize(YsVkContext* context,
+                     YsVkResources* resources,
+                     YsVkRasterizationSystem* rasterization_system) {
+    // Render Stage
+    rasterization_system->render_stage = createRenderStage(context, resources, false);
+    rasterization_system->late_render_stage = createRenderStage(context, resources, true);
 
     //
     const u32 vertex_input_description_count = 3;
@@ -116,23 +148,12 @@ static b8 initialize(YsVkContext* context,
     rasterization_pipeline_config->shader_config.shader_stage_config[1].source = getSpvCode(Rasterization_Frag);
     rasterization_pipeline_config->render_stage = rasterization_system->render_stage;
     rasterization_pipeline_config->vertex_input_info = &pipeline_vertex_info;
-    rasterization_pipeline_config->descriptor_count = 3;
+    rasterization_pipeline_config->descriptor_count = 1;
     rasterization_pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * rasterization_pipeline_config->descriptor_count);
-    rasterization_pipeline_config->descriptors[0] = resources->ubo_descriptor;
-    rasterization_pipeline_config->descriptors[1] = resources->ssbo_descriptor;
-    rasterization_pipeline_config->descriptors[2] = resources->shadow_map_image_descriptor;
+    rasterization_pipeline_config->descriptors[0] = resources->global_descriptor;
     rasterization_pipeline_config->push_constant_range_count = resources->push_constant_range_count;
     rasterization_pipeline_config->push_constant_range = resources->push_constant_range;
-    rasterization_pipeline_config->viewport.x = 0.0f;
-    rasterization_pipeline_config->viewport.y = 0.0f;
-    rasterization_pipeline_config->viewport.width = resources->rasterization_color_image->create_info->extent.width;
-    rasterization_pipeline_config->viewport.height = resources->rasterization_color_image->create_info->extent.height;
-    rasterization_pipeline_config->viewport.minDepth = 0.0f;
-    rasterization_pipeline_config->viewport.maxDepth = 1.0f;
-    rasterization_pipeline_config->scissor.offset.x = 0;
-    rasterization_pipeline_config->scissor.offset.y = 0;
-    rasterization_pipeline_config->scissor.extent.width = resources->rasterization_color_image->create_info->extent.width;
-    rasterization_pipeline_config->scissor.extent.height = resources->rasterization_color_image->create_info->extent.height;
+    setViewport(resources, rasterization_pipeline_config);
     rasterization_system->pipeline = yVkAllocatePipelineObject();
     if (!rasterization_system->pipeline->create(context,
                                                 rasterization_pipeline_config,
@@ -141,6 +162,23 @@ static b8 initialize(YsVkContext* context,
         return false;
     }
 
+    //
+    rasterization_system->secondary_command_buffers = (VkCommandBuffer*)yCMemoryAllocate(sizeof(VkCommandBuffer) * context->swapchain->max_frames_in_flight);
+    rasterization_system->late_secondary_command_buffers = (VkCommandBuffer*)yCMemoryAllocate(sizeof(VkCommandBuffer) * context->swapchain->max_frames_in_flight);
+    rasterization_system->secondary_command_buffer_generations = (u64*)yCMemoryAllocate(sizeof(u64) * context->swapchain->max_frames_in_flight);
+    for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        context->device->commandBufferAllocate(context,
+                                               context->device->commandUnitsAt(context->device, i),
+                                               COMMAND_POOL_RECORDING_THREAD_BEGIN + RECORDING_THREAD_RASTERIZATION,
+                                               false,
+                                               &rasterization_system->secondary_command_buffers[i]);
+        context->device->commandBufferAllocate(context,
+                                               context->device->commandUnitsAt(context->device, i),
+                                               COMMAND_POOL_RECORDING_THREAD_BEGIN + RECORDING_THREAD_RASTERIZATION,
+                                               false,
+                                               &rasterization_system->late_secondary_command_buffers[i]);
+    }
+
     // Sync objects.
     rasterization_system->complete_semaphores = yCMemoryAllocate(sizeof(VkSemaphore) * context->swapchain->max_frames_in_flight);
     for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
@@ -154,36 +192,18 @@ static b8 initialize(YsVkContext* context,
     return true;
 }
 
-static void cmdDrawCall(YsVkContext* context,
-                        YsVkCommandUnit* command_unit,
-                        u32 command_buffer_index,
-                        YsVkResources* resources,
-                        u32 current_present_image_index,
-                        u32 current_frame,
-                        void* push_constant_data,
-                        YsVkRasterizationSystem* rasterization_system) {
-    VkClearValue clear_values[2];
-    clear_values[0].color.float32[0] = 0.0f;
-    clear_values[0].color.float32[1] = 0.0f;
-    clear_values[0].color.float32[2] = 0.0f;
-    clear_values[0].color.float32[3] = 1.0f;
-    clear_values[1].depthStencil.depth = 1.0f;
-    clear_values[1].depthStencil.stencil = 0;
-
-    vkCmdSetViewport(command_unit->command_buffers[command_buffer_index], 0, 1, &rasterization_system->pipeline->config->viewport);
-    vkCmdSetScissor(command_unit->command_buffers[command_buffer_index], 0, 1, &rasterization_system->pipeline->config->scissor);
+// Push constants are baked in at record time, the rasterization shaders do not read the per-frame values.
+static void cmdRecordDraw(YsVkContext* context,
+                          VkCommandBuffer command_buffer,
+                          YsVkResources* resources,
+                          u32 current_frame,
+                          u32 view,
+                          void* push_constant_data,
+                          YsVkRasterizationSystem* rasterization_system) {
+    vkCmdSetViewport(command_buffer, 0, 1, &rasterization_system->pipeline->config->viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &rasterization_system->pipeline->config->scissor);
 
-    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_pass_begin_info.renderPass = rasterization_system->render_stage->render_pass_handle;
-    render_pass_begin_info.framebuffer = rasterization_system->render_stage->framebuffers[current_frame];
-    render_pass_begin_info.renderArea = rasterization_system->pipeline->config->scissor;
-    render_pass_begin_info.clearValueCount = rasterization_system->render_stage->create_info->attachment_count;
-    render_pass_begin_info.pClearValues = clear_values;
-    vkCmdBeginRenderPass(command_unit->command_buffers[command_buffer_index], 
-                         &render_pass_begin_info,
-                         VK_SUBPASS_CONTENTS_INLINE);                                                    
-
-    vkCmdBindPipeline(command_unit->command_buffers[command_buffer_index],
+    vkCmdBindPipeline(command_buffer,
                       VK_PIPELINE_BIND_POINT_GRAPHICS,
                       rasterization_system->pipeline->handle);
 
@@ -191,7 +211,7 @@ static void cmdDrawCall(YsVkContext* context,
                                   resources->vertex_input_normal_buffer->handle,
                                   resources->vertex_input_material_id_buffer->handle};
     VkDeviceSize vertex_offsets[3] = {0};
-    vkCmdBindVertexBuffers(command_unit->command_buffers[command_buffer_index],
+    vkCmdBindVertexBuffers(command_buffer,
                            0,
                            3,
                            vertex_buffers,
@@ -202,7 +222,7 @@ static void cmdDrawCall(YsVkContext* context,
                                                   &rasterization_system->pipeline->config->descriptors[i].descriptor_sets[0] :
                                                   &rasterization_system->pipeline->config->descriptors[i].descriptor_sets[current_frame];                     
 
-        vkCmdBindDescriptorSets(command_unit->command_buffers[command_buffer_index],
+        vkCmdBindDescriptorSets(command_buffer,
                                 VK_PIPELINE_BIND_POINT_GRAPHICS,
                                 rasterization_system->pipeline->pipeline_layout,
                                 rasterization_system->pipeline->config->descriptors[i].set,
@@ -212,27 +232,157 @@ static void cmdDrawCall(YsVkContext* context,
                                 NULL); 
     }
                                                       
-    vkCmdPushConstants(command_unit->command_buffers[command_buffer_index],
+    vkCmdPushConstants(command_buffer,
                        rasterization_system->pipeline->pipeline_layout,
                        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
                        0,
                        yPushConstantSize(),
                        push_constant_data);
 
-    vkCmdDraw(command_unit->command_buffers[command_buffer_index],
-              resources->current_draw_vertex_count,
-              1,
-              0,
-              0);
+    yVkCmdDrawCulled(context,
+                     command_buffer,
+                     resources,
+                     current_frame,
+                     view);
+}
+
+static void cmdRecordSecondary(YsVkContext* context,
+                               YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               YsVkRasterizationSystem* rasterization_system) {
+    if(rasterization_system->secondary_command_buffer_generations[current_frame] == resources->command_generation) {
+        return;
+    }
+
+    VkCommandBuffer secondary_command_buffer = rasterization_system->secondary_command_buffers[current_frame];
+    context->device->commandBufferBeginSecondary(context->device,
+                                                 secondary_command_buffer,
+                                                 rasterization_system->render_stage->render_pass_handle,
+                                                 0,
+                                                 rasterization_system->render_stage->framebuffers[current_frame]);
+    cmdRecordDraw(context, secondary_command_buffer, resources, current_frame, DRAW_VIEW_CAMERA, push_constant_data, rasterization_system);
+    context->device->commandBufferEnd(secondary_command_buffer);
+
+    // The pipeline is compatible with both stages, they differ in load operations and layouts only.
+    VkCommandBuffer late_secondary_command_buffer = rasterization_system->late_secondary_command_buffers[current_frame];
+    context->device->commandBufferBeginSecondary(context->device,
+                                                 late_secondary_command_buffer,
+                                                 rasterization_system->late_render_stage->render_pass_handle,
+                                                 0,
+                                                 rasterization_system->late_render_stage->framebuffers[current_frame]);
+    cmdRecordDraw(context, late_secondary_command_buffer, resources, current_frame, DRAW_VIEW_CAMERA_LATE, push_constant_data, rasterization_system);
+    context->device->commandBufferEnd(late_secondary_command_buffer);
+    rasterization_system->secondary_command_buffer_generations[current_frame] = resources->command_generation;
+}
+
+static void cmdRunRenderStage(VkCommandBuffer command_buffer,
+                              YsVkRenderStage* render_stage,
+                              VkCommandBuffer secondary_command_buffer,
+                              u32 current_frame,
+                              YsVkRasterizationSystem* rasterization_system) {
+    VkClearValue clear_values[2];
+    clear_values[0].color.float32[0] = 0.0f;
+    clear_values[0].color.float32[1] = 0.0f;
+    clear_values[0].color.float32[2] = 0.0f;
+    clear_values[0].color.float32[3] = 1.0f;
+    clear_values[1].depthStencil.depth = 1.0f;
+    clear_values[1].depthStencil.stencil = 0;
+
+    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    render_pass_begin_info.renderPass = render_stage->render_pass_handle;
+    render_pass_begin_info.framebuffer = render_stage->framebuffers[current_frame];
+    render_pass_begin_info.renderArea = rasterization_system->pipeline->config->scissor;
+    render_pass_begin_info.clearValueCount = render_stage->create_info->attachment_count;
+    render_pass_begin_info.pClearValues = clear_values;
+    vkCmdBeginRenderPass(command_buffer, 
+                         &render_pass_begin_info,
+                         VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    vkCmdExecuteCommands(command_buffer, 1, &secondary_command_buffer);
+
+    vkCmdEndRenderPass(command_buffer);
+}
+
+static void cmdDrawCall(YsVkContext* context,
+                        YsVkCommandUnit* command_unit,
+                        u32 command_buffer_index,
+                        YsVkResources* resources,
+                        u32 current_present_image_index,
+                        u32 current_frame,
+                        void* push_constant_data,
+                        YsVkRasterizationSystem* rasterization_system) {
+    cmdRunRenderStage(command_unit->command_buffers[command_buffer_index],
+                      rasterization_system->render_stage,
+                      rasterization_system->secondary_command_buffers[current_frame],
+                      current_frame,
+                      rasterization_system);
+}
+
+static void cmdDrawLateCall(YsVkContext* context,
+                            YsVkCommandUnit* command_unit,
+                            u32 command_buffer_index,
+                            YsVkResources* resources,
+                            u32 current_frame,
+                            YsVkRasterizationSystem* rasterization_system) {
+    VkCommandBuffer command_buffer = command_unit->command_buffers[command_buffer_index];
+
+    // The late stage loads what the early one stored.
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | 
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | 
+                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         NULL,
+                         0,
+                         NULL);
+
+    cmdRunRenderStage(command_buffer,
+                      rasterization_system->late_render_stage,
+                      rasterization_system->late_secondary_command_buffers[current_frame],
+                      current_frame,
+                      rasterization_system);
+}
+
+static void resizeRenderStage(YsVkContext* context,
+                              YsVkResources* resources,
+                              YsVkRenderStage* render_stage) {
+    render_stage->destroyFramebuffers(context, render_stage);
+    for(int i = 0; i < render_stage->create_info->framebuffer_count; ++i) {
+        yCMemoryFree((void*)render_stage->create_info->framebuffer_create_info[i].pAttachments);
+    }
+    yCMemoryFree(render_stage->create_info->framebuffer_create_info);
+    fillFramebufferCreateInfos(context, resources, render_stage->create_info);
+    render_stage->createFramebuffers(context, render_stage);
+}
+
+static void resize(YsVkContext* context,
+                   YsVkResources* resources,
+                   YsVkRasterizationSystem* rasterization_system) {
+    resizeRenderStage(context, resources, rasterization_system->render_stage);
+    resizeRenderStage(context, resources, rasterization_system->late_render_stage);
 
-    vkCmdEndRenderPass(command_unit->command_buffers[command_buffer_index]);
+    setViewport(resources, rasterization_system->pipeline->config);
 }
 
 YsVkRasterizationSystem* yVkRasterizationSystemCreate() {
     YsVkRasterizationSystem* rasterization_system = yCMemoryAllocate(sizeof(YsVkRasterizationSystem));
     if(rasterization_system) {
         rasterization_system->initialize = initialize;
+        rasterization_system->resize = resize;
+        rasterization_system->cmdRecordSecondary = cmdRecordSecondary;
         rasterization_system->cmdDrawCall = cmdDrawCall;
+        rasterization_system->cmdDrawLateCall = cmdDrawLateCall;
     }
 
     return rasterization_system;
@@ -39,6 +39,20 @@ typedef struct YsVkRasterizationSystem {
                      struct YsVkResources* resources,
                      struct YsVkRasterizationSystem* rasterization_system);
 
+    // Rebuilds the framebuffers around the recreated images of the resources, the device must be idle.
+    void (*resize)(struct YsVkContext* context,
+                   struct YsVkResources* resources,
+                   struct YsVkRasterizationSystem* rasterization_system);
+
+    // Re-records the cached draw commands of current_frame when they are stale, called on the rasterization recording thread.
+    void (*cmdRecordSecondary)(struct YsVkContext* context,
+                               struct YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               struct YsVkRasterizationSystem* rasterization_system);
+
+    // Runs the early render pass with the cached draw commands, cmdRecordSecondary must have finished for current_frame.
+    // Leaves the color attachment to the late pass.
     void (*cmdDrawCall)(struct YsVkContext* context,
                         struct YsVkCommandUnit* command_unit,
                         u32 command_buffer_index,
@@ -48,9 +62,23 @@ typedef struct YsVkRasterizationSystem {
                         void* push_constant_data,
                         struct YsVkRasterizationSystem* rasterization_system);
 
+    // Runs the late render pass, drawing the records the late culling phase found visible over the early pass.
+    void (*cmdDrawLateCall)(struct YsVkContext* context,
+                            struct YsVkCommandUnit* command_unit,
+                            u32 command_buffer_index,
+                            struct YsVkResources* resources,
+                            u32 current_frame,
+                            struct YsVkRasterizationSystem* rasterization_system);
+
     struct YsVkRenderStage* render_stage;
+    struct YsVkRenderStage* late_render_stage;
     struct YsVkPipeline* pipeline;
     VkSemaphore* complete_semaphores;
+
+    // Draw commands per frame in flight, replayed until the command generation of the resources changes.
+    VkCommandBuffer* secondary_command_buffers;
+    VkCommandBuffer* late_secondary_command_buffers;
+    u64* secondary_command_buffer_generations;
 } YsVkRasterizationSystem;
 
 YsVkRasterizationSystem* yVkRasterizationSystemCreate();
@@ -2,12 +2,10 @@
 #include "YDeveloperConsole.hpp"
 
 
-void yRenderDeveloperConsole(YsVkCommandUnit* command_unit,
-                             u32 command_buffer_index,
+void yRenderDeveloperConsole(VkCommandBuffer command_buffer,
                              u32 current_frame, 
                              u32 image_index) {
-    YDeveloperConsole::instance()->cmdDraw(command_unit,
-                                           command_buffer_index,
+    YDeveloperConsole::instance()->cmdDraw(command_buffer,
                                            current_frame, 
                                            image_index);
 }
\ No newline at end of file
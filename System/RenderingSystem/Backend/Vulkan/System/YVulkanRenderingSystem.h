@@ -39,10 +39,12 @@ typedef struct YsVkRenderingSystem {
     struct YsVkRasterizationSystem* rasterization;
     struct YsVkShadowMappingSystem* shadow_mapping;
     struct YsVkPathTracingSystem* path_tracing;
+    struct YsVkCullingSystem* culling;
+    struct YsVkUpscalingSystem* upscaling;
 } YsVkRenderingSystem;
 
-void yRenderDeveloperConsole(struct YsVkCommandUnit* command_unit,
-                             u32 command_buffer_index,
+// Records the console into a secondary buffer that continues the output subpass.
+void yRenderDeveloperConsole(VkCommandBuffer command_buffer,
                              u32 current_frame, 
                              u32 image_index);
 
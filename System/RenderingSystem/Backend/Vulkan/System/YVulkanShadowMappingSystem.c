@@ -24,6 +24,7 @@
 
 #include "YVulkanShadowMappingSystem.h"
 #include "YVulkanOutputSystem.h"
+#include "YVulkanCullingSystem.h"
 #include "YVulkanRenderingSystem.h"
 #include "YVulkanContext.h"
 #include "YVulkanDevice.h"
@@ -33,7 +34,42 @@
 #include "YLogger.h"
 #include "YCMemoryManager.h"
 #include "YAssets.h"
+#include "YGlobalFunction.h"
 
+#include <string.h>
+
+
+// The frames in flight share the single layer of the shadow map, so they share its framebuffer too.
+static void fillFramebufferCreateInfos(YsVkContext* context,
+                                       YsVkResources* resources,
+                                       YsVkRenderStageCreateInfo* render_stage_create_info) {
+    render_stage_create_info->framebuffer_count = 1;
+    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
+    render_stage_create_info->framebuffer_create_info[0].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    render_stage_create_info->framebuffer_create_info[0].attachmentCount = render_stage_create_info->attachment_count;
+    render_stage_create_info->framebuffer_create_info[0].pAttachments = &resources->shadow_map_image->image_view;
+    render_stage_create_info->framebuffer_create_info[0].width = resources->shadow_map_image->create_info->extent.width;
+    render_stage_create_info->framebuffer_create_info[0].height = resources->shadow_map_image->create_info->extent.height;
+    render_stage_create_info->framebuffer_create_info[0].layers = 1;
+}
+
+// The cascades are square and laid out side by side, the viewport covers the first one.
+static u32 cascadeCount(YsVkResources* resources) {
+    return resources->shadow_map_image->create_info->extent.width / resources->shadow_map_image->create_info->extent.height;
+}
+
+static void setViewport(YsVkResources* resources, YsVkPipelineConfig* pipeline_config) {
+    pipeline_config->viewport.x = 0.0f;
+    pipeline_config->viewport.y = 0.0f;
+    pipeline_config->viewport.width = resources->shadow_map_image->create_info->extent.height;
+    pipeline_config->viewport.height = resources->shadow_map_image->create_info->extent.height;
+    pipeline_config->viewport.minDepth = 0.0f;
+    pipeline_config->viewport.maxDepth = 1.0f;
+    pipeline_config->scissor.offset.x = 0;
+    pipeline_config->scissor.offset.y = 0;
+    pipeline_config->scissor.extent.width = resources->shadow_map_image->create_info->extent.height;
+    pipeline_config->scissor.extent.height = resources->shadow_map_image->create_info->extent.height;
+}
 
 static b8 initialize(YsVkContext* context,
                                           YsVkResources* resources,
@@ -58,16 +94,7 @@ static b8 initialize(YsVkContext* context,
     render_stage_create_info->subpass_configs[0].attachment_references[0].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     render_stage_create_info->subpass_configs[0].subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     render_stage_create_info->subpass_configs[0].subpass_description.pDepthStencilAttachment = &render_stage_create_info->subpass_configs[0].attachment_references[0];
-    render_stage_create_info->framebuffer_count = context->swapchain->image_count;
-    render_stage_create_info->framebuffer_create_info = yCMemoryAllocate(sizeof(VkFramebufferCreateInfo) * render_stage_create_info->framebuffer_count);
-    for(int i = 0; i < render_stage_create_info->framebuffer_count; ++i) {
-        render_stage_create_info->framebuffer_create_info[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        render_stage_create_info->framebuffer_create_info[i].attachmentCount = render_stage_create_info->attachment_count;
-        render_stage_create_info->framebuffer_create_info[i].pAttachments = &resources->shadow_map_image->layer_views[i];
-        render_stage_create_info->framebuffer_create_info[i].width = resources->shadow_map_image->create_info->extent.width;
-        render_stage_create_info->framebuffer_create_info[i].height = resources->shadow_map_image->create_info->extent.height;
-        render_stage_create_info->framebuffer_create_info[i].layers = 1;
-    }
+    fillFramebufferCreateInfos(context, resources, render_stage_create_info);
     shadow_mapping_system->render_stage = yVkAllocateRenderStageObject();
     shadow_mapping_system->render_stage->create(context,
                                                 render_stage_create_info,
@@ -92,19 +119,12 @@ static b8 initialize(YsVkContext* context,
     shadow_map_pipeline_config->shader_config.shader_stage_config[1].source = getSpvCode(Shadow_Map_Frag);
     shadow_map_pipeline_config->render_stage = shadow_mapping_system->render_stage;
     shadow_map_pipeline_config->vertex_input_info = &pipeline_vertex_info;
+    shadow_map_pipeline_config->push_constant_range_count = resources->push_constant_range_count;
+    shadow_map_pipeline_config->push_constant_range = resources->push_constant_range;
     shadow_map_pipeline_config->descriptor_count = 1;
     shadow_map_pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * shadow_map_pipeline_config->descriptor_count);
-    shadow_map_pipeline_config->descriptors[0] = resources->ubo_descriptor;
-    shadow_map_pipeline_config->viewport.x = 0.0f;
-    shadow_map_pipeline_config->viewport.y = 0.0f;
-    shadow_map_pipeline_config->viewport.width = resources->shadow_map_image->create_info->extent.width;
-    shadow_map_pipeline_config->viewport.height = resources->shadow_map_image->create_info->extent.height;
-    shadow_map_pipeline_config->viewport.minDepth = 0.0f;
-    shadow_map_pipeline_config->viewport.maxDepth = 1.0f;
-    shadow_map_pipeline_config->scissor.offset.x = 0;
-    shadow_map_pipeline_config->scissor.offset.y = 0;
-    shadow_map_pipeline_config->scissor.extent.width = resources->shadow_map_image->create_info->extent.width;
-    shadow_map_pipeline_config->scissor.extent.height = resources->shadow_map_image->create_info->extent.height;
+    shadow_map_pipeline_config->descriptors[0] = resources->global_descriptor;
+    setViewport(resources, shadow_map_pipeline_config);
     shadow_mapping_system->pipeline = yVkAllocatePipelineObject();
     if (!shadow_mapping_system->pipeline->create(context,
                                                  shadow_map_pipeline_config,
@@ -113,6 +133,17 @@ static b8 initialize(YsVkContext* context,
         return false;
     }
 
+    //
+    shadow_mapping_system->secondary_command_buffers = (VkCommandBuffer*)yCMemoryAllocate(sizeof(VkCommandBuffer) * context->swapchain->max_frames_in_flight);
+    shadow_mapping_system->secondary_command_buffer_generations = (u64*)yCMemoryAllocate(sizeof(u64) * context->swapchain->max_frames_in_flight);
+    for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
+        context->device->commandBufferAllocate(context,
+                                               context->device->commandUnitsAt(context->device, i),
+                                               COMMAND_POOL_RECORDING_THREAD_BEGIN + RECORDING_THREAD_SHADOW_MAPPING,
+                                               false,
+                                               &shadow_mapping_system->secondary_command_buffers[i]);
+    }
+
     //
     shadow_mapping_system->complete_semaphores = (VkSemaphore*)yCMemoryAllocate(sizeof(VkSemaphore) * context->swapchain->max_frames_in_flight);
     for (u8 i = 0; i < context->swapchain->max_frames_in_flight; ++i) {
@@ -126,38 +157,18 @@ static b8 initialize(YsVkContext* context,
     return true;
 }
 
-static void cmdDrawCall(YsVkContext* context,
-                        YsVkCommandUnit* command_unit,
-                        u32 command_buffer_index,
-                        YsVkResources* resources,
-                        u32 current_present_image_index,
-                        u32 current_frame,
-                        void* push_constant_data,
-                        YsVkShadowMappingSystem* shadow_mapping_system) {
-    //
-    VkClearValue clear_value;
-    clear_value.depthStencil.depth = 1.0f;
-    clear_value.depthStencil.stencil = 0;
-
-    vkCmdSetViewport(command_unit->command_buffers[command_buffer_index], 0, 1, &shadow_mapping_system->pipeline->config->viewport);
-    vkCmdSetScissor(command_unit->command_buffers[command_buffer_index], 0, 1, &shadow_mapping_system->pipeline->config->scissor);
-
-    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_pass_begin_info.renderPass = shadow_mapping_system->render_stage->render_pass_handle;
-    render_pass_begin_info.framebuffer = shadow_mapping_system->render_stage->framebuffers[current_frame];
-    render_pass_begin_info.renderArea = shadow_mapping_system->pipeline->config->scissor;
-    render_pass_begin_info.clearValueCount = shadow_mapping_system->render_stage->create_info->attachment_count;
-    render_pass_begin_info.pClearValues = &clear_value;
-    vkCmdBeginRenderPass(command_unit->command_buffers[command_buffer_index], 
-                         &render_pass_begin_info,
-                         VK_SUBPASS_CONTENTS_INLINE);                                                     
-
-    vkCmdBindPipeline(command_unit->command_buffers[command_buffer_index],
+static void cmdRecordDraw(YsVkContext* context,
+                          VkCommandBuffer command_buffer,
+                          YsVkResources* resources,
+                          u32 current_frame,
+                          void* push_constant_data,
+                          YsVkShadowMappingSystem* shadow_mapping_system) {
+    vkCmdBindPipeline(command_buffer,
                       VK_PIPELINE_BIND_POINT_GRAPHICS,
                       shadow_mapping_system->pipeline->handle);
 
     VkDeviceSize vertex_offsets = 0;
-    vkCmdBindVertexBuffers(command_unit->command_buffers[command_buffer_index],
+    vkCmdBindVertexBuffers(command_buffer,
                            0,
                            1,
                            &resources->vertex_input_position_buffer->handle,
@@ -168,7 +179,7 @@ static void cmdDrawCall(YsVkContext* context,
                                                   &shadow_mapping_system->pipeline->config->descriptors[i].descriptor_sets[0] :
                                                   &shadow_mapping_system->pipeline->config->descriptors[i].descriptor_sets[current_frame];
 
-        vkCmdBindDescriptorSets(command_unit->command_buffers[command_buffer_index],
+        vkCmdBindDescriptorSets(command_buffer,
                             VK_PIPELINE_BIND_POINT_GRAPHICS,
                             shadow_mapping_system->pipeline->pipeline_layout,
                             shadow_mapping_system->pipeline->config->descriptors[i].set,
@@ -178,19 +189,107 @@ static void cmdDrawCall(YsVkContext* context,
                             NULL);              
     }                                      
 
-    vkCmdDraw(command_unit->command_buffers[command_buffer_index],
-              resources->current_draw_vertex_count,
-              1,
-              0,
-              0);
+    // The light view list is culled against the whole light frustum, every cascade draws it with its own crop.
+    u32 push_constant_size = yPushConstantSize();
+    u8* push_constant = yCMemoryAllocate(push_constant_size);
+    memcpy(push_constant, push_constant_data, push_constant_size);
+    for(u32 cascade = 0; cascade < cascadeCount(resources); ++cascade) {
+        VkViewport viewport = shadow_mapping_system->pipeline->config->viewport;
+        viewport.x = viewport.width * cascade;
+        VkRect2D scissor = shadow_mapping_system->pipeline->config->scissor;
+        scissor.offset.x = scissor.extent.width * cascade;
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+        *(i32*)(push_constant + PUSH_CONSTANT_SHADOW_MAP_CASCADE_OFFSET) = cascade;
+        vkCmdPushConstants(command_buffer,
+                           shadow_mapping_system->pipeline->pipeline_layout,
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                           0,
+                           push_constant_size,
+                           push_constant);
+
+        yVkCmdDrawCulled(context,
+                         command_buffer,
+                         resources,
+                         current_frame,
+                         DRAW_VIEW_LIGHT);
+    }
+    yCMemoryFree(push_constant);
+}
+
+static void cmdRecordSecondary(YsVkContext* context,
+                               YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               YsVkShadowMappingSystem* shadow_mapping_system) {
+    if(shadow_mapping_system->secondary_command_buffer_generations[current_frame] == resources->command_generation) {
+        return;
+    }
+
+    VkCommandBuffer secondary_command_buffer = shadow_mapping_system->secondary_command_buffers[current_frame];
+    context->device->commandBufferBeginSecondary(context->device,
+                                                 secondary_command_buffer,
+                                                 shadow_mapping_system->render_stage->render_pass_handle,
+                                                 0,
+                                                 shadow_mapping_system->render_stage->framebuffers[0]);
+    cmdRecordDraw(context, secondary_command_buffer, resources, current_frame, push_constant_data, shadow_mapping_system);
+    context->device->commandBufferEnd(secondary_command_buffer);
+    shadow_mapping_system->secondary_command_buffer_generations[current_frame] = resources->command_generation;
+}
+
+static void cmdDrawCall(YsVkContext* context,
+                        YsVkCommandUnit* command_unit,
+                        u32 command_buffer_index,
+                        YsVkResources* resources,
+                        u32 current_present_image_index,
+                        u32 current_frame,
+                        void* push_constant_data,
+                        YsVkShadowMappingSystem* shadow_mapping_system) {
+    //
+    VkFramebuffer framebuffer = shadow_mapping_system->render_stage->framebuffers[0];
+    VkCommandBuffer secondary_command_buffer = shadow_mapping_system->secondary_command_buffers[current_frame];
+
+    VkClearValue clear_value;
+    clear_value.depthStencil.depth = 1.0f;
+    clear_value.depthStencil.stencil = 0;
+
+    VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    render_pass_begin_info.renderPass = shadow_mapping_system->render_stage->render_pass_handle;
+    render_pass_begin_info.framebuffer = framebuffer;
+    render_pass_begin_info.renderArea.offset.x = 0;
+    render_pass_begin_info.renderArea.offset.y = 0;
+    render_pass_begin_info.renderArea.extent.width = resources->shadow_map_image->create_info->extent.width;
+    render_pass_begin_info.renderArea.extent.height = resources->shadow_map_image->create_info->extent.height;
+    render_pass_begin_info.clearValueCount = shadow_mapping_system->render_stage->create_info->attachment_count;
+    render_pass_begin_info.pClearValues = &clear_value;
+    vkCmdBeginRenderPass(command_unit->command_buffers[command_buffer_index], 
+                         &render_pass_begin_info,
+                         VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    vkCmdExecuteCommands(command_unit->command_buffers[command_buffer_index], 1, &secondary_command_buffer);
 
     vkCmdEndRenderPass(command_unit->command_buffers[command_buffer_index]);
 }
 
+static void resize(YsVkContext* context,
+                   YsVkResources* resources,
+                   YsVkShadowMappingSystem* shadow_mapping_system) {
+    YsVkRenderStage* render_stage = shadow_mapping_system->render_stage;
+    render_stage->destroyFramebuffers(context, render_stage);
+    yCMemoryFree(render_stage->create_info->framebuffer_create_info);
+    fillFramebufferCreateInfos(context, resources, render_stage->create_info);
+    render_stage->createFramebuffers(context, render_stage);
+
+    setViewport(resources, shadow_mapping_system->pipeline->config);
+}
+
 YsVkShadowMappingSystem* yVkMainShadowMappingCreate() {
     YsVkShadowMappingSystem* shadow_mapping_system = yCMemoryAllocate(sizeof(YsVkShadowMappingSystem));
     if(shadow_mapping_system) {
         shadow_mapping_system->initialize = initialize;
+        shadow_mapping_system->resize = resize;
+        shadow_mapping_system->cmdRecordSecondary = cmdRecordSecondary;
         shadow_mapping_system->cmdDrawCall = cmdDrawCall;
     }
 
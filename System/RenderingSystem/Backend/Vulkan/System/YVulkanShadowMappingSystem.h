@@ -39,6 +39,19 @@ typedef struct YsVkShadowMappingSystem {
                      struct YsVkResources* resources,
                      struct YsVkShadowMappingSystem* shadow_mapping_system);
 
+    // Rebuilds the framebuffers around the recreated shadow map, the device must be idle.
+    void (*resize)(struct YsVkContext* context,
+                   struct YsVkResources* resources,
+                   struct YsVkShadowMappingSystem* shadow_mapping_system);
+
+    // Re-records the cached draw commands of current_frame when they are stale, called on the shadow mapping recording thread.
+    void (*cmdRecordSecondary)(struct YsVkContext* context,
+                               struct YsVkResources* resources,
+                               u32 current_frame,
+                               void* push_constant_data,
+                               struct YsVkShadowMappingSystem* shadow_mapping_system);
+
+    // Runs the render pass with the cached draw commands, cmdRecordSecondary must have finished for current_frame.
     void (*cmdDrawCall)(struct YsVkContext* context,
                         struct YsVkCommandUnit* command_unit,
                         u32 command_buffer_index,
@@ -51,6 +64,11 @@ typedef struct YsVkShadowMappingSystem {
     struct YsVkRenderStage* render_stage;
     struct YsVkPipeline* pipeline;
     VkSemaphore* complete_semaphores;
+
+    // Draw commands per frame in flight, replayed until the command generation of the resources changes. They
+    // all draw into the one framebuffer, but read the culled draws and descriptors of their own frame.
+    VkCommandBuffer* secondary_command_buffers;
+    u64* secondary_command_buffer_generations;
 } YsVkShadowMappingSystem;
 
 YsVkShadowMappingSystem* yVkMainShadowMappingCreate();
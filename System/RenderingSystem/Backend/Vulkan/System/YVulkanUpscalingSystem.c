@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Sheldon Yancy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "YVulkanUpscalingSystem.h"
+#include "YVulkanContext.h"
+#include "YVulkanDevice.h"
+#include "YVulkanResource.h"
+#include "YVulkanImage.h"
+#include "YLogger.h"
+#include "YCMemoryManager.h"
+#include "YAssets.h"
+
+
+static b8 initialize(YsVkContext* context,
+                     YsVkResources* resources,
+                     YsVkUpscalingSystem* upscaling_system) {
+    YsVkPipelineConfig* pipeline_config = yCMemoryAllocate(sizeof(YsVkPipelineConfig));
+    pipeline_config->pipeline_type = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_config->shader_config.shader_stage_config_count = 1;
+    pipeline_config->shader_config.shader_stage_config[0].stage_flag = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_config->shader_config.shader_stage_config[0].source_length = getSpvCodeSize(Upscaling_Comp);
+    pipeline_config->shader_config.shader_stage_config[0].source = getSpvCode(Upscaling_Comp);
+
+    pipeline_config->descriptor_count = 1;
+    pipeline_config->descriptors = (YsVkDescriptor*)yCMemoryAllocate(sizeof(YsVkDescriptor) * pipeline_config->descriptor_count);
+    pipeline_config->descriptors[0] = resources->global_descriptor;
+    pipeline_config->push_constant_range_count = resources->push_constant_range_count;
+    pipeline_config->push_constant_range = resources->push_constant_range;
+
+    upscaling_system->pipeline = yVkAllocatePipelineObject();
+    if (!upscaling_system->pipeline->create(context,
+                                            pipeline_config,
+                                            upscaling_system->pipeline)) {
+        YERROR("Create Upscaling Pipeline Failed.");
+        return false;
+    }
+
+    return true;
+}
+
+static void cmdDispatchCall(YsVkContext* context,
+                            VkCommandBuffer command_buffer,
+                            YsVkResources* resources,
+                            u32 current_frame,
+                            YsVkUpscalingSystem* upscaling_system) {
+    YsVkPipeline* pipeline = upscaling_system->pipeline;
+    vkCmdBindPipeline(command_buffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      pipeline->handle);
+
+    for(int i = 0; i < pipeline->config->descriptor_count; ++i) {
+        const VkDescriptorSet* p_descriptor_set = pipeline->config->descriptors[i].is_single_descriptor_set ?
+                                                  &pipeline->config->descriptors[i].descriptor_sets[0] :
+                                                  &pipeline->config->descriptors[i].descriptor_sets[current_frame];
+
+        vkCmdBindDescriptorSets(command_buffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipeline->pipeline_layout,
+                                pipeline->config->descriptors[i].set,
+                                1,
+                                p_descriptor_set,
+                                0,
+                                NULL);
+    }
+
+    // One invocation per display texel.
+    u32 width = resources->upscaling_image->create_info->extent.width;
+    u32 height = resources->upscaling_image->create_info->extent.height;
+    vkCmdDispatch(command_buffer,
+                  (width + 8 - 1) / 8,
+                  (height + 8 - 1) / 8,
+                  1);
+}
+
+YsVkUpscalingSystem* yVkUpscalingSystemCreate() {
+    YsVkUpscalingSystem* upscaling_system = yCMemoryAllocate(sizeof(YsVkUpscalingSystem));
+    if(upscaling_system) {
+        upscaling_system->initialize = initialize;
+        upscaling_system->cmdDispatchCall = cmdDispatchCall;
+    }
+
+    return upscaling_system;
+}
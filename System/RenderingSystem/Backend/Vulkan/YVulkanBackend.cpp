@@ -31,9 +31,14 @@
 #include "YVulkanOutputSystem.h"
 #include "YVulkanImage.h"
 #include "YVulkanBuffer.h"
+#include "YVulkanStagingBuffer.h"
+#include "YVulkanUploadQueue.h"
+#include "YVulkanRenderGraph.h"
 #include "YVulkanRasterizationSystem.h"
 #include "YVulkanShadowMappingSystem.h"
 #include "YVulkanPathTracingSystem.h"
+#include "YVulkanCullingSystem.h"
+#include "YVulkanUpscalingSystem.h"
 #include "YLogger.h"
 #include "YCMemoryManager.h"
 #include "YDeveloperConsole.hpp"
@@ -47,8 +52,18 @@
 #include <cstdio>
 #include <cstdint>
 #include <cinttypes>
+#include <algorithm>
+#include <chrono>
 
 
+static VkPresentModeKHR vkPresentMode(YePresentMode present_mode) {
+    switch (present_mode) {
+        case YePresentMode::Mailbox: return VK_PRESENT_MODE_MAILBOX_KHR;
+        case YePresentMode::Immediate: return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        default: return VK_PRESENT_MODE_FIFO_KHR;
+    }
+}
+
 YVulkanBackend::YVulkanBackend() {
 
     yCMemorySystemInitialize();
@@ -66,10 +81,12 @@ YVulkanBackend::YVulkanBackend() {
         vk_enable_layers[i] = this->m_enable_layers[i].layerName;
     }
 
-    glm::fvec2 main_window_size = YRendererFrontendManager::instance()->mainWindowSize();
+    this->m_swapchain_request_size = YRendererFrontendManager::instance()->mainWindowFramebufferSize();
+    this->m_swapchain_request_present_mode = vkPresentMode(YRendererBackendManager::instance()->getPresentMode());
     this->m_vk_context = yVkContextCreate();
-    this->m_vk_context->initialize(main_window_size.x,
-                                   main_window_size.y,
+    this->m_vk_context->initialize(this->m_swapchain_request_size.x,
+                                   this->m_swapchain_request_size.y,
+                                   this->m_swapchain_request_present_mode,
                                    YRendererFrontendManager::instance()->glfwWindow(),
                                    vk_enable_extensions,
                                    this->m_enable_extensions.size(),
@@ -99,36 +116,30 @@ YVulkanBackend::YVulkanBackend() {
     this->m_current_present_image_index = 0;
 
     //
-    YeRendererResolution renderer_resolution = YRendererBackendManager::instance()->rendererResolution();
-    glm::fvec2 renderer_image_size;
-    switch (renderer_resolution){
-        case YeRendererResolution::Original: {
-            renderer_image_size = main_window_size;
-            break;
-        }
-        case YeRendererResolution::Half: {
-            renderer_image_size = main_window_size * 0.5f;
-            break;
-        }
-        case YeRendererResolution::Double: {
-            renderer_image_size = main_window_size * 2.0f;
-            break;
-        }
-        default: {
-            break;
-        }
+    YsVkResourcesImageSize image_size = this->rendererImageSize(YRendererFrontendManager::instance()->mainWindowFramebufferSize());
+    this->m_ubo.upscaling_enable = image_size.path_tracing_image_width != image_size.upscaling_image_width ||
+                                   image_size.path_tracing_image_height != image_size.upscaling_image_height;
+
+    // Both rendering models are planned up front, transient images that only one of them uses share memory.
+    this->m_render_graph = yVkAllocateRenderGraphObject();
+    this->m_render_graph->addImage(this->m_render_graph, "Rasterization Color", true);
+    this->m_render_graph->addImage(this->m_render_graph, "Rasterization Depth", true);
+    this->m_render_graph->addImage(this->m_render_graph, "Shadow Map", true);
+    this->m_render_graph->addImage(this->m_render_graph, "Path Tracing", true);
+    this->m_render_graph->addImage(this->m_render_graph, "Path Tracing Accumulation", false);
+    this->m_render_graph->addImage(this->m_render_graph, "Upscaling", false);
+    const YeRenderingModelType rendering_models[2] = {YeRenderingModelType::PathTracing, YeRenderingModelType::Rasterization};
+    for(u32 i = 0; i < 2; ++i) {
+        this->buildRenderGraph(rendering_models[i]);
+        this->m_render_graph->compile(this->m_render_graph);
+        this->m_render_graph->planConfiguration(this->m_render_graph, static_cast<u32>(rendering_models[i]));
     }
-    YsVkResourcesImageSize image_size;
-    image_size.rasterization_image_width = renderer_image_size.x;
-    image_size.rasterization_image_height = renderer_image_size.y;
-    image_size.shadow_map_image_width = renderer_image_size.x;
-    image_size.shadow_map_image_height = renderer_image_size.y;
-    image_size.random_image_width = renderer_image_size.x;
-    image_size.random_image_height = renderer_image_size.y;
-    image_size.path_tracing_image_width = renderer_image_size.x;
-    image_size.path_tracing_image_height = renderer_image_size.y;
+    this->m_render_graph->planAliases(this->m_render_graph);
+    this->m_render_graph->reset(this->m_render_graph);
+    this->m_render_graph_rendering_model = YRendererBackendManager::instance()->getRenderingModel();
 
     this->m_vk_resource = yVkAllocateResourcesObject();
+    this->m_vk_resource->render_graph = this->m_render_graph;
     this->m_vk_resource->initialize(this->m_vk_context,
                                     this->m_vk_resource,
                                     image_size);
@@ -177,11 +188,30 @@ YVulkanBackend::YVulkanBackend() {
                                                        this->m_vk_resource,
                                                        this->m_rendering_system->path_tracing);
 
+    this->m_rendering_system->culling = yVkCullingSystemCreate();
+    this->m_rendering_system->culling->initialize(this->m_vk_context,
+                                                  this->m_vk_resource,
+                                                  this->m_rendering_system->culling);
+
+    this->m_rendering_system->upscaling = yVkUpscalingSystemCreate();
+    this->m_rendering_system->upscaling->initialize(this->m_vk_context,
+                                                    this->m_vk_resource,
+                                                    this->m_rendering_system->upscaling);
+
     //
     YDeveloperConsole::instance()->init(this->m_vk_context,
                                         this->m_rendering_system,
                                         this->m_vk_resource);
 
+    YINFO("Pipeline creation took %.3f ms with a %s pipeline cache.",
+          this->m_vk_context->pipeline_creation_time,
+          this->m_vk_context->pipeline_cache_warm ? "warm" : "cold");
+
+    //
+    for(u32 i = 0; i < RECORDING_THREAD_COUNT; ++i) {
+        this->m_recording_threads.push_back(std::make_unique<YWorkerThread>());
+    }
+
     //
     this->m_init_finished = true;
 }
@@ -230,61 +260,197 @@ void YVulkanBackend::initializeSupportInfo()
 }
 
 void YVulkanBackend::shutdown() {
+    vkDeviceWaitIdle(this->m_vk_context->device->logical_device);
+    this->m_recording_threads.clear();
+
+    this->m_vk_context->savePipelineCache(this->m_vk_context);
+    vkDestroyPipelineCache(this->m_vk_context->device->logical_device,
+                           this->m_vk_context->pipeline_cache,
+                           this->m_vk_context->allocator);
+    this->m_vk_context->pipeline_cache = VK_NULL_HANDLE;
 
+    if(this->m_vk_context->gpu_timer) {
+        this->m_vk_context->gpu_timer->destroy(this->m_vk_context, this->m_vk_context->gpu_timer);
+    }
 }
 
-void YVulkanBackend::deviceUpdateVertexInput(u32 vertex_count,
-                                             void* vertex_position_data,
-                                             void* vertex_normal_data,
-                                             void* vertex_material_id_data) {
+void YVulkanBackend::waitFramesInFlight() {
     for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
         vkWaitForFences(this->m_vk_context->device->logical_device,
                         1,
                         &this->m_in_flight_fences[i],
                         true,
                         UINT64_MAX);                    
-    }                                             
+    }
+}
+
+YsVkResourcesImageSize YVulkanBackend::rendererImageSize(const glm::ivec2& display_size) {
+    glm::ivec2 renderer_image_size = YRendererBackendManager::instance()->rendererSize(display_size);
+    YsVkResourcesImageSize image_size;
+    image_size.rasterization_image_width = renderer_image_size.x;
+    image_size.rasterization_image_height = renderer_image_size.y;
+    u32 shadow_map_cascade_count = std::clamp(YRendererBackendManager::instance()->getShadowMapCascadeCount(), 1u, u32(SHADOW_MAP_MAX_CASCADE_COUNT));
+    image_size.shadow_map_image_width = YRendererBackendManager::instance()->getShadowMapResolution() * shadow_map_cascade_count;
+    image_size.shadow_map_image_height = YRendererBackendManager::instance()->getShadowMapResolution();
+    image_size.random_image_width = renderer_image_size.x;
+    image_size.random_image_height = renderer_image_size.y;
+    image_size.path_tracing_image_width = renderer_image_size.x;
+    image_size.path_tracing_image_height = renderer_image_size.y;
+    image_size.upscaling_image_width = display_size.x;
+    image_size.upscaling_image_height = display_size.y;
+
+    return image_size;
+}
+
+b8 YVulkanBackend::renderTargetsMatch(const YsVkResourcesImageSize& image_size) {
+    const VkExtent3D& path_tracing_extent = this->m_vk_resource->path_tracing_image->create_info->extent;
+    const VkExtent3D& shadow_map_extent = this->m_vk_resource->shadow_map_image->create_info->extent;
+    const VkExtent3D& upscaling_extent = this->m_vk_resource->upscaling_image->create_info->extent;
+    return image_size.path_tracing_image_width == path_tracing_extent.width &&
+           image_size.path_tracing_image_height == path_tracing_extent.height &&
+           image_size.shadow_map_image_width == shadow_map_extent.width &&
+           image_size.shadow_map_image_height == shadow_map_extent.height &&
+           image_size.upscaling_image_width == upscaling_extent.width &&
+           image_size.upscaling_image_height == upscaling_extent.height;
+}
+
+void YVulkanBackend::recreateSwapchain(const glm::ivec2& framebuffer_size, VkPresentModeKHR present_mode) {
+    vkDeviceWaitIdle(this->m_vk_context->device->logical_device);
+
+    this->m_vk_context->swapchain->create(this->m_vk_context,
+                                          framebuffer_size.x,
+                                          framebuffer_size.y,
+                                          present_mode,
+                                          this->m_vk_context->swapchain);
+    this->m_rendering_system->output->resize(this->m_vk_context, this->m_rendering_system->output);
+    this->m_swapchain_request_size = framebuffer_size;
+    this->m_swapchain_request_present_mode = present_mode;
+    this->m_need_recreate_swapchain = false;
+
+    // A new present mode keeps the extent, the render targets are only rebuilt when the framebuffer size changed.
+    YsVkResourcesImageSize image_size = this->rendererImageSize(framebuffer_size);
+    if(this->renderTargetsMatch(image_size)) {
+        return;
+    }
+
+    this->resizeRenderTargets(image_size);
+}
+
+void YVulkanBackend::resizeRenderTargets(const YsVkResourcesImageSize& image_size) {
+    this->m_vk_resource->resize(this->m_vk_context,
+                                this->m_vk_resource,
+                                image_size);
+    this->m_rendering_system->rasterization->resize(this->m_vk_context,
+                                                    this->m_vk_resource,
+                                                    this->m_rendering_system->rasterization);
+    this->m_rendering_system->shadow_mapping->resize(this->m_vk_context,
+                                                     this->m_vk_resource,
+                                                     this->m_rendering_system->shadow_mapping);
+    this->m_rendering_system->path_tracing->resize(this->m_vk_resource,
+                                                   this->m_rendering_system->path_tracing);
+    YDeveloperConsole::instance()->updateTextures();
+
+    this->m_ubo.physically_based_camera.image_sensor_width = 25.0f * (float(image_size.path_tracing_image_width) / float(image_size.path_tracing_image_height));
+    this->m_ubo.physically_based_camera.resolution[0] = image_size.path_tracing_image_width;
+    this->m_ubo.physically_based_camera.resolution[1] = image_size.path_tracing_image_height;
+    this->m_ubo.upscaling_enable = image_size.path_tracing_image_width != image_size.upscaling_image_width ||
+                                   image_size.path_tracing_image_height != image_size.upscaling_image_height;
+    this->updateHostUbo();
+
+    // The accumulation image was recreated, tracing starts over from the first tile.
+    this->m_need_reset_path_tracing_accumulation = true;
+    this->m_path_tracing_tile_cursor = 0;
+    this->m_shadow_map_dirty = true;
+    for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
+        this->m_frame_status[i].need_draw_path_tracing = true;
+        this->m_frame_status[i].need_draw_rasterization = true;
+    }
+}
+
+void YVulkanBackend::deviceUpdateVertexInput(u32 vertex_count,
+                                             void* vertex_position_data,
+                                             void* vertex_normal_data,
+                                             void* vertex_material_id_data,
+                                             u32 draw_record_count,
+                                             void* draw_record_data) {
+    // With an upload queue the copies run in the background and the buffers are swapped in by framePrepare.
+    if(this->m_vk_context->upload_queue) {
+        this->m_vk_resource->uploadVertexInputBuffer(this->m_vk_context,
+                                                     this->m_vk_resource,
+                                                     vertex_count,
+                                                     vertex_position_data,
+                                                     vertex_normal_data,
+                                                     vertex_material_id_data,
+                                                     draw_record_count,
+                                                     draw_record_data);
+        return;
+    }
+
+    // Uploads are recorded into the current frame, only a reallocation has to drain the frames in flight.
+    if(!this->m_vk_resource->vertexInputBufferFits(this->m_vk_resource, vertex_count, draw_record_count)) {
+        this->waitFramesInFlight();
+    }
 
     this->m_vk_resource->createVertexInputBuffer(this->m_vk_context,
                                                  this->m_vk_resource,
-                                                 vertex_count);
+                                                 vertex_count,
+                                                 draw_record_count);
     this->m_vk_resource->updateVertexInputBuffer(this->m_vk_context,
                                                  this->m_vk_resource,
-                                                 this->m_vk_context->device->commandUnitsFront(this->m_vk_context->device),
                                                  vertex_position_data,
                                                  vertex_normal_data,
-                                                 vertex_material_id_data);
+                                                 vertex_material_id_data,
+                                                 draw_record_data);
 }
 
-void YVulkanBackend::deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) {
-    for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
-        vkWaitForFences(this->m_vk_context->device->logical_device,
-                        1,
-                        &this->m_in_flight_fences[i],
-                        true,
-                        UINT64_MAX);                    
-    } 
+void YVulkanBackend::deviceUpdateSsbo(void* scene_info_data,
+                                      void* bvh_node_data,
+                                      void* material_data,
+                                      void* vertex_position_data,
+                                      void* vertex_normal_data,
+                                      void* vertex_material_id_data,
+                                      void* vertex_entity_id_data) {
+    GLSL_SceneInfo* scene_info = static_cast<GLSL_SceneInfo*>(scene_info_data);
+    YsVkResourcesSsboData ssbo_data = {};
+    ssbo_data.sizes[SSBO_BINDING_SCENE_INFO] = sizeof(GLSL_SceneInfo);
+    ssbo_data.data[SSBO_BINDING_SCENE_INFO] = scene_info_data;
+    ssbo_data.sizes[SSBO_BINDING_BVH_NODE] = sizeof(GLSL_BVHNode) * scene_info->bvh_node_count;
+    ssbo_data.data[SSBO_BINDING_BVH_NODE] = bvh_node_data;
+    ssbo_data.sizes[SSBO_BINDING_MATERIAL] = sizeof(GLSL_Material) * scene_info->material_count;
+    ssbo_data.data[SSBO_BINDING_MATERIAL] = material_data;
+    ssbo_data.sizes[SSBO_BINDING_VERTEX_POSITION] = sizeof(glm::fvec4) * scene_info->vertex_count;
+    ssbo_data.data[SSBO_BINDING_VERTEX_POSITION] = vertex_position_data;
+    ssbo_data.sizes[SSBO_BINDING_VERTEX_NORMAL] = sizeof(glm::fvec4) * scene_info->vertex_count;
+    ssbo_data.data[SSBO_BINDING_VERTEX_NORMAL] = vertex_normal_data;
+    ssbo_data.sizes[SSBO_BINDING_VERTEX_MATERIAL_ID] = sizeof(i32) * scene_info->vertex_count;
+    ssbo_data.data[SSBO_BINDING_VERTEX_MATERIAL_ID] = vertex_material_id_data;
+    ssbo_data.sizes[SSBO_BINDING_VERTEX_ENTITY_ID] = sizeof(i32) * scene_info->vertex_count;
+    ssbo_data.data[SSBO_BINDING_VERTEX_ENTITY_ID] = vertex_entity_id_data;
+
+    if(this->m_vk_context->upload_queue) {
+        this->m_vk_resource->uploadSsbo(this->m_vk_context,
+                                        this->m_vk_resource,
+                                        &ssbo_data);
+        return;
+    }
+
+    if(!this->m_vk_resource->ssboFits(this->m_vk_resource, &ssbo_data)) {
+        this->waitFramesInFlight();
+    }
 
     this->m_vk_resource->createSsbo(this->m_vk_context,
                                     this->m_vk_resource,
-                                    ssbo_data_size);
+                                    &ssbo_data);
     this->m_vk_resource->updateSsboBuffer(this->m_vk_context,
                                           this->m_vk_resource,
-                                          this->m_vk_context->device->commandUnitsBack(this->m_vk_context->device),
-                                          ssbo_data);                                  
+                                          &ssbo_data);                                  
 }
 
 void YVulkanBackend::deviceUpdateUbo(void* ubo_data) {
-    for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
-        vkWaitForFences(this->m_vk_context->device->logical_device,
-                        1,
-                        &this->m_in_flight_fences[i],
-                        true,
-                        UINT64_MAX);                    
-    } 
-
+    // Only the slice of the frame being recorded is written, its fence was waited on in framePrepare.
     this->m_vk_resource->updateUboBuffer(this->m_vk_context,
                                          this->m_vk_resource,
+                                         this->m_current_frame,
                                          ubo_data);   
 
     for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
@@ -293,12 +459,63 @@ void YVulkanBackend::deviceUpdateUbo(void* ubo_data) {
     }                                                                                                      
 }
 
+b8 YVulkanBackend::frameResize() {
+    // Nothing is presented while the window is minimized.
+    glm::ivec2 framebuffer_size = YRendererFrontendManager::instance()->mainWindowFramebufferSize();
+    if(0 == framebuffer_size.x || 0 == framebuffer_size.y) {
+        return false;
+    }
+
+    // Frames are indexed modulo the count, every frame has to retire before it changes.
+    YsVkSwapchain* swapchain = this->m_vk_context->swapchain;
+    u32 frames_in_flight = std::clamp(YRendererBackendManager::instance()->getFramesInFlight(), 1u, u32(swapchain->max_frames_in_flight));
+    if(frames_in_flight != swapchain->frames_in_flight) {
+        this->waitFramesInFlight();
+        swapchain->frames_in_flight = frames_in_flight;
+        this->m_current_frame = 0;
+    }
+
+    VkPresentModeKHR present_mode = vkPresentMode(YRendererBackendManager::instance()->getPresentMode());
+    if(this->m_need_recreate_swapchain ||
+       framebuffer_size != this->m_swapchain_request_size ||
+       present_mode != this->m_swapchain_request_present_mode) {
+        this->recreateSwapchain(framebuffer_size, present_mode);
+    }
+
+    // A new render scale, shadow map resolution or cascade count keeps the swapchain, only the render targets are
+    // rebuilt.
+    YsVkResourcesImageSize image_size = this->rendererImageSize(framebuffer_size);
+    if(!this->renderTargetsMatch(image_size)) {
+        vkDeviceWaitIdle(this->m_vk_context->device->logical_device);
+        this->resizeRenderTargets(image_size);
+    }
+
+    return true;
+}
+
 b8 YVulkanBackend::framePrepare() {
     vkWaitForFences(this->m_vk_context->device->logical_device,
                     1,
                     &this->m_in_flight_fences[this->m_current_frame],
                     true,
                     UINT64_MAX);
+
+    // The fence guarantees the previous uploads of this frame have been consumed.
+    this->m_vk_resource->staging_buffer->beginFrame(this->m_vk_context,
+                                                    this->m_current_frame,
+                                                    this->m_vk_resource->staging_buffer);
+
+    // A finished background upload replaces the scene that was drawn while it was copied.
+    if(this->m_vk_resource->beginFrame(this->m_vk_context,
+                                       this->m_vk_resource,
+                                       this->m_current_frame)) {
+        this->m_need_reset_path_tracing_accumulation = true;
+        this->m_shadow_map_dirty = true;
+        for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
+            this->m_frame_status[i].need_draw_path_tracing = true;
+            this->m_frame_status[i].need_draw_rasterization = true;
+        }
+    }
                 
     VkResult result = vkAcquireNextImageKHR(this->m_vk_context->device->logical_device,
                                             this->m_vk_context->swapchain->handle,
@@ -306,141 +523,882 @@ b8 YVulkanBackend::framePrepare() {
                                             this->m_image_available_semaphores[this->m_current_frame],
                                             VK_NULL_HANDLE,
                                             &this->m_current_present_image_index);
-    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        YFATAL("Failed to acquire swapchain image!");
+    // The semaphore is not signaled when the swapchain is out of date, it is recreated and acquired from again.
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        this->recreateSwapchain(YRendererFrontendManager::instance()->mainWindowFramebufferSize(),
+                                this->m_swapchain_request_present_mode);
+        result = vkAcquireNextImageKHR(this->m_vk_context->device->logical_device,
+                                       this->m_vk_context->swapchain->handle,
+                                       UINT64_MAX,
+                                       this->m_image_available_semaphores[this->m_current_frame],
+                                       VK_NULL_HANDLE,
+                                       &this->m_current_present_image_index);
+    }
+    if (result == VK_SUBOPTIMAL_KHR) {
+        this->m_need_recreate_swapchain = true;
+    } else if (result != VK_SUCCESS) {
+        YERROR("Failed to acquire swapchain image: %s", string_VkResult(result));
         return false;
     }
     
     return true;
 }
 
+u32 YVulkanBackend::pathTracingScheduleTiles(u32* tile_begin) {
+    u32 total_tile_count = this->m_rendering_system->path_tracing->tile_count;
+    u32 remaining_tile_count = total_tile_count - this->m_path_tracing_tile_cursor;
+    f32 frame_budget = YRendererBackendManager::instance()->getPathTracingFrameBudget();
+
+    // Without a budget or a measurement yet, trace everything or probe with a single tile.
+    u32 tile_count = remaining_tile_count;
+    if(frame_budget > 0.0f) {
+        tile_count = this->m_path_tracing_tile_time > 0.0 ? u32(frame_budget / this->m_path_tracing_tile_time) : 1;
+        tile_count = std::max(1u, std::min(tile_count, remaining_tile_count));
+    }
+
+    // Every tile of an accumulation frame shares one frame index, it only advances once the whole image is covered.
+    this->m_push_constant[this->m_current_frame].path_tracing_frame_index = this->m_path_tracing_frame_index;
+    *tile_begin = this->m_path_tracing_tile_cursor;
+    this->m_path_tracing_tile_cursor += tile_count;
+    if(this->m_path_tracing_tile_cursor >= total_tile_count) {
+        this->m_path_tracing_tile_cursor = 0;
+        this->m_path_tracing_frame_index++;
+    }
+
+    return tile_count;
+}
+
+void YVulkanBackend::cmdPathTracing(YsVkCommandUnit* command_unit,
+                                    u32 command_buffer_index,
+                                    u32 graphics_queue_family_index) {
+    VkCommandBuffer command_buffer = command_unit->command_buffers[command_buffer_index];
+    // On the async compute queue the output layer is acquired from and released back to the graphics family.
+    b8 is_async_compute = command_unit->queue_family_index != graphics_queue_family_index;
+
+    u32 tile_begin = 0;
+    u32 tile_count = this->pathTracingScheduleTiles(&tile_begin);
+
+    // The accumulation image is shared by all frames in flight, wait until the previous frame has traced and copied it.
+    this->m_vk_resource->path_tracing_accumulation_image->transitionLayout(command_buffer,
+                                                                           0,
+                                                                           1,
+                                                                           VK_IMAGE_LAYOUT_GENERAL,
+                                                                           VK_IMAGE_LAYOUT_GENERAL,
+                                                                           VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+                                                                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                                           command_unit->queue_family_index,
+                                                                           command_unit->queue_family_index,
+                                                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                                           this->m_vk_resource->path_tracing_accumulation_image);
+
+    // The shader only adds to the counters while the UBO asks for statistics, they start from zero every frame.
+    VkDeviceSize statistics_offset = this->m_vk_resource->path_tracing_statistics_slice_size * this->m_current_frame;
+    VkDeviceSize statistics_size = sizeof(u32) * 2 * PATH_TRACING_COUNTER_COUNT;
+    this->m_path_tracing_collected_statistics[this->m_current_frame] = YRendererBackendManager::instance()->getCollectGpuStatistics();
+    if(this->m_path_tracing_collected_statistics[this->m_current_frame]) {
+        vkCmdFillBuffer(command_buffer,
+                        this->m_vk_resource->path_tracing_statistics_buffer->handle,
+                        statistics_offset,
+                        statistics_size,
+                        0);
+
+        VkBufferMemoryBarrier statistics_barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        statistics_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        statistics_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        statistics_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        statistics_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        statistics_barrier.buffer = this->m_vk_resource->path_tracing_statistics_buffer->handle;
+        statistics_barrier.offset = statistics_offset;
+        statistics_barrier.size = statistics_size;
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0,
+                             NULL,
+                             1,
+                             &statistics_barrier,
+                             0,
+                             NULL);
+    }
+
+    vkCmdWriteTimestamp(command_buffer,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        command_unit->query_pool_timestamps,
+                        TIMESTAMP_QUERY_PATH_TRACING_BEGIN);
+
+    this->m_rendering_system->path_tracing->cmdDispatchCall(this->m_vk_context,
+                                                            command_unit,
+                                                            command_buffer_index,
+                                                            this->m_vk_resource,
+                                                            this->m_current_present_image_index,
+                                                            this->m_current_frame,
+                                                            &this->m_push_constant[this->m_current_frame],
+                                                            tile_begin,
+                                                            tile_count,
+                                                            this->m_rendering_system->path_tracing);
+
+    vkCmdWriteTimestamp(command_buffer,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        command_unit->query_pool_timestamps,
+                        TIMESTAMP_QUERY_PATH_TRACING_END);
+    this->m_path_tracing_dispatched_tile_count[this->m_current_frame] = tile_count;
+
+    if(this->m_path_tracing_collected_statistics[this->m_current_frame]) {
+        VkBufferMemoryBarrier statistics_barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        statistics_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        statistics_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        statistics_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        statistics_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        statistics_barrier.buffer = this->m_vk_resource->path_tracing_statistics_buffer->handle;
+        statistics_barrier.offset = statistics_offset;
+        statistics_barrier.size = statistics_size;
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0,
+                             0,
+                             NULL,
+                             1,
+                             &statistics_barrier,
+                             0,
+                             NULL);
+    }
+    this->m_path_tracing_command_unit[this->m_current_frame] = command_unit;
+
+    // Publish the running mean, including the tiles that were not traced this frame, to this frame's output layer.
+    this->m_vk_resource->path_tracing_accumulation_image->transitionLayout(command_buffer,
+                                                                           0,
+                                                                           1,
+                                                                           VK_IMAGE_LAYOUT_GENERAL,
+                                                                           VK_IMAGE_LAYOUT_GENERAL,
+                                                                           VK_ACCESS_SHADER_WRITE_BIT,
+                                                                           VK_ACCESS_TRANSFER_READ_BIT,
+                                                                           command_unit->queue_family_index,
+                                                                           command_unit->queue_family_index,
+                                                                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                                           this->m_vk_resource->path_tracing_accumulation_image);
+    this->m_vk_resource->path_tracing_image->transitionLayout(command_buffer,
+                                                              this->m_current_frame,
+                                                              1,
+                                                              this->m_render_graph->imageLayout(this->m_render_graph,
+                                                                                                GRAPH_IMAGE_PATH_TRACING,
+                                                                                                this->m_current_frame),
+                                                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                              is_async_compute ? VK_ACCESS_NONE : VK_ACCESS_SHADER_READ_BIT,
+                                                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                              graphics_queue_family_index,
+                                                              command_unit->queue_family_index,
+                                                              is_async_compute ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                              this->m_vk_resource->path_tracing_image);
+
+    VkImageCopy image_copy = {};
+    image_copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    image_copy.srcSubresource.mipLevel = 0;
+    image_copy.srcSubresource.baseArrayLayer = 0;
+    image_copy.srcSubresource.layerCount = 1;
+    image_copy.dstSubresource = image_copy.srcSubresource;
+    image_copy.dstSubresource.baseArrayLayer = this->m_current_frame;
+    image_copy.extent = this->m_vk_resource->path_tracing_image->create_info->extent;
+    vkCmdCopyImage(command_buffer,
+                   this->m_vk_resource->path_tracing_accumulation_image->handle,
+                   VK_IMAGE_LAYOUT_GENERAL,
+                   this->m_vk_resource->path_tracing_image->handle,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1,
+                   &image_copy);
+
+    this->m_vk_resource->path_tracing_image->transitionLayout(command_buffer,
+                                                              this->m_current_frame,
+                                                              1,
+                                                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                              is_async_compute ? VK_ACCESS_NONE : VK_ACCESS_SHADER_READ_BIT,
+                                                              command_unit->queue_family_index,
+                                                              graphics_queue_family_index,
+                                                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                              is_async_compute ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                              this->m_vk_resource->path_tracing_image);
+}
+
+void YVulkanBackend::buildRenderGraph(YeRenderingModelType rendering_model) {
+    YsVkRenderGraph* graph = this->m_render_graph;
+    const YsFrameStatus& frame_status = this->m_frame_status[this->m_current_frame];
+    u32 layer = this->m_current_frame;
+    VkPipelineStageFlags depth_stage_mask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    VkAccessFlags depth_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    graph->reset(graph);
+    this->m_render_graph_shadow_mapping_pass = RENDER_GRAPH_NONE;
+    this->m_render_graph_path_tracing_pass = RENDER_GRAPH_NONE;
+    this->m_render_graph_path_tracing_acquire_pass = RENDER_GRAPH_NONE;
+    this->m_render_graph_rasterization_pass = RENDER_GRAPH_NONE;
+    this->m_render_graph_upscaling_pass = RENDER_GRAPH_NONE;
+
+    // The shadow map has a single layer that stays valid across frames until it is dirty.
+    if(this->m_shadow_map_dirty) {
+        u32 pass = graph->addPass(graph, "Shadow Mapping", false, recordShadowMapping, this);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_SHADOW_MAP, 0,
+                         RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_DISCARD,
+                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         depth_stage_mask,
+                         depth_access_mask);
+        this->m_render_graph_shadow_mapping_pass = pass;
+    }
+
+    // Path tracing synchronizes its images itself since it may run on the compute family.
+    if(frame_status.need_draw_path_tracing) {
+        u32 pass = graph->addPass(graph, "Path Tracing", false, recordPathTracing, this);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_PATH_TRACING_ACCUMULATION, 0,
+                         RENDER_GRAPH_ACCESS_READ | RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_EXTERNAL,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_PATH_TRACING, layer,
+                         RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_EXTERNAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        this->m_render_graph_path_tracing_pass = pass;
+
+        pass = graph->addPass(graph, "Path Tracing Acquire", false, recordPathTracingAcquire, this);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_PATH_TRACING, layer,
+                         RENDER_GRAPH_ACCESS_READ | RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_EXTERNAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        this->m_render_graph_path_tracing_acquire_pass = pass;
+    }
+
+    if(frame_status.need_draw_rasterization) {
+        u32 pass = graph->addPass(graph, "Rasterization", false, recordRasterization, this);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_SHADOW_MAP, 0,
+                         RENDER_GRAPH_ACCESS_READ,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_RASTERIZATION_COLOR, layer,
+                         RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_DISCARD,
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_RASTERIZATION_DEPTH, layer,
+                         RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_DISCARD,
+                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         depth_stage_mask,
+                         depth_access_mask);
+        this->m_render_graph_rasterization_pass = pass;
+    }
+
+    graph->addPass(graph, "Scene End", true, recordSceneEnd, this);
+
+    // The upscaled layer stays valid as long as the layer it was reconstructed from, so it is only redone with it.
+    b8 upscaling_enable = 1 == this->m_ubo.upscaling_enable;
+    u32 upscaling_source_pass = YeRenderingModelType::PathTracing == rendering_model ?
+                                this->m_render_graph_path_tracing_acquire_pass :
+                                this->m_render_graph_rasterization_pass;
+    if(upscaling_enable && RENDER_GRAPH_NONE != upscaling_source_pass) {
+        u32 pass = graph->addPass(graph, "Upscaling", false, recordUpscaling, this);
+        graph->addAccess(graph, pass,
+                         YeRenderingModelType::PathTracing == rendering_model ? GRAPH_IMAGE_PATH_TRACING : GRAPH_IMAGE_RASTERIZATION_COLOR,
+                         layer,
+                         RENDER_GRAPH_ACCESS_READ,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_UPSCALING, layer,
+                         RENDER_GRAPH_ACCESS_WRITE | RENDER_GRAPH_ACCESS_DISCARD,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_WRITE_BIT);
+        this->m_render_graph_upscaling_pass = pass;
+    }
+
+    // The output pass also draws the developer console, which previews the rasterization images.
+    u32 pass = graph->addPass(graph, "Output", true, recordOutput, this);
+    if(upscaling_enable) {
+        graph->addAccess(graph, pass, GRAPH_IMAGE_UPSCALING, layer,
+                         RENDER_GRAPH_ACCESS_READ,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+    }
+    if(YeRenderingModelType::PathTracing == rendering_model) {
+        if(!upscaling_enable) {
+            graph->addAccess(graph, pass, GRAPH_IMAGE_PATH_TRACING, layer,
+                             RENDER_GRAPH_ACCESS_READ,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_ACCESS_SHADER_READ_BIT);
+        }
+    } else {
+        graph->addAccess(graph, pass, GRAPH_IMAGE_RASTERIZATION_COLOR, layer,
+                         RENDER_GRAPH_ACCESS_READ,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        graph->addAccess(graph, pass, GRAPH_IMAGE_SHADOW_MAP, 0,
+                         RENDER_GRAPH_ACCESS_READ,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+    }
+    this->m_render_graph_output_pass = pass;
+}
+
+u32 YVulkanBackend::beginGpuScope(VkCommandBuffer command_buffer, const char* name, YeVkGpuTimerStatistics statistics) {
+    YsVkGpuTimer* gpu_timer = this->m_vk_context->gpu_timer;
+    if(!gpu_timer) {
+        return GPU_TIMER_NO_SCOPE;
+    }
+
+    // Only the main buffer of the async compute unit is submitted to the compute queue.
+    YsVkCommandUnit* async_compute_command_unit = this->m_vk_context->device->asyncComputeCommandUnitAt(this->m_vk_context->device,
+                                                                                                         this->m_current_frame);
+    YeVkGpuTimerQueue queue = async_compute_command_unit && command_buffer == async_compute_command_unit->command_buffers[FRAME_COMMAND_BUFFER_MAIN] ?
+                              GPU_TIMER_QUEUE_ASYNC_COMPUTE :
+                              GPU_TIMER_QUEUE_GRAPHICS;
+    return gpu_timer->cmdBeginScope(command_buffer, this->m_current_frame, name, queue, statistics, gpu_timer);
+}
+
+void YVulkanBackend::endGpuScope(VkCommandBuffer command_buffer, u32 scope) {
+    YsVkGpuTimer* gpu_timer = this->m_vk_context->gpu_timer;
+    if(gpu_timer) {
+        gpu_timer->cmdEndScope(command_buffer, this->m_current_frame, scope, gpu_timer);
+    }
+}
+
+void YVulkanBackend::recordShadowMapping(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    u32 gpu_scope = backend->beginGpuScope(command_buffer, "Shadow Mapping", GPU_TIMER_STATISTICS_GRAPHICS);
+    backend->m_rendering_system->culling->cmdDispatchCall(backend->m_vk_context,
+                                                          command_buffer,
+                                                          backend->m_vk_resource,
+                                                          backend->m_current_frame,
+                                                          DRAW_VIEW_LIGHT,
+                                                          backend->m_rendering_system->culling);
+    backend->m_rendering_system->shadow_mapping->cmdDrawCall(backend->m_vk_context,
+                                                             backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                                           backend->m_current_frame),
+                                                             FRAME_COMMAND_BUFFER_MAIN,
+                                                             backend->m_vk_resource,
+                                                             backend->m_current_present_image_index,
+                                                             backend->m_current_frame,
+                                                             &backend->m_push_constant[backend->m_current_frame],
+                                                             backend->m_rendering_system->shadow_mapping);
+    backend->endGpuScope(command_buffer, gpu_scope);
+
+    backend->m_shadow_map_dirty = false;
+}
+
+void YVulkanBackend::recordPathTracing(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    YsVkCommandUnit* command_unit = backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                  backend->m_current_frame);
+    u32 gpu_scope = backend->beginGpuScope(command_buffer, "Path Tracing", GPU_TIMER_STATISTICS_COMPUTE);
+    backend->cmdPathTracing(backend->m_path_tracing_command_unit[backend->m_current_frame],
+                            FRAME_COMMAND_BUFFER_MAIN,
+                            command_unit->queue_family_index);
+    backend->endGpuScope(command_buffer, gpu_scope);
+
+    backend->m_frame_status[backend->m_current_frame].need_draw_path_tracing = false;
+}
+
+void YVulkanBackend::recordPathTracingAcquire(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    YsVkCommandUnit* command_unit = backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                  backend->m_current_frame);
+    YsVkCommandUnit* path_tracing_command_unit = backend->m_path_tracing_command_unit[backend->m_current_frame];
+    if(path_tracing_command_unit->queue_family_index == command_unit->queue_family_index) {
+        return;
+    }
+
+    // Acquire the traced output layer back from the compute family, chained to the semaphore wait on the fragment stage.
+    backend->m_vk_resource->path_tracing_image->transitionLayout(command_buffer,
+                                                                 backend->m_current_frame,
+                                                                 1,
+                                                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                                 VK_ACCESS_NONE,
+                                                                 VK_ACCESS_SHADER_READ_BIT,
+                                                                 path_tracing_command_unit->queue_family_index,
+                                                                 command_unit->queue_family_index,
+                                                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                                 backend->m_vk_resource->path_tracing_image);
+}
+
+void YVulkanBackend::recordRasterization(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    u32 gpu_scope = backend->beginGpuScope(command_buffer, "Rasterization", GPU_TIMER_STATISTICS_GRAPHICS);
+    backend->m_rendering_system->culling->cmdDispatchCall(backend->m_vk_context,
+                                                          command_buffer,
+                                                          backend->m_vk_resource,
+                                                          backend->m_current_frame,
+                                                          DRAW_VIEW_CAMERA,
+                                                          backend->m_rendering_system->culling);
+    backend->m_rendering_system->rasterization->cmdDrawCall(backend->m_vk_context,
+                                                            backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                                          backend->m_current_frame),
+                                                            FRAME_COMMAND_BUFFER_MAIN,
+                                                            backend->m_vk_resource,
+                                                            backend->m_current_present_image_index,
+                                                            backend->m_current_frame,
+                                                            &backend->m_push_constant[backend->m_current_frame],
+                                                            backend->m_rendering_system->rasterization);
+
+    // Records the previous pyramid hid are tested again against the one of the early draws, and the pyramid of
+    // the complete depth is kept for the next frame.
+    backend->m_rendering_system->culling->cmdBuildHiZ(backend->m_vk_context,
+                                                      command_buffer,
+                                                      backend->m_vk_resource,
+                                                      backend->m_current_frame,
+                                                      backend->m_rendering_system->culling);
+    backend->m_rendering_system->culling->cmdDispatchCall(backend->m_vk_context,
+                                                          command_buffer,
+                                                          backend->m_vk_resource,
+                                                          backend->m_current_frame,
+                                                          DRAW_VIEW_CAMERA_LATE,
+                                                          backend->m_rendering_system->culling);
+    backend->m_rendering_system->culling->cmdReadbackStatistics(backend->m_vk_context,
+                                                                command_buffer,
+                                                                backend->m_vk_resource,
+                                                                backend->m_current_frame,
+                                                                backend->m_rendering_system->culling);
+    backend->m_rendering_system->rasterization->cmdDrawLateCall(backend->m_vk_context,
+                                                                backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                                              backend->m_current_frame),
+                                                                FRAME_COMMAND_BUFFER_MAIN,
+                                                                backend->m_vk_resource,
+                                                                backend->m_current_frame,
+                                                                backend->m_rendering_system->rasterization);
+    backend->m_rendering_system->culling->cmdBuildHiZ(backend->m_vk_context,
+                                                      command_buffer,
+                                                      backend->m_vk_resource,
+                                                      backend->m_current_frame,
+                                                      backend->m_rendering_system->culling);
+    backend->endGpuScope(command_buffer, gpu_scope);
+
+    backend->m_culling_collected_statistics[backend->m_current_frame] = true;
+
+    backend->m_frame_status[backend->m_current_frame].need_draw_rasterization = false;
+}
+
+void YVulkanBackend::recordSceneEnd(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    vkCmdWriteTimestamp(command_buffer,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                      backend->m_current_frame)->query_pool_timestamps,
+                        TIMESTAMP_QUERY_SCENE_END);
+}
+
+void YVulkanBackend::recordUpscaling(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    u32 gpu_scope = backend->beginGpuScope(command_buffer, "Upscaling", GPU_TIMER_STATISTICS_COMPUTE);
+    backend->m_rendering_system->upscaling->cmdDispatchCall(backend->m_vk_context,
+                                                            command_buffer,
+                                                            backend->m_vk_resource,
+                                                            backend->m_current_frame,
+                                                            backend->m_rendering_system->upscaling);
+    backend->endGpuScope(command_buffer, gpu_scope);
+}
+
+void YVulkanBackend::recordOutput(VkCommandBuffer command_buffer, void* user_data) {
+    YVulkanBackend* backend = static_cast<YVulkanBackend*>(user_data);
+    // The console's secondary buffer writes its own ImGui scope, nested in this one.
+    u32 gpu_scope = backend->beginGpuScope(command_buffer, "Output", GPU_TIMER_STATISTICS_GRAPHICS);
+    backend->m_rendering_system->output->cmdDrawCall(backend->m_vk_context,
+                                                     backend->m_vk_context->device->commandUnitsAt(backend->m_vk_context->device,
+                                                                                                   backend->m_current_frame),
+                                                     backend->m_post_command_buffer_index,
+                                                     backend->m_vk_resource,
+                                                     backend->m_current_present_image_index,
+                                                     backend->m_current_frame,
+                                                     &backend->m_push_constant[backend->m_current_frame],
+                                                     backend->m_rendering_system->output);
+    backend->endGpuScope(command_buffer, gpu_scope);
+}
+
 b8 YVulkanBackend::frameRun() {
     YsVkCommandUnit* command_unit = this->m_vk_context->device->commandUnitsAt(this->m_vk_context->device, this->m_current_frame);
-   
-    uint64_t time_stamps[2] = {0};
-    vkGetQueryPoolResults(this->m_vk_context->device->logical_device,
-                          command_unit->query_pool_timestamps,
-                          0,
-                          2,
-                          sizeof(time_stamps),
-                          time_stamps,
-                          sizeof(uint64_t),
-                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
-    double execution_time_in_milliseconds = (time_stamps[1] - time_stamps[0]) * this->m_vk_context->device->properties.limits.timestampPeriod / 1000000.0;
-    execution_time_in_milliseconds = round(execution_time_in_milliseconds * 10.0) / 10.0;
-    YProfiler::instance()->accumulateGpuFrameTime(execution_time_in_milliseconds);
-
-    u32 command_buffer_index = 0;
-    VkCommandBuffer command_buffer = command_unit->command_buffers[command_buffer_index];
+    YsVkDevice* device = this->m_vk_context->device;
+    f64 timestamp_period = device->properties.limits.timestampPeriod;
+
+    // Each frame in flight owns its query pools, so the results read here were written max_frames_in_flight frames
+    // ago. They are taken without waiting and a frame whose queries are not available yet is left out of the profile.
+    u64 time_stamps[TIMESTAMP_QUERY_COUNT] = {0};
+    if(device->queryTimestamps(device,
+                               command_unit->query_pool_timestamps,
+                               TIMESTAMP_QUERY_FRAME_BEGIN,
+                               3,
+                               time_stamps)) {
+        double execution_time_in_milliseconds = (time_stamps[TIMESTAMP_QUERY_FRAME_END] - time_stamps[TIMESTAMP_QUERY_FRAME_BEGIN]) * timestamp_period / 1000000.0;
+        execution_time_in_milliseconds = round(execution_time_in_milliseconds * 10.0) / 10.0;
+        YProfiler::instance()->accumulateGpuFrameTime(execution_time_in_milliseconds);
+
+        YsQueueTimeline queue_timeline = {};
+        queue_timeline.async_compute = device->async_compute_command_units_count > 0;
+        queue_timeline.scene_end = (time_stamps[TIMESTAMP_QUERY_SCENE_END] - time_stamps[TIMESTAMP_QUERY_FRAME_BEGIN]) * timestamp_period / 1000000.0;
+        queue_timeline.frame_end = (time_stamps[TIMESTAMP_QUERY_FRAME_END] - time_stamps[TIMESTAMP_QUERY_FRAME_BEGIN]) * timestamp_period / 1000000.0;
+        u64 frame_begin_time_stamp = time_stamps[TIMESTAMP_QUERY_FRAME_BEGIN];
+
+        // The path tracing timestamps are only written by frames that dispatched tiles, on the queue that traced them.
+        u64 path_tracing_time_stamps[2] = {0};
+        if(this->m_path_tracing_dispatched_tile_count[this->m_current_frame] > 0 &&
+           device->queryTimestamps(device,
+                                   this->m_path_tracing_command_unit[this->m_current_frame]->query_pool_timestamps,
+                                   TIMESTAMP_QUERY_PATH_TRACING_BEGIN,
+                                   2,
+                                   path_tracing_time_stamps)) {
+            double path_tracing_time = (path_tracing_time_stamps[1] - path_tracing_time_stamps[0]) * timestamp_period / 1000000.0;
+            double tile_time = path_tracing_time / this->m_path_tracing_dispatched_tile_count[this->m_current_frame];
+            this->m_path_tracing_tile_time = this->m_path_tracing_tile_time > 0.0 ? 
+                                             this->m_path_tracing_tile_time * 0.75 + tile_time * 0.25 :
+                                             tile_time;
+
+            // Timestamps of another queue are only placed relative to the graphics frame once the device clock is
+            // calibrated, otherwise the compute span is kept on its own axis.
+            queue_timeline.common_time_base = device->has_calibrated_timestamps ||
+                                              this->m_path_tracing_command_unit[this->m_current_frame] == command_unit;
+            if(queue_timeline.common_time_base) {
+                queue_timeline.compute_begin = i64(path_tracing_time_stamps[0] - frame_begin_time_stamp) * timestamp_period / 1000000.0;
+                queue_timeline.compute_end = i64(path_tracing_time_stamps[1] - frame_begin_time_stamp) * timestamp_period / 1000000.0;
+            } else {
+                queue_timeline.compute_begin = 0.0;
+                queue_timeline.compute_end = path_tracing_time;
+            }
+
+            // The frame fence covers the host read barrier recorded after the dispatches.
+            if(this->m_path_tracing_collected_statistics[this->m_current_frame] && path_tracing_time > 0.0) {
+                const u32* counters = reinterpret_cast<const u32*>(static_cast<const u8*>(this->m_vk_resource->path_tracing_statistics_buffer->allocation.mapped_data) +
+                                                                   this->m_vk_resource->path_tracing_statistics_slice_size * this->m_current_frame);
+                YsPathTracingStatistics statistics = {};
+                statistics.ray_count = u64(counters[2 * PATH_TRACING_COUNTER_RAY]) | u64(counters[2 * PATH_TRACING_COUNTER_RAY + 1]) << 32;
+                statistics.node_count = u64(counters[2 * PATH_TRACING_COUNTER_NODE]) | u64(counters[2 * PATH_TRACING_COUNTER_NODE + 1]) << 32;
+                statistics.triangle_count = u64(counters[2 * PATH_TRACING_COUNTER_TRIANGLE]) | u64(counters[2 * PATH_TRACING_COUNTER_TRIANGLE + 1]) << 32;
+                statistics.time = path_tracing_time;
+                statistics.mrays_per_second = statistics.ray_count / (path_tracing_time * 1000.0);
+                if(statistics.ray_count > 0) {
+                    YProfiler::instance()->recordPathTracingStatistics(statistics);
+                }
+            }
+        }
+        YProfiler::instance()->recordQueueTimeline(queue_timeline);
+    }
+
+    // The pools are reset when this frame is recorded again, a skipped result is gone for good.
+    this->m_path_tracing_dispatched_tile_count[this->m_current_frame] = 0;
+    this->m_path_tracing_collected_statistics[this->m_current_frame] = false;
+
+    // The late header only counts what the early phase deferred, whatever it did not draw stayed occluded.
+    if(this->m_culling_collected_statistics[this->m_current_frame]) {
+        const u32* headers = reinterpret_cast<const u32*>(static_cast<const u8*>(this->m_vk_resource->culling_statistics_buffer->allocation.mapped_data) +
+                                                          this->m_vk_resource->culling_statistics_slice_size * this->m_current_frame);
+        const u32* early_header = headers;
+        const u32* late_header = headers + DRAW_COMMAND_HEADER_WORD_COUNT;
+        YsCullingStatistics statistics = {};
+        statistics.record_count = early_header[DRAW_COMMAND_HEADER_RECORD_COUNT];
+        statistics.frustum_culled_count = early_header[DRAW_COMMAND_HEADER_FRUSTUM_CULLED_COUNT];
+        statistics.occlusion_culled_count = early_header[DRAW_COMMAND_HEADER_OCCLUDED_COUNT] - late_header[DRAW_COMMAND_HEADER_DRAW_COUNT];
+        statistics.drawn_count = early_header[DRAW_COMMAND_HEADER_DRAW_COUNT] + late_header[DRAW_COMMAND_HEADER_DRAW_COUNT];
+        statistics.late_drawn_count = late_header[DRAW_COMMAND_HEADER_DRAW_COUNT];
+        YProfiler::instance()->recordCullingStatistics(statistics);
+        this->m_culling_collected_statistics[this->m_current_frame] = false;
+    }
+
+    YsVkGpuTimer* gpu_timer = this->m_vk_context->gpu_timer;
+    if(gpu_timer && gpu_timer->beginFrame(this->m_vk_context, this->m_current_frame, gpu_timer)) {
+        for(u32 i = 0; i < gpu_timer->result_count; ++i) {
+            const YsVkGpuTimerResult& result = gpu_timer->results[i];
+            YProfiler::instance()->accumulateGpuScopeTime(result.name, result.time);
+            if(GPU_TIMER_STATISTICS_NONE != result.statistics) {
+                YProfiler::instance()->recordGpuScopeInvocations(result.name,
+                                                                 result.vertex_invocations,
+                                                                 result.fragment_invocations,
+                                                                 result.compute_invocations);
+            }
+        }
+    }
+    if(gpu_timer) {
+        gpu_timer->collect_statistics = YRendererBackendManager::instance()->getCollectGpuStatistics();
+    }
+
+    // Images shared between the rendering models lose their contents once the other model has drawn into them.
+    YeRenderingModelType rendering_model = YRendererBackendManager::instance()->getRenderingModel();
+    if(rendering_model != this->m_render_graph_rendering_model) {
+        this->waitFramesInFlight();
+        this->m_render_graph->invalidateAliasedImages(this->m_render_graph);
+        this->m_shadow_map_dirty = true;
+        for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
+            this->m_frame_status[i].need_draw_path_tracing = true;
+            this->m_frame_status[i].need_draw_rasterization = true;
+        }
+        this->m_render_graph_rendering_model = rendering_model;
+    }
+
+    auto start_recording = std::chrono::high_resolution_clock::now();
+
+    // Without reuse every cached secondary command buffer is treated as stale.
+    if(!YRendererBackendManager::instance()->getReuseCommandBuffers()) {
+        this->m_vk_resource->command_generation++;
+    }
+
+    this->buildRenderGraph(rendering_model);
+    this->m_render_graph->compile(this->m_render_graph);
+
+    // With a dedicated compute family path tracing is split into its own submission. The graphics side is recorded
+    // into a pre buffer that flushes uploads and releases the output layer, a main buffer with the scene passes
+    // that runs alongside the compute queue, and a post buffer that acquires the layer back for output.
+    YsVkCommandUnit* async_compute_command_unit = this->m_vk_context->device->asyncComputeCommandUnitAt(this->m_vk_context->device, 
+                                                                                                         this->m_current_frame);
+    b8 need_draw_path_tracing = RENDER_GRAPH_NONE != this->m_render_graph_path_tracing_pass &&
+                                this->m_render_graph->passes[this->m_render_graph_path_tracing_pass].is_live;
+    b8 is_async_compute = need_draw_path_tracing && async_compute_command_unit;
+    u32 pre_command_buffer_index = is_async_compute ? FRAME_COMMAND_BUFFER_PRE_ASYNC_COMPUTE : FRAME_COMMAND_BUFFER_MAIN;
+    this->m_post_command_buffer_index = is_async_compute ? FRAME_COMMAND_BUFFER_POST_ASYNC_COMPUTE : FRAME_COMMAND_BUFFER_MAIN;
+    VkCommandBuffer command_buffer = command_unit->command_buffers[FRAME_COMMAND_BUFFER_MAIN];
+    VkCommandBuffer pre_command_buffer = command_unit->command_buffers[pre_command_buffer_index];
+    VkCommandBuffer post_command_buffer = command_unit->command_buffers[this->m_post_command_buffer_index];
+
+    // Scene passes go to the main buffer, the traced layer is acquired, upscaled and presented from the post buffer.
+    for(u32 i = 0; i < this->m_render_graph->pass_count; ++i) {
+        this->m_render_graph->passes[i].command_buffer = command_buffer;
+    }
+    this->m_render_graph->passes[this->m_render_graph_output_pass].command_buffer = post_command_buffer;
+    if(RENDER_GRAPH_NONE != this->m_render_graph_upscaling_pass) {
+        this->m_render_graph->passes[this->m_render_graph_upscaling_pass].command_buffer = post_command_buffer;
+    }
+    if(need_draw_path_tracing) {
+        this->m_path_tracing_command_unit[this->m_current_frame] = is_async_compute ? async_compute_command_unit : command_unit;
+        this->m_render_graph->passes[this->m_render_graph_path_tracing_pass].command_buffer =
+            this->m_path_tracing_command_unit[this->m_current_frame]->command_buffers[FRAME_COMMAND_BUFFER_MAIN];
+        this->m_render_graph->passes[this->m_render_graph_path_tracing_acquire_pass].command_buffer = post_command_buffer;
+    }
+
+    // Stale secondaries of the live passes are re-recorded on the recording threads while the main thread records the
+    // frame setup and the console. Every thread allocates from its own command pool of this frame, so none of them lock.
+    YsVkRenderingSystem* rendering_system = this->m_rendering_system;
+    YsVkContext* context = this->m_vk_context;
+    YsVkResources* resources = this->m_vk_resource;
+    u32 current_frame = this->m_current_frame;
+    void* push_constant_data = &this->m_push_constant[current_frame];
+    auto isLivePass = [this](u32 pass) -> b8 {
+        return RENDER_GRAPH_NONE != pass && this->m_render_graph->passes[pass].is_live;
+    };
+    if(isLivePass(this->m_render_graph_shadow_mapping_pass) &&
+       rendering_system->shadow_mapping->secondary_command_buffer_generations[current_frame] != resources->command_generation) {
+        this->m_recording_threads[RECORDING_THREAD_SHADOW_MAPPING]->start([=]() {
+            rendering_system->shadow_mapping->cmdRecordSecondary(context,
+                                                                 resources,
+                                                                 current_frame,
+                                                                 push_constant_data,
+                                                                 rendering_system->shadow_mapping);
+        });
+    }
+    if(isLivePass(this->m_render_graph_rasterization_pass) &&
+       rendering_system->rasterization->secondary_command_buffer_generations[current_frame] != resources->command_generation) {
+        this->m_recording_threads[RECORDING_THREAD_RASTERIZATION]->start([=]() {
+            rendering_system->rasterization->cmdRecordSecondary(context,
+                                                                resources,
+                                                                current_frame,
+                                                                push_constant_data,
+                                                                rendering_system->rasterization);
+        });
+    }
+    if(rendering_system->output->secondary_command_buffer_generations[current_frame] != resources->command_generation) {
+        this->m_recording_threads[RECORDING_THREAD_OUTPUT]->start([=]() {
+            rendering_system->output->cmdRecordSecondary(context,
+                                                         resources,
+                                                         current_frame,
+                                                         push_constant_data,
+                                                         rendering_system->output);
+        });
+    }
+
     this->m_vk_context->device->commandBufferBegin(command_buffer, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+    if(is_async_compute) {
+        this->m_vk_context->device->commandBufferBegin(pre_command_buffer, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+        this->m_vk_context->device->commandBufferBegin(post_command_buffer, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+    }
     {
-        vkCmdResetQueryPool(command_buffer,
+        vkCmdResetQueryPool(pre_command_buffer,
                             command_unit->query_pool_timestamps,
                             0,
-                            2);
-        vkCmdWriteTimestamp(command_buffer,
+                            TIMESTAMP_QUERY_COUNT);
+        vkCmdWriteTimestamp(pre_command_buffer,
                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
                             command_unit->query_pool_timestamps,
-                            0);                   
-
-        if(this->m_frame_status[this->m_current_frame].need_draw_shadow_mapping) {
-            this->m_rendering_system->shadow_mapping->cmdDrawCall(this->m_vk_context,
-                                                                  command_unit,
-                                                                  command_buffer_index,
-                                                                  this->m_vk_resource,
-                                                                  this->m_current_present_image_index,
-                                                                  this->m_current_frame,
-                                                                  &this->m_push_constant[this->m_current_frame],
-                                                                  this->m_rendering_system->shadow_mapping);
-
-            this->m_frame_status[this->m_current_frame].need_draw_shadow_mapping = false;                                                         
-        }
+                            TIMESTAMP_QUERY_FRAME_BEGIN);                   
+
+        this->m_vk_resource->staging_buffer->cmdFlush(pre_command_buffer, this->m_vk_resource->staging_buffer);
 
-        bool need_reset_path_tracing_image_layout = false;
-        if(this->m_frame_status[this->m_current_frame].need_draw_path_tracing) {
-            this->m_vk_resource->path_tracing_image->transitionLayout(command_buffer,
+        VkCommandBuffer compute_command_buffer = VK_NULL_HANDLE;
+        if(is_async_compute) {
+            // Release this frame's output layer to the compute family, the compute queue performs the matching acquire.
+            this->m_vk_resource->path_tracing_image->transitionLayout(pre_command_buffer,
                                                                       this->m_current_frame,
                                                                       1,
-                                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                                      VK_IMAGE_LAYOUT_GENERAL,
+                                                                      this->m_render_graph->imageLayout(this->m_render_graph,
+                                                                                                        GRAPH_IMAGE_PATH_TRACING,
+                                                                                                        this->m_current_frame),
+                                                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                                                       VK_ACCESS_SHADER_READ_BIT,
-                                                                      VK_ACCESS_SHADER_WRITE_BIT,
-                                                                      command_unit->queue_family_index,
+                                                                      VK_ACCESS_NONE,
                                                                       command_unit->queue_family_index,
+                                                                      async_compute_command_unit->queue_family_index,
                                                                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
                                                                       this->m_vk_resource->path_tracing_image);
 
-            this->m_rendering_system->path_tracing->cmdDispatchCall(this->m_vk_context,
-                                                                    command_unit,
-                                                                    command_buffer_index,
-                                                                    this->m_vk_resource,
-                                                                    this->m_current_present_image_index,
-                                                                    this->m_current_frame,
-                                                                    &this->m_push_constant[this->m_current_frame],
-                                                                    this->m_rendering_system->path_tracing);
-
-            this->m_vk_resource->path_tracing_image->transitionLayout(command_buffer,
-                                                                      this->m_current_frame,
-                                                                      1,
-                                                                      VK_IMAGE_LAYOUT_GENERAL,
-                                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                                      VK_ACCESS_SHADER_WRITE_BIT,
-                                                                      VK_ACCESS_SHADER_READ_BIT,
-                                                                      command_unit->queue_family_index,
-                                                                      command_unit->queue_family_index,
-                                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                                                      this->m_vk_resource->path_tracing_image);                                                        
-            need_reset_path_tracing_image_layout = true;
-            this->m_frame_status[this->m_current_frame].need_draw_path_tracing = false;                                                            
+            compute_command_buffer = async_compute_command_unit->command_buffers[FRAME_COMMAND_BUFFER_MAIN];
+            this->m_vk_context->device->commandBufferBegin(compute_command_buffer, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+            vkCmdResetQueryPool(compute_command_buffer,
+                                async_compute_command_unit->query_pool_timestamps,
+                                0,
+                                TIMESTAMP_QUERY_COUNT);
         }
 
-        if(this->m_frame_status[this->m_current_frame].need_draw_rasterization) {
-            this->m_rendering_system->rasterization->cmdDrawCall(this->m_vk_context,
-                                                                 command_unit,
-                                                                 command_buffer_index,
-                                                                 this->m_vk_resource,
-                                                                 this->m_current_present_image_index,
-                                                                 this->m_current_frame,
-                                                                 &this->m_push_constant[this->m_current_frame],
-                                                                 this->m_rendering_system->rasterization);
-
-            this->m_frame_status[this->m_current_frame].need_draw_rasterization = false;
+        rendering_system->output->cmdRecordConsole(context,
+                                                   this->m_current_present_image_index,
+                                                   current_frame,
+                                                   rendering_system->output);
+
+        // The primary buffers only execute the secondaries, so every recording thread has to be done first.
+        for(auto& recording_thread : this->m_recording_threads) {
+            recording_thread->wait();
         }
 
-        this->m_rendering_system->output->cmdDrawCall(this->m_vk_context,
-                                                      command_unit,
-                                                      command_buffer_index,
-                                                      this->m_vk_resource,
-                                                      this->m_current_present_image_index,
-                                                      this->m_current_frame,
-                                                      &this->m_push_constant[this->m_current_frame],
-                                                      this->m_rendering_system->output);
+        this->m_render_graph->execute(this->m_render_graph);
+
+        if(is_async_compute) {
+            this->m_vk_context->device->commandBufferEnd(compute_command_buffer);
+        }
 
-        vkCmdWriteTimestamp(command_buffer,
+        vkCmdWriteTimestamp(post_command_buffer,
                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
                             command_unit->query_pool_timestamps,
-                            1);
+                            TIMESTAMP_QUERY_FRAME_END);
     }
     this->m_vk_context->device->commandBufferEnd(command_buffer);
+    if(is_async_compute) {
+        this->m_vk_context->device->commandBufferEnd(pre_command_buffer);
+        this->m_vk_context->device->commandBufferEnd(post_command_buffer);
+    }
+
+    std::chrono::duration<double, std::milli> recording_time = std::chrono::high_resolution_clock::now() - start_recording;
+    YProfiler::instance()->accumulateCommandRecordingTime(recording_time.count());
 
     VK_CHECK(vkResetFences(this->m_vk_context->device->logical_device,
                            1,
                            &this->m_in_flight_fences[this->m_current_frame]));
-    VkPipelineStageFlags wait_dst_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &this->m_image_available_semaphores[this->m_current_frame];
-    submit_info.pWaitDstStageMask = &wait_dst_stage_mask;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &this->m_rendering_system->output->complete_semaphores[this->m_current_frame];
-    VkResult result = vkQueueSubmit(command_unit->queue,
-                                    1,
-                                    &submit_info,
-                                    this->m_in_flight_fences[this->m_current_frame]);
+
+    // The first graphics batch waits on the upload timeline, later batches on this queue follow it in submission order.
+    u64 upload_wait_values[2] = {0, this->m_vk_resource->upload_wait_value};
+    VkSemaphore upload_semaphore = this->m_vk_context->upload_queue ? this->m_vk_context->upload_queue->timeline_semaphore : VK_NULL_HANDLE;
+    VkTimelineSemaphoreSubmitInfo timeline_submit_info = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    b8 need_upload_wait = upload_wait_values[1] > 0;
+
+    VkResult result = VK_SUCCESS;
+    if(is_async_compute) {
+        VkPipelineStageFlags pre_wait_dst_stage_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        timeline_submit_info.waitSemaphoreValueCount = 1;
+        timeline_submit_info.pWaitSemaphoreValues = &upload_wait_values[1];
+        VkSubmitInfo pre_submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        if(need_upload_wait) {
+            pre_submit_info.pNext = &timeline_submit_info;
+            pre_submit_info.waitSemaphoreCount = 1;
+            pre_submit_info.pWaitSemaphores = &upload_semaphore;
+            pre_submit_info.pWaitDstStageMask = &pre_wait_dst_stage_mask;
+        }
+        pre_submit_info.commandBufferCount = 1;
+        pre_submit_info.pCommandBuffers = &pre_command_buffer;
+        pre_submit_info.signalSemaphoreCount = 1;
+        pre_submit_info.pSignalSemaphores = &this->m_rendering_system->path_tracing->ready_semaphores[this->m_current_frame];
+        result = vkQueueSubmit(command_unit->queue,
+                               1,
+                               &pre_submit_info,
+                               VK_NULL_HANDLE);
+        if (result != VK_SUCCESS) {
+            YERROR("vkQueueSubmit failed with result: %s", string_VkResult(result));
+            return false;
+        }
+
+        VkPipelineStageFlags compute_wait_dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        VkSubmitInfo compute_submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        compute_submit_info.waitSemaphoreCount = 1;
+        compute_submit_info.pWaitSemaphores = &this->m_rendering_system->path_tracing->ready_semaphores[this->m_current_frame];
+        compute_submit_info.pWaitDstStageMask = &compute_wait_dst_stage_mask;
+        compute_submit_info.commandBufferCount = 1;
+        compute_submit_info.pCommandBuffers = &async_compute_command_unit->command_buffers[FRAME_COMMAND_BUFFER_MAIN];
+        compute_submit_info.signalSemaphoreCount = 1;
+        compute_submit_info.pSignalSemaphores = &this->m_rendering_system->path_tracing->complete_semaphores[this->m_current_frame];
+        result = vkQueueSubmit(async_compute_command_unit->queue,
+                               1,
+                               &compute_submit_info,
+                               VK_NULL_HANDLE);
+        if (result != VK_SUCCESS) {
+            YERROR("vkQueueSubmit failed with result: %s", string_VkResult(result));
+            return false;
+        }
+
+        // The scene passes do not wait on compute, only the output pass does. The frame fence therefore also covers the compute work.
+        VkSemaphore post_wait_semaphores[2] = {this->m_image_available_semaphores[this->m_current_frame],
+                                               this->m_rendering_system->path_tracing->complete_semaphores[this->m_current_frame]};
+        VkPipelineStageFlags post_wait_dst_stage_masks[2] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+        VkSubmitInfo submit_infos[2] = {{VK_STRUCTURE_TYPE_SUBMIT_INFO}, {VK_STRUCTURE_TYPE_SUBMIT_INFO}};
+        submit_infos[0].commandBufferCount = 1;
+        submit_infos[0].pCommandBuffers = &command_buffer;
+        submit_infos[1].waitSemaphoreCount = 2;
+        submit_infos[1].pWaitSemaphores = post_wait_semaphores;
+        submit_infos[1].pWaitDstStageMask = post_wait_dst_stage_masks;
+        submit_infos[1].commandBufferCount = 1;
+        submit_infos[1].pCommandBuffers = &post_command_buffer;
+        submit_infos[1].signalSemaphoreCount = 1;
+        submit_infos[1].pSignalSemaphores = &this->m_rendering_system->output->complete_semaphores[this->m_current_frame];
+        result = vkQueueSubmit(command_unit->queue,
+                               2,
+                               submit_infos,
+                               this->m_in_flight_fences[this->m_current_frame]);
+    } else {
+        // The binary image available semaphore ignores its value.
+        VkSemaphore wait_semaphores[2] = {this->m_image_available_semaphores[this->m_current_frame], upload_semaphore};
+        VkPipelineStageFlags wait_dst_stage_masks[2] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+        timeline_submit_info.waitSemaphoreValueCount = 2;
+        timeline_submit_info.pWaitSemaphoreValues = upload_wait_values;
+        VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submit_info.pNext = need_upload_wait ? &timeline_submit_info : NULL;
+        submit_info.waitSemaphoreCount = need_upload_wait ? 2 : 1;
+        submit_info.pWaitSemaphores = wait_semaphores;
+        submit_info.pWaitDstStageMask = wait_dst_stage_masks;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer;
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &this->m_rendering_system->output->complete_semaphores[this->m_current_frame];
+        result = vkQueueSubmit(command_unit->queue,
+                               1,
+                               &submit_info,
+                               this->m_in_flight_fences[this->m_current_frame]);
+    }
     if (result != VK_SUCCESS) {
         YERROR("vkQueueSubmit failed with result: %s", string_VkResult(result));
         return false;
@@ -459,11 +1417,13 @@ b8 YVulkanBackend::framePresent() {
     present_info.pImageIndices = &this->m_current_present_image_index;
     present_info.pResults = nullptr;
     VkResult result = vkQueuePresentKHR(result_command_unit->queue, &present_info);
-    if (result != VK_SUCCESS) {
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        this->m_need_recreate_swapchain = true;
+    } else if (result != VK_SUCCESS) {
         YFATAL("Failed to present swap chain image: %i", this->m_current_present_image_index);
     }
 
-    this->m_current_frame = (this->m_current_frame + 1) % this->m_vk_context->swapchain->max_frames_in_flight;
+    this->m_current_frame = (this->m_current_frame + 1) % this->m_vk_context->swapchain->frames_in_flight;
 
     return true;
 }
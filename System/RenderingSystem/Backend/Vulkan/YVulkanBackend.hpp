@@ -29,12 +29,16 @@
 #include "YRendererBackend.hpp"
 #include "YVulkanTypes.h"
 #include "YVulkanResource.h"
+#include "YVulkanGpuTimer.h"
+#include "YWorkerThread.hpp"
 
 #include <vector>
 #include <string>
+#include <memory>
 
 struct GLFWwindow;
 struct YsEntity;
+enum class YeRenderingModelType : unsigned char;
 
 
 
@@ -46,8 +50,49 @@ public:
 private:
     void initializeSupportInfo();
 
-    void shutdown();
+    void shutdown() override;
 
+    // Picks the tiles the current frame traces so the dispatch fits the path tracing frame budget.
+    u32 pathTracingScheduleTiles(u32* tile_begin);
+
+    // Records the traced tiles and the copy into this frame's output layer, with ownership transfers when
+    // the command unit is on a different family than the graphics queue.
+    void cmdPathTracing(YsVkCommandUnit* command_unit,
+                        u32 command_buffer_index,
+                        u32 graphics_queue_family_index);
+
+    // Declares this frame's passes and the image layers they access, passes whose output is cached are left out.
+    void buildRenderGraph(YeRenderingModelType rendering_model);
+
+    static void recordShadowMapping(VkCommandBuffer command_buffer, void* user_data);
+    static void recordPathTracing(VkCommandBuffer command_buffer, void* user_data);
+    static void recordPathTracingAcquire(VkCommandBuffer command_buffer, void* user_data);
+    static void recordRasterization(VkCommandBuffer command_buffer, void* user_data);
+    static void recordSceneEnd(VkCommandBuffer command_buffer, void* user_data);
+    static void recordUpscaling(VkCommandBuffer command_buffer, void* user_data);
+    static void recordOutput(VkCommandBuffer command_buffer, void* user_data);
+
+    // Wraps the commands recorded in between into a named GPU timing scope of the current frame.
+    u32 beginGpuScope(VkCommandBuffer command_buffer, const char* name, YeVkGpuTimerStatistics statistics);
+    void endGpuScope(VkCommandBuffer command_buffer, u32 scope);
+
+    // Blocks until every frame in flight has retired, required before device buffers are reallocated.
+    void waitFramesInFlight();
+
+    // Sizes of the render targets for a framebuffer of display_size, following the render scale setting. The
+    // shadow map follows its own resolution and cascade count instead.
+    YsVkResourcesImageSize rendererImageSize(const glm::ivec2& display_size);
+
+    // Whether the render targets that exist already have the sizes of image_size.
+    b8 renderTargetsMatch(const YsVkResourcesImageSize& image_size);
+
+    // Recreates the swapchain and everything sized after it, render targets only when their size changed.
+    void recreateSwapchain(const glm::ivec2& framebuffer_size, VkPresentModeKHR present_mode);
+
+    // Recreates the render targets and the framebuffers around them, the device must be idle.
+    void resizeRenderTargets(const YsVkResourcesImageSize& image_size);
+
+    b8 frameResize() override;
     b8 framePrepare() override;
     b8 frameRun() override;
     b8 framePresent() override;
@@ -55,9 +100,17 @@ private:
     void deviceUpdateVertexInput(u32 vertex_count,
                                void* vertex_position_data,
                                void* vertex_normal_data,
-                               void* vertex_material_id_data) override;
-
-    void deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) override;
+                               void* vertex_material_id_data,
+                               u32 draw_record_count,
+                               void* draw_record_data) override;
+
+    void deviceUpdateSsbo(void* scene_info_data,
+                          void* bvh_node_data,
+                          void* material_data,
+                          void* vertex_position_data,
+                          void* vertex_normal_data,
+                          void* vertex_material_id_data,
+                          void* vertex_entity_id_data) override;
 
     void deviceUpdateUbo(void* ubo_data) override;
 
@@ -77,6 +130,36 @@ private:
     const u32 m_max_semaphores = 10;
     VkSemaphore* m_image_available_semaphores;
     VkFence* m_in_flight_fences;
+
+    // What the swapchain was last created for, the surface may have clamped the extent or replaced the mode.
+    glm::ivec2 m_swapchain_request_size;
+    VkPresentModeKHR m_swapchain_request_present_mode;
+    // Set when acquire or present report the swapchain as out of date or suboptimal.
+    b8 m_need_recreate_swapchain = false;
+
+    //
+    u32 m_path_tracing_dispatched_tile_count[3] = {};
+    YsVkCommandUnit* m_path_tracing_command_unit[3] = {};
+    b8 m_path_tracing_collected_statistics[3] = {};
+    f64 m_path_tracing_tile_time = 0.0;
+
+    // Set for frames that rasterized, whose culling statistics slice holds the headers of both camera phases.
+    b8 m_culling_collected_statistics[3] = {};
+
+    //
+    YsVkRenderGraph* m_render_graph;
+    YeRenderingModelType m_render_graph_rendering_model;
+    u32 m_render_graph_shadow_mapping_pass;
+    u32 m_render_graph_path_tracing_pass;
+    u32 m_render_graph_path_tracing_acquire_pass;
+    u32 m_render_graph_rasterization_pass;
+    u32 m_render_graph_upscaling_pass;
+    u32 m_render_graph_output_pass;
+    u32 m_post_command_buffer_index;
+
+    // One per YeVkRecordingThread, alive for the whole backend so a frame never pays for starting threads. Each one
+    // only records into the command pool of its own index.
+    std::vector<std::unique_ptr<YWorkerThread>> m_recording_threads;
 };
 
 
@@ -45,13 +45,20 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
 
 YRendererBackend::YRendererBackend()
     : m_init_finished(false),
       m_need_draw(false),
+      m_shadow_map_dirty(true),
       m_need_update_device_vertex_input(false),
       m_need_update_device_ssbo(false),
-      m_need_update_device_ubo(false){
+      m_need_reset_path_tracing_accumulation(true),
+      m_path_tracing_frame_index(0),
+      m_path_tracing_tile_cursor(0){
 
 }
 
@@ -60,6 +67,12 @@ YRendererBackend::~YRendererBackend() {
 }
 
 void YRendererBackend::updateHostVertexInput() {
+    this->m_vertex_positions.clear();
+    this->m_vertex_normals.clear();
+    this->m_vertex_material_id.clear();
+    this->m_vertex_entity_id.clear();
+    this->m_draw_records.clear();
+
     std::vector<YsMeshComponent*> meshes = YSceneManager::instance()->getComponents<YsMeshComponent>();
     for(auto mesh : meshes) {
         YsEntity* entity = YSceneManager::instance()->getEntity(mesh);
@@ -68,6 +81,13 @@ void YRendererBackend::updateHostVertexInput() {
         std::vector<i32> vertex_material_id(mesh->positions.size(), material_id);
         std::vector<i32> vertex_entity_id(mesh->positions.size(), entity->id);
 
+        GLSL_DrawRecord draw_record = {};
+        draw_record.aabb.min = mesh->aabb.min;
+        draw_record.aabb.max = mesh->aabb.max;
+        draw_record.first_vertex = this->m_vertex_positions.size();
+        draw_record.vertex_count = mesh->positions.size();
+        this->m_draw_records.push_back(draw_record);
+
         this->m_vertex_positions.insert(this->m_vertex_positions.end(), mesh->positions.begin(), mesh->positions.end());
         this->m_vertex_normals.insert(this->m_vertex_normals.end(), mesh->normals.begin(), mesh->normals.end());
         this->m_vertex_material_id.insert(this->m_vertex_material_id.end(), vertex_material_id.begin(), vertex_material_id.end());
@@ -78,39 +98,53 @@ void YRendererBackend::updateHostVertexInput() {
 }
 
 void YRendererBackend::updateHostSsbo() {
-    std::vector<GLSL_BVHNode> bvh_buffers;
-    this->recursiveFillingBVHBuffer(&bvh_buffers, YPhysicsSystem::instance()->rootBVHNode());
-
-    this->m_ssbo.bvh_node_count = bvh_buffers.size();
-    this->m_ssbo.material_count = YMaterialSystem::instance()->materialCount();
-    this->m_ssbo.vertex_count = this->m_vertex_positions.size();
-    yCMemoryCopy(this->m_ssbo.bvh_node,
-                 bvh_buffers.data(),
-                 sizeof(GLSL_BVHNode) * this->m_ssbo.bvh_node_count);
-    yCMemoryCopy(this->m_ssbo.materials,
-                 YMaterialSystem::instance()->materialData(),
-                 sizeof(GLSL_Material) * this->m_ssbo.material_count);
-    yCMemoryCopy(this->m_ssbo.vertex_position,
-                 this->m_vertex_positions.data(),
-                 sizeof(vec4) * this->m_ssbo.vertex_count);
-    yCMemoryCopy(this->m_ssbo.vertex_normal,
-                 this->m_vertex_normals.data(),
-                 sizeof(vec4) * this->m_ssbo.vertex_count);
-    yCMemoryCopy(this->m_ssbo.vertex_material_id,
-                 this->m_vertex_material_id.data(),
-                 sizeof(i32) * this->m_ssbo.vertex_count);
-    yCMemoryCopy(this->m_ssbo.vertex_entity_id,
-                 this->m_vertex_entity_id.data(),
-                 sizeof(i32) * this->m_ssbo.vertex_count);
+    this->m_bvh_nodes.clear();
+    this->recursiveFillingBVHBuffer(&this->m_bvh_nodes, YPhysicsSystem::instance()->rootBVHNode());
+
+    // Reorder the triangles so that every BVH leaf covers a contiguous vertex range.
+    const std::vector<u32>& triangle_indices = YPhysicsSystem::instance()->triangleIndices();
+    YASSERT_MSG(triangle_indices.size() * 3 == this->m_vertex_positions.size(), "BVH triangle permutation does not match the vertex input.");
+    if(triangle_indices.size() * 3 != this->m_vertex_positions.size()) {
+        return;
+    }
+    u32 ssbo_vertex_count = triangle_indices.size() * 3;
+    this->m_ssbo_vertex_positions.resize(ssbo_vertex_count);
+    this->m_ssbo_vertex_normals.resize(ssbo_vertex_count);
+    this->m_ssbo_vertex_material_id.resize(ssbo_vertex_count);
+    this->m_ssbo_vertex_entity_id.resize(ssbo_vertex_count);
+    for(u32 i = 0; i < triangle_indices.size(); ++i) {
+        for(u32 k = 0; k < 3; ++k) {
+            u32 source = triangle_indices[i] * 3 + k;
+            u32 dest = i * 3 + k;
+            this->m_ssbo_vertex_positions[dest] = this->m_vertex_positions[source];
+            this->m_ssbo_vertex_normals[dest] = this->m_vertex_normals[source];
+            this->m_ssbo_vertex_material_id[dest] = this->m_vertex_material_id[source];
+            this->m_ssbo_vertex_entity_id[dest] = this->m_vertex_entity_id[source];
+        }
+    }
+
+    GLSL_Material* material_data = static_cast<GLSL_Material*>(YMaterialSystem::instance()->materialData());
+    this->m_materials.assign(material_data, material_data + YMaterialSystem::instance()->materialCount());
+
+    this->m_scene_info.bvh_node_count = this->m_bvh_nodes.size();
+    this->m_scene_info.material_count = this->m_materials.size();
+    this->m_scene_info.vertex_count = this->m_ssbo_vertex_positions.size();
 
     this->m_need_update_device_ssbo = true;
+    this->m_need_reset_path_tracing_accumulation = true;
 }
 
 void YRendererBackend::updateHostUbo() {
+    GLSL_UBO previous_ubo = this->m_ubo;
+
     //
     this->m_ubo.rendering_model = static_cast<int>(YRendererBackendManager::instance()->getRenderingModel());
     this->m_ubo.path_tracing_spp = YRendererBackendManager::instance()->getPathTracingSpp();
     this->m_ubo.path_tracing_max_depth = YRendererBackendManager::instance()->getPathTracingMaxDepth();
+    this->m_ubo.path_tracing_enable_bvh_acceleration = YRendererBackendManager::instance()->getPathTracingEnableBvhAcceleration();
+    this->m_ubo.path_tracing_traversal_heatmap = YRendererBackendManager::instance()->getPathTracingTraversalHeatmap();
+    this->m_ubo.path_tracing_collect_statistics = YRendererBackendManager::instance()->getCollectGpuStatistics();
+    this->m_ubo.upscaling_sharpness = YRendererBackendManager::instance()->getUpscalingSharpness();
     
     //
     YsAreaLightComponent* light_component = YSceneManager::instance()->getComponents<YsAreaLightComponent>().front();
@@ -119,9 +153,8 @@ void YRendererBackend::updateHostUbo() {
     glm::fvec3 light_up = glm::normalize((transpose(inverse(YSceneManager::instance()->modelMatrix())) * glm::fvec4(light_component->light_space_up, 1.0)));
     glm::fmat4x4 light_view_matrix = glm::lookAt(light_center, light_target, light_up);
     float fovy = glm::radians(100.0f);
-    glm::fvec2 window_size = YRendererFrontendManager::instance()->mainWindowSize();
-    float aspect = window_size.x / window_size.y;
-    glm::fmat4x4 light_projection_matrix = glm::perspective(fovy, aspect, CAMERA_Z_NEAR, 1.3f);
+    // Shadow map cascades are square whatever the window is.
+    glm::fmat4x4 light_projection_matrix = glm::perspective(fovy, 1.0f, CAMERA_Z_NEAR, 1.3f);
     light_component->light_space_matrix = light_projection_matrix * light_view_matrix;
 
     //
@@ -141,7 +174,92 @@ void YRendererBackend::updateHostUbo() {
 
     this->m_ubo.model_matrix = YSceneManager::instance()->modelMatrix();
 
-    this->m_need_update_device_ubo = true;
+    this->updateShadowMapCascades();
+    if(0 != std::memcmp(&previous_ubo.light, &this->m_ubo.light, sizeof(GLSL_Light)) ||
+       previous_ubo.model_matrix != this->m_ubo.model_matrix) {
+        this->m_shadow_map_dirty = true;
+    }
+
+    // Any change of camera, light or path tracing settings invalidates the accumulated samples, sharpening only
+    // changes how they are upscaled.
+    previous_ubo.upscaling_sharpness = this->m_ubo.upscaling_sharpness;
+    if(0 != std::memcmp(&previous_ubo, &this->m_ubo, sizeof(GLSL_UBO))) {
+        this->m_need_reset_path_tracing_accumulation = true;
+    }
+
+    for(bool& need_update_device_ubo : this->m_need_update_device_ubo) {
+        need_update_device_ubo = true;
+    }
+    this->m_host_ubo_update_time = std::chrono::high_resolution_clock::now();
+    this->m_need_report_ubo_update_latency = true;
+}
+
+void YRendererBackend::updateShadowMapCascades() {
+    GLSL_Light& light = this->m_ubo.light;
+    u32 cascade_count = std::clamp(YRendererBackendManager::instance()->getShadowMapCascadeCount(), 1u, u32(SHADOW_MAP_MAX_CASCADE_COUNT));
+    light.cascade_count = cascade_count;
+    light.cascade_split_depths = glm::fvec4(CAMERA_Z_FAR);
+    for(glm::fmat4x4& cascade_space_matrix : light.cascade_space_matrices) {
+        cascade_space_matrix = light.space_matrix;
+    }
+    if(1 == cascade_count) {
+        return;
+    }
+
+    // Corners of the camera frustum on the near and the far plane, in world space.
+    glm::fmat4x4 inverse_view_projection = glm::inverse(this->m_ubo.rasterization_camera.projection_matrix *
+                                                        this->m_ubo.rasterization_camera.view_matrix);
+    glm::fvec3 near_corners[4];
+    glm::fvec3 far_corners[4];
+    for(u32 i = 0; i < 4; ++i) {
+        glm::fvec2 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f);
+        glm::fvec4 near_corner = inverse_view_projection * glm::fvec4(ndc, -1.0f, 1.0f);
+        glm::fvec4 far_corner = inverse_view_projection * glm::fvec4(ndc, 1.0f, 1.0f);
+        near_corners[i] = glm::fvec3(near_corner) / near_corner.w;
+        far_corners[i] = glm::fvec3(far_corner) / far_corner.w;
+    }
+
+    // Practical split scheme, halfway between logarithmic and uniform split depths.
+    const float split_lambda = 0.5f;
+    float slice_begin = 0.0f;
+    for(u32 cascade = 0; cascade < cascade_count; ++cascade) {
+        float p = float(cascade + 1) / float(cascade_count);
+        float log_split = CAMERA_Z_NEAR * std::pow(CAMERA_Z_FAR / CAMERA_Z_NEAR, p);
+        float uniform_split = CAMERA_Z_NEAR + (CAMERA_Z_FAR - CAMERA_Z_NEAR) * p;
+        float split_depth = glm::mix(uniform_split, log_split, split_lambda);
+        float slice_end = (split_depth - CAMERA_Z_NEAR) / (CAMERA_Z_FAR - CAMERA_Z_NEAR);
+        light.cascade_split_depths[cascade] = split_depth;
+
+        // Bounds of the slice in the light's clip space, slices reaching behind the light keep the whole frustum.
+        glm::fvec2 crop_min(1.0f);
+        glm::fvec2 crop_max(-1.0f);
+        bool is_behind_light = false;
+        for(u32 i = 0; i < 8; ++i) {
+            glm::fvec3 corner = glm::mix(near_corners[i % 4], far_corners[i % 4], i < 4 ? slice_begin : slice_end);
+            glm::fvec4 light_corner = light.space_matrix * glm::fvec4(corner, 1.0f);
+            if(light_corner.w <= 0.0f) {
+                is_behind_light = true;
+                break;
+            }
+            crop_min = glm::min(crop_min, glm::fvec2(light_corner) / light_corner.w);
+            crop_max = glm::max(crop_max, glm::fvec2(light_corner) / light_corner.w);
+        }
+        crop_min = glm::clamp(crop_min, -1.0f, 1.0f);
+        crop_max = glm::clamp(crop_max, -1.0f, 1.0f);
+        if(is_behind_light || crop_max.x <= crop_min.x || crop_max.y <= crop_min.y) {
+            crop_min = glm::fvec2(-1.0f);
+            crop_max = glm::fvec2(1.0f);
+        }
+
+        glm::fmat4x4 crop_matrix(1.0f);
+        crop_matrix[0][0] = 2.0f / (crop_max.x - crop_min.x);
+        crop_matrix[1][1] = 2.0f / (crop_max.y - crop_min.y);
+        crop_matrix[3][0] = -(crop_max.x + crop_min.x) / (crop_max.x - crop_min.x);
+        crop_matrix[3][1] = -(crop_max.y + crop_min.y) / (crop_max.y - crop_min.y);
+        light.cascade_space_matrices[cascade] = crop_matrix * light.space_matrix;
+
+        slice_begin = slice_end;
+    }
 }
 
 void YRendererBackend::draw() {
@@ -153,6 +271,10 @@ void YRendererBackend::draw() {
         return;
     }
 
+    if(!this->frameResize()) {
+        return;
+    }
+
     if(!this->framePrepare()){
         YERROR("Frame Prepare Error!");
         return;
@@ -164,22 +286,47 @@ void YRendererBackend::draw() {
         this->deviceUpdateVertexInput(this->m_vertex_positions.size(),
                                       this->m_vertex_positions.data(),
                                       this->m_vertex_normals.data(),
-                                      this->m_vertex_material_id.data());
+                                      this->m_vertex_material_id.data(),
+                                      this->m_draw_records.size(),
+                                      this->m_draw_records.data());
         this->m_need_update_device_vertex_input = false;            
     }
 
     if(this->m_need_update_device_ssbo) {
-        this->deviceUpdateSsbo(sizeof(GLSL_SSBO), &this->m_ssbo);
+        this->deviceUpdateSsbo(&this->m_scene_info,
+                               this->m_bvh_nodes.data(),
+                               this->m_materials.data(),
+                               this->m_ssbo_vertex_positions.data(),
+                               this->m_ssbo_vertex_normals.data(),
+                               this->m_ssbo_vertex_material_id.data(),
+                               this->m_ssbo_vertex_entity_id.data());
         this->m_need_update_device_ssbo = false;            
     }
 
-    if(this->m_need_update_device_ubo) {
+    if(this->m_need_update_device_ubo[this->m_current_frame]) {
         this->deviceUpdateUbo(&this->m_ubo);
-        this->m_need_update_device_ubo = false;            
+        this->m_need_update_device_ubo[this->m_current_frame] = false;
+
+        if(this->m_need_report_ubo_update_latency) {
+            std::chrono::duration<double, std::milli> latency = std::chrono::high_resolution_clock::now() - this->m_host_ubo_update_time;
+            YProfiler::instance()->accumulateUboUpdateLatency(latency.count());
+            this->m_need_report_ubo_update_latency = false;
+        }
     }
 
     this->m_push_constant[this->m_current_frame].current_present_image_index = this->m_current_present_image_index;
     this->m_push_constant[this->m_current_frame].current_frame = this->m_current_frame;
+
+    if(this->m_need_reset_path_tracing_accumulation) {
+        this->m_path_tracing_frame_index = 0;
+        this->m_path_tracing_tile_cursor = 0;
+        this->m_need_reset_path_tracing_accumulation = false;
+    }
+    if((YeRenderingModelType::PathTracing == YRendererBackendManager::instance()->getRenderingModel()) &&
+       (this->m_path_tracing_frame_index < this->m_path_tracing_max_frame_count)) {
+        this->m_frame_status[this->m_current_frame].need_draw_path_tracing = true;
+    }
+    this->m_push_constant[this->m_current_frame].path_tracing_frame_index = this->m_path_tracing_frame_index;
     
     this->frameRun();
 
@@ -202,6 +349,8 @@ void YRendererBackend::rotatePhysicallyBasedCamera(const glm::fquat& rotation) {
                                                                rotation);
 
     this->m_ubo.physically_based_camera.forward = glm::normalize(this->m_ubo.physically_based_camera.target - this->m_ubo.physically_based_camera.position);
+
+    this->m_need_reset_path_tracing_accumulation = true;
 }
 
 void YRendererBackend::recursiveFillingBVHBuffer(std::vector<GLSL_BVHNode>* bvh_buffers, YsBVHNodeComponent* node) {
@@ -230,10 +379,8 @@ void YRendererBackend::recursiveFillingBVHBuffer(std::vector<GLSL_BVHNode>* bvh_
     }
 
     if(node->isLeaf()) {
-        bvh_buffers->at(buffer_index).vertex_index = YPhysicsSystem::instance()->meshVertexIndex(node->meshes.front());
-        for(auto mesh : node->meshes) {
-            bvh_buffers->at(buffer_index).vertex_count += mesh->positions.size();
-        }
+        bvh_buffers->at(buffer_index).vertex_index = node->triangle_index * 3;
+        bvh_buffers->at(buffer_index).vertex_count = node->triangle_count * 3;
     } else {
         bvh_buffers->at(buffer_index).vertex_count = 0;
     }
@@ -30,6 +30,7 @@
 #include "YGLSLStructs.hpp"
 
 #include <list>
+#include <chrono>
 
 #include <glm/fwd.hpp>
 #include <glm/vec2.hpp>
@@ -43,7 +44,6 @@
 struct YsBVHNodeComponent;
 
 struct YsFrameStatus {
-    bool need_draw_shadow_mapping = true;
     bool need_draw_rasterization = true;
     bool need_draw_path_tracing = true;
 };
@@ -61,9 +61,17 @@ public:
 
     void rotatePhysicallyBasedCamera(const glm::fquat& rotation);
 
+    // Releases device state that has to outlive the render loop, such as on-disk caches.
+    virtual void shutdown() {}
+
+    // Frames folded into the progressive path tracing accumulation since the last reset.
+    inline u32 pathTracingAccumulatedFrameCount() {return this->m_path_tracing_frame_index;}
+
 protected:
     YRendererBackend();
 
+    // Follows window size and presentation settings before a frame is prepared, false skips the frame.
+    virtual b8 frameResize() {return true;}
     virtual b8 framePrepare() = 0;
     virtual b8 frameRun() = 0;
     virtual b8 framePresent() = 0;
@@ -71,13 +79,24 @@ protected:
     virtual void deviceUpdateVertexInput(u32 vertex_count,
                                        void* vertex_position_data,
                                        void* vertex_normal_data,
-                                       void* vertex_material_id_data) = 0;
-
-    virtual void deviceUpdateSsbo(u32 ssbo_data_size, void* ssbo_data) = 0;
+                                       void* vertex_material_id_data,
+                                       u32 draw_record_count,
+                                       void* draw_record_data) = 0;
+
+    virtual void deviceUpdateSsbo(void* scene_info_data,
+                                  void* bvh_node_data,
+                                  void* material_data,
+                                  void* vertex_position_data,
+                                  void* vertex_normal_data,
+                                  void* vertex_material_id_data,
+                                  void* vertex_entity_id_data) = 0;
 
     virtual void deviceUpdateUbo(void* ubo_data) = 0;
 
 private:
+    // Splits the camera frustum between the shadow map cascades and crops the light frustum to every slice.
+    void updateShadowMapCascades();
+
     void recursiveFillingBVHBuffer(std::vector<GLSL_BVHNode>* bvh_buffers, YsBVHNodeComponent* node);    
 
 protected:
@@ -86,19 +105,40 @@ protected:
     bool m_need_draw;
 
     YsFrameStatus m_frame_status[3];
+    // The shadow map is shared by the frames in flight and only drawn again once the light, the model transform
+    // or the geometry changed, or the camera with more than one cascade.
+    bool m_shadow_map_dirty;
 
     bool m_need_update_device_vertex_input;
     bool m_need_update_device_ssbo;
-    bool m_need_update_device_ubo;
+    // Every frame in flight owns a UBO slice, each one is refreshed when its frame is recorded.
+    bool m_need_update_device_ubo[3] = {};
+    // Time of the latest host UBO change, reported once the next frame has uploaded it.
+    std::chrono::high_resolution_clock::time_point m_host_ubo_update_time;
+    bool m_need_report_ubo_update_latency = false;
+
+    bool m_need_reset_path_tracing_accumulation;
+    u32 m_path_tracing_frame_index;
+    // First tile of the current accumulation frame not traced yet, for backends that spread a frame over several draws.
+    u32 m_path_tracing_tile_cursor;
+    const u32 m_path_tracing_max_frame_count = 4096;
 
     // vertex_data
     std::vector<glm::fvec4> m_vertex_positions;
     std::vector<glm::fvec4> m_vertex_normals;
     std::vector<i32> m_vertex_material_id;
     std::vector<i32> m_vertex_entity_id;
+    // One record per mesh, the GPU culls them and writes the indirect draws.
+    std::vector<GLSL_DrawRecord> m_draw_records;
 
     // ssbo_data
-    GLSL_SSBO m_ssbo = {};
+    GLSL_SceneInfo m_scene_info = {};
+    std::vector<GLSL_BVHNode> m_bvh_nodes;
+    std::vector<GLSL_Material> m_materials;
+    std::vector<glm::fvec4> m_ssbo_vertex_positions;
+    std::vector<glm::fvec4> m_ssbo_vertex_normals;
+    std::vector<i32> m_ssbo_vertex_material_id;
+    std::vector<i32> m_ssbo_vertex_entity_id;
     // ubo_data
     GLSL_UBO m_ubo = {};
     // push_constant_data
@@ -33,8 +33,7 @@ YRendererBackendManager* YRendererBackendManager::instance() {
 }
 
 YRendererBackendManager::YRendererBackendManager()
-    : m_current_renderer_backend_api(YeRendererBackendApi::VULKAN),
-      m_renderer_resolution(YeRendererResolution::Double){
+    : m_current_renderer_backend_api(YeRendererBackendApi::VULKAN){
 
 }
 
@@ -44,4 +43,10 @@ YRendererBackendManager::~YRendererBackendManager() {
 
 void YRendererBackendManager::initBackend() {
     this->m_renderer_backend.insert(std::make_pair(YeRendererBackendApi::VULKAN, std::make_unique<YVulkanBackend>()));
+}
+
+void YRendererBackendManager::shutdownBackend() {
+    for(auto& [api, backend] : this->m_renderer_backend) {
+        backend->shutdown();
+    }
 }
\ No newline at end of file
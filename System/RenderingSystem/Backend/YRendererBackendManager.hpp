@@ -47,10 +47,10 @@ enum class YeRenderingModelType : unsigned char {
     Rasterization
 };
 
-enum class YeRendererResolution : unsigned char {
-    Original,
-    Half,
-    Double
+enum class YePresentMode : unsigned char {
+    Fifo,
+    Mailbox,
+    Immediate
 };
 
 class YRendererBackendManager {
@@ -59,9 +59,12 @@ public:
 
     void initBackend();
 
+    void shutdownBackend();
+
     inline YRendererBackend* backend() {return this->m_renderer_backend.find(this->m_current_renderer_backend_api)->second.get();}
 
-    inline YeRendererResolution rendererResolution() {return this->m_renderer_resolution;}
+    // Size the scene is rendered at for a display of display_size, the upscaling pass brings it back to the display.
+    inline glm::ivec2 rendererSize(const glm::ivec2& display_size) {return glm::max(glm::ivec2(glm::fvec2(display_size) * this->m_render_scale), glm::ivec2(1));}
 
     inline YeRenderingModelType getRenderingModel() {return this->m_rendering_model;}
     inline void setRenderingModel(YeRenderingModelType value) {this->m_rendering_model = value;}
@@ -71,8 +74,28 @@ public:
     inline void setPathTracingMaxDepth(const u32& value) {this->m_path_tracing_max_depth = value;}                                 
     inline u8 getPathTracingEnableBvhAcceleration() {return this->m_path_tracing_enable_bvh_acceleration;}
     inline void setPathTracingEnableBvhAcceleration(b8 value) {this->m_path_tracing_enable_bvh_acceleration = value;}
+    inline f32 getPathTracingFrameBudget() {return this->m_path_tracing_frame_budget;}
+    inline void setPathTracingFrameBudget(f32 value) {this->m_path_tracing_frame_budget = value;}
+    inline u8 getPathTracingTraversalHeatmap() {return this->m_path_tracing_traversal_heatmap;}
+    inline void setPathTracingTraversalHeatmap(b8 value) {this->m_path_tracing_traversal_heatmap = value;}
     inline u8 getPathTracingEnableDenoiser() {return this->m_path_tracing_enable_denoiser;}
     inline void setPathTracingEnableDenoiser(b8 value) {this->m_path_tracing_enable_denoiser = value;}
+    inline u8 getReuseCommandBuffers() {return this->m_reuse_command_buffers;}
+    inline void setReuseCommandBuffers(b8 value) {this->m_reuse_command_buffers = value;}
+    inline u8 getCollectGpuStatistics() {return this->m_collect_gpu_statistics;}
+    inline void setCollectGpuStatistics(b8 value) {this->m_collect_gpu_statistics = value;}
+    inline YePresentMode getPresentMode() {return this->m_present_mode;}
+    inline void setPresentMode(YePresentMode value) {this->m_present_mode = value;}
+    inline u32 getFramesInFlight() {return this->m_frames_in_flight;}
+    inline void setFramesInFlight(const u32& value) {this->m_frames_in_flight = value;}
+    inline u32 getShadowMapResolution() {return this->m_shadow_map_resolution;}
+    inline void setShadowMapResolution(const u32& value) {this->m_shadow_map_resolution = value;}
+    inline u32 getShadowMapCascadeCount() {return this->m_shadow_map_cascade_count;}
+    inline void setShadowMapCascadeCount(const u32& value) {this->m_shadow_map_cascade_count = value;}
+    inline f32 getRenderScale() {return this->m_render_scale;}
+    inline void setRenderScale(f32 value) {this->m_render_scale = value;}
+    inline f32 getUpscalingSharpness() {return this->m_upscaling_sharpness;}
+    inline void setUpscalingSharpness(f32 value) {this->m_upscaling_sharpness = value;}
 
 private:
     YRendererBackendManager();
@@ -82,15 +105,36 @@ private:
     YeRendererBackendApi m_current_renderer_backend_api;
     std::map<YeRendererBackendApi, std::unique_ptr<YRendererBackend>> m_renderer_backend;
 
-    YeRendererResolution m_renderer_resolution;
-
     //
     YeRenderingModelType m_rendering_model = YeRenderingModelType::PathTracing;
 
     u32 m_path_tracing_spp = 1;
     u32 m_path_tracing_max_depth = 100;                                 
     u8 m_path_tracing_enable_bvh_acceleration = false;
+    // GPU milliseconds one frame may spend tracing, 0 traces the whole image every frame.
+    f32 m_path_tracing_frame_budget = 12.0f;
+    u8 m_path_tracing_traversal_heatmap = false;
     u8 m_path_tracing_enable_denoiser = false;
+
+    // Replays the cached draw commands of unchanged passes, turning it off re-records them every frame for comparison.
+    u8 m_reuse_command_buffers = true;
+    // Pipeline statistics queries and the path tracing ray counters, both cost GPU time so they are off by default.
+    u8 m_collect_gpu_statistics = false;
+
+    // Applied by the backend at the start of the next frame, the swapchain is recreated for a new present mode.
+    YePresentMode m_present_mode = YePresentMode::Fifo;
+    // Frames the CPU may record ahead of the GPU, between 1 and the per-frame resources the backend allocated.
+    u32 m_frames_in_flight = 2;
+
+    // Edge length of every shadow map cascade, independent of the renderer resolution.
+    u32 m_shadow_map_resolution = 2048;
+    // Between 1 and SHADOW_MAP_MAX_CASCADE_COUNT, more cascades spread the shadow map over the camera frustum.
+    u32 m_shadow_map_cascade_count = 1;
+
+    // Render size over display size, between 0.5 and 2.0. Applied by the backend at the start of the next frame.
+    f32 m_render_scale = 1.0f;
+    // Between 0 and 1, how much detail the upscaling pass restores after reconstruction.
+    f32 m_upscaling_sharpness = 0.25f;
 };
 
 
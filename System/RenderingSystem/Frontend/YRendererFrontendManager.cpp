@@ -99,7 +99,7 @@ void glfwScrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
 }
 
 void glfwFramebufferSizeCallback(GLFWwindow* window, int width, int height) {
-
+    YRendererFrontendManager::instance()->resizeMainWindow(width, height);
 }
 
 void glfwErrorCallback(int error_code, const char* description) {
@@ -158,10 +158,10 @@ void YRendererFrontendManager::initVulkanEnv() {
 
     glfwWindowHint(GLFW_DECORATED, GLFW_FALSE);
     glfwSetWindowSizeLimits(this->m_glfw_window, 
-                            this->m_main_window_size.x, 
-                            this->m_main_window_size.y, 
-                            this->m_main_window_size.x, 
-                            this->m_main_window_size.y);
+                            640, 
+                            360, 
+                            GLFW_DONT_CARE, 
+                            GLFW_DONT_CARE);
     glfwSetKeyCallback(this->m_glfw_window, glfwKeyCallback);
     glfwSetMouseButtonCallback(this->m_glfw_window, glfwMouseButtonCallback);
     glfwSetCursorPosCallback(this->m_glfw_window, glfwCursorPositionCallback);
@@ -177,6 +177,12 @@ void YRendererFrontendManager::eventLoop() {
     while (!glfwWindowShouldClose(this->m_glfw_window)) {
         auto start_rendering = std::chrono::high_resolution_clock::now();
         {
+            // Nothing can be presented to a minimized window, block until it is restored.
+            if(0 == this->m_main_window_framebuffer_size.x || 0 == this->m_main_window_framebuffer_size.y) {
+                glfwWaitEvents();
+                continue;
+            }
+
             glfwPollEvents();
 
             YEventHandlerManager::instance()->pollEvents();
@@ -190,6 +196,13 @@ void YRendererFrontendManager::eventLoop() {
     }
 }
 
+void YRendererFrontendManager::resizeMainWindow(int framebuffer_width, int framebuffer_height) {
+    this->m_main_window_framebuffer_size = glm::ivec2(framebuffer_width, framebuffer_height);
+    glfwGetWindowSize(this->m_glfw_window, 
+                      &this->m_main_window_size.x, 
+                      &this->m_main_window_size.y);
+}
+
 void YRendererFrontendManager::rotateCameraOnSphere(glm::fvec3& position,
                                                     const glm::fvec3& target,
                                                     glm::fvec3& up,
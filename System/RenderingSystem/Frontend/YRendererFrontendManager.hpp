@@ -52,6 +52,8 @@ public:
 
     inline GLFWwindow* glfwWindow() {return this->m_glfw_window;}
     inline const glm::ivec2& mainWindowSize() {return this->m_main_window_size;}
+    // In pixels, zero while the window is minimized.
+    inline const glm::ivec2& mainWindowFramebufferSize() {return this->m_main_window_framebuffer_size;}
     inline YCamera* camera() {return this->m_camera.get();}
     inline YTrackball* trackball() {return this->m_trackball.get();}
 
@@ -61,6 +63,9 @@ public:
                               glm::fvec3& right,
                               const glm::fquat& rotation);
 
+    // Called from the GLFW framebuffer size callback, the backend picks the new size up before its next frame.
+    void resizeMainWindow(int framebuffer_width, int framebuffer_height);
+
 private:
     YRendererFrontendManager();
     ~YRendererFrontendManager();
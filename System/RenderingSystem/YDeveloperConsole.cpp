@@ -40,8 +40,10 @@
 #include "glfw/glfw3.h"
 #include "YRendererBackendManager.hpp"
 #include "YRendererFrontendManager.hpp"
+#include "YPhysicsSystem.hpp"
 
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
@@ -105,7 +107,7 @@ void YDeveloperConsole::init(YsVkContext* vk_context,
     init_info.Device = vk_context->device->logical_device;
     init_info.QueueFamily = vk_context->device->commandUnitsBack(vk_context->device)->queue_family_index;
     init_info.Queue = vk_context->device->commandUnitsBack(vk_context->device)->queue;
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = vk_context->pipeline_cache;
     init_info.DescriptorPool = this->m_imgui_descriptor_pool;
     init_info.RenderPass = rendering_system->output->render_stage->render_pass_handle;
     init_info.Subpass = 0;
@@ -115,16 +117,27 @@ void YDeveloperConsole::init(YsVkContext* vk_context,
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     ImGui_ImplVulkan_Init(&init_info);
 
-    this->m_rasterization_image_descriptor_sets = (VkDescriptorSet*)yCMemoryAllocate(sizeof(VkDescriptorSet) * vk_context->swapchain->image_count);
-    this->m_shadow_mapping_descriptor_sets = (VkDescriptorSet*)yCMemoryAllocate(sizeof(VkDescriptorSet) * vk_context->swapchain->image_count);
-    for(int i = 0; i < vk_context->swapchain->image_count; ++i) {
-        this->m_rasterization_image_descriptor_sets[i] = ImGui_ImplVulkan_AddTexture(vk_resource->sampler_linear,
-                                                                                     vk_resource->rasterization_color_image->layer_views[i],
+    this->m_rasterization_image_descriptor_sets = (VkDescriptorSet*)yCMemoryAllocate(sizeof(VkDescriptorSet) * vk_context->swapchain->max_frames_in_flight);
+    this->updateTextures();
+}
+
+void YDeveloperConsole::updateTextures() {
+    for(int i = 0; i < this->m_vk_context->swapchain->max_frames_in_flight; ++i) {
+        if(this->m_rasterization_image_descriptor_sets[i]) {
+            ImGui_ImplVulkan_RemoveTexture(this->m_rasterization_image_descriptor_sets[i]);
+        }
+        this->m_rasterization_image_descriptor_sets[i] = ImGui_ImplVulkan_AddTexture(this->m_vk_resource->sampler_linear,
+                                                                                     this->m_vk_resource->rasterization_color_image->layer_views[i],
                                                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        this->m_shadow_mapping_descriptor_sets[i] = ImGui_ImplVulkan_AddTexture(vk_resource->sampler_linear,
-                                                                                vk_resource->shadow_map_image->layer_views[i],
-                                                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);                                                                                    
     }
+
+    // The frames in flight share the shadow map.
+    if(this->m_shadow_mapping_descriptor_set) {
+        ImGui_ImplVulkan_RemoveTexture(this->m_shadow_mapping_descriptor_set);
+    }
+    this->m_shadow_mapping_descriptor_set = ImGui_ImplVulkan_AddTexture(this->m_vk_resource->sampler_linear,
+                                                                        this->m_vk_resource->shadow_map_image->image_view,
+                                                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
 void YDeveloperConsole::addLogMessage(int log_level, const std::string& message) {
@@ -161,8 +174,7 @@ void YDeveloperConsole::addLogMessage(int log_level, const std::string& message)
     this->m_log_message.push_back(m);
 }
 
-void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
-                                u32 command_buffer_index,
+void YDeveloperConsole::cmdDraw(VkCommandBuffer command_buffer,
                                 u32 current_frame, 
                                 u32 current_present_image_index) {
     glm::fvec2 window_size = glm::fvec2(ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
@@ -187,25 +199,7 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
     ImGui::Begin("Performance Monitor");
     {
         ImVec4 yellow = ImVec4(1.0f, 1.0f, 0.0f, 1.0f);
-        YeRendererResolution renderer_resolution = YRendererBackendManager::instance()->rendererResolution();
-        glm::fvec2 renderer_image_size;
-        switch (renderer_resolution){
-            case YeRendererResolution::Original: {
-                renderer_image_size = window_size;
-                break;
-            }
-            case YeRendererResolution::Half: {
-                renderer_image_size = window_size * 0.5f;
-                break;
-            }
-            case YeRendererResolution::Double: {
-                renderer_image_size = window_size * 2.0f;
-                break;
-            }
-            default: {
-                break;
-            }
-        }
+        glm::ivec2 renderer_image_size = YRendererBackendManager::instance()->rendererSize(YRendererFrontendManager::instance()->mainWindowFramebufferSize());
         std::string str_render_res = std::to_string(u32(renderer_image_size.x)) + " x " + std::to_string(u32(renderer_image_size.y));
         ImGui::Text("Render Resolution: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text(str_render_res.c_str());ImGui::PopStyleColor();
         ImGui::Text("Render FPS: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%i", YProfiler::instance()->renderingFPS());ImGui::PopStyleColor();
@@ -214,12 +208,145 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
         ImGui::Text("Render Frame Time(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%f", 1000.0f / YProfiler::instance()->renderingFPS());ImGui::PopStyleColor();
         ImGui::Text("CPU Frame Time(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%f", 1000.0f / YProfiler::instance()->cpuFPS());ImGui::PopStyleColor();
         ImGui::Text("GPU Frame Time(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%f", 1000.0f / YProfiler::instance()->gpuFPS());ImGui::PopStyleColor();
+        ImGui::Text("UBO Update Latency(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f", YProfiler::instance()->uboUpdateLatency());ImGui::PopStyleColor();
+        ImGui::Text("Command Recording(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f", YProfiler::instance()->commandRecordingTime());ImGui::PopStyleColor();
+        ImGui::Text("Accumulated Frames: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u", YRendererBackendManager::instance()->backend()->pathTracingAccumulatedFrameCount());ImGui::PopStyleColor();
+
+        // Per-queue timeline of the last measured frame, the compute row only overlaps the scene passes with async compute.
+        YsQueueTimeline queue_timeline = YProfiler::instance()->queueTimeline();
+        double compute_time = queue_timeline.compute_end - queue_timeline.compute_begin;
+        double compute_overlap = std::max(0.0, std::min(queue_timeline.scene_end, queue_timeline.compute_end) - std::max(0.0, queue_timeline.compute_begin));
+        ImGui::Text("Async Compute: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%s", queue_timeline.async_compute ? "On" : "Off");ImGui::PopStyleColor();
+        // Spans of queues on unrelated time bases cannot overlap in any meaningful way, only the compute time is shown.
+        if(queue_timeline.common_time_base || compute_time <= 0.0) {
+            ImGui::Text("Compute Overlap(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f / %.3f", compute_overlap, compute_time);ImGui::PopStyleColor();
+        } else {
+            ImGui::Text("Compute Overlap(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("n/a / %.3f (uncalibrated)", compute_time);ImGui::PopStyleColor();
+        }
+        {
+            ImDrawList* draw_list = ImGui::GetWindowDrawList();
+            f32 label_width = ImGui::CalcTextSize("Graphics ").x;
+            f32 row_height = ImGui::GetTextLineHeight();
+            f32 timeline_width = std::max(ImGui::GetContentRegionAvail().x - label_width, 1.0f);
+            double timeline_span = std::max(queue_timeline.frame_end, queue_timeline.compute_end);
+            f32 scale = timeline_span > 0.0 ? f32(timeline_width / timeline_span) : 0.0f;
+
+            ImGui::Text("Graphics");ImGui::SameLine(label_width);
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            draw_list->AddRectFilled(origin,
+                                     ImVec2(origin.x + f32(queue_timeline.scene_end) * scale, origin.y + row_height),
+                                     IM_COL32(80, 160, 255, 255));
+            draw_list->AddRectFilled(ImVec2(origin.x + f32(queue_timeline.scene_end) * scale, origin.y),
+                                     ImVec2(origin.x + f32(queue_timeline.frame_end) * scale, origin.y + row_height),
+                                     IM_COL32(80, 220, 120, 255));
+            ImGui::Dummy(ImVec2(timeline_width, row_height));
+
+            ImGui::Text("Compute");ImGui::SameLine(label_width);
+            origin = ImGui::GetCursorScreenPos();
+            if(compute_time > 0.0) {
+                draw_list->AddRectFilled(ImVec2(origin.x + f32(std::max(0.0, queue_timeline.compute_begin)) * scale, origin.y),
+                                         ImVec2(origin.x + f32(queue_timeline.compute_end) * scale, origin.y + row_height),
+                                         IM_COL32(255, 170, 60, 255));
+            }
+            ImGui::Dummy(ImVec2(timeline_width, row_height));
+        }
+        // GPU scopes in the order they ran, ImGui is measured inside Output.
+        std::vector<YsGpuScopeTiming> gpu_scope_timings = YProfiler::instance()->gpuScopeTimings();
+        if (ImGui::BeginTable("GPU Scopes", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableSetupColumn("Time(ms)");
+            ImGui::TableSetupColumn("Invocations");
+            ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableHeadersRow();
+            for(const YsGpuScopeTiming& timing : gpu_scope_timings) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();ImGui::Text("%s", timing.name.c_str());
+                ImGui::TableNextColumn();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f", timing.time);ImGui::PopStyleColor();
+                ImGui::TableNextColumn();
+                if(timing.has_invocations && timing.compute_invocations > 0) {
+                    ImGui::Text("CS %llu", (unsigned long long)timing.compute_invocations);
+                } else if(timing.has_invocations) {
+                    ImGui::Text("VS %llu / FS %llu", (unsigned long long)timing.vertex_invocations, (unsigned long long)timing.fragment_invocations);
+                } else {
+                    ImGui::Text("-");
+                }
+                ImGui::TableNextColumn();
+                ImGui::PushID(timing.name.c_str());
+                ImGui::PlotLines("",
+                                 timing.history.data(),
+                                 i32(timing.history.size()),
+                                 i32(timing.history_offset),
+                                 nullptr,
+                                 0.0f,
+                                 FLT_MAX,
+                                 ImVec2(-1.0f, ImGui::GetTextLineHeight() * 2.0f));
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+        if(YRendererBackendManager::instance()->getCollectGpuStatistics()) {
+            YsPathTracingStatistics path_tracing_statistics = YProfiler::instance()->pathTracingStatistics();
+            ImGui::Text("Path Tracing Mrays/s: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.2f", path_tracing_statistics.mrays_per_second);ImGui::PopStyleColor();
+            ImGui::Text("Rays / Nodes / Triangles: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%llu / %llu / %llu",
+                                                                                                                                (unsigned long long)path_tracing_statistics.ray_count,
+                                                                                                                                (unsigned long long)path_tracing_statistics.node_count,
+                                                                                                                                (unsigned long long)path_tracing_statistics.triangle_count);ImGui::PopStyleColor();
+        }
+        YsCullingStatistics culling_statistics = YProfiler::instance()->cullingStatistics();
+        ImGui::Text("Draw Records: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u", culling_statistics.record_count);ImGui::PopStyleColor();
+        ImGui::Text("Frustum / Occlusion Culled: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u / %u",
+                                                                                                                           culling_statistics.frustum_culled_count,
+                                                                                                                           culling_statistics.occlusion_culled_count);ImGui::PopStyleColor();
+        ImGui::Text("Drawn (Late): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u (%u)",
+                                                                                                              culling_statistics.drawn_count,
+                                                                                                              culling_statistics.late_drawn_count);ImGui::PopStyleColor();
+        YsBVHBuildReport bvh_report = YPhysicsSystem::instance()->buildReport();
+        ImGui::Text("BVH Build Time(ms): ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f", bvh_report.build_time);ImGui::PopStyleColor();
+        ImGui::Text("BVH SAH Cost: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%.3f", bvh_report.sah_cost);ImGui::PopStyleColor();
+        ImGui::Text("BVH Nodes / Leaves: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u / %u", bvh_report.node_count, bvh_report.leaf_count);ImGui::PopStyleColor();
+        ImGui::Text("BVH Build Threads: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u", bvh_report.thread_count);ImGui::PopStyleColor();
     }
     ImGui::End();
 
-    ImGui::Begin("Intermediate Image", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+    ImGui::Begin("Device Memory");
     {
-        ImGui::Image(u64(this->m_shadow_mapping_descriptor_sets[current_frame]),
+        ImVec4 yellow = ImVec4(1.0f, 1.0f, 0.0f, 1.0f);
+        YsVkMemoryAllocator* memory_allocator = this->m_vk_context->memory_allocator;
+        ImGui::Text("Device Allocations: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u / %u", memory_allocator->device_allocation_count, this->m_vk_context->device->properties.limits.maxMemoryAllocationCount);ImGui::PopStyleColor();
+        ImGui::Text("Dedicated Allocations: ");ImGui::SameLine();ImGui::PushStyleColor(ImGuiCol_Text, yellow);ImGui::Text("%u (%.2f MB)", memory_allocator->dedicated_allocation_count, memory_allocator->dedicated_allocation_size / (1024.0 * 1024.0));ImGui::PopStyleColor();
+
+        YsVkMemoryPoolStatistics pool_statistics[VK_MAX_MEMORY_TYPES * MEMORY_RESOURCE_COUNT * MEMORY_STRATEGY_COUNT];
+        u32 pool_count = memory_allocator->queryPoolStatistics(memory_allocator, IM_ARRAYSIZE(pool_statistics), pool_statistics);
+        if (ImGui::BeginTable("Memory Pools", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Pool");
+            ImGui::TableSetupColumn("Blocks");
+            ImGui::TableSetupColumn("Allocations");
+            ImGui::TableSetupColumn("Used / Reserved(MB)");
+            ImGui::TableSetupColumn("Largest Free(MB)");
+            ImGui::TableSetupColumn("Fragmentation");
+            ImGui::TableHeadersRow();
+            for(u32 i = 0; i < pool_count; ++i) {
+                const YsVkMemoryPoolStatistics& statistics = pool_statistics[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();ImGui::Text("Type %u %s %s",
+                                                     statistics.memory_type_index,
+                                                     this->m_memory_resource_kind_items[statistics.resource_kind],
+                                                     this->m_memory_strategy_items[statistics.strategy]);
+                ImGui::TableNextColumn();ImGui::Text("%u", statistics.block_count);
+                ImGui::TableNextColumn();ImGui::Text("%u", statistics.allocation_count);
+                ImGui::TableNextColumn();ImGui::Text("%.2f / %.2f", statistics.used_size / (1024.0 * 1024.0), statistics.reserved_size / (1024.0 * 1024.0));
+                ImGui::TableNextColumn();ImGui::Text("%.2f", statistics.largest_free_size / (1024.0 * 1024.0));
+                ImGui::TableNextColumn();ImGui::Text("%.1f%%", statistics.fragmentation * 100.0f);
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+
+    ImGui::Begin("Intermediate Image", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+    // The render graph culls the rasterization passes while path tracing and may alias their images.
+    if(YeRenderingModelType::Rasterization == YRendererBackendManager::instance()->getRenderingModel()) {
+        ImGui::Image(u64(this->m_shadow_mapping_descriptor_set),
                      ImVec2(this->m_vk_resource->shadow_map_image->create_info->extent.width * 0.05f,
                             this->m_vk_resource->shadow_map_image->create_info->extent.height * 0.05f));
         ImGui::Text("Shadow Map Image");
@@ -229,6 +356,8 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
                             this->m_vk_resource->rasterization_color_image->create_info->extent.height * 0.05f));
         ImGui::Text("Rasterization Image");
         ImGui::Dummy(ImVec2(0.0f, 20.0f));
+    } else {
+        ImGui::Text("Not rendered in path tracing mode.");
     }
     ImGui::End();
 
@@ -271,6 +400,59 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
                      &current_rendering_api_item,
                      this->m_rendering_api_items,
                      IM_ARRAYSIZE(this->m_rendering_api_items));
+
+        // The backend picks both up before its next frame, a new present mode recreates the swapchain.
+        ImGui::SetNextItemWidth(150.0f);
+        int present_mode_item = static_cast<int>(YRendererBackendManager::instance()->getPresentMode());
+        ImGui::Combo("Present Mode",
+                     &present_mode_item,
+                     this->m_present_mode_items,
+                     IM_ARRAYSIZE(this->m_present_mode_items));
+        YRendererBackendManager::instance()->setPresentMode(static_cast<YePresentMode>(present_mode_item));
+
+        ImGui::SetNextItemWidth(150.0f);
+        int frames_in_flight = YRendererBackendManager::instance()->getFramesInFlight();
+        ImGui::InputInt("Frames In Flight", &frames_in_flight, 1, 1, ImGuiInputTextFlags_CharsDecimal);
+        frames_in_flight = std::clamp(frames_in_flight, 1, i32(this->m_vk_context->swapchain->max_frames_in_flight));
+        YRendererBackendManager::instance()->setFramesInFlight(frames_in_flight);
+
+        // A new shadow map resolution or cascade count rebuilds the shadow map before the next frame.
+        ImGui::SetNextItemWidth(150.0f);
+        int shadow_map_resolution_item = 0;
+        while(shadow_map_resolution_item < IM_ARRAYSIZE(this->m_shadow_map_resolution_items) - 1 &&
+              (512u << shadow_map_resolution_item) < YRendererBackendManager::instance()->getShadowMapResolution()) {
+            ++shadow_map_resolution_item;
+        }
+        ImGui::Combo("Shadow Map Resolution",
+                     &shadow_map_resolution_item,
+                     this->m_shadow_map_resolution_items,
+                     IM_ARRAYSIZE(this->m_shadow_map_resolution_items));
+        YRendererBackendManager::instance()->setShadowMapResolution(512u << shadow_map_resolution_item);
+
+        ImGui::SetNextItemWidth(150.0f);
+        int shadow_map_cascade_count = YRendererBackendManager::instance()->getShadowMapCascadeCount();
+        ImGui::InputInt("Shadow Cascades", &shadow_map_cascade_count, 1, 1, ImGuiInputTextFlags_CharsDecimal);
+        shadow_map_cascade_count = std::clamp(shadow_map_cascade_count, 1, SHADOW_MAP_MAX_CASCADE_COUNT);
+        YRendererBackendManager::instance()->setShadowMapCascadeCount(shadow_map_cascade_count);
+
+        // Every render target is rebuilt for a new scale, so it is only applied once the slider is released.
+        ImGui::SetNextItemWidth(150.0f);
+        static f32 render_scale = YRendererBackendManager::instance()->getRenderScale();
+        ImGui::SliderFloat("Render Scale", &render_scale, 0.5f, 2.0f, "%.2f");
+        if(ImGui::IsItemDeactivatedAfterEdit()) {
+            YRendererBackendManager::instance()->setRenderScale(std::clamp(render_scale, 0.5f, 2.0f));
+        }
+
+        ImGui::SetNextItemWidth(150.0f);
+        f32 upscaling_sharpness = YRendererBackendManager::instance()->getUpscalingSharpness();
+        ImGui::SliderFloat("Upscaling Sharpness", &upscaling_sharpness, 0.0f, 1.0f, "%.2f");
+        upscaling_sharpness = std::clamp(upscaling_sharpness, 0.0f, 1.0f);
+        if(upscaling_sharpness != YRendererBackendManager::instance()->getUpscalingSharpness()) {
+            YRendererBackendManager::instance()->setUpscalingSharpness(upscaling_sharpness);
+            YsChangingUpscalingSharpnessEvent e;
+            e.upscaling_sharpness = upscaling_sharpness;
+            YEventHandlerManager::instance()->pushEvent(e);
+        }
     }
     ImGui::End();
 
@@ -296,6 +478,10 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
         }
         YRendererBackendManager::instance()->setPathTracingMaxDepth(max_depth);
 
+        f32 frame_budget = YRendererBackendManager::instance()->getPathTracingFrameBudget();
+        ImGui::InputFloat("Frame Budget(ms)", &frame_budget, 1.0f, 10.0f, "%.1f");
+        YRendererBackendManager::instance()->setPathTracingFrameBudget(frame_budget < 0.0f ? 0.0f : frame_budget);
+
         bool enable_bvh_acceleration = YRendererBackendManager::instance()->getPathTracingEnableBvhAcceleration();
         ImGui::Checkbox("Enable BVH Acceleration", &enable_bvh_acceleration);
         if(enable_bvh_acceleration != YRendererBackendManager::instance()->getPathTracingEnableBvhAcceleration()) {
@@ -305,6 +491,32 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
         }
         YRendererBackendManager::instance()->setPathTracingEnableBvhAcceleration(enable_bvh_acceleration);
 
+        bool traversal_heatmap = YRendererBackendManager::instance()->getPathTracingTraversalHeatmap();
+        ImGui::Checkbox("Traversal Heatmap", &traversal_heatmap);
+        if(traversal_heatmap != YRendererBackendManager::instance()->getPathTracingTraversalHeatmap()) {
+            YsChangingPathTracingTraversalHeatmapEvent e;
+            e.traversal_heatmap = traversal_heatmap;
+            YEventHandlerManager::instance()->pushEvent(e);
+        }
+        YRendererBackendManager::instance()->setPathTracingTraversalHeatmap(traversal_heatmap);
+
+        ImGui::SetNextItemWidth(150.0f);
+        i32 bvh_partitioning_item = static_cast<i32>(YPhysicsSystem::instance()->getPartitioningAlgorithm());
+        ImGui::Combo("BVH Partitioning",
+                     &bvh_partitioning_item,
+                     this->m_bvh_partitioning_items,
+                     IM_ARRAYSIZE(this->m_bvh_partitioning_items));
+        i32 bvh_leaf_size = YPhysicsSystem::instance()->getMaxLeafTriangleCount();
+        ImGui::InputInt("BVH Leaf Size", &bvh_leaf_size, 1, 8, ImGuiInputTextFlags_CharsDecimal);
+        bvh_leaf_size = bvh_leaf_size < 1 ? 1 : bvh_leaf_size;
+        if((bvh_partitioning_item != static_cast<i32>(YPhysicsSystem::instance()->getPartitioningAlgorithm())) ||
+           (bvh_leaf_size != YPhysicsSystem::instance()->getMaxLeafTriangleCount())) {
+            YsChangingBvhBuildSettingsEvent e;
+            e.partitioning_algorithm = bvh_partitioning_item;
+            e.max_leaf_triangle_count = bvh_leaf_size;
+            YEventHandlerManager::instance()->pushEvent(e);
+        }
+
         bool enable_denoiser = YRendererBackendManager::instance()->getPathTracingEnableDenoiser();
         ImGui::Checkbox("Enable Denoiser", &enable_denoiser);
         if(enable_denoiser != YRendererBackendManager::instance()->getPathTracingEnableDenoiser()) {
@@ -313,13 +525,27 @@ void YDeveloperConsole::cmdDraw(YsVkCommandUnit* command_unit,
             YEventHandlerManager::instance()->pushEvent(e);
         }
         YRendererBackendManager::instance()->setPathTracingEnableDenoiser(enable_denoiser);
+
+        // Compare the CPU frame time with the cached draw commands on and off.
+        bool reuse_command_buffers = YRendererBackendManager::instance()->getReuseCommandBuffers();
+        ImGui::Checkbox("Reuse Command Buffers", &reuse_command_buffers);
+        YRendererBackendManager::instance()->setReuseCommandBuffers(reuse_command_buffers);
+
+        bool collect_gpu_statistics = YRendererBackendManager::instance()->getCollectGpuStatistics();
+        ImGui::Checkbox("GPU Statistics", &collect_gpu_statistics);
+        if(collect_gpu_statistics != YRendererBackendManager::instance()->getCollectGpuStatistics()) {
+            YsChangingCollectGpuStatisticsEvent e;
+            e.collect_gpu_statistics = collect_gpu_statistics;
+            YEventHandlerManager::instance()->pushEvent(e);
+        }
+        YRendererBackendManager::instance()->setCollectGpuStatistics(collect_gpu_statistics);
     }  
     ImGui::End();  
 
     ImGui::Render();
     ImDrawData* draw_data = ImGui::GetDrawData();
 
-    ImGui_ImplVulkan_RenderDrawData(draw_data, command_unit->command_buffers[command_buffer_index]);
+    ImGui_ImplVulkan_RenderDrawData(draw_data, command_buffer);
 }
 
 void YDeveloperConsole::drawLog() const {
@@ -56,8 +56,10 @@ public:
 
     void addLogMessage(int log_level, const std::string& message);
 
-    void cmdDraw(YsVkCommandUnit* command_unit,
-                 u32 command_buffer_index,
+    // Points the intermediate image previews at the current layer views, after the resources were resized.
+    void updateTextures();
+
+    void cmdDraw(VkCommandBuffer command_buffer,
                  u32 current_frame, 
                  u32 current_present_image_index);
 
@@ -79,11 +81,16 @@ private:
     VkDescriptorPool m_imgui_descriptor_pool;
 
     VkDescriptorSet* m_rasterization_image_descriptor_sets;
-    VkDescriptorSet* m_shadow_mapping_descriptor_sets;
+    VkDescriptorSet m_shadow_mapping_descriptor_set = VK_NULL_HANDLE;
 
     //
     const char* m_rendering_model_items[2] = {"Path Tracing", "Rasterization"};
     const char* m_rendering_api_items[4] = {"Vulkan", "Metal", "DirectX", "CPU"};
+    const char* m_bvh_partitioning_items[2] = {"SAH", "Median Split"};
+    const char* m_memory_strategy_items[2] = {"Buddy", "Linear"};
+    const char* m_memory_resource_kind_items[2] = {"Buffer", "Image"};
+    const char* m_present_mode_items[3] = {"FIFO", "Mailbox", "Immediate"};
+    const char* m_shadow_map_resolution_items[4] = {"512", "1024", "2048", "4096"};
     const char* m_scene_items[10] = {"Cornell Box",
                                      "Utah Teapot",
                                      "Armadillo",
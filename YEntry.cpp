@@ -61,5 +61,7 @@ int main(int argc, char *argv[]) {
 
     YRendererFrontendManager::instance()->eventLoop();
 
+    YRendererBackendManager::instance()->shutdownBackend();
+
     return 0;
 }